@@ -0,0 +1,78 @@
+//
+//  JotBenchmark.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#ifndef JotBenchmark_h
+#define JotBenchmark_h
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// the size of a full screen retina iPad page, in pixels
+#define kJotBenchmarkPageWidth 1536
+#define kJotBenchmarkPageHeight 2048
+
+static inline double JotBenchmarkNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+// runs statement repeat times, and returns the average milliseconds per run
+#define JotBenchmarkTime(repeat, statement)                  \
+    ({                                                       \
+        double _jotStart = JotBenchmarkNow();                \
+        for (int _jotRun = 0; _jotRun < (repeat); _jotRun++) { \
+            statement;                                       \
+        }                                                    \
+        (JotBenchmarkNow() - _jotStart) * 1000.0 / (repeat); \
+    })
+
+/**
+ * fills a premultiplied RGBA page with strokeCount random walks of
+ * antialiased round dots, like ink on a page that's mostly transparent
+ */
+static inline void JotBenchmarkFillPage(uint8_t* pixels, size_t width, size_t height, int strokeCount, unsigned seed) {
+    memset(pixels, 0, width * height * 4);
+    srand(seed);
+    for (int stroke = 0; stroke < strokeCount; stroke++) {
+        double x = rand() % width, y = rand() % height, dx = 0, dy = 0;
+        uint8_t color[3] = {rand() % 256, rand() % 256, rand() % 256};
+        double radius = 2 + rand() % 6;
+        for (int step = 0; step < 400; step++) {
+            dx += ((rand() % 100) - 50) / 200.0;
+            dy += ((rand() % 100) - 50) / 200.0;
+            x += dx;
+            y += dy;
+            for (long py = (long)(y - radius - 1); py <= y + radius + 1; py++) {
+                for (long px = (long)(x - radius - 1); px <= x + radius + 1; px++) {
+                    if (px < 0 || py < 0 || px >= (long)width || py >= (long)height) {
+                        continue;
+                    }
+                    double coverage = radius + 0.5 - sqrt((px - x) * (px - x) + (py - y) * (py - y));
+                    if (coverage <= 0) {
+                        continue;
+                    }
+                    uint8_t alpha = (uint8_t)(fmin(coverage, 1) * 255);
+                    uint8_t* pixel = pixels + ((size_t)py * width + (size_t)px) * 4;
+                    if (alpha > pixel[3]) {
+                        for (int c = 0; c < 3; c++) {
+                            pixel[c] = (uint8_t)(color[c] * alpha / 255);
+                        }
+                        pixel[3] = alpha;
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif /* JotBenchmark_h */
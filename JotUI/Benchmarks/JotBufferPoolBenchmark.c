@@ -0,0 +1,270 @@
+//
+//  JotBufferPoolBenchmark.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+//  compares JotBufferPool to a first fit cache over one list, like the
+//  data cache it replaced, for same sized thumbnails, mixed sizes, and
+//  small scratch buffers on one and four threads. first checks the size
+//  classes, that every run gives back what it took, and that a thread
+//  that exits only returns its own magazine:
+//
+//      cc -O2 -I../JotUI JotBufferPoolBenchmark.c ../JotUI/JotBufferPool.c -o buffer_pool -lpthread -lm
+//
+
+#include "JotBenchmark.h"
+#include "JotBufferPool.h"
+#include <pthread.h>
+#include <stdbool.h>
+
+#define kJotFirstFitCapacity 4096
+#define kJotMaxThreads 4
+#define kJotLiveBuffers 8
+
+typedef enum {
+    JotPatternThumbnails,
+    JotPatternMixed,
+    JotPatternScratch,
+} JotPattern;
+
+#pragma mark - First Fit
+
+// takes the first cached buffer that's big enough, whatever its size
+typedef struct {
+    void* buffer;
+    size_t capacity;
+} JotFirstFitEntry;
+
+static JotFirstFitEntry firstFitEntries[kJotFirstFitCapacity];
+static int firstFitCount;
+static pthread_mutex_t firstFitLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void* JotFirstFitAlloc(size_t size, size_t* capacity) {
+    pthread_mutex_lock(&firstFitLock);
+    for (int i = 0; i < firstFitCount; i++) {
+        if (firstFitEntries[i].capacity >= size) {
+            void* buffer = firstFitEntries[i].buffer;
+            *capacity = firstFitEntries[i].capacity;
+            memmove(&firstFitEntries[i], &firstFitEntries[i + 1], (size_t)(firstFitCount - i - 1) * sizeof(JotFirstFitEntry));
+            firstFitCount--;
+            pthread_mutex_unlock(&firstFitLock);
+            return buffer;
+        }
+    }
+    pthread_mutex_unlock(&firstFitLock);
+    *capacity = size;
+    return malloc(size);
+}
+
+static void JotFirstFitRelease(void* buffer, size_t capacity) {
+    pthread_mutex_lock(&firstFitLock);
+    if (firstFitCount < kJotFirstFitCapacity) {
+        firstFitEntries[firstFitCount++] = (JotFirstFitEntry){buffer, capacity};
+        buffer = NULL;
+    }
+    pthread_mutex_unlock(&firstFitLock);
+    free(buffer);
+}
+
+static void JotFirstFitDrain(void) {
+    for (int i = 0; i < firstFitCount; i++) {
+        free(firstFitEntries[i].buffer);
+    }
+    firstFitCount = 0;
+}
+
+#pragma mark - Workers
+
+typedef struct {
+    JotBufferPool* pool;
+    JotPattern pattern;
+    int iterations;
+    unsigned seed;
+    bool corrupt;
+} JotWorker;
+
+static unsigned JotRandom(unsigned* seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return *seed >> 8;
+}
+
+static size_t JotSizeForPattern(JotPattern pattern, unsigned* seed) {
+    switch (pattern) {
+        case JotPatternThumbnails:
+            return 1024 * 768 * 4;
+        case JotPatternMixed:
+            return 4096 + JotRandom(seed) % (4 * 1024 * 1024);
+        default:
+            return 512 + JotRandom(seed) % (48 * 1024);
+    }
+}
+
+// holds up to kJotLiveBuffers at once, and checks that no one else
+// wrote into them while they were held
+static void* JotRunWorker(void* context) {
+    JotWorker* worker = context;
+    void* live[kJotLiveBuffers] = {NULL};
+    size_t sizes[kJotLiveBuffers], capacities[kJotLiveBuffers];
+    unsigned seed = worker->seed;
+    for (int i = 0; i < worker->iterations; i++) {
+        int slot = (int)(JotRandom(&seed) % kJotLiveBuffers);
+        uint8_t* buffer = live[slot];
+        if (buffer) {
+            uint8_t mark = (uint8_t)slot;
+            worker->corrupt |= buffer[0] != mark || buffer[sizes[slot] - 1] != mark || capacities[slot] < sizes[slot];
+            if (worker->pool) {
+                JotBufferPoolRelease(worker->pool, buffer, capacities[slot]);
+            } else {
+                JotFirstFitRelease(buffer, capacities[slot]);
+            }
+            live[slot] = NULL;
+        } else {
+            sizes[slot] = JotSizeForPattern(worker->pattern, &seed);
+            buffer = worker->pool ? JotBufferPoolAlloc(worker->pool, sizes[slot], &capacities[slot]) : JotFirstFitAlloc(sizes[slot], &capacities[slot]);
+            if (!buffer) {
+                worker->corrupt = true;
+                break;
+            }
+            buffer[0] = buffer[sizes[slot] - 1] = (uint8_t)slot;
+            live[slot] = buffer;
+        }
+    }
+    for (int slot = 0; slot < kJotLiveBuffers; slot++) {
+        if (live[slot] && worker->pool) {
+            JotBufferPoolRelease(worker->pool, live[slot], capacities[slot]);
+        } else if (live[slot]) {
+            JotFirstFitRelease(live[slot], capacities[slot]);
+        }
+    }
+    return NULL;
+}
+
+// runs the pattern on threadCount threads, with the pool or with
+// first fit if pool is NULL, and returns the milliseconds it took
+static double JotRunPattern(JotBufferPool* pool, JotPattern pattern, int threadCount, int iterations, int* failures) {
+    pthread_t threads[kJotMaxThreads];
+    JotWorker workers[kJotMaxThreads];
+    double start = JotBenchmarkNow();
+    for (int i = 0; i < threadCount; i++) {
+        workers[i] = (JotWorker){pool, pattern, iterations, (unsigned)(i * 7 + 1), false};
+        pthread_create(&threads[i], NULL, JotRunWorker, &workers[i]);
+    }
+    for (int i = 0; i < threadCount; i++) {
+        pthread_join(threads[i], NULL);
+        *failures += workers[i].corrupt;
+    }
+    return (JotBenchmarkNow() - start) * 1000.0;
+}
+
+#pragma mark - Checks
+
+static bool JotSizeClassesAreTight(void) {
+    bool tight = JotBufferPoolCapacityForSize(1) == 4096 && JotBufferPoolCapacityForSize(4097) == 6144 &&
+                 JotBufferPoolCapacityForSize(6145) == 8192 && JotBufferPoolCapacityForSize(64u << 20) == 64u << 20 &&
+                 JotBufferPoolCapacityForSize((64u << 20) + 1) == (64u << 20) + 1;
+    for (size_t size = 1; tight && size < (1u << 22); size += 777) {
+        size_t capacity = JotBufferPoolCapacityForSize(size);
+        tight = capacity >= size && (size <= 4096 || capacity <= size + size / 2);
+    }
+    return tight;
+}
+
+// fills a thread's magazine and the pool with 4KB buffers, and exits
+static void* JotCacheAndExit(void* context) {
+    JotBufferPool* pool = context;
+    void* buffers[4];
+    size_t capacity;
+    for (int i = 0; i < 4; i++) {
+        buffers[i] = JotBufferPoolAlloc(pool, 4096, &capacity);
+    }
+    for (int i = 0; i < 4; i++) {
+        JotBufferPoolRelease(pool, buffers[i], capacity);
+    }
+    return NULL;
+}
+
+/**
+ * a thread that exits returns its magazine to the pool like any other
+ * release. the pool's cap decides what's kept, and the main thread's
+ * magazine isn't emptied into the pool
+ */
+static bool JotThreadExitKeepsOtherMagazines(void) {
+    JotBufferPool* pool = JotBufferPoolCreate(3 * 4096);
+    void* buffers[2];
+    size_t capacity;
+    for (int i = 0; i < 2; i++) {
+        buffers[i] = JotBufferPoolAlloc(pool, 4096, &capacity);
+    }
+    for (int i = 0; i < 2; i++) {
+        JotBufferPoolRelease(pool, buffers[i], capacity);
+    }
+    pthread_t thread;
+    pthread_create(&thread, NULL, JotCacheAndExit, pool);
+    pthread_join(thread, NULL);
+
+    // the main thread's 2 are still in its magazine, and the pool kept
+    // 3 of the other thread's 4. a full trim would have left only 3
+    JotBufferPoolStats stats;
+    JotBufferPoolGetStats(pool, &stats);
+    bool kept = stats.cachedBytes == 5 * 4096 && stats.outstandingBytes == 0;
+
+    // the main thread's allocations still come from its magazine
+    for (int i = 0; i < 2; i++) {
+        buffers[i] = JotBufferPoolAlloc(pool, 4096, &capacity);
+    }
+    JotBufferPoolStats after;
+    JotBufferPoolGetStats(pool, &after);
+    kept = kept && after.hits == stats.hits + 2 && after.misses == stats.misses && after.cachedBytes == 3 * 4096;
+    for (int i = 0; i < 2; i++) {
+        JotBufferPoolRelease(pool, buffers[i], capacity);
+    }
+    JotBufferPoolFree(pool);
+    return kept;
+}
+
+int main(void) {
+    int failures = 0;
+    if (!JotSizeClassesAreTight()) {
+        printf("a size class is more than 50%% bigger than its requests\n");
+        failures++;
+    }
+    if (!JotThreadExitKeepsOtherMagazines()) {
+        printf("a thread's exit changed more than its own magazine\n");
+        failures++;
+    }
+
+    struct {
+        const char* name;
+        JotPattern pattern;
+        int threadCount;
+        int iterations;
+    } runs[] = {
+        {"thumbnails, 1 thread", JotPatternThumbnails, 1, 20000},
+        {"mixed, 1 thread", JotPatternMixed, 1, 20000},
+        {"mixed, 4 threads", JotPatternMixed, 4, 20000},
+        {"scratch, 1 thread", JotPatternScratch, 1, 400000},
+        {"scratch, 4 threads", JotPatternScratch, 4, 400000},
+    };
+    printf("%-22s %12s %10s %10s\n", "", "first fit ms", "pool ms", "pool hits");
+    for (size_t r = 0; r < sizeof(runs) / sizeof(runs[0]); r++) {
+        double firstFitTime = JotRunPattern(NULL, runs[r].pattern, runs[r].threadCount, runs[r].iterations, &failures);
+        JotFirstFitDrain();
+
+        JotBufferPool* pool = JotBufferPoolCreate(64 * 1024 * 1024);
+        double poolTime = JotRunPattern(pool, runs[r].pattern, runs[r].threadCount, runs[r].iterations, &failures);
+        JotBufferPoolStats stats;
+        JotBufferPoolGetStats(pool, &stats);
+        if (stats.outstandingBytes) {
+            printf("%s: %zu bytes weren't returned\n", runs[r].name, stats.outstandingBytes);
+            failures++;
+        }
+        JotBufferPoolTrim(pool, 0);
+        JotBufferPoolFree(pool);
+
+        double hitRate = 100.0 * (double)stats.hits / (double)(stats.hits + stats.misses);
+        printf("%-22s %12.1f %10.1f %9.1f%%\n", runs[r].name, firstFitTime, poolTime, hitRate);
+    }
+    return failures ? 1 : 0;
+}
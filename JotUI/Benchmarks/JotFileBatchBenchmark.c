@@ -0,0 +1,227 @@
+//
+//  JotFileBatchBenchmark.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+//  times a burst of autosaves, where every page saves its ink, texture
+//  sidecar and thumbnail a few times in a row. compares one atomic write
+//  per file, one group commit per save, and one group commit per page
+//  once JotDiskAssetManager has dropped the saves that were replaced.
+//  checks that the files end up with the last save's bytes, and that
+//  temp files are only left behind by a crash, and then swept:
+//
+//      cc -O2 -I../JotUI JotFileBatchBenchmark.c ../JotUI/JotFileBatch.c -o file_batch -lm
+//
+//  the numbers depend on the disk and file system of the directory it
+//  writes to, which is $TMPDIR or /tmp
+//
+
+#include "JotBenchmark.h"
+#include "JotFileBatch.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define kJotPageCount 40
+#define kJotSavesPerPage 4
+#define kJotFilesPerSave 3
+
+static const char* JotFileNames[kJotFilesPerSave] = {"ink.png", "ink.png.jottex", "thumb.png"};
+static const size_t JotFileSizes[kJotFilesPerSave] = {200000, 100000, 20000};
+
+// whether the path fit in the PATH_MAX bytes of path
+static bool JotFilePath(char* path, const char* root, int page, int file) {
+    int length = snprintf(path, PATH_MAX, "%s/%d/%s", root, page, JotFileNames[file]);
+    return length >= 0 && length < PATH_MAX;
+}
+
+static bool JotDirectoryPath(char* path, const char* root, int page) {
+    int length = snprintf(path, PATH_MAX, "%s/%d", root, page);
+    return length >= 0 && length < PATH_MAX;
+}
+
+// what each save writes, so that the files show which save was last
+static void JotFillSave(uint8_t* bytes, int save) {
+    for (size_t i = 0; i < JotFileSizes[0]; i++) {
+        bytes[i] = (uint8_t)(i * 31 + save * 7);
+    }
+}
+
+// the way each file was written before group commits
+static bool JotWriteAtomically(const char* path, const uint8_t* bytes, size_t length) {
+    char tempPath[PATH_MAX];
+    int tempLength = snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+    if (tempLength < 0 || tempLength >= (int)sizeof(tempPath)) {
+        return false;
+    }
+    int fd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool success = write(fd, bytes, length) == (ssize_t)length && fsync(fd) == 0;
+    success = close(fd) == 0 && success && rename(tempPath, path) == 0;
+
+    char* slash = strrchr(tempPath, '/');
+    *slash = '\0';
+    int dirFd = open(tempPath, O_RDONLY);
+    success = dirFd >= 0 && fsync(dirFd) == 0 && success;
+    if (dirFd >= 0) {
+        close(dirFd);
+    }
+    return success;
+}
+
+static bool JotSaveInBatch(const char* root, int page, const uint8_t* bytes, size_t* directorySyncs) {
+    char path[PATH_MAX];
+    JotFileBatch* batch = JotFileBatchCreate();
+    bool success = true;
+    for (int file = 0; file < kJotFilesPerSave; file++) {
+        success = JotFilePath(path, root, page, file) && JotFileBatchAdd(batch, path, bytes, JotFileSizes[file]) && success;
+    }
+    success = success && JotFileBatchCommit(batch);
+    *directorySyncs += JotFileBatchDirectorySyncCount(batch);
+    JotFileBatchFree(batch);
+    return success;
+}
+
+// whether every file of every page holds the bytes of the last save
+static bool JotPagesMatch(const char* root, const uint8_t* bytes) {
+    char path[PATH_MAX];
+    uint8_t* contents = malloc(JotFileSizes[0] + 1);
+    bool matches = true;
+    for (int page = 0; matches && page < kJotPageCount; page++) {
+        for (int file = 0; matches && file < kJotFilesPerSave; file++) {
+            FILE* stream = JotFilePath(path, root, page, file) ? fopen(path, "rb") : NULL;
+            size_t length = stream ? fread(contents, 1, JotFileSizes[0] + 1, stream) : 0;
+            matches = stream && length == JotFileSizes[file] && !memcmp(contents, bytes, length);
+            if (stream) {
+                fclose(stream);
+            }
+        }
+    }
+    free(contents);
+    return matches;
+}
+
+static size_t JotCountTempFiles(const char* directory) {
+    size_t count = 0;
+    DIR* dir = opendir(directory);
+    struct dirent* entry;
+    while (dir && (entry = readdir(dir))) {
+        count += strstr(entry->d_name, ".jottmp.") != NULL;
+    }
+    if (dir) {
+        closedir(dir);
+    }
+    return count;
+}
+
+int main(void) {
+    const char* tmp = getenv("TMPDIR") ?: "/tmp";
+    char root[PATH_MAX], dir[PATH_MAX];
+    int rootLength = snprintf(root, sizeof(root), "%s/JotFileBatchBenchmark.XXXXXX", tmp);
+    if (rootLength < 0 || rootLength >= (int)sizeof(root) || !mkdtemp(root)) {
+        printf("couldn't make a directory in %s\n", tmp);
+        return 1;
+    }
+    for (int page = 0; page < kJotPageCount; page++) {
+        if (!JotDirectoryPath(dir, root, page) || mkdir(dir, 0755) != 0) {
+            printf("couldn't make the page directories in %s\n", root);
+            return 1;
+        }
+    }
+    uint8_t* saves[kJotSavesPerPage];
+    for (int save = 0; save < kJotSavesPerPage; save++) {
+        saves[save] = malloc(JotFileSizes[0]);
+        JotFillSave(saves[save], save);
+    }
+    int failures = 0;
+    char path[PATH_MAX];
+
+    double start = JotBenchmarkNow();
+    for (int save = 0; save < kJotSavesPerPage; save++) {
+        for (int page = 0; page < kJotPageCount; page++) {
+            for (int file = 0; file < kJotFilesPerSave; file++) {
+                failures += !JotFilePath(path, root, page, file) || !JotWriteAtomically(path, saves[save], JotFileSizes[file]);
+            }
+        }
+    }
+    double perFileTime = (JotBenchmarkNow() - start) * 1000.0;
+    if (!JotPagesMatch(root, saves[kJotSavesPerPage - 1])) {
+        printf("per file: the pages don't hold the last save\n");
+        failures++;
+    }
+
+    size_t groupSyncs = 0;
+    start = JotBenchmarkNow();
+    for (int save = 0; save < kJotSavesPerPage; save++) {
+        for (int page = 0; page < kJotPageCount; page++) {
+            failures += !JotSaveInBatch(root, page, saves[save], &groupSyncs);
+        }
+    }
+    double groupTime = (JotBenchmarkNow() - start) * 1000.0;
+
+    // the first save puts different bytes in place, so a match
+    // shows that the coalesced save was written
+    size_t coalescedSyncs = 0;
+    for (int page = 0; page < kJotPageCount; page++) {
+        failures += !JotSaveInBatch(root, page, saves[0], &coalescedSyncs);
+    }
+    coalescedSyncs = 0;
+    start = JotBenchmarkNow();
+    for (int page = 0; page < kJotPageCount; page++) {
+        failures += !JotSaveInBatch(root, page, saves[kJotSavesPerPage - 1], &coalescedSyncs);
+    }
+    double coalescedTime = (JotBenchmarkNow() - start) * 1000.0;
+    if (!JotPagesMatch(root, saves[kJotSavesPerPage - 1])) {
+        printf("group commit: the pages don't hold the last save\n");
+        failures++;
+    }
+
+    // an abandoned batch leaves nothing behind. a crash leaves its temp
+    // file, which is swept if it's older than the sweep's cutoff
+    failures += !JotDirectoryPath(dir, root, 0) || !JotFilePath(path, root, 0, 0);
+    JotFileBatch* batch = JotFileBatchCreate();
+    failures += !JotFileBatchAdd(batch, path, saves[1], 10);
+    JotFileBatchFree(batch);
+    char crashedPath[PATH_MAX], inFlightPath[PATH_MAX];
+    int crashedLength = snprintf(crashedPath, sizeof(crashedPath), "%s.jottmp.a1b2c3", path);
+    int inFlightLength = snprintf(inFlightPath, sizeof(inFlightPath), "%s.jottmp.d4e5f6", path);
+    bool wroteTempFiles = crashedLength >= 0 && crashedLength < (int)sizeof(crashedPath) &&
+                          inFlightLength >= 0 && inFlightLength < (int)sizeof(inFlightPath) &&
+                          JotWriteAtomically(crashedPath, saves[1], 10) && JotWriteAtomically(inFlightPath, saves[1], 10);
+    struct timeval crashTime[2] = {{time(NULL) - 60, 0}, {time(NULL) - 60, 0}};
+    if (!wroteTempFiles || utimes(crashedPath, crashTime) != 0 ||
+        JotFileBatchRemoveStaleFiles(dir, time(NULL) - 30) != 1 || JotCountTempFiles(dir) != 1) {
+        printf("only the crashed temp file should be swept\n");
+        failures++;
+    }
+    unlink(inFlightPath);
+
+    printf("%d pages, %d saves each, %d files per save\n", kJotPageCount, kJotSavesPerPage, kJotFilesPerSave);
+    printf("%-22s %10s %10s\n", "", "ms", "dir syncs");
+    printf("%-22s %10.1f %10d\n", "atomic write per file", perFileTime, kJotPageCount * kJotSavesPerPage * kJotFilesPerSave);
+    printf("%-22s %10.1f %10zu\n", "group commit per save", groupTime, groupSyncs);
+    printf("%-22s %10.1f %10zu\n", "coalesced per page", coalescedTime, coalescedSyncs);
+
+    for (int page = 0; page < kJotPageCount; page++) {
+        for (int file = 0; file < kJotFilesPerSave; file++) {
+            if (JotFilePath(path, root, page, file)) {
+                unlink(path);
+            }
+        }
+        if (JotDirectoryPath(dir, root, page)) {
+            rmdir(dir);
+        }
+    }
+    rmdir(root);
+    for (int save = 0; save < kJotSavesPerPage; save++) {
+        free(saves[save]);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,270 @@
+//
+//  JotGLCommandBufferBenchmark.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+//  times recording and submitting a frame of strokes, each of which sets
+//  its texture, program, blending and vertex arrays before it draws, and
+//  counts the commands that are stripped. first checks exactly which
+//  commands the mock backend is given for redundant binds, state and
+//  uniforms, within a buffer and across buffers that share a state:
+//
+//      cc -O2 -I../JotUI JotGLCommandBufferBenchmark.c ../JotUI/JotGLCommandBuffer.c ../JotUI/JotGLMockBackend.c -o command_buffer -lpthread
+//
+
+#include "JotBenchmark.h"
+#include "JotGLCommandBuffer.h"
+#include "JotGLMockBackend.h"
+#include <stdbool.h>
+
+// the GL values that are recorded, without GL's headers
+#define kJotGLPoints 0x0000
+#define kJotGLTriangleStrip 0x0005
+#define kJotGLOne 1
+#define kJotGLOneMinusSrcAlpha 0x0303
+#define kJotGLBlend 0x0BE2
+#define kJotGLStencilTest 0x0B90
+#define kJotGLFloat 0x1406
+#define kJotGLColorBufferBit 0x4000
+
+#define kJotStrokeCount 1000
+#define kJotVertexBufferCount 8
+
+// whether the mock was given exactly the expected commands
+static bool JotExpectCommands(JotGLMockBackend* mock, const JotGLCommand* expected, size_t count, const char* what) {
+    bool matches = JotGLMockBackendGetCommandCount(mock) == count;
+    for (size_t i = 0; matches && i < count; i++) {
+        JotGLCommand command;
+        JotGLMockBackendGetCommand(mock, i, &command);
+        matches = command.type == expected[i].type && !memcmp(command.ints, expected[i].ints, sizeof(command.ints)) &&
+            !memcmp(command.floats, expected[i].floats, sizeof(command.floats)) && command.pointer == expected[i].pointer &&
+            command.length == expected[i].length;
+        if (!matches) {
+            printf("%s: command %zu is type %d, expected type %d\n", what, i, command.type, expected[i].type);
+        }
+    }
+    if (JotGLMockBackendGetCommandCount(mock) != count) {
+        printf("%s: %zu commands, expected %zu\n", what, JotGLMockBackendGetCommandCount(mock), count);
+    }
+    JotGLMockBackendReset(mock);
+    return matches;
+}
+
+/**
+ * binds and state that repeat are stripped as they're recorded, but
+ * uniforms, uploads, clears and draws are kept. a vertex pointer that's
+ * set again after a different array buffer is bound is kept too
+ */
+static bool JotCheckRecording(JotGLMockBackend* mock) {
+    static const float color[4] = {0.25f, 0.5f, 0.75f, 1};
+    static const float matrix[16] = {2, 0, 0, 0, 0, -2, 0, 0, 0, 0, 1, 0, -1, 1, 0, 1};
+    JotGLCommandBuffer* buffer = JotGLCommandBufferCreate();
+    JotGLCommandBufferBindFramebuffer(buffer, 1);
+    JotGLCommandBufferBindFramebuffer(buffer, 1);
+    JotGLCommandBufferBindTexture(buffer, 2);
+    JotGLCommandBufferBindTexture(buffer, 2);
+    JotGLCommandBufferBindTexture(buffer, 3);
+    JotGLCommandBufferUseProgram(buffer, 4);
+    JotGLCommandBufferUseProgram(buffer, 4);
+    JotGLCommandBufferViewport(buffer, 0, 0, 768, 1024);
+    JotGLCommandBufferViewport(buffer, 0, 0, 768, 1024);
+    JotGLCommandBufferClearColor(buffer, 0, 0, 0, 0);
+    JotGLCommandBufferClearColor(buffer, 0, 0, 0, 0);
+    JotGLCommandBufferClear(buffer, kJotGLColorBufferBit);
+    JotGLCommandBufferClear(buffer, kJotGLColorBufferBit);
+    JotGLCommandBufferEnable(buffer, kJotGLBlend);
+    JotGLCommandBufferEnable(buffer, kJotGLBlend);
+    JotGLCommandBufferDisable(buffer, kJotGLStencilTest);
+    JotGLCommandBufferDisable(buffer, kJotGLStencilTest);
+    JotGLCommandBufferBlendFunc(buffer, kJotGLOne, kJotGLOneMinusSrcAlpha);
+    JotGLCommandBufferBlendFunc(buffer, kJotGLOne, kJotGLOneMinusSrcAlpha);
+    JotGLCommandBufferUniform1f(buffer, 5, 0.5f);
+    JotGLCommandBufferUniform1f(buffer, 5, 0.5f);
+    JotGLCommandBufferUniform4fv(buffer, 6, color);
+    JotGLCommandBufferUniformMatrix4fv(buffer, 7, matrix);
+    JotGLCommandBufferBindArrayBuffer(buffer, 8);
+    JotGLCommandBufferBufferSubData(buffer, 16, "strokes", 7);
+    JotGLCommandBufferEnableVertexAttribArray(buffer, 0);
+    JotGLCommandBufferEnableVertexAttribArray(buffer, 0);
+    JotGLCommandBufferVertexAttribPointer(buffer, 0, 2, kJotGLFloat, false, 12, (const void*)4);
+    JotGLCommandBufferVertexAttribPointer(buffer, 0, 2, kJotGLFloat, false, 12, (const void*)4);
+    JotGLCommandBufferDrawArrays(buffer, kJotGLTriangleStrip, 0, 4);
+    JotGLCommandBufferBindArrayBuffer(buffer, 9);
+    JotGLCommandBufferVertexAttribPointer(buffer, 0, 2, kJotGLFloat, false, 12, (const void*)4);
+    JotGLCommandBufferDrawArrays(buffer, kJotGLTriangleStrip, 0, 4);
+    JotGLCommandBufferFlush(buffer);
+
+    JotGLCommand expected[] = {
+        {.type = JotGLCommandBindFramebuffer, .ints = {1}},
+        {.type = JotGLCommandBindTexture, .ints = {2}},
+        {.type = JotGLCommandBindTexture, .ints = {3}},
+        {.type = JotGLCommandUseProgram, .ints = {4}},
+        {.type = JotGLCommandViewport, .ints = {0, 0, 768, 1024}},
+        {.type = JotGLCommandClearColor},
+        {.type = JotGLCommandClear, .ints = {kJotGLColorBufferBit}},
+        {.type = JotGLCommandClear, .ints = {kJotGLColorBufferBit}},
+        {.type = JotGLCommandEnable, .ints = {kJotGLBlend}},
+        {.type = JotGLCommandDisable, .ints = {kJotGLStencilTest}},
+        {.type = JotGLCommandBlendFunc, .ints = {kJotGLOne, kJotGLOneMinusSrcAlpha}},
+        {.type = JotGLCommandUniform1f, .ints = {5}, .floats = {0.5f}},
+        {.type = JotGLCommandUniform1f, .ints = {5}, .floats = {0.5f}},
+        {.type = JotGLCommandUniform4fv, .ints = {6}, .floats = {0.25f, 0.5f, 0.75f, 1}},
+        {.type = JotGLCommandUniformMatrix4fv, .ints = {7}, .floats = {2, 0, 0, 0, 0, -2, 0, 0, 0, 0, 1, 0, -1, 1, 0, 1}},
+        {.type = JotGLCommandBindArrayBuffer, .ints = {8}},
+        {.type = JotGLCommandBufferSubData, .ints = {16}, .length = 7},
+        {.type = JotGLCommandEnableVertexAttribArray, .ints = {0}},
+        {.type = JotGLCommandVertexAttribPointer, .ints = {0, 2, kJotGLFloat, false, 12}, .pointer = (const void*)4},
+        {.type = JotGLCommandDrawArrays, .ints = {kJotGLTriangleStrip, 0, 4}},
+        {.type = JotGLCommandBindArrayBuffer, .ints = {9}},
+        {.type = JotGLCommandVertexAttribPointer, .ints = {0, 2, kJotGLFloat, false, 12}, .pointer = (const void*)4},
+        {.type = JotGLCommandDrawArrays, .ints = {kJotGLTriangleStrip, 0, 4}},
+        {.type = JotGLCommandFlush},
+    };
+    size_t expectedCount = sizeof(expected) / sizeof(expected[0]);
+    bool matches = JotGLCommandBufferGetCommandCount(buffer) == expectedCount && JotGLCommandBufferGetElidedCount(buffer) == 10;
+    if (!matches) {
+        printf("recording: kept %zu and stripped %zu commands, expected %zu and 10\n", JotGLCommandBufferGetCommandCount(buffer),
+               JotGLCommandBufferGetElidedCount(buffer), expectedCount);
+    }
+
+    // a new state doesn't strip anything more
+    JotGLCommandState* state = JotGLCommandStateCreate();
+    matches = JotGLCommandBufferSubmit(buffer, state, JotGLMockBackendGetBackend(mock)) == expectedCount && matches;
+    matches = JotGLMockBackendGetUploadedBytes(mock) == 7 && matches;
+    matches = JotExpectCommands(mock, expected, expectedCount, "recording") && matches;
+
+    // a reset buffer forgets its commands and what they set
+    JotGLCommandBufferReset(buffer);
+    JotGLCommandBufferBindFramebuffer(buffer, 1);
+    matches = JotGLCommandBufferGetCommandCount(buffer) == 1 && JotGLCommandBufferGetElidedCount(buffer) == 0 && matches;
+    JotGLCommandStateFree(state);
+    JotGLCommandBufferFree(buffer);
+    return matches;
+}
+
+// records what a stroke sets before it draws, the same way every time
+static void JotRecordStroke(JotGLCommandBuffer* buffer, uint32_t vertexBuffer, int32_t vertexCount) {
+    static const float color[4] = {0, 0, 0, 1};
+    JotGLCommandBufferBindFramebuffer(buffer, 1);
+    JotGLCommandBufferBindTexture(buffer, 2);
+    JotGLCommandBufferUseProgram(buffer, 3);
+    JotGLCommandBufferEnable(buffer, kJotGLBlend);
+    JotGLCommandBufferBlendFunc(buffer, kJotGLOne, kJotGLOneMinusSrcAlpha);
+    JotGLCommandBufferUniform4fv(buffer, 4, color);
+    JotGLCommandBufferBindArrayBuffer(buffer, vertexBuffer);
+    for (uint32_t attribute = 0; attribute < 3; attribute++) {
+        JotGLCommandBufferEnableVertexAttribArray(buffer, attribute);
+        JotGLCommandBufferVertexAttribPointer(buffer, attribute, attribute == 2 ? 4 : 2, kJotGLFloat, false, 32, (const void*)(uintptr_t)(attribute * 8));
+    }
+    JotGLCommandBufferDrawArrays(buffer, kJotGLPoints, 0, vertexCount);
+}
+
+/**
+ * buffers that share a state only run the state that the earlier
+ * buffers didn't already set. invalidating the state runs it again,
+ * and submitting without a state runs every recorded command
+ */
+static bool JotCheckSubmitting(JotGLMockBackend* mock) {
+    JotGLCommandState* state = JotGLCommandStateCreate();
+    JotGLCommandQueue* queue = JotGLCommandQueueCreate();
+    for (int i = 0; i < 2; i++) {
+        JotGLCommandBuffer* buffer = JotGLCommandBufferCreate();
+        JotRecordStroke(buffer, 7, 10);
+        JotGLCommandQueueEnqueue(queue, buffer);
+    }
+    JotGLCommandBuffer* invalidated = JotGLCommandBufferCreate();
+    JotRecordStroke(invalidated, 7, 10);
+    bool matches = JotGLCommandBufferGetCommandCount(invalidated) == 14 && JotGLCommandBufferGetElidedCount(invalidated) == 0;
+
+    static const float color[4] = {0, 0, 0, 1};
+    JotGLCommand stroke[] = {
+        {.type = JotGLCommandBindFramebuffer, .ints = {1}},
+        {.type = JotGLCommandBindTexture, .ints = {2}},
+        {.type = JotGLCommandUseProgram, .ints = {3}},
+        {.type = JotGLCommandEnable, .ints = {kJotGLBlend}},
+        {.type = JotGLCommandBlendFunc, .ints = {kJotGLOne, kJotGLOneMinusSrcAlpha}},
+        {.type = JotGLCommandUniform4fv, .ints = {4}, .floats = {color[0], color[1], color[2], color[3]}},
+        {.type = JotGLCommandBindArrayBuffer, .ints = {7}},
+        {.type = JotGLCommandEnableVertexAttribArray, .ints = {0}},
+        {.type = JotGLCommandVertexAttribPointer, .ints = {0, 2, kJotGLFloat, false, 32}, .pointer = (const void*)0},
+        {.type = JotGLCommandEnableVertexAttribArray, .ints = {1}},
+        {.type = JotGLCommandVertexAttribPointer, .ints = {1, 2, kJotGLFloat, false, 32}, .pointer = (const void*)8},
+        {.type = JotGLCommandEnableVertexAttribArray, .ints = {2}},
+        {.type = JotGLCommandVertexAttribPointer, .ints = {2, 4, kJotGLFloat, false, 32}, .pointer = (const void*)16},
+        {.type = JotGLCommandDrawArrays, .ints = {kJotGLPoints, 0, 10}},
+    };
+    // the first stroke, and then only the second's uniform and draw
+    JotGLCommand expected[16];
+    memcpy(expected, stroke, sizeof(stroke));
+    expected[14] = stroke[5];
+    expected[15] = stroke[13];
+
+    matches = JotGLCommandQueueSubmit(queue, state, JotGLMockBackendGetBackend(mock)) == 16 && matches;
+    matches = JotGLCommandStateGetElidedCount(state) == 12 && JotGLCommandQueueGetBufferCount(queue) == 0 && matches;
+    matches = JotExpectCommands(mock, expected, 16, "submitting") && matches;
+
+    JotGLCommandStateInvalidate(state);
+    matches = JotGLCommandBufferSubmit(invalidated, state, JotGLMockBackendGetBackend(mock)) == 14 && matches;
+    matches = JotGLCommandStateGetElidedCount(state) == 12 && matches;
+    matches = JotExpectCommands(mock, stroke, 14, "invalidated") && matches;
+
+    matches = JotGLCommandBufferSubmit(invalidated, NULL, JotGLMockBackendGetBackend(mock)) == 14 && matches;
+    matches = JotExpectCommands(mock, stroke, 14, "without a state") && matches;
+    if (!matches) {
+        printf("submitting: the state didn't strip the right commands\n");
+    }
+
+    JotGLCommandBufferFree(invalidated);
+    JotGLCommandQueueFree(queue);
+    JotGLCommandStateFree(state);
+    return matches;
+}
+
+// a backend that only counts, so the timing is the buffer's
+static void JotCountCommand(void* context, const JotGLCommand* command) {
+    (void)command;
+    (*(size_t*)context)++;
+}
+
+int main(void) {
+    int failures = 0;
+    JotGLMockBackend* mock = JotGLMockBackendCreate();
+    failures += !JotCheckRecording(mock);
+    failures += !JotCheckSubmitting(mock);
+    JotGLMockBackendFree(mock);
+
+    // strokes mostly share their texture and program, and use a few
+    // vertex buffers in turn
+    JotGLCommandBuffer* buffer = JotGLCommandBufferCreate();
+    JotGLCommandState* state = JotGLCommandStateCreate();
+    size_t executedCount = 0;
+    JotGLCommandBackend backend = {&JotCountCommand, &executedCount};
+    double recordTime = JotBenchmarkTime(100, {
+        JotGLCommandBufferReset(buffer);
+        for (int stroke = 0; stroke < kJotStrokeCount; stroke++) {
+            JotRecordStroke(buffer, 1 + (uint32_t)(stroke % kJotVertexBufferCount), 100);
+        }
+    });
+    size_t recordedCount = JotGLCommandBufferGetCommandCount(buffer) + JotGLCommandBufferGetElidedCount(buffer);
+    double submitTime = JotBenchmarkTime(100, {
+        JotGLCommandStateInvalidate(state);
+        executedCount = 0;
+        JotGLCommandBufferSubmit(buffer, state, backend);
+    });
+    if (recordedCount != kJotStrokeCount * 14 || executedCount != JotGLCommandBufferGetCommandCount(buffer)) {
+        printf("timing: recorded %zu commands and ran %zu\n", recordedCount, executedCount);
+        failures++;
+    }
+
+    printf("%d strokes, %d vertex buffers\n", kJotStrokeCount, kJotVertexBufferCount);
+    printf("%-10s %10s %10s %10s %10s\n", "", "ms", "commands", "kept", "bytes");
+    printf("%-10s %10.3f %10zu %10zu %10zu\n", "record", recordTime, recordedCount, JotGLCommandBufferGetCommandCount(buffer),
+           JotGLCommandBufferGetByteSize(buffer));
+    printf("%-10s %10.3f %10zu %10zu\n", "submit", submitTime, JotGLCommandBufferGetCommandCount(buffer), executedCount);
+
+    JotGLCommandStateFree(state);
+    JotGLCommandBufferFree(buffer);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,137 @@
+//
+//  JotImageKernelsBenchmark.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+//  compares the vector image kernels to the scalar reference on a page.
+//  first checks premultiply and unpremultiply for every color and alpha:
+//
+//      cc -O2 -I../JotUI JotImageKernelsBenchmark.c ../JotUI/JotImageKernels.c -o image_kernels -lm
+//
+//  x86-64 compilers only target SSE2 by default. add -mssse3 to measure
+//  the byte shuffle swizzle that the simulator and desktops can use
+//
+
+#include "JotBenchmark.h"
+#include "JotImageKernels.h"
+
+typedef enum {
+    JotKernelFlip,
+    JotKernelPremultiply,
+    JotKernelUnpremultiply,
+    JotKernelSwizzle,
+    JotKernelCount
+} JotKernel;
+
+static const char* JotKernelNames[JotKernelCount] = {"flip", "premultiply", "unpremultiply", "swizzle"};
+
+static void JotRunKernel(JotKernel kernel, uint8_t* pixels, size_t width, size_t height) {
+    static const uint8_t fromBGRA[4] = {2, 1, 0, 3};
+    switch (kernel) {
+        case JotKernelFlip:
+            JotImageFlipVertical(pixels, width * 4, height);
+            break;
+        case JotKernelPremultiply:
+            JotImagePremultiply(pixels, width * height);
+            break;
+        case JotKernelUnpremultiply:
+            JotImageUnpremultiply(pixels, width * height);
+            break;
+        default:
+            JotImageSwizzle(pixels, width * height, fromBGRA);
+            break;
+    }
+}
+
+int main(void) {
+    size_t width = kJotBenchmarkPageWidth, height = kJotBenchmarkPageHeight, bytes = width * height * 4;
+    uint8_t* page = malloc(bytes);
+    uint8_t* scalar = malloc(bytes);
+    uint8_t* vector = malloc(bytes);
+    JotBenchmarkFillPage(page, width, height, 200, 1);
+    int failures = 0;
+
+    // every color and alpha, including colors above their alpha, which
+    // aren't validly premultiplied and have to clamp the same way
+    uint8_t* everyScalar = malloc(256 * 256 * 4);
+    uint8_t* everyVector = malloc(256 * 256 * 4);
+    for (size_t i = 0; i < 256 * 256; i++) {
+        uint8_t pixel[4] = {(uint8_t)(i & 0xFF), (uint8_t)(255 - (i & 0xFF)), (uint8_t)((i * 7) & 0xFF), (uint8_t)(i >> 8)};
+        memcpy(everyScalar + i * 4, pixel, 4);
+    }
+    for (JotKernel kernel = JotKernelPremultiply; kernel <= JotKernelUnpremultiply; kernel++) {
+        memcpy(everyVector, everyScalar, 256 * 256 * 4);
+        uint8_t* scalarPixels = malloc(256 * 256 * 4);
+        memcpy(scalarPixels, everyScalar, 256 * 256 * 4);
+        JotImageKernelsSetVectorized(false);
+        JotRunKernel(kernel, scalarPixels, 256, 256);
+        JotImageKernelsSetVectorized(true);
+        JotRunKernel(kernel, everyVector, 256, 256);
+        if (memcmp(scalarPixels, everyVector, 256 * 256 * 4)) {
+            printf("%s: vector output differs from scalar for some color and alpha\n", JotKernelNames[kernel]);
+            failures++;
+        }
+        free(scalarPixels);
+    }
+    free(everyScalar);
+    free(everyVector);
+
+    printf("%-14s %10s %10s %8s\n", "kernel", "scalar ms", "vector ms", "speedup");
+    for (JotKernel kernel = 0; kernel < JotKernelCount; kernel++) {
+        // odd repeat counts leave flips and swizzles changed, so the outputs are comparable
+        memcpy(scalar, page, bytes);
+        JotImageKernelsSetVectorized(false);
+        double scalarTime = JotBenchmarkTime(5, JotRunKernel(kernel, scalar, width, height));
+        memcpy(vector, page, bytes);
+        JotImageKernelsSetVectorized(true);
+        double vectorTime = JotBenchmarkTime(5, JotRunKernel(kernel, vector, width, height));
+        if (memcmp(scalar, vector, bytes)) {
+            printf("%s: vector output differs from scalar\n", JotKernelNames[kernel]);
+            failures++;
+        }
+        printf("%-14s %10.2f %10.2f %7.1fx\n", JotKernelNames[kernel], scalarTime, vectorTime, scalarTime / vectorTime);
+    }
+
+    // thumbnails, and exports larger than the canvas
+    struct {
+        const char* name;
+        size_t width;
+        size_t height;
+        JotImageResampleFilter filter;
+    } resamples[] = {
+        {"box 1/4", width / 4, height / 4, JotImageResampleBox},
+        {"lanczos 1/4", width / 4, height / 4, JotImageResampleLanczos},
+        {"lanczos 3/2", width * 3 / 2, height * 3 / 2, JotImageResampleLanczos},
+    };
+    for (size_t i = 0; i < sizeof(resamples) / sizeof(resamples[0]); i++) {
+        size_t outputBytes = resamples[i].width * resamples[i].height * 4;
+        uint8_t* scalarOutput = malloc(outputBytes);
+        uint8_t* vectorOutput = malloc(outputBytes);
+        JotImageKernelsSetVectorized(false);
+        double scalarTime = JotBenchmarkTime(3, JotImageResample(page, width, height, width * 4, scalarOutput, resamples[i].width, resamples[i].height,
+                                                                 resamples[i].width * 4, resamples[i].filter, true));
+        JotImageKernelsSetVectorized(true);
+        double vectorTime = JotBenchmarkTime(3, JotImageResample(page, width, height, width * 4, vectorOutput, resamples[i].width, resamples[i].height,
+                                                                 resamples[i].width * 4, resamples[i].filter, true));
+        // the vector resampler rounds its weights differently, but by no more than 1
+        int maxDifference = 0;
+        for (size_t b = 0; b < outputBytes; b++) {
+            int difference = abs(scalarOutput[b] - vectorOutput[b]);
+            maxDifference = difference > maxDifference ? difference : maxDifference;
+        }
+        if (maxDifference > 1) {
+            printf("%s: vector output is off by %d\n", resamples[i].name, maxDifference);
+            failures++;
+        }
+        printf("%-14s %10.2f %10.2f %7.1fx\n", resamples[i].name, scalarTime, vectorTime, scalarTime / vectorTime);
+        free(scalarOutput);
+        free(vectorOutput);
+    }
+
+    free(page);
+    free(scalar);
+    free(vector);
+    return failures ? 1 : 0;
+}
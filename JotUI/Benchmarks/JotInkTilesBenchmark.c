@@ -0,0 +1,156 @@
+//
+//  JotInkTilesBenchmark.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+//  times finding the inked tiles of a page and packing them, with the
+//  vector and scalar empty checks. first checks the tile bitmap against
+//  a byte by byte reference for blank, inked and edge tiles, and that
+//  packing and then unpacking gives back the same bytes, on page sizes
+//  that don't divide into tiles:
+//
+//      cc -O2 -I../JotUI JotInkTilesBenchmark.c ../JotUI/JotInkTiles.c ../JotUI/JotImageKernels.c -o ink_tiles -lm
+//
+
+#include "JotBenchmark.h"
+#include "JotImageKernels.h"
+#include "JotInkTiles.h"
+#include <stdbool.h>
+
+// whether the tile has any non-zero byte, one byte at a time
+static bool JotReferenceTileHasInk(const JotInkTileGrid* grid, const uint8_t* rgba, size_t bytesPerRow, size_t column, size_t row) {
+    for (size_t y = row * grid->tileSize; y < (row + 1) * grid->tileSize && y < grid->height; y++) {
+        for (size_t x = column * grid->tileSize; x < (column + 1) * grid->tileSize && x < grid->width; x++) {
+            for (size_t c = 0; c < 4; c++) {
+                if (rgba[y * bytesPerRow + x * 4 + c]) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * a page with a blank tile, a fully inked tile, and single bytes of
+ * ink in the last pixel of every edge tile, where the tiles are cut
+ * short. the bytes past each row's pixels are filled in, so that any
+ * tile that reads them is found inked
+ */
+static void JotFillTestPage(uint8_t* rgba, size_t width, size_t height, size_t bytesPerRow, unsigned seed) {
+    memset(rgba, 0, bytesPerRow * height);
+    for (size_t y = 0; y < height; y++) {
+        memset(rgba + y * bytesPerRow + width * 4, 0xAB, bytesPerRow - width * 4);
+    }
+    size_t inkedSize = width < kJotInkTileSize ? width : kJotInkTileSize;
+    for (size_t y = 0; y < kJotInkTileSize && y < height; y++) {
+        memset(rgba + y * bytesPerRow, 0xFF, inkedSize * 4);
+    }
+    // one byte in the last pixel of the right and bottom edge tiles
+    for (size_t y = kJotInkTileSize - 1; y < height; y += kJotInkTileSize) {
+        rgba[y * bytesPerRow + (width - 1) * 4 + 3] = 1;
+    }
+    for (size_t x = kJotInkTileSize - 1; x < width; x += 2 * kJotInkTileSize) {
+        rgba[(height - 1) * bytesPerRow + x * 4] = 1;
+    }
+    rgba[(height - 1) * bytesPerRow + (width - 1) * 4 + 2] = 1;
+    // and a few random bytes anywhere
+    srand(seed);
+    for (int i = 0; i < 6; i++) {
+        size_t x = (size_t)rand() % width, y = (size_t)rand() % height;
+        rgba[y * bytesPerRow + x * 4 + (size_t)rand() % 4] = (uint8_t)(1 + rand() % 255);
+    }
+}
+
+// finds, packs and unpacks the page's tiles, and checks each step
+static bool JotTilesRoundTrip(const uint8_t* rgba, size_t width, size_t height, size_t bytesPerRow) {
+    JotInkTileGrid grid = JotInkTileGridMake(width, height, 0);
+    size_t bitmapLength = JotInkTileGridBitmapLength(&grid);
+    uint8_t* bitmap = malloc(bitmapLength);
+    bool matches = true;
+    for (int vectorized = 0; vectorized < 2; vectorized++) {
+        JotImageKernelsSetVectorized(vectorized);
+        size_t count = JotInkFindNonEmptyTiles(&grid, rgba, bytesPerRow, bitmap);
+        size_t expectedCount = 0;
+        for (size_t row = 0; row < grid.rows; row++) {
+            for (size_t column = 0; column < grid.columns; column++) {
+                bool hasInk = JotReferenceTileHasInk(&grid, rgba, bytesPerRow, column, row);
+                matches = matches && hasInk == JotInkTileBitmapIsSet(bitmap, row * grid.columns + column);
+                expectedCount += hasInk;
+            }
+        }
+        matches = matches && count == expectedCount;
+    }
+
+    size_t length = JotInkPackTiles(&grid, rgba, bytesPerRow, bitmap, NULL);
+    uint8_t* packed = malloc(length + 1);
+    matches = matches && JotInkPackTiles(&grid, rgba, bytesPerRow, bitmap, packed) == length;
+
+    // unpacking every row of tiles gives back the page, without the
+    // bytes past each row's pixels
+    size_t bandBytesPerRow = grid.columns * grid.tileSize * 4;
+    uint8_t* band = malloc(bandBytesPerRow * grid.tileSize);
+    const uint8_t* next = packed;
+    for (size_t row = 0; matches && row < grid.rows; row++) {
+        next = JotInkUnpackTileRow(&grid, bitmap, row, next, band, bandBytesPerRow);
+        for (size_t y = row * grid.tileSize; y < (row + 1) * grid.tileSize && y < height; y++) {
+            matches = matches && !memcmp(band + (y - row * grid.tileSize) * bandBytesPerRow, rgba + y * bytesPerRow, width * 4);
+        }
+    }
+    matches = matches && next == packed + length;
+
+    free(band);
+    free(packed);
+    free(bitmap);
+    return matches;
+}
+
+int main(void) {
+    int failures = 0;
+    size_t sizes[][2] = {{1, 1}, {63, 65}, {64, 64}, {65, 129}, {1000, 777}, {kJotBenchmarkPageWidth, kJotBenchmarkPageHeight}};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t width = sizes[s][0], height = sizes[s][1];
+        // tightly packed rows, and rows with bytes past their pixels
+        size_t strides[2] = {width * 4, width * 4 + 36};
+        for (int i = 0; i < 2; i++) {
+            uint8_t* rgba = malloc(strides[i] * height);
+            JotFillTestPage(rgba, width, height, strides[i], (unsigned)s);
+            if (!JotTilesRoundTrip(rgba, width, height, strides[i])) {
+                printf("%zux%zu, %zu bytes per row: the tiles don't match the page\n", width, height, strides[i]);
+                failures++;
+            }
+            free(rgba);
+        }
+    }
+
+    size_t width = kJotBenchmarkPageWidth, height = kJotBenchmarkPageHeight;
+    uint8_t* page = malloc(width * height * 4);
+    JotInkTileGrid grid = JotInkTileGridMake(width, height, 0);
+    uint8_t* bitmap = malloc(JotInkTileGridBitmapLength(&grid));
+    uint8_t* packed = malloc(width * height * 4);
+    int strokeCounts[] = {0, 20, 200};
+
+    printf("%-8s %8s %10s %10s %10s %12s\n", "strokes", "tiles", "scalar ms", "vector ms", "pack ms", "packed bytes");
+    for (size_t s = 0; s < sizeof(strokeCounts) / sizeof(strokeCounts[0]); s++) {
+        JotBenchmarkFillPage(page, width, height, strokeCounts[s], 2);
+        if (!JotTilesRoundTrip(page, width, height, width * 4)) {
+            printf("%d strokes: the tiles don't match the page\n", strokeCounts[s]);
+            failures++;
+        }
+        JotImageKernelsSetVectorized(false);
+        double scalarTime = JotBenchmarkTime(10, JotInkFindNonEmptyTiles(&grid, page, width * 4, bitmap));
+        JotImageKernelsSetVectorized(true);
+        size_t count = 0;
+        double vectorTime = JotBenchmarkTime(10, count = JotInkFindNonEmptyTiles(&grid, page, width * 4, bitmap));
+        size_t length = 0;
+        double packTime = JotBenchmarkTime(10, length = JotInkPackTiles(&grid, page, width * 4, bitmap, packed));
+        printf("%-8d %4zu/%-3zu %10.2f %10.2f %10.2f %12zu\n", strokeCounts[s], count, grid.columns * grid.rows, scalarTime, vectorTime, packTime, length);
+    }
+
+    free(page);
+    free(bitmap);
+    free(packed);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,209 @@
+//
+//  JotMemoryAccountantBenchmark.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+//  times adjusting a category's bytes, counting the domains' bytes, and
+//  trimming, with as many pools as an app with a few pages open. first
+//  checks which pools a budget, a memory warning and a critical warning
+//  trim, in what order, for how many bytes, and the totals afterward:
+//
+//      cc -O2 -I../JotUI JotMemoryAccountantBenchmark.c ../JotUI/JotMemoryAccountant.c -o memory_accountant -lpthread
+//
+
+#include "JotBenchmark.h"
+#include "JotMemoryAccountant.h"
+#include <stdbool.h>
+
+#define kJotTimingPoolCount 64
+
+// a cache that frees its cached bytes when it's trimmed. the bytes of
+// a pool with a size function aren't adjusted into its category
+typedef struct {
+    const char* name;
+    JotMemoryAccountant* accountant;
+    JotMemoryCategory category;
+    size_t cachedBytes;
+    bool sized;
+} JotTestPool;
+
+// each trim, as "name:bytesToFree", in the order they're called
+static char trimLog[512];
+
+static size_t JotTestPoolTrim(void* context, size_t bytesToFree) {
+    JotTestPool* pool = context;
+    size_t length = strlen(trimLog);
+    snprintf(trimLog + length, sizeof(trimLog) - length, "%s%s:%zu", length ? " " : "", pool->name, bytesToFree);
+    size_t freed = bytesToFree < pool->cachedBytes ? bytesToFree : pool->cachedBytes;
+    pool->cachedBytes -= freed;
+    if (!pool->sized) {
+        JotMemoryAccountantAdjust(pool->accountant, pool->category, -(int64_t)freed);
+    }
+    return freed;
+}
+
+static size_t JotTestPoolSize(void* context) {
+    return ((JotTestPool*)context)->cachedBytes;
+}
+
+static void JotTestOverBudget(JotMemoryAccountant* accountant, void* context) {
+    (void)accountant;
+    (*(int*)context)++;
+}
+
+static bool JotExpect(bool condition, const char* what) {
+    if (!condition) {
+        printf("%s\n", what);
+    }
+    return condition;
+}
+
+static bool JotExpectTrims(const char* expected, const char* what) {
+    bool matches = JotExpect(!strcmp(trimLog, expected), what);
+    if (!matches) {
+        printf("  trimmed \"%s\", expected \"%s\"\n", trimLog, expected);
+    }
+    trimLog[0] = '\0';
+    return matches;
+}
+
+static JotMemoryPoolID JotAddTestPool(JotTestPool* pool, int priority) {
+    return JotMemoryAccountantAddPool(pool->accountant, pool->category, priority, &JotTestPoolTrim,
+                                      pool->sized ? &JotTestPoolSize : NULL, pool);
+}
+
+/**
+ * a GPU budget, with pools of both domains at different priorities,
+ * and one that reports its own size. the limit only trims the GPU
+ * domain, a warning halves both, and a critical warning asks every
+ * pool for everything it holds
+ */
+static bool JotCheckTrimLevels(void) {
+    JotMemoryAccountant* accountant = JotMemoryAccountantCreate();
+    JotTestPool textures = {"textures", accountant, JotMemoryCategoryTexture, 40, false};
+    JotTestPool buffers = {"buffers", accountant, JotMemoryCategoryVertexBuffer, 30, false};
+    JotTestPool data = {"data", accountant, JotMemoryCategoryDataCache, 25, false};
+    JotTestPool warm = {"warm", accountant, JotMemoryCategoryWarmTextures, 30, true};
+    // added out of order, since they're trimmed by priority
+    JotAddTestPool(&buffers, 20);
+    JotAddTestPool(&textures, 10);
+    JotAddTestPool(&warm, 5);
+    JotAddTestPool(&data, 0);
+    int overBudgetCount = 0;
+    JotMemoryAccountantSetOverBudgetHandler(accountant, &JotTestOverBudget, &overBudgetCount);
+    JotMemoryAccountantSetBudget(accountant, JotMemoryDomainGPU, 150);
+    bool matches = true;
+
+    JotMemoryAccountantAdjust(accountant, JotMemoryCategoryTexture, 140);
+    matches = JotExpect(overBudgetCount == 0, "under budget: the handler was called") && matches;
+    JotMemoryAccountantAdjust(accountant, JotMemoryCategoryVertexBuffer, 50);
+    JotMemoryAccountantAdjust(accountant, JotMemoryCategoryTexture, 1);
+    JotMemoryAccountantAdjust(accountant, JotMemoryCategoryTexture, -1);
+    JotMemoryAccountantAdjust(accountant, JotMemoryCategoryDataCache, 50);
+    matches = JotExpect(overBudgetCount == 1, "over budget: the handler should be called once until the budget's enforced") && matches;
+    matches = JotExpect(JotMemoryAccountantGetDomainBytes(accountant, JotMemoryDomainGPU) == 190, "over budget: wrong GPU bytes") && matches;
+    matches = JotExpect(JotMemoryAccountantGetDomainBytes(accountant, JotMemoryDomainCPU) == 80, "over budget: wrong CPU bytes, with the sized pool") && matches;
+    matches = JotExpectTrims("", "over budget: adjusting bytes shouldn't trim") && matches;
+
+    // the textures have enough to get back under budget on their own
+    matches = JotExpect(JotMemoryAccountantEnforceBudget(accountant) == 40, "limit: wrong bytes freed") && matches;
+    matches = JotExpectTrims("textures:40", "limit: only the GPU pools should be trimmed, until it's under budget") && matches;
+    matches = JotExpect(JotMemoryAccountantGetDomainBytes(accountant, JotMemoryDomainGPU) == 150, "limit: wrong GPU bytes") && matches;
+    matches = JotExpect(JotMemoryAccountantGetDomainBytes(accountant, JotMemoryDomainCPU) == 80, "limit: wrong CPU bytes") && matches;
+    JotMemoryAccountantAdjust(accountant, JotMemoryCategoryVertexBuffer, 10);
+    JotMemoryAccountantAdjust(accountant, JotMemoryCategoryVertexBuffer, -10);
+    matches = JotExpect(overBudgetCount == 2, "limit: the handler should be called again once the budget's enforced") && matches;
+
+    // each domain is trimmed to half, lowest priority first, and each
+    // pool is asked for what its domain is still over by
+    textures.cachedBytes = 5;
+    matches = JotExpect(JotMemoryAccountantHandlePressure(accountant, JotMemoryPressureWarning) == 75, "warning: wrong bytes freed") && matches;
+    matches = JotExpectTrims("data:40 warm:15 textures:75 buffers:70", "warning: wrong trim order") && matches;
+    matches = JotExpect(JotMemoryAccountantGetDomainBytes(accountant, JotMemoryDomainGPU) == 115, "warning: wrong GPU bytes") && matches;
+    matches = JotExpect(JotMemoryAccountantGetDomainBytes(accountant, JotMemoryDomainCPU) == 40, "warning: wrong CPU bytes") && matches;
+    matches = JotExpect(JotMemoryAccountantGetCategoryBytes(accountant, JotMemoryCategoryWarmTextures) == 15, "warning: wrong sized pool bytes") && matches;
+
+    // every pool is trimmed, even those that are empty
+    data.cachedBytes = 10;
+    matches = JotExpect(JotMemoryAccountantHandlePressure(accountant, JotMemoryPressureCritical) == 25, "critical: wrong bytes freed") && matches;
+    matches = JotExpectTrims("data:40 warm:30 textures:115 buffers:115", "critical: every pool should be asked for everything") && matches;
+    matches = JotExpect(!data.cachedBytes && !warm.cachedBytes && !textures.cachedBytes && !buffers.cachedBytes, "critical: a pool kept cached bytes") && matches;
+    matches = JotExpect(JotMemoryAccountantGetDomainBytes(accountant, JotMemoryDomainGPU) == 115, "critical: wrong GPU bytes") && matches;
+    matches = JotExpect(JotMemoryAccountantGetDomainBytes(accountant, JotMemoryDomainCPU) == 15, "critical: wrong CPU bytes") && matches;
+
+    matches = JotExpect(JotMemoryAccountantGetTrimCount(accountant) == 9, "wrong trim count") && matches;
+    matches = JotExpect(JotMemoryAccountantGetTrimmedBytes(accountant) == 140, "wrong trimmed bytes") && matches;
+    JotMemoryAccountantFree(accountant);
+    return matches;
+}
+
+// pools of the same priority are trimmed in the order they're added,
+// and a removed pool isn't trimmed
+static bool JotCheckSamePriority(void) {
+    JotMemoryAccountant* accountant = JotMemoryAccountantCreate();
+    JotTestPool first = {"first", accountant, JotMemoryCategoryDataCache, 10, false};
+    JotTestPool removed = {"removed", accountant, JotMemoryCategoryDataCache, 10, false};
+    JotTestPool last = {"last", accountant, JotMemoryCategoryDataCache, 10, false};
+    JotTestPool low = {"low", accountant, JotMemoryCategoryDataCache, 10, false};
+    JotAddTestPool(&first, 1);
+    JotMemoryPoolID removedID = JotAddTestPool(&removed, 1);
+    JotAddTestPool(&last, 1);
+    JotAddTestPool(&low, 0);
+    JotMemoryAccountantRemovePool(accountant, removedID);
+    JotMemoryAccountantAdjust(accountant, JotMemoryCategoryDataCache, 40);
+
+    bool matches = JotExpect(JotMemoryAccountantHandlePressure(accountant, JotMemoryPressureWarning) == 20, "same priority: wrong bytes freed");
+    matches = JotExpectTrims("low:20 first:10", "same priority: wrong trim order") && matches;
+    matches = JotExpect(JotMemoryAccountantHandlePressure(accountant, JotMemoryPressureCritical) == 10, "same priority: wrong bytes freed") && matches;
+    matches = JotExpectTrims("low:20 first:20 last:20", "same priority: the removed pool was trimmed") && matches;
+    matches = JotExpect(removed.cachedBytes == 10 && JotMemoryAccountantGetCategoryBytes(accountant, JotMemoryCategoryDataCache) == 10, "same priority: wrong bytes left") && matches;
+    JotMemoryAccountantFree(accountant);
+    return matches;
+}
+
+int main(void) {
+    int failures = 0;
+    failures += !JotCheckTrimLevels();
+    failures += !JotCheckSamePriority();
+
+    // half the pools report their own size, like the warm texture cache
+    JotMemoryAccountant* accountant = JotMemoryAccountantCreate();
+    JotTestPool pools[kJotTimingPoolCount];
+    for (int i = 0; i < kJotTimingPoolCount; i++) {
+        pools[i] = (JotTestPool){"pool", accountant, (JotMemoryCategory)(i % JotMemoryCategoryCount), 1000, i % 2};
+        JotAddTestPool(&pools[i], i % 8);
+        if (!pools[i].sized) {
+            JotMemoryAccountantAdjust(accountant, pools[i].category, 1000);
+        }
+    }
+    JotMemoryAccountantSetBudget(accountant, JotMemoryDomainGPU, 1 << 30);
+
+    int repeat = 1000000;
+    double adjustTime = JotBenchmarkTime(repeat, JotMemoryAccountantAdjust(accountant, JotMemoryCategoryTexture, (_jotRun & 1) ? -4096 : 4096));
+    size_t bytes = 0;
+    double countTime = JotBenchmarkTime(10000, bytes += JotMemoryAccountantGetDomainBytes(accountant, JotMemoryDomainCPU));
+    double trimTime = JotBenchmarkTime(10000, {
+        for (int i = 0; i < kJotTimingPoolCount; i++) {
+            if (!pools[i].sized) {
+                JotMemoryAccountantAdjust(accountant, pools[i].category, 1000 - (int64_t)pools[i].cachedBytes);
+            }
+            pools[i].cachedBytes = 1000;
+        }
+        trimLog[0] = '\0';
+        bytes += JotMemoryAccountantHandlePressure(accountant, JotMemoryPressureCritical);
+    });
+    if (!bytes) {
+        printf("timing: nothing was counted or trimmed\n");
+        failures++;
+    }
+    JotMemoryAccountantFree(accountant);
+
+    printf("%d pools\n", kJotTimingPoolCount);
+    printf("%-28s %10s\n", "", "us");
+    printf("%-28s %10.4f\n", "adjust", adjustTime * 1000.0);
+    printf("%-28s %10.4f\n", "domain bytes", countTime * 1000.0);
+    printf("%-28s %10.4f\n", "refill and critical trim", trimTime * 1000.0);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,145 @@
+//
+//  JotPNGWriterBenchmark.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+//  times JotPNGWriter's fast and compact options on mostly transparent
+//  pages. compact is zlib's defaults on one thread, which is close to
+//  what ImageIO does. then times re-encoding a saved page in 64 row
+//  bands, reusing the bands of the last save that haven't changed:
+//
+//      cc -O2 -I../JotUI JotPNGWriterBenchmark.c ../JotUI/JotPNGWriter.c ../JotUI/JotImageKernels.c ../JotUI/JotContentHash.c -o png_writer -lz -lpthread -lm
+//
+
+#include "JotBenchmark.h"
+#include "JotPNGWriter.h"
+#include <zlib.h>
+
+static uint32_t JotReadBigEndian(const uint8_t* bytes) {
+    return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+}
+
+static int JotPaeth(int a, int b, int c) {
+    int p = a + b - c, pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    return (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+}
+
+/**
+ * inflates the PNG's IDAT chunks and undoes its row filters, and
+ * returns whether that matches the straight RGBA it was encoded from
+ */
+static int JotPNGMatches(const uint8_t* png, size_t length, const uint8_t* rgba, size_t width, size_t height) {
+    static const uint8_t signature[8] = {137, 'P', 'N', 'G', '\r', '\n', 26, '\n'};
+    if (length < 8 || memcmp(png, signature, 8)) {
+        return 0;
+    }
+    size_t stride = width * 4 + 1;
+    uint8_t* filtered = malloc(stride * height);
+    z_stream stream = {0};
+    inflateInit(&stream);
+    stream.next_out = filtered;
+    stream.avail_out = (uInt)(stride * height);
+    for (size_t offset = 8; offset + 12 <= length;) {
+        uint32_t chunkLength = JotReadBigEndian(png + offset);
+        if (!memcmp(png + offset + 4, "IDAT", 4)) {
+            stream.next_in = (Bytef*)png + offset + 8;
+            stream.avail_in = chunkLength;
+            inflate(&stream, Z_NO_FLUSH);
+        }
+        offset += 12 + chunkLength;
+    }
+    int matches = stream.total_out == stride * height;
+    inflateEnd(&stream);
+
+    uint8_t* previous = calloc(width * 4, 1);
+    uint8_t* row = malloc(width * 4);
+    for (size_t y = 0; matches && y < height; y++) {
+        const uint8_t* line = filtered + y * stride;
+        for (size_t x = 0; x < width * 4; x++) {
+            int left = x >= 4 ? row[x - 4] : 0, up = previous[x], upLeft = x >= 4 ? previous[x - 4] : 0;
+            int predicted[5] = {0, left, up, (left + up) / 2, JotPaeth(left, up, upLeft)};
+            row[x] = (uint8_t)(line[1 + x] + (line[0] < 5 ? predicted[line[0]] : 0));
+        }
+        matches = line[0] < 5 && !memcmp(row, rgba + y * width * 4, width * 4);
+        memcpy(previous, row, width * 4);
+    }
+    free(previous);
+    free(row);
+    free(filtered);
+    return matches;
+}
+
+int main(void) {
+    size_t width = kJotBenchmarkPageWidth, height = kJotBenchmarkPageHeight;
+    uint8_t* page = malloc(width * height * 4);
+    int failures = 0;
+
+    JotPNGWriterOptions singleThread = JotPNGWriterFastOptions();
+    singleThread.threadCount = 1;
+    struct {
+        const char* name;
+        JotPNGWriterOptions options;
+    } encoders[] = {
+        {"compact", JotPNGWriterCompactOptions()},
+        {"fast, 1 thread", singleThread},
+        {"fast", JotPNGWriterFastOptions()},
+    };
+    int strokeCounts[] = {0, 20, 200};
+
+    printf("%-8s %-16s %10s %12s\n", "strokes", "options", "ms", "bytes");
+    for (size_t s = 0; s < sizeof(strokeCounts) / sizeof(strokeCounts[0]); s++) {
+        // PNGs hold straight alpha, like JotPNGEncoder hands the writer
+        JotBenchmarkFillPage(page, width, height, strokeCounts[s], 3);
+        for (size_t i = 0; i < width * height; i++) {
+            uint8_t* pixel = page + i * 4;
+            for (int c = 0; pixel[3] && c < 3; c++) {
+                pixel[c] = (uint8_t)((pixel[c] * 255 + pixel[3] / 2) / pixel[3]);
+            }
+        }
+        for (size_t e = 0; e < sizeof(encoders) / sizeof(encoders[0]); e++) {
+            size_t length = 0;
+            uint8_t* png = JotPNGWriterEncode(page, width, height, width * 4, &encoders[e].options, &length);
+            if (!png || !JotPNGMatches(png, length, page, width, height)) {
+                printf("%s: the PNG doesn't decode to the page\n", encoders[e].name);
+                failures++;
+            }
+            free(png);
+            double time = JotBenchmarkTime(3, free(JotPNGWriterEncode(page, width, height, width * 4, &encoders[e].options, &length)));
+            printf("%-8d %-16s %10.1f %12zu\n", strokeCounts[s], encoders[e].name, time, length);
+        }
+    }
+
+    // autosaves after an edit, a small stroke, and a corrupt last save
+    JotPNGWriterOptions fast = JotPNGWriterFastOptions();
+    size_t bandHeight = 64, saved = 0, length = 0, encodedBands = 0;
+    uint8_t* savedPNG = JotPNGWriterEncodeBands(page, width, height, width * 4, bandHeight, NULL, 0, &fast, &saved, &encodedBands);
+    printf("\n%-24s %10s %8s %12s\n", "bands", "ms", "encoded", "bytes");
+    for (int edit = 0; edit < 3; edit++) {
+        uint8_t* previous = malloc(saved);
+        memcpy(previous, savedPNG, saved);
+        if (edit == 1) {
+            for (size_t y = 900; y < 940; y++) {
+                memset(page + (y * width + 700) * 4, 0xFF, 80 * 4);
+            }
+        } else if (edit == 2) {
+            previous[saved / 2] ^= 0xFF;
+        }
+        uint8_t* png = JotPNGWriterEncodeBands(page, width, height, width * 4, bandHeight, previous, saved, &fast, &length, &encodedBands);
+        // an unchanged page has to come out byte for byte the same
+        if (!png || !JotPNGMatches(png, length, page, width, height) || (edit == 0 && (encodedBands || length != saved || memcmp(png, savedPNG, saved)))) {
+            printf("bands, edit %d: the PNG doesn't decode to the page\n", edit);
+            failures++;
+        }
+        free(png);
+        double time = JotBenchmarkTime(3, free(JotPNGWriterEncodeBands(page, width, height, width * 4, bandHeight, previous, saved, &fast, &length, NULL)));
+        const char* names[] = {"unchanged", "80x40 stroke", "corrupt last save"};
+        printf("%-24s %10.1f %4zu/%-3zu %12zu\n", names[edit], time, encodedBands, (height + bandHeight - 1) / bandHeight, length);
+        free(previous);
+    }
+    free(savedPNG);
+
+    free(page);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,164 @@
+//
+//  JotStrokeCodecBenchmark.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+//  times saving and loading the segment columns of a long stroke in
+//  the binary stroke file format, and checks that every column comes
+//  back bit for bit and that a corrupt file is refused:
+//
+//      cc -O2 -I../JotUI JotStrokeCodecBenchmark.c ../JotUI/JotStrokeCodec.c -o stroke_codec -lz -lm
+//
+
+#include "JotBenchmark.h"
+#include "JotStrokeCodec.h"
+
+#define kJotSegmentCount 2000
+#define kJotFloatColumnCount 16
+
+typedef struct {
+    float floats[kJotFloatColumnCount][kJotSegmentCount];
+    int64_t renderVersions[kJotSegmentCount];
+    bool followsMoveTo[kJotSegmentCount];
+} JotSegments;
+
+/**
+ * the columns of a CurveToPathElement stroke: points and controls
+ * that walk across the page, widths that change a little between
+ * segments, and columns like rotation that hardly change at all
+ */
+static void JotFillSegments(JotSegments* segments) {
+    srand(5);
+    for (int column = 0; column < kJotFloatColumnCount; column++) {
+        float value = 100 + rand() % 700;
+        for (int i = 0; i < kJotSegmentCount; i++) {
+            if (column < 8) {
+                value += ((rand() % 100) - 50) / 37.0f;
+            } else if (column < 12) {
+                value = 6 + (i % 3) * .25f;
+            } else {
+                value = column == 12 ? .5f : 0;
+            }
+            segments->floats[column][i] = value;
+        }
+    }
+    for (int i = 0; i < kJotSegmentCount; i++) {
+        segments->renderVersions[i] = 2;
+        segments->followsMoveTo[i] = i == 1;
+    }
+}
+
+// encodes the segments as a stroke file, and returns its length
+static size_t JotEncodeSegments(const JotSegments* segments, uint8_t** file) {
+    JotStrokeBuffer columns[kJotFloatColumnCount + 2];
+    JotStrokeTable table;
+    memset(&table, 0, sizeof(table));
+    table.rowCount = kJotSegmentCount;
+    table.columnCount = kJotFloatColumnCount + 2;
+    for (uint32_t i = 0; i < table.columnCount; i++) {
+        JotStrokeBufferInit(&columns[i]);
+        JotStrokeColumnKind kind = JotStrokeColumnKindFloat;
+        if (i < kJotFloatColumnCount) {
+            JotStrokeEncodeFloats(segments->floats[i], kJotSegmentCount, &columns[i]);
+        } else if (i == kJotFloatColumnCount) {
+            kind = JotStrokeColumnKindInteger;
+            JotStrokeEncodeIntegers(segments->renderVersions, kJotSegmentCount, &columns[i]);
+        } else {
+            kind = JotStrokeColumnKindBool;
+            JotStrokeEncodeBits(segments->followsMoveTo, kJotSegmentCount, &columns[i]);
+        }
+        table.columns[i] = (JotStrokeColumn){i, kind, 0, columns[i].bytes, columns[i].length};
+    }
+
+    // a string table of column names, an empty palette,
+    // and an empty stroke table
+    JotStrokeBuffer payload;
+    JotStrokeBufferInit(&payload);
+    for (uint32_t i = 0; i < table.columnCount; i++) {
+        char name[16];
+        int length = snprintf(name, sizeof(name), "column%u", i);
+        JotStrokeBufferAppendVarint(&payload, (uint64_t)length);
+        JotStrokeBufferAppend(&payload, name, (size_t)length);
+    }
+    JotStrokeTable stroke;
+    memset(&stroke, 0, sizeof(stroke));
+    stroke.rowCount = 1;
+    JotStrokeWriteTable(&stroke, &payload);
+    JotStrokeWriteTable(&table, &payload);
+
+    JotStrokeFileHeader header;
+    JotStrokeFileHeaderMake(&header, payload.bytes, payload.length, kJotStrokeFileHasSegments, kJotSegmentCount, table.columnCount, 0);
+    size_t length = sizeof(header) + payload.length;
+    *file = malloc(length);
+    memcpy(*file, &header, sizeof(header));
+    memcpy(*file + sizeof(header), payload.bytes, payload.length);
+
+    JotStrokeBufferFree(&payload);
+    for (uint32_t i = 0; i < table.columnCount; i++) {
+        JotStrokeBufferFree(&columns[i]);
+    }
+    return length;
+}
+
+// opens and verifies the file, and decodes its segment columns
+static bool JotDecodeSegments(const uint8_t* file, size_t length, JotSegments* segments) {
+    JotStrokeReader reader;
+    if (!JotStrokeReaderOpen(file, length, &reader) || !JotStrokeReaderVerify(&reader) || reader.segments.columnCount != kJotFloatColumnCount + 2) {
+        return false;
+    }
+    for (uint32_t i = 0; i < reader.segments.columnCount; i++) {
+        const JotStrokeColumn* column = &reader.segments.columns[i];
+        JotStrokeCursor cursor = {column->bytes, column->bytes + column->length};
+        bool decoded;
+        if (i < kJotFloatColumnCount) {
+            decoded = JotStrokeDecodeFloats(&cursor, segments->floats[i], kJotSegmentCount);
+        } else if (i == kJotFloatColumnCount) {
+            decoded = JotStrokeDecodeIntegers(&cursor, segments->renderVersions, kJotSegmentCount);
+        } else {
+            decoded = JotStrokeDecodeBits(&cursor, segments->followsMoveTo, kJotSegmentCount);
+        }
+        if (!decoded || cursor.bytes != cursor.end) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void) {
+    JotSegments* segments = malloc(sizeof(JotSegments));
+    JotSegments* decoded = malloc(sizeof(JotSegments));
+    JotFillSegments(segments);
+    int failures = 0;
+
+    uint8_t* file;
+    size_t length = JotEncodeSegments(segments, &file);
+    memset(decoded, 0, sizeof(JotSegments));
+    if (!JotDecodeSegments(file, length, decoded) || memcmp(segments, decoded, sizeof(JotSegments))) {
+        printf("the segments don't decode to what was saved\n");
+        failures++;
+    }
+    // the checksum covers everything after the header
+    for (size_t i = sizeof(JotStrokeFileHeader); i < length; i += 11) {
+        file[i] ^= 0x40;
+        if (JotDecodeSegments(file, length, decoded)) {
+            printf("a file corrupted at byte %zu was loaded\n", i);
+            failures++;
+        }
+        file[i] ^= 0x40;
+    }
+
+    double encodeTime = JotBenchmarkTime(200, free(({ uint8_t* encoded; JotEncodeSegments(segments, &encoded); encoded; })));
+    double decodeTime = JotBenchmarkTime(200, JotDecodeSegments(file, length, decoded));
+    size_t rawLength = sizeof(segments->floats) + sizeof(segments->renderVersions) + sizeof(segments->followsMoveTo);
+    printf("%d segments: %zu bytes, %zu raw\n", kJotSegmentCount, length, rawLength);
+    printf("%-8s %10s\n", "", "ms");
+    printf("%-8s %10.3f\n", "encode", encodeTime);
+    printf("%-8s %10.3f\n", "decode", decodeTime);
+
+    free(file);
+    free(segments);
+    free(decoded);
+    return failures ? 1 : 0;
+}
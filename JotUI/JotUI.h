@@ -38,6 +38,7 @@
 #import <JotUI/JotViewStateProxy.h>
 #import <JotUI/JotViewStateProxyDelegate.h>
 #import <JotUI/NSArray+JotMapReduce.h>
+#import <JotUI/NSDictionary+JotStrokeValues.h>
 #import <JotUI/JotTrashManager.h>
 #import <JotUI/UIImage+Resize.h>
 #import <JotUI/JotDiskAssetManager.h>
@@ -48,6 +49,30 @@
 #import <JotUI/JotBrushTexture.h>
 #import <JotUI/JotDefaultBrushTexture.h>
 #import <JotUI/JotHighlighterBrushTexture.h>
+#import <JotUI/JotImageKernels.h>
+#import <JotUI/JotInkTiles.h>
+#import <JotUI/JotInkTileSet.h>
+#import <JotUI/JotDirtyTileTracker.h>
+#import <JotUI/JotImageEncoder.h>
+#import <JotUI/JotPNGEncoder.h>
+#import <JotUI/JotPNGWriter.h>
+#import <JotUI/JotLZ4.h>
+#import <JotUI/JotInkTextureSidecar.h>
+#import <JotUI/JotStrokeCodec.h>
+#import <JotUI/JotStrokeFile.h>
+#import <JotUI/JotPageJournal.h>
+#import <JotUI/JotContentHash.h>
+#import <JotUI/JotVertexCache.h>
+#import <JotUI/JotFileBatch.h>
+#import <JotUI/JotBufferPool.h>
+#import <JotUI/JotMemoryAccountant.h>
+#import <JotUI/JotMemoryManager.h>
+#import <JotUI/JotPageResidencyManager.h>
+#import <JotUI/JotWarmTextureCache.h>
+#import <JotUI/JotGLContextPool.h>
+#import <JotUI/JotGLCommandBuffer.h>
+#import <JotUI/JotGLMockBackend.h>
+#import <JotUI/JotGLProfiler.h>
 
 typedef struct {
     GLfloat x;
@@ -33,6 +33,14 @@
 
 - (id)initWithStart:(CGPoint)point;
 
+// the hash of the element's points, which subclasses cache. the
+// contentHash combines it with the brush values, which can be
+// set after the element is created
+- (uint64_t)pointsHash;
+
+// the hash of the element's width, step width, rotation and color
+- (uint64_t)brushHash;
+
 - (NSInteger)numberOfVerticesPerStep;
 
 - (NSInteger)numberOfSteps;
@@ -16,12 +16,12 @@
 struct ColorfulVertex {
     GLfloat Position[2]; // x,y position   // 8
     GLfloat Color[4]; // rgba color     // 16
-    GLfloat Size; // pixel size     // 4
+    GLfloat Size; // point size     // 4
 };
 
 struct ColorlessVertex {
     GLfloat Position[2]; // x,y position   // 8
-    GLfloat Size; // pixel size     // 4
+    GLfloat Size; // point size     // 4
 };
 
 #endif
@@ -39,6 +39,10 @@ struct ColorlessVertex {
  */
 #define kBrushStepSize 1
 
+// This value should change if we ever decide to change how strokes are rendered, which would
+// cause them to need to re-calculate their cached vertex buffer
+#define kJotUIRenderVersion 1
+
 
 @interface AbstractBezierPathElement : NSObject <PlistSaving> {
     CGPoint _startPoint;
@@ -72,6 +76,24 @@ struct ColorlessVertex {
 - (void)adjustStartBy:(CGPoint)adjustment;
 - (UIBezierPath*)bezierPathSegment;
 
+// a 64 bit hash of the element's points, width, step width,
+// rotation and color, see JotContentHash.h
+- (uint64_t)contentHash;
+
+// the element's generated vertex data in page points, or nil if it
+// hasn't been generated for the element's current points
+- (NSData*)vertexBuffer;
+
 - (void)scaleForWidth:(CGFloat)widthRatio andHeight:(CGFloat)heightRatio NS_REQUIRES_SUPER;
 
+// initFromDictionary: reads the dictionary through this, and stroke
+// files read their segments through it straight from their columns.
+// subclasses override this instead of initFromDictionary:
+- (id)initFromStrokeValues:(id<JotStrokeValues>)values;
+
+// adopts vertices in page points from the page's JotVertexCache.
+// they're dropped by validateDataGivenPreviousElement: if they
+// don't have the number of bytes the segment needs
+- (void)useCachedVertexBuffer:(NSData*)vertexBuffer;
+
 @end
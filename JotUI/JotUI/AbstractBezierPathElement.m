@@ -9,13 +9,11 @@
 #import "AbstractBezierPathElement.h"
 #import "AbstractBezierPathElement-Protected.h"
 #import "UIColor+JotHelper.h"
+#import "JotContentHash.h"
+#import "NSDictionary+JotStrokeValues.h"
 #import "JotUI.h"
 #import "JotGLColorlessPointProgram.h"
 
-// This value should change if we ever decide to change how strokes are rendered, which would
-// cause them to need to re-calculate their cached vertex buffer
-#define kJotUIRenderVersion 1
-
 
 @implementation AbstractBezierPathElement
 
@@ -127,6 +125,31 @@
     @throw kAbstractMethodException;
 }
 
+- (uint64_t)contentHash {
+    // the brush is part of the content, so that segments
+    // that differ only in color or width don't hash the same
+    return JotContentHashCombine([self pointsHash], [self brushHash]);
+}
+
+- (uint64_t)pointsHash {
+    @throw kAbstractMethodException;
+}
+
+- (uint64_t)brushHash {
+    // segments without a color are drawn with the
+    // stroke's color, which isn't a valid component
+    GLfloat rgba[4] = {-1, -1, -1, -1};
+    if (_color) {
+        [_color getRGBAComponents:rgba];
+    }
+    double values[7] = { _width, _stepWidth, _rotation, rgba[0], rgba[1], rgba[2], rgba[3] };
+    return JotContentHashOfDoubles(values, 7);
+}
+
+- (NSData*)vertexBuffer {
+    return nil;
+}
+
 
 - (CGFloat)angleBetweenPoint:(CGPoint)point1 andPoint:(CGPoint)point2 {
     // Provides a directional bearing from point2 to the given point.
@@ -188,26 +211,34 @@
 }
 
 - (id)initFromDictionary:(NSDictionary*)dictionary {
+    return [self initFromStrokeValues:dictionary];
+}
+
+- (id)initFromStrokeValues:(id<JotStrokeValues>)values {
     self = [super init];
     if (self) {
-        _startPoint = CGPointMake([[dictionary objectForKey:@"startPoint.x"] floatValue], [[dictionary objectForKey:@"startPoint.y"] floatValue]);
-        _width = [[dictionary objectForKey:@"width"] floatValue];
-        _rotation = [[dictionary objectForKey:@"rotation"] floatValue];
-        _stepWidth = [[dictionary objectForKey:@"stepWidth"] floatValue] ?: .5;
-        _extraLengthWithoutDot = [[dictionary objectForKey:@"extraLengthWithoutDot"] floatValue];
-        _color = [UIColor colorWithDictionary:[dictionary objectForKey:@"color"]];
-        _scaleOfVertexBuffer = [[dictionary objectForKey:@"scaleOfVertexBuffer"] floatValue];
-        _followsMoveTo = [[dictionary objectForKey:@"followsMoveTo"] boolValue];
-        _previousWidth = [[dictionary objectForKey:@"previousWidth"] floatValue];
-        _previousRotation = [[dictionary objectForKey:@"previousRotation"] floatValue];
-        _previousExtraLengthWithoutDot = [[dictionary objectForKey:@"previousExtraLengthWithoutDot"] floatValue] ?: .5;
-        _previousColor = [UIColor colorWithDictionary:[dictionary objectForKey:@"previousColor"]];
-        _renderVersion = [[dictionary objectForKey:@"renderVersion"] integerValue];
-        _bakedPreviousElementProps = [[dictionary objectForKey:@"followsMoveTo"] boolValue];
+        _startPoint = CGPointMake([values jotFloatForKey:@"startPoint.x"], [values jotFloatForKey:@"startPoint.y"]);
+        _width = [values jotFloatForKey:@"width"];
+        _rotation = [values jotFloatForKey:@"rotation"];
+        _stepWidth = [values jotFloatForKey:@"stepWidth"] ?: .5;
+        _extraLengthWithoutDot = [values jotFloatForKey:@"extraLengthWithoutDot"];
+        _color = [values jotColorForKey:@"color"];
+        _scaleOfVertexBuffer = [values jotFloatForKey:@"scaleOfVertexBuffer"];
+        _followsMoveTo = [values jotBoolForKey:@"followsMoveTo"];
+        _previousWidth = [values jotFloatForKey:@"previousWidth"];
+        _previousRotation = [values jotFloatForKey:@"previousRotation"];
+        _previousExtraLengthWithoutDot = [values jotFloatForKey:@"previousExtraLengthWithoutDot"] ?: .5;
+        _previousColor = [values jotColorForKey:@"previousColor"];
+        _renderVersion = [values jotIntegerForKey:@"renderVersion"];
+        _bakedPreviousElementProps = [values jotBoolForKey:@"followsMoveTo"];
     }
     return self;
 }
 
+- (void)useCachedVertexBuffer:(NSData*)vertexBuffer {
+    // only segments with vertices use the cache
+}
+
 #pragma mark - Scaling
 
 - (void)scaleForWidth:(CGFloat)widthRatio andHeight:(CGFloat)heightRatio {
@@ -9,6 +9,7 @@
 #import "CurveToPathElement.h"
 #import "UIColor+JotHelper.h"
 #import "AbstractBezierPathElement-Protected.h"
+#import "JotContentHash.h"
 #import <OpenGLES/EAGLDrawable.h>
 #import <OpenGLES/EAGL.h>
 #import "JotBufferManager.h"
@@ -21,13 +22,12 @@
 #import "JotGLColoredPointProgram.h"
 
 #define kDivideStepBy 1.5
-#define kAbsoluteMinWidth 0.5
 
 
 @implementation CurveToPathElement {
     CGRect _boundsCache;
     // cache the hash, since it's expenseive to calculate
-    NSUInteger _hashCache;
+    uint64_t _hashCache;
     // the VBO
     JotBufferVBO* _vbo;
     // a boolean for if color information is encoded in the VBO
@@ -38,6 +38,9 @@
     // every time we bind
     BOOL _hasCalculatedColorComponents;
     GLfloat _colorComponents[4];
+    // the vertices are in page points. this is the screen
+    // scale to draw them at
+    CGFloat _scaleToDraw;
 
     CGFloat _subBezierlengthCache[1000];
 
@@ -55,16 +58,7 @@ const CGPoint JotCGNotFoundPoint = {-10000000.2, -999999.6};
         _ctrl1 = ctrl1;
         _ctrl2 = ctrl2;
 
-        NSUInteger prime = 31;
-        _hashCache = 1;
-        _hashCache = prime * _hashCache + _startPoint.x;
-        _hashCache = prime * _hashCache + _startPoint.y;
-        _hashCache = prime * _hashCache + _curveTo.x;
-        _hashCache = prime * _hashCache + _curveTo.y;
-        _hashCache = prime * _hashCache + _ctrl1.x;
-        _hashCache = prime * _hashCache + _ctrl1.y;
-        _hashCache = prime * _hashCache + _ctrl2.x;
-        _hashCache = prime * _hashCache + _ctrl2.y;
+        [self updateHashCache];
 
         _boundsCache.origin = JotCGNotFoundPoint;
 
@@ -138,6 +132,7 @@ const CGPoint JotCGNotFoundPoint = {-10000000.2, -999999.6};
 - (void)adjustStartBy:(CGPoint)adjustment {
     _startPoint = CGPointMake(_startPoint.x + adjustment.x, _startPoint.y + adjustment.y);
     _ctrl1 = CGPointMake(_ctrl1.x + adjustment.x, _ctrl1.y + adjustment.y);
+    _boundsCache.origin = JotCGNotFoundPoint;
 }
 
 
@@ -207,9 +202,6 @@ const CGPoint JotCGNotFoundPoint = {-10000000.2, -999999.6};
 
             NSAssert(_colorComponents[3] / (self.width / kDivideStepBy) > 0, @"color can't be negative");
 
-            CGFloat stepWidth = self.width * _scaleOfVertexBuffer;
-            if (stepWidth < kAbsoluteMinWidth)
-                stepWidth = kAbsoluteMinWidth;
             CGFloat alpha = _colorComponents[3] / kDivideStepBy;
             if (alpha > 1)
                 alpha = 1;
@@ -245,16 +237,19 @@ const CGPoint JotCGNotFoundPoint = {-10000000.2, -999999.6};
 
 /**
  * generate a vertex buffer array for all of the points
- * along this curve for the input scale.
+ * along this curve.
  *
- * this method will cache the array for a single scale. if
- * a new scale is sent in later, then the cache will be rebuilt
- * for the new scale.
+ * the vertices are in page points, so the same array is
+ * used for every scale. the scale is only saved so that
+ * the point program can convert them to pixels when
+ * the element is drawn
  */
 - (struct ColorfulVertex*)generatedVertexArrayForScale:(CGFloat)scale {
+    _scaleToDraw = scale;
+
     // if we have a buffer generated and cached,
     // then just return that
-    if (_dataVertexBuffer && _scaleOfVertexBuffer == scale) {
+    if (_dataVertexBuffer) {
         return (struct ColorfulVertex*)_dataVertexBuffer.bytes;
     }
 
@@ -287,9 +282,10 @@ const CGPoint JotCGNotFoundPoint = {-10000000.2, -999999.6};
     // malloc the memory for our buffer, if needed
     _dataVertexBuffer = nil;
 
-    // save our scale, we're only going to cache a vertex
-    // buffer for 1 scale at a time
-    _scaleOfVertexBuffer = scale;
+    // vertices are generated in points, which is the same
+    // as pixels at scale 1. buffers saved by older versions
+    // at other scales are regenerated
+    _scaleOfVertexBuffer = 1;
 
     if (!_vertexBufferShouldContainColor) {
         [self calculateAndCacheColorComponents];
@@ -355,10 +351,11 @@ const CGPoint JotCGNotFoundPoint = {-10000000.2, -999999.6};
         CGFloat t = (CGFloat)step / (CGFloat)numberOfVertices;
 
         // current width
-        CGFloat stepWidth = (prevWidth + widthDiff * t) * _scaleOfVertexBuffer;
-        // ensure min width for dots
-        if (stepWidth < kAbsoluteMinWidth)
-            stepWidth = kAbsoluteMinWidth;
+        CGFloat stepWidth = prevWidth + widthDiff * t;
+        // the point shaders keep dots at least half a pixel
+        // wide once they know the screen scale
+        if (stepWidth < 0)
+            stepWidth = 0;
 
         // calculate the point that is realStepSize distance
         // along the curve * which step we're on
@@ -397,12 +394,12 @@ const CGPoint JotCGNotFoundPoint = {-10000000.2, -999999.6};
             calcColor[1] = calcColor[1] * calcColor[3];
             calcColor[2] = calcColor[2] * calcColor[3];
         }
-        // Convert locations from screen Points to GL points (screen pixels)
+        // locations stay in page points, the MVP converts them to pixels
         if (_vertexBufferShouldContainColor) {
             struct ColorfulVertex* coloredVertexBuffer = (struct ColorfulVertex*)vertexBuffer;
             // set colors to the array
-            coloredVertexBuffer[step].Position[0] = (GLfloat)point.x * _scaleOfVertexBuffer;
-            coloredVertexBuffer[step].Position[1] = (GLfloat)point.y * _scaleOfVertexBuffer;
+            coloredVertexBuffer[step].Position[0] = (GLfloat)point.x;
+            coloredVertexBuffer[step].Position[1] = (GLfloat)point.y;
             coloredVertexBuffer[step].Color[0] = calcColor[0];
             coloredVertexBuffer[step].Color[1] = calcColor[1];
             coloredVertexBuffer[step].Color[2] = calcColor[2];
@@ -412,8 +409,8 @@ const CGPoint JotCGNotFoundPoint = {-10000000.2, -999999.6};
         } else {
             struct ColorlessVertex* colorlessVertexBuffer = (struct ColorlessVertex*)vertexBuffer;
             // set colors to the array
-            colorlessVertexBuffer[step].Position[0] = (GLfloat)point.x * _scaleOfVertexBuffer;
-            colorlessVertexBuffer[step].Position[1] = (GLfloat)point.y * _scaleOfVertexBuffer;
+            colorlessVertexBuffer[step].Position[0] = (GLfloat)point.x;
+            colorlessVertexBuffer[step].Position[1] = (GLfloat)point.y;
             colorlessVertexBuffer[step].Size = stepWidth;
         }
     }
@@ -435,7 +432,7 @@ static CGFloat screenHeight;
     });
 
 
-    NSAssert(!(vertex.Size < 1 || vertex.Size > 360), @"valid vertex size");
+    NSAssert(!(vertex.Size < 0 || vertex.Size > 360), @"valid vertex size");
 }
 
 - (void)loadDataIntoVBOIfNeeded {
@@ -479,6 +476,7 @@ static CGFloat screenHeight;
         // if we need a vbo, then create it
         JotGLPointProgram* program = (JotGLPointProgram*)[self glProgramForContext:context];
         program.rotation = self.rotation;
+        program.pointScale = _scaleToDraw ?: 1;
         [program use];
 
         [self loadDataIntoVBOIfNeeded];
@@ -678,31 +676,29 @@ static CGFloat subdivideBezierAtLength(const CGPoint bez[4],
     [dict setObject:[NSNumber numberWithFloat:_ctrl2.x] forKey:@"ctrl2.x"];
     [dict setObject:[NSNumber numberWithFloat:_ctrl2.y] forKey:@"ctrl2.y"];
     [dict setObject:[NSNumber numberWithBool:_vertexBufferShouldContainColor] forKey:@"vertexBufferShouldContainColor"];
-    if (_dataVertexBuffer) {
-        [dict setObject:_dataVertexBuffer forKey:@"vertexBuffer"];
-    }
+    // the vertex data isn't saved with the segment. it's only usable at the same
+    // screen scale, so it's kept in the page's JotVertexCache instead
     [dict setObject:[NSNumber numberWithFloat:_numberOfBytesOfVertexData] forKey:@"numberOfBytesOfVertexData"];
     return [NSDictionary dictionaryWithDictionary:dict];
 }
 
-- (id)initFromDictionary:(NSDictionary*)dictionary {
-    self = [super initFromDictionary:dictionary];
+- (id)initFromStrokeValues:(id<JotStrokeValues>)values {
+    self = [super initFromStrokeValues:values];
     if (self) {
         _lock = [[NSLock alloc] init];
         _boundsCache.origin = JotCGNotFoundPoint;
-        _curveTo = CGPointMake([[dictionary objectForKey:@"curveTo.x"] floatValue], [[dictionary objectForKey:@"curveTo.y"] floatValue]);
-        _ctrl1 = CGPointMake([[dictionary objectForKey:@"ctrl1.x"] floatValue], [[dictionary objectForKey:@"ctrl1.y"] floatValue]);
-        _ctrl2 = CGPointMake([[dictionary objectForKey:@"ctrl2.x"] floatValue], [[dictionary objectForKey:@"ctrl2.y"] floatValue]);
-        _dataVertexBuffer = [dictionary objectForKey:@"vertexBuffer"];
-        _vertexBufferShouldContainColor = [[dictionary objectForKey:@"vertexBufferShouldContainColor"] boolValue];
-        _numberOfBytesOfVertexData = [[dictionary objectForKey:@"numberOfBytesOfVertexData"] integerValue];
-
-        CGFloat currentScale = [[UIScreen mainScreen] scale];
-        if (currentScale != _scaleOfVertexBuffer) {
-            // the scale of the cached data in the dictionary is
-            // different than the scael of the data that we need.
-            // zero this out and it'll regenerate with the
-            // correct scale on demand
+        _curveTo = CGPointMake([values jotFloatForKey:@"curveTo.x"], [values jotFloatForKey:@"curveTo.y"]);
+        _ctrl1 = CGPointMake([values jotFloatForKey:@"ctrl1.x"], [values jotFloatForKey:@"ctrl1.y"]);
+        _ctrl2 = CGPointMake([values jotFloatForKey:@"ctrl2.x"], [values jotFloatForKey:@"ctrl2.y"]);
+        // saved by an older version
+        _dataVertexBuffer = [values objectForKey:@"vertexBuffer"];
+        _vertexBufferShouldContainColor = [values jotBoolForKey:@"vertexBufferShouldContainColor"];
+        _numberOfBytesOfVertexData = [values jotIntegerForKey:@"numberOfBytesOfVertexData"];
+
+        if (_scaleOfVertexBuffer != 1) {
+            // older versions saved vertices in pixels for the
+            // screen's scale. zero this out and it'll regenerate
+            // in points on demand
             _scaleOfVertexBuffer = 0;
             _dataVertexBuffer = nil;
             _numberOfBytesOfVertexData = 0;
@@ -712,20 +708,18 @@ static CGFloat subdivideBezierAtLength(const CGPoint bez[4],
             [self calculateAndCacheColorComponents];
         }
 
-        NSUInteger prime = 31;
-        _hashCache = 1;
-        _hashCache = prime * _hashCache + _startPoint.x;
-        _hashCache = prime * _hashCache + _startPoint.y;
-        _hashCache = prime * _hashCache + _curveTo.x;
-        _hashCache = prime * _hashCache + _curveTo.y;
-        _hashCache = prime * _hashCache + _ctrl1.x;
-        _hashCache = prime * _hashCache + _ctrl1.y;
-        _hashCache = prime * _hashCache + _ctrl2.x;
-        _hashCache = prime * _hashCache + _ctrl2.y;
+        [self updateHashCache];
     }
     return self;
 }
 
+- (void)useCachedVertexBuffer:(NSData*)vertexBuffer {
+    // cached vertices are in points, the same as pixels at scale 1
+    _dataVertexBuffer = vertexBuffer;
+    _scaleOfVertexBuffer = 1;
+    _numberOfBytesOfVertexData = [vertexBuffer length];
+}
+
 /**
  * if we ever change how we render segments, then the data that's stored in our
  * dataVertexBuffer will contain "bad" data, since it would have been generated
@@ -749,6 +743,11 @@ static CGFloat subdivideBezierAtLength(const CGPoint bez[4],
     }
 }
 
+- (NSData*)vertexBuffer {
+    NSData* vertexBuffer = _dataVertexBuffer;
+    return _scaleOfVertexBuffer == 1 && [vertexBuffer length] ? vertexBuffer : nil;
+}
+
 - (UIBezierPath*)bezierPathSegment {
     UIBezierPath* strokePath = [UIBezierPath bezierPath];
     [strokePath moveToPoint:self.startPoint];
@@ -759,10 +758,19 @@ static CGFloat subdivideBezierAtLength(const CGPoint bez[4],
 
 #pragma mark - hashing and equality
 
-- (NSUInteger)hash {
+- (void)updateHashCache {
+    double values[8] = { _startPoint.x, _startPoint.y, _curveTo.x, _curveTo.y, _ctrl1.x, _ctrl1.y, _ctrl2.x, _ctrl2.y };
+    _hashCache = JotContentHashOfDoubles(values, 8);
+}
+
+- (uint64_t)pointsHash {
     return _hashCache;
 }
 
+- (NSUInteger)hash {
+    return (NSUInteger)[self contentHash];
+}
+
 - (BOOL)isEqual:(id)object {
     return self == object || [self hash] == [object hash];
 }
@@ -782,8 +790,13 @@ static CGFloat subdivideBezierAtLength(const CGPoint bez[4],
     _ctrl2.y = _ctrl2.y * heightRatio;
 
     _length = 0;
+    _boundsCache.origin = JotCGNotFoundPoint;
 
+    // the dots are spaced and sized along the resized curve, so
+    // the vertices are regenerated instead of stretched
     _dataVertexBuffer = nil;
+    _scaleOfVertexBuffer = 0;
+    _numberOfBytesOfVertexData = 0;
     if (_vbo) {
         [self.bufferManager recycleBuffer:_vbo];
         _vbo = nil;
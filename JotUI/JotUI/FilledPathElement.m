@@ -8,12 +8,13 @@
 
 #import "FilledPathElement.h"
 #import "AbstractBezierPathElement-Protected.h"
+#import "JotContentHash.h"
 #import <MessageUI/MFMailComposeViewController.h>
 
 
 @implementation FilledPathElement {
     // cache the hash, since it's expenseive to calculate
-    NSUInteger _hashCache;
+    uint64_t _hashCache;
     // bezier path
     UIBezierPath* _path;
     // create texture
@@ -49,16 +50,7 @@
         _p3 = p3;
         _p4 = p4;
 
-        NSUInteger prime = 31;
-        _hashCache = 1;
-        _hashCache = prime * _hashCache + _p1.x;
-        _hashCache = prime * _hashCache + _p1.y;
-        _hashCache = prime * _hashCache + _p2.x;
-        _hashCache = prime * _hashCache + _p2.y;
-        _hashCache = prime * _hashCache + _p3.x;
-        _hashCache = prime * _hashCache + _p3.y;
-        _hashCache = prime * _hashCache + _p4.x;
-        _hashCache = prime * _hashCache + _p4.y;
+        [self updateHashCache];
 
         [self generateTextureFromPath];
 
@@ -255,33 +247,24 @@
     return [NSDictionary dictionaryWithDictionary:dict];
 }
 
-- (id)initFromDictionary:(NSDictionary*)dictionary {
-    self = [super initFromDictionary:dictionary];
+- (id)initFromStrokeValues:(id<JotStrokeValues>)values {
+    self = [super initFromStrokeValues:values];
     if (self) {
         _lock = [[NSLock alloc] init];
         // load from dictionary
-        _path = [NSKeyedUnarchiver unarchiveObjectWithData:[dictionary objectForKey:@"bezierPath"]];
-        _p1 = CGPointMake([[dictionary objectForKey:@"p1.x"] floatValue], [[dictionary objectForKey:@"p1.y"] floatValue]);
-        _p2 = CGPointMake([[dictionary objectForKey:@"p2.x"] floatValue], [[dictionary objectForKey:@"p2.y"] floatValue]);
-        _p3 = CGPointMake([[dictionary objectForKey:@"p3.x"] floatValue], [[dictionary objectForKey:@"p3.y"] floatValue]);
-        _p4 = CGPointMake([[dictionary objectForKey:@"p4.x"] floatValue], [[dictionary objectForKey:@"p4.y"] floatValue]);
-        _sizeOfTexture = CGSizeMake([[dictionary objectForKey:@"sizeOfTexture.width"] floatValue], [[dictionary objectForKey:@"sizeOfTexture.height"] floatValue]);
+        _path = [NSKeyedUnarchiver unarchiveObjectWithData:[values objectForKey:@"bezierPath"]];
+        _p1 = CGPointMake([values jotFloatForKey:@"p1.x"], [values jotFloatForKey:@"p1.y"]);
+        _p2 = CGPointMake([values jotFloatForKey:@"p2.x"], [values jotFloatForKey:@"p2.y"]);
+        _p3 = CGPointMake([values jotFloatForKey:@"p3.x"], [values jotFloatForKey:@"p3.y"]);
+        _p4 = CGPointMake([values jotFloatForKey:@"p4.x"], [values jotFloatForKey:@"p4.y"]);
+        _sizeOfTexture = CGSizeMake([values jotFloatForKey:@"sizeOfTexture.width"], [values jotFloatForKey:@"sizeOfTexture.height"]);
 
         //        CGFloat currentScale = [[dictionary objectForKey:@"scale"] floatValue];
         // we can ignore the scale that's sent in because
         // we set the scaleTransform on demand, and keep all pts
         // of this element in pts instead of pxs
 
-        NSUInteger prime = 31;
-        _hashCache = 1;
-        _hashCache = prime * _hashCache + _p1.x;
-        _hashCache = prime * _hashCache + _p1.y;
-        _hashCache = prime * _hashCache + _p2.x;
-        _hashCache = prime * _hashCache + _p2.y;
-        _hashCache = prime * _hashCache + _p3.x;
-        _hashCache = prime * _hashCache + _p3.y;
-        _hashCache = prime * _hashCache + _p4.x;
-        _hashCache = prime * _hashCache + _p4.y;
+        [self updateHashCache];
 
         [self generateTextureFromPath];
     }
@@ -295,10 +278,19 @@
 
 #pragma mark - hashing and equality
 
-- (NSUInteger)hash {
+- (void)updateHashCache {
+    double values[8] = { _p1.x, _p1.y, _p2.x, _p2.y, _p3.x, _p3.y, _p4.x, _p4.y };
+    _hashCache = JotContentHashOfDoubles(values, 8);
+}
+
+- (uint64_t)pointsHash {
     return _hashCache;
 }
 
+- (NSUInteger)hash {
+    return (NSUInteger)[self contentHash];
+}
+
 - (BOOL)isEqual:(id)object {
     return self == object || [self hash] == [object hash];
 }
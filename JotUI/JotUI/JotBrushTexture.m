@@ -94,11 +94,12 @@
             [context glTexParameteriWithPname:GL_TEXTURE_WRAP_S param:GL_CLAMP_TO_EDGE];
             [context glTexParameteriWithPname:GL_TEXTURE_WRAP_T param:GL_CLAMP_TO_EDGE];
             // Specify a 2D texture image, providing the a pointer to the image data in memory
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, brushData);
+            JotGLProfileCall([context profiler], JotGLCallTexImage2D, glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, brushData));
+            JotGLProfileUpload([context profiler], width * height * 4);
 
             // Release  the image data; it's no longer needed
             free(brushData);
-            glFlush();
+            JotGLProfileCall([context profiler], JotGLCallFlush, glFlush());
             ret = YES;
             return;
         }
@@ -29,4 +29,9 @@
 
 - (NSDictionary*)cacheMemoryStats;
 
+// sends about bytesToFree of unused buffers to the trash manager, and
+// returns how many bytes were sent. the memory manager calls this when
+// it's over budget
+- (NSUInteger)trimCachedBuffers:(NSUInteger)bytesToFree;
+
 @end
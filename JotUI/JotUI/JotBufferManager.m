@@ -13,6 +13,7 @@
 #import "OpenGLVBO.h"
 #import "JotBufferVBO.h"
 #import "MMMainOperationQueue.h"
+#import "JotMemoryManager.h"
 
 /**
  * the JotBufferManager will help allocate
@@ -50,10 +51,17 @@
 
 static JotBufferManager* _instance = nil;
 
+static size_t JotBufferManagerTrim(void* context, size_t bytesToFree) {
+    return [(__bridge JotBufferManager*)context trimCachedBuffers:bytesToFree];
+}
+
 - (id)init {
     if ((self = [super init])) {
         cacheOfVBOs = [NSMutableDictionary dictionary];
         cacheStats = [NSMutableDictionary dictionary];
+        // the manager is never deallocated, so it's never removed
+        JotMemoryAccountantAddPool([[JotMemoryManager sharedManager] accountant], JotMemoryCategoryVertexBuffer, kJotMemoryPriorityVertexBufferCache,
+                                   &JotBufferManagerTrim, NULL, (__bridge void*)self);
 
 #ifdef DEBUG
         if (kJotEnableCacheStats) {
@@ -219,7 +227,40 @@ static JotBufferManager* _instance = nil;
     }
 }
 
+/**
+ * sends cached buffers to the trash manager, largest first, until
+ * about bytesToFree are sent. an OpenGLVBO is only deleted once all of
+ * its steps are, so the bytes are freed as the rest of its buffers
+ * are trimmed or released
+ */
+- (NSUInteger)trimCachedBuffers:(NSUInteger)bytesToFree {
+    NSArray* cacheNumbers;
+    @synchronized(cacheOfVBOs) {
+        cacheNumbers = [[cacheOfVBOs allKeys] sortedArrayUsingSelector:@selector(compare:)];
+    }
+    NSUInteger freedBytes = 0;
+    for (NSNumber* cacheNumber in [cacheNumbers reverseObjectEnumerator]) {
+        NSMutableArray* vboCache = [self arrayOfVBOsForCacheNumber:[cacheNumber integerValue]];
+        NSMutableArray* trimmed = [NSMutableArray array];
+        @synchronized(vboCache) {
+            while (freedBytes < bytesToFree && [vboCache count]) {
+                // the most recently cached buffers are trimmed first
+                JotBufferVBO* buffer = [vboCache lastObject];
+                [vboCache removeLastObject];
+                [trimmed addObject:buffer];
+                freedBytes += buffer.fullByteSize;
+            }
+        }
+        [[JotTrashManager sharedInstance] addObjectsToDealloc:trimmed];
+        if (freedBytes >= bytesToFree) {
+            break;
+        }
+    }
+    return freedBytes;
+}
+
 - (void)openGLBufferHasBeenBorn:(OpenGLVBO*)openGLVBO {
+    JotMemoryAccountantAdjust([[JotMemoryManager sharedManager] accountant], JotMemoryCategoryVertexBuffer, openGLVBO.fullByteSize);
     @synchronized(cacheStats) {
         int mem = [[cacheStats objectForKey:kVBOCacheSize] intValue];
         mem += openGLVBO.fullByteSize;
@@ -233,6 +274,7 @@ static JotBufferManager* _instance = nil;
 }
 
 - (void)openGLBufferHasDied:(OpenGLVBO*)openGLVBO {
+    JotMemoryAccountantAdjust([[JotMemoryManager sharedManager] accountant], JotMemoryCategoryVertexBuffer, -openGLVBO.fullByteSize);
     @synchronized(cacheStats) {
         int mem = [[cacheStats objectForKey:kVBOCacheSize] intValue];
         mem -= openGLVBO.fullByteSize;
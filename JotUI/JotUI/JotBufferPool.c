@@ -0,0 +1,412 @@
+//
+//  JotBufferPool.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#include "JotBufferPool.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// the smallest class is 4KB
+#define kJotBufferPoolMinShift 12
+// two classes per power of two, up to 64MB
+#define kJotBufferPoolClassCount 29
+// classes up to 64KB are cached in each thread's magazine
+#define kJotBufferPoolMagazineClassCount 9
+#define kJotBufferPoolMagazineSize 2
+
+// cached buffers are linked through their first bytes
+typedef struct JotBufferPoolFreeBuffer {
+    struct JotBufferPoolFreeBuffer* next;
+} JotBufferPoolFreeBuffer;
+
+// a buffer is outstanding from the time it leaves the class's free list
+// until it's returned to it, which includes time in a magazine. the
+// magazines are small, and this keeps them from touching the pool at all
+typedef struct {
+    JotBufferPoolFreeBuffer* freeList;
+    size_t freeCount;
+    size_t outstandingCount;
+    size_t highWaterCount;
+} JotBufferPoolClass;
+
+typedef struct JotBufferPoolMagazine {
+    // only ever contended by a trim
+    pthread_mutex_t lock;
+    JotBufferPool* pool;
+    void* buffers[kJotBufferPoolMagazineClassCount][kJotBufferPoolMagazineSize];
+    int counts[kJotBufferPoolMagazineClassCount];
+    // the magazine's share of the pool's stats. outstandingBytes can be
+    // negative if other threads allocated what this one released
+    uint64_t hits;
+    int64_t outstandingBytes;
+    struct JotBufferPoolMagazine* prev;
+    struct JotBufferPoolMagazine* next;
+} JotBufferPoolMagazine;
+
+struct JotBufferPool {
+    pthread_mutex_t lock;
+    pthread_key_t magazineKey;
+    JotBufferPoolClass classes[kJotBufferPoolClassCount];
+    JotBufferPoolMagazine* magazines;
+    size_t maxCachedBytes;
+    // the bytes in the classes' free lists
+    size_t cachedBytes;
+    // stats that aren't in any magazine
+    uint64_t hits;
+    uint64_t misses;
+    int64_t outstandingBytes;
+};
+
+#pragma mark - Size Classes
+
+static size_t JotBufferPoolClassSize(int index) {
+    size_t size = (size_t)1 << (kJotBufferPoolMinShift + index / 2);
+    return index % 2 ? size + size / 2 : size;
+}
+
+// the smallest class that fits size, or -1 if it's too big to pool
+static int JotBufferPoolClassIndex(size_t size) {
+    if (size <= ((size_t)1 << kJotBufferPoolMinShift)) {
+        return 0;
+    }
+    // the highest bit of size - 1
+#if defined(__GNUC__) || defined(__clang__)
+    int shift = (int)(sizeof(unsigned long long) * 8 - 1) - __builtin_clzll((unsigned long long)(size - 1));
+#else
+    int shift = 0;
+    for (size_t bits = size - 1; bits > 1; bits >>= 1) {
+        shift++;
+    }
+#endif
+    size_t power = (size_t)1 << shift;
+    int index = size <= power + power / 2 ? 2 * (shift - kJotBufferPoolMinShift) + 1 : 2 * (shift + 1 - kJotBufferPoolMinShift);
+    return index < kJotBufferPoolClassCount ? index : -1;
+}
+
+size_t JotBufferPoolCapacityForSize(size_t size) {
+    int index = JotBufferPoolClassIndex(size);
+    return index < 0 ? size : JotBufferPoolClassSize(index);
+}
+
+#pragma mark - Free Lists
+
+static void JotBufferPoolFreeAll(JotBufferPoolFreeBuffer* buffers) {
+    while (buffers) {
+        JotBufferPoolFreeBuffer* next = buffers->next;
+        free(buffers);
+        buffers = next;
+    }
+}
+
+static size_t JotBufferPoolMagazineBytes(JotBufferPoolMagazine* magazine) {
+    size_t bytes = 0;
+    for (int index = 0; index < kJotBufferPoolMagazineClassCount; index++) {
+        bytes += magazine->counts[index] * JotBufferPoolClassSize(index);
+    }
+    return bytes;
+}
+
+// must be called with the pool locked
+static void JotBufferPoolPush(JotBufferPool* pool, int index, void* buffer) {
+    JotBufferPoolClass* sizeClass = &pool->classes[index];
+    JotBufferPoolFreeBuffer* freeBuffer = buffer;
+    freeBuffer->next = sizeClass->freeList;
+    sizeClass->freeList = freeBuffer;
+    sizeClass->freeCount++;
+    pool->cachedBytes += JotBufferPoolClassSize(index);
+}
+
+// must be called with the pool locked
+static void* JotBufferPoolPop(JotBufferPool* pool, int index) {
+    JotBufferPoolClass* sizeClass = &pool->classes[index];
+    JotBufferPoolFreeBuffer* freeBuffer = sizeClass->freeList;
+    if (freeBuffer) {
+        sizeClass->freeList = freeBuffer->next;
+        sizeClass->freeCount--;
+        pool->cachedBytes -= JotBufferPoolClassSize(index);
+    }
+    return freeBuffer;
+}
+
+// returns a released buffer to its class's free list, unless the class
+// already has as many as it's needed at once or the pool is at its cap.
+// returns false if the caller should free the buffer instead. must be
+// called with the pool locked
+static bool JotBufferPoolReturn(JotBufferPool* pool, int index, void* buffer) {
+    JotBufferPoolClass* sizeClass = &pool->classes[index];
+    sizeClass->outstandingCount--;
+    // a trim lowers the high water mark to what's in use
+    if (sizeClass->freeCount + sizeClass->outstandingCount < sizeClass->highWaterCount && pool->cachedBytes + JotBufferPoolClassSize(index) <= pool->maxCachedBytes) {
+        JotBufferPoolPush(pool, index, buffer);
+        return true;
+    }
+    return false;
+}
+
+// moves the magazine's buffers into the free lists. must be called
+// with both the pool and the magazine locked
+static void JotBufferPoolEmptyMagazine(JotBufferPool* pool, JotBufferPoolMagazine* magazine) {
+    for (int index = 0; index < kJotBufferPoolMagazineClassCount; index++) {
+        while (magazine->counts[index]) {
+            JotBufferPoolPush(pool, index, magazine->buffers[index][--magazine->counts[index]]);
+            pool->classes[index].outstandingCount--;
+        }
+    }
+}
+
+#pragma mark - Magazines
+
+static void JotBufferPoolMagazineDestroy(void* value) {
+    JotBufferPoolMagazine* magazine = value;
+    JotBufferPool* pool = magazine->pool;
+
+    pthread_mutex_lock(&pool->lock);
+    if (magazine->prev) {
+        magazine->prev->next = magazine->next;
+    } else {
+        pool->magazines = magazine->next;
+    }
+    if (magazine->next) {
+        magazine->next->prev = magazine->prev;
+    }
+    // the thread's buffers go back like any other release, so they're
+    // only kept if the pool has room. the other threads' magazines
+    // and the high water marks are left alone
+    JotBufferPoolFreeBuffer* toFree = NULL;
+    pthread_mutex_lock(&magazine->lock);
+    for (int index = 0; index < kJotBufferPoolMagazineClassCount; index++) {
+        while (magazine->counts[index]) {
+            void* buffer = magazine->buffers[index][--magazine->counts[index]];
+            if (!JotBufferPoolReturn(pool, index, buffer)) {
+                JotBufferPoolFreeBuffer* freeBuffer = buffer;
+                freeBuffer->next = toFree;
+                toFree = freeBuffer;
+            }
+        }
+    }
+    pool->hits += magazine->hits;
+    pool->outstandingBytes += magazine->outstandingBytes;
+    pthread_mutex_unlock(&magazine->lock);
+    pthread_mutex_unlock(&pool->lock);
+
+    JotBufferPoolFreeAll(toFree);
+    pthread_mutex_destroy(&magazine->lock);
+    free(magazine);
+}
+
+static JotBufferPoolMagazine* JotBufferPoolGetMagazine(JotBufferPool* pool) {
+    JotBufferPoolMagazine* magazine = pthread_getspecific(pool->magazineKey);
+    if (!magazine) {
+        magazine = calloc(1, sizeof(JotBufferPoolMagazine));
+        if (!magazine) {
+            return NULL;
+        }
+        if (pthread_mutex_init(&magazine->lock, NULL) != 0) {
+            free(magazine);
+            return NULL;
+        }
+        magazine->pool = pool;
+        pthread_mutex_lock(&pool->lock);
+        magazine->next = pool->magazines;
+        if (pool->magazines) {
+            pool->magazines->prev = magazine;
+        }
+        pool->magazines = magazine;
+        pthread_mutex_unlock(&pool->lock);
+        if (pthread_setspecific(pool->magazineKey, magazine) != 0) {
+            JotBufferPoolMagazineDestroy(magazine);
+            return NULL;
+        }
+    }
+    return magazine;
+}
+
+#pragma mark - Pool
+
+JotBufferPool* JotBufferPoolCreate(size_t maxCachedBytes) {
+    JotBufferPool* pool = calloc(1, sizeof(JotBufferPool));
+    if (!pool) {
+        return NULL;
+    }
+    if (pthread_mutex_init(&pool->lock, NULL) != 0) {
+        free(pool);
+        return NULL;
+    }
+    if (pthread_key_create(&pool->magazineKey, JotBufferPoolMagazineDestroy) != 0) {
+        pthread_mutex_destroy(&pool->lock);
+        free(pool);
+        return NULL;
+    }
+    pool->maxCachedBytes = maxCachedBytes;
+    return pool;
+}
+
+void* JotBufferPoolAlloc(JotBufferPool* pool, size_t size, size_t* capacity) {
+    int index = JotBufferPoolClassIndex(size);
+    if (index < 0) {
+        void* buffer = malloc(size);
+        if (buffer) {
+            pthread_mutex_lock(&pool->lock);
+            pool->misses++;
+            pool->outstandingBytes += size;
+            pthread_mutex_unlock(&pool->lock);
+            *capacity = size;
+        }
+        return buffer;
+    }
+    size_t classSize = JotBufferPoolClassSize(index);
+
+    if (index < kJotBufferPoolMagazineClassCount) {
+        JotBufferPoolMagazine* magazine = JotBufferPoolGetMagazine(pool);
+        if (magazine) {
+            void* buffer = NULL;
+            pthread_mutex_lock(&magazine->lock);
+            if (magazine->counts[index]) {
+                buffer = magazine->buffers[index][--magazine->counts[index]];
+                magazine->hits++;
+                magazine->outstandingBytes += classSize;
+            }
+            pthread_mutex_unlock(&magazine->lock);
+            if (buffer) {
+                *capacity = classSize;
+                return buffer;
+            }
+        }
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    JotBufferPoolClass* sizeClass = &pool->classes[index];
+    void* buffer = JotBufferPoolPop(pool, index);
+    if (buffer) {
+        pool->hits++;
+    } else {
+        pool->misses++;
+    }
+    pool->outstandingBytes += classSize;
+    sizeClass->outstandingCount++;
+    if (sizeClass->outstandingCount > sizeClass->highWaterCount) {
+        sizeClass->highWaterCount = sizeClass->outstandingCount;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    if (!buffer) {
+        buffer = malloc(classSize);
+        if (!buffer) {
+            pthread_mutex_lock(&pool->lock);
+            pool->outstandingBytes -= classSize;
+            sizeClass->outstandingCount--;
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+    }
+    *capacity = classSize;
+    return buffer;
+}
+
+void JotBufferPoolRelease(JotBufferPool* pool, void* buffer, size_t capacity) {
+    if (!buffer) {
+        return;
+    }
+    int index = JotBufferPoolClassIndex(capacity);
+    if (index < 0 || JotBufferPoolClassSize(index) != capacity) {
+        // too big to pool
+        pthread_mutex_lock(&pool->lock);
+        pool->outstandingBytes -= capacity;
+        pthread_mutex_unlock(&pool->lock);
+        free(buffer);
+        return;
+    }
+
+    if (index < kJotBufferPoolMagazineClassCount) {
+        JotBufferPoolMagazine* magazine = JotBufferPoolGetMagazine(pool);
+        if (magazine) {
+            bool cached = false;
+            pthread_mutex_lock(&magazine->lock);
+            if (magazine->counts[index] < kJotBufferPoolMagazineSize) {
+                magazine->buffers[index][magazine->counts[index]++] = buffer;
+                magazine->outstandingBytes -= capacity;
+                cached = true;
+            }
+            pthread_mutex_unlock(&magazine->lock);
+            if (cached) {
+                return;
+            }
+        }
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->outstandingBytes -= capacity;
+    bool cached = JotBufferPoolReturn(pool, index, buffer);
+    pthread_mutex_unlock(&pool->lock);
+    if (!cached) {
+        free(buffer);
+    }
+}
+
+void JotBufferPoolTrim(JotBufferPool* pool, size_t maxCachedBytes) {
+    JotBufferPoolFreeBuffer* toFree = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    for (JotBufferPoolMagazine* magazine = pool->magazines; magazine; magazine = magazine->next) {
+        pthread_mutex_lock(&magazine->lock);
+        JotBufferPoolEmptyMagazine(pool, magazine);
+        pthread_mutex_unlock(&magazine->lock);
+    }
+    for (int index = kJotBufferPoolClassCount - 1; index >= 0; index--) {
+        JotBufferPoolClass* sizeClass = &pool->classes[index];
+        while (pool->cachedBytes > maxCachedBytes && sizeClass->freeList) {
+            JotBufferPoolFreeBuffer* buffer = JotBufferPoolPop(pool, index);
+            buffer->next = toFree;
+            toFree = buffer;
+        }
+        sizeClass->highWaterCount = sizeClass->outstandingCount + sizeClass->freeCount;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    // free outside of the lock, since it can take a while
+    JotBufferPoolFreeAll(toFree);
+}
+
+void JotBufferPoolGetStats(JotBufferPool* pool, JotBufferPoolStats* stats) {
+    pthread_mutex_lock(&pool->lock);
+    size_t cachedBytes = pool->cachedBytes;
+    uint64_t hits = pool->hits;
+    int64_t outstandingBytes = pool->outstandingBytes;
+    for (JotBufferPoolMagazine* magazine = pool->magazines; magazine; magazine = magazine->next) {
+        pthread_mutex_lock(&magazine->lock);
+        cachedBytes += JotBufferPoolMagazineBytes(magazine);
+        hits += magazine->hits;
+        outstandingBytes += magazine->outstandingBytes;
+        pthread_mutex_unlock(&magazine->lock);
+    }
+    stats->cachedBytes = cachedBytes;
+    stats->outstandingBytes = outstandingBytes > 0 ? (size_t)outstandingBytes : 0;
+    stats->hits = hits;
+    stats->misses = pool->misses;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void JotBufferPoolFree(JotBufferPool* pool) {
+    if (!pool) {
+        return;
+    }
+    // after this, no thread's magazine is destroyed on its own
+    pthread_key_delete(pool->magazineKey);
+    while (pool->magazines) {
+        JotBufferPoolMagazine* magazine = pool->magazines;
+        pool->magazines = magazine->next;
+        JotBufferPoolEmptyMagazine(pool, magazine);
+        pthread_mutex_destroy(&magazine->lock);
+        free(magazine);
+    }
+    for (int index = 0; index < kJotBufferPoolClassCount; index++) {
+        JotBufferPoolFreeAll(pool->classes[index].freeList);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+}
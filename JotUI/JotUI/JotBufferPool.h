@@ -0,0 +1,82 @@
+//
+//  JotBufferPool.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#ifndef JotBufferPool_h
+#define JotBufferPool_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A pool of reusable byte buffers, such as the bitmaps that images
+ * are resized into.
+ *
+ * Buffers are grouped into size classes, from 4KB to 64MB, with a class
+ * at every power of two and one halfway between. A request is served by
+ * the smallest class it fits in, so a buffer is never more than 50%
+ * bigger than asked for. Larger requests aren't pooled.
+ *
+ * Each class remembers the most buffers it has had in use at once, and
+ * doesn't cache more than that, and the pool never caches more than its
+ * byte cap. Trimming, such as for a memory warning, frees cached buffers
+ * down to a target and lowers each class's high water mark to what's
+ * in use, so the pool grows back only as far as it's needed again.
+ *
+ * The smallest classes are also cached in a small magazine per thread,
+ * so that a thread that allocates and releases them over and over
+ * doesn't contend for the pool's lock.
+ *
+ * Every function is thread safe, but the pool must outlive every
+ * buffer it allocates.
+ */
+typedef struct JotBufferPool JotBufferPool;
+
+typedef struct {
+    // bytes that are cached for reuse, including the threads' magazines
+    size_t cachedBytes;
+    // bytes that have been allocated and not yet released
+    size_t outstandingBytes;
+    // allocations served from the cache, and those that weren't
+    uint64_t hits;
+    uint64_t misses;
+} JotBufferPoolStats;
+
+// maxCachedBytes caps the bytes cached in the pool, but not those in
+// the threads' magazines, which are at most a few hundred KB each
+JotBufferPool* JotBufferPoolCreate(size_t maxCachedBytes);
+
+// the capacity of the buffer that a request for size is served with
+size_t JotBufferPoolCapacityForSize(size_t size);
+
+// returns a buffer of at least size bytes, and sets capacity to its
+// actual size, or returns NULL if it can't be allocated
+void* JotBufferPoolAlloc(JotBufferPool* pool, size_t size, size_t* capacity);
+
+// returns buffer to the pool. capacity must be the capacity that it
+// was allocated with
+void JotBufferPoolRelease(JotBufferPool* pool, void* buffer, size_t capacity);
+
+// frees cached buffers, largest first, until no more than
+// maxCachedBytes are cached. this includes every thread's magazine
+void JotBufferPoolTrim(JotBufferPool* pool, size_t maxCachedBytes);
+
+void JotBufferPoolGetStats(JotBufferPool* pool, JotBufferPoolStats* stats);
+
+// frees the pool and its cached buffers. buffers that are still
+// outstanding must be released with free() instead
+void JotBufferPoolFree(JotBufferPool* pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JotBufferPool_h */
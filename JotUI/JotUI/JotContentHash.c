@@ -0,0 +1,158 @@
+//
+//  JotContentHash.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#include "JotContentHash.h"
+#include <math.h>
+#include <string.h>
+
+#define kJotHashPrime1 0x9E3779B185EBCA87ULL
+#define kJotHashPrime2 0xC2B2AE3D27D4EB4FULL
+#define kJotHashPrime3 0x165667B19E3779F9ULL
+#define kJotHashPrime4 0x85EBCA77C2B2AE63ULL
+#define kJotHashPrime5 0x27D4EB2F165667C5ULL
+
+// the stack hash's base, and its inverse mod 2^64
+#define kJotStackHashBase kJotHashPrime1
+#define kJotStackHashBaseInverse 0x0887493432BADB37ULL
+
+static inline uint64_t JotHashRotate(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// all reads are little endian, which is every platform we run on
+static inline uint64_t JotHashRead64(const uint8_t* bytes) {
+    uint64_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static inline uint32_t JotHashRead32(const uint8_t* bytes) {
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static inline uint64_t JotHashRound(uint64_t accumulator, uint64_t input) {
+    accumulator += input * kJotHashPrime2;
+    accumulator = JotHashRotate(accumulator, 31);
+    return accumulator * kJotHashPrime1;
+}
+
+static inline uint64_t JotHashMergeRound(uint64_t accumulator, uint64_t value) {
+    accumulator ^= JotHashRound(0, value);
+    return accumulator * kJotHashPrime1 + kJotHashPrime4;
+}
+
+uint64_t JotContentHash(const void* bytes, size_t length, uint64_t seed) {
+    const uint8_t* next = bytes;
+    const uint8_t* end = next + length;
+    uint64_t hash;
+
+    if (length >= 32) {
+        uint64_t v1 = seed + kJotHashPrime1 + kJotHashPrime2;
+        uint64_t v2 = seed + kJotHashPrime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kJotHashPrime1;
+        const uint8_t* limit = end - 32;
+        do {
+            v1 = JotHashRound(v1, JotHashRead64(next));
+            v2 = JotHashRound(v2, JotHashRead64(next + 8));
+            v3 = JotHashRound(v3, JotHashRead64(next + 16));
+            v4 = JotHashRound(v4, JotHashRead64(next + 24));
+            next += 32;
+        } while (next <= limit);
+
+        hash = JotHashRotate(v1, 1) + JotHashRotate(v2, 7) + JotHashRotate(v3, 12) + JotHashRotate(v4, 18);
+        hash = JotHashMergeRound(hash, v1);
+        hash = JotHashMergeRound(hash, v2);
+        hash = JotHashMergeRound(hash, v3);
+        hash = JotHashMergeRound(hash, v4);
+    } else {
+        hash = seed + kJotHashPrime5;
+    }
+    hash += (uint64_t)length;
+
+    while (end - next >= 8) {
+        hash ^= JotHashRound(0, JotHashRead64(next));
+        hash = JotHashRotate(hash, 27) * kJotHashPrime1 + kJotHashPrime4;
+        next += 8;
+    }
+    if (end - next >= 4) {
+        hash ^= (uint64_t)JotHashRead32(next) * kJotHashPrime1;
+        hash = JotHashRotate(hash, 23) * kJotHashPrime2 + kJotHashPrime3;
+        next += 4;
+    }
+    while (next < end) {
+        hash ^= (*next) * kJotHashPrime5;
+        hash = JotHashRotate(hash, 11) * kJotHashPrime1;
+        next++;
+    }
+
+    hash ^= hash >> 33;
+    hash *= kJotHashPrime2;
+    hash ^= hash >> 29;
+    hash *= kJotHashPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t JotContentHashOfDoubles(const double* values, size_t count) {
+    // segments hash a handful of values, so this is almost always on the stack
+    double canonical[16];
+    uint64_t hash = 0;
+    size_t done = 0;
+    while (done < count) {
+        size_t batch = count - done < 16 ? count - done : 16;
+        for (size_t i = 0; i < batch; i++) {
+            double value = values[done + i];
+            canonical[i] = isnan(value) ? NAN : value == 0 ? 0.0 : value;
+        }
+        hash = JotContentHash(canonical, batch * sizeof(double), hash);
+        done += batch;
+    }
+    return hash;
+}
+
+uint64_t JotContentHashCombine(uint64_t hash, uint64_t value) {
+    uint64_t pair[2] = { hash, value };
+    return JotContentHash(pair, sizeof(pair), 0);
+}
+
+#pragma mark - Stack Hash
+
+void JotStackHashInit(JotStackHash* stackHash) {
+    stackHash->hash = 0;
+    stackHash->power = 1;
+    stackHash->count = 0;
+}
+
+void JotStackHashPush(JotStackHash* stackHash, uint64_t value) {
+    stackHash->hash = stackHash->hash * kJotStackHashBase + value;
+    stackHash->power *= kJotStackHashBase;
+    stackHash->count++;
+}
+
+void JotStackHashPop(JotStackHash* stackHash, uint64_t value) {
+    stackHash->hash = (stackHash->hash - value) * kJotStackHashBaseInverse;
+    stackHash->power *= kJotStackHashBaseInverse;
+    stackHash->count--;
+}
+
+void JotStackHashRemoveBottom(JotStackHash* stackHash, uint64_t value) {
+    // the bottom value is multiplied by B^(count - 1)
+    stackHash->power *= kJotStackHashBaseInverse;
+    stackHash->hash -= value * stackHash->power;
+    stackHash->count--;
+}
+
+void JotStackHashInsertBottom(JotStackHash* stackHash, uint64_t value) {
+    // the new bottom value is multiplied by B^count
+    stackHash->hash += value * stackHash->power;
+    stackHash->power *= kJotStackHashBase;
+    stackHash->count++;
+}
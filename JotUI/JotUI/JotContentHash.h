@@ -0,0 +1,66 @@
+//
+//  JotContentHash.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#ifndef JotContentHash_h
+#define JotContentHash_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 64 bit content hashes for segments, strokes and undo stacks.
+ *
+ * A stroke's hash is also its uuid, which names its record in the page
+ * journal, so two different strokes must never share one. The hashes
+ * here are xxHash (XXH64) over the exact bits of the values, instead of
+ * the values truncated to integers.
+ */
+
+// XXH64 of the bytes
+uint64_t JotContentHash(const void* bytes, size_t length, uint64_t seed);
+
+// the hash of the values' bits, with -0 hashed as 0 and every NaN as
+// the same NaN, so that equal values always hash the same
+uint64_t JotContentHashOfDoubles(const double* values, size_t count);
+
+// folds value into hash. the order matters, so this builds a stroke's
+// hash from the hashes of its segments as they're added
+uint64_t JotContentHashCombine(uint64_t hash, uint64_t value);
+
+/**
+ * the hash of a stack of hashes, kept up to date in O(1) as hashes are
+ * pushed and popped from the top or removed from the bottom.
+ *
+ * it's the polynomial sum of value[i] * B^(count - 1 - i) mod 2^64. B is
+ * odd, so it has an inverse mod 2^64 and pops can undo a push exactly.
+ * a value must be removed with the same value it was pushed with.
+ * values can also be inserted under the bottom, which hashes the same as
+ * if they'd been pushed first
+ */
+typedef struct {
+    uint64_t hash;
+    // B^count
+    uint64_t power;
+    uint64_t count;
+} JotStackHash;
+
+void JotStackHashInit(JotStackHash* stackHash);
+void JotStackHashPush(JotStackHash* stackHash, uint64_t value);
+void JotStackHashPop(JotStackHash* stackHash, uint64_t value);
+void JotStackHashRemoveBottom(JotStackHash* stackHash, uint64_t value);
+void JotStackHashInsertBottom(JotStackHash* stackHash, uint64_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JotContentHash_h */
@@ -0,0 +1,53 @@
+//
+//  JotDirtyTileTracker.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+@class JotInkTileSet;
+
+/**
+ * Tracks which tiles of a backing texture have been drawn to since
+ * the texture last matched the ink saved on disk, so that a save can
+ * read back only those tiles and apply them to the saved tiles, which
+ * the tracker keeps. Tiles are the same grid as JotInkTileSet, and
+ * rects are in texture pixels.
+ *
+ * A tracker starts out with everything dirty, since it doesn't know
+ * what's on disk. It's safe to use from any thread.
+ */
+@interface JotDirtyTileTracker : NSObject
+
+@property(nonatomic, readonly) CGSize pixelSize;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithPixelSize:(CGSize)pixelSize;
+
+- (void)markDirtyInRect:(CGRect)pixelRect;
+
+- (void)markAllDirty;
+
+// the texture was just loaded from tiles, which is the ink saved at path
+- (void)markCleanForPath:(NSString*)path withTiles:(JotInkTileSet*)tiles;
+
+/**
+ * call this when the texture's contents are captured for a save to path.
+ * returns the tiles that have changed since the ink in savedTiles, or nil
+ * if the whole texture needs to be read back. empty data means nothing has
+ * changed, and that savedTiles is already on disk at path. either way,
+ * tracking starts over from this moment.
+ *
+ * the save must be finished with finishSaveToPath:withTiles:generation:
+ */
+- (NSData*)beginSaveToPath:(NSString*)path savedTiles:(JotInkTileSet**)savedTiles generation:(NSUInteger*)generation;
+
+// tiles is the ink that was saved to path, or nil if the save failed
+- (void)finishSaveToPath:(NSString*)path withTiles:(JotInkTileSet*)tiles generation:(NSUInteger)generation;
+
+@end
@@ -0,0 +1,116 @@
+//
+//  JotDirtyTileTracker.m
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import "JotDirtyTileTracker.h"
+#import "JotInkTiles.h"
+#import "JotInkTileSet.h"
+
+
+@implementation JotDirtyTileTracker {
+    JotInkTileGrid grid;
+    NSMutableData* dirtyTiles;
+    BOOL isAllDirty;
+    // the ink saved at savedPath, which matches the texture minus dirtyTiles.
+    // it's nil while a save is in flight, and after a save fails
+    NSString* savedPath;
+    JotInkTileSet* savedTiles;
+    NSUInteger generation;
+}
+
+@synthesize pixelSize;
+
+- (instancetype)initWithPixelSize:(CGSize)_pixelSize {
+    if (self = [super init]) {
+        pixelSize = _pixelSize;
+        grid = JotInkTileGridMake(pixelSize.width, pixelSize.height, kJotInkTileSize);
+        dirtyTiles = [NSMutableData dataWithLength:JotInkTileGridBitmapLength(&grid)];
+        isAllDirty = YES;
+    }
+    return self;
+}
+
+- (void)markDirtyInRect:(CGRect)pixelRect {
+    CGRect clipped = CGRectIntersection(CGRectIntegral(pixelRect), CGRectMake(0, 0, grid.width, grid.height));
+    if (CGRectIsEmpty(clipped)) {
+        return;
+    }
+    size_t firstColumn = CGRectGetMinX(clipped) / grid.tileSize;
+    size_t lastColumn = (CGRectGetMaxX(clipped) - 1) / grid.tileSize;
+    size_t firstRow = CGRectGetMinY(clipped) / grid.tileSize;
+    size_t lastRow = (CGRectGetMaxY(clipped) - 1) / grid.tileSize;
+    @synchronized(self) {
+        uint8_t* bitmap = [dirtyTiles mutableBytes];
+        for (size_t row = firstRow; row <= lastRow; row++) {
+            for (size_t column = firstColumn; column <= lastColumn; column++) {
+                JotInkTileBitmapSet(bitmap, row * grid.columns + column);
+            }
+        }
+    }
+}
+
+- (void)markAllDirty {
+    @synchronized(self) {
+        isAllDirty = YES;
+    }
+}
+
+- (void)markCleanForPath:(NSString*)path withTiles:(JotInkTileSet*)tiles {
+    @synchronized(self) {
+        memset([dirtyTiles mutableBytes], 0, [dirtyTiles length]);
+        isAllDirty = NO;
+        savedPath = path;
+        savedTiles = CGSizeEqualToSize(tiles.pixelSize, pixelSize) ? tiles : nil;
+        // any save that's still in flight is now moot
+        generation++;
+    }
+}
+
+#pragma mark - Saving
+
+- (NSData*)beginSaveToPath:(NSString*)path savedTiles:(JotInkTileSet**)outSavedTiles generation:(NSUInteger*)outGeneration {
+    @synchronized(self) {
+        generation++;
+        *outGeneration = generation;
+
+        NSData* changedTiles = nil;
+        *outSavedTiles = nil;
+        if (!isAllDirty && savedTiles && path && [savedPath isEqualToString:path]) {
+            size_t dirtyCount = 0;
+            const uint8_t* bitmap = [dirtyTiles bytes];
+            for (size_t i = 0; i < grid.columns * grid.rows && !dirtyCount; i++) {
+                dirtyCount += JotInkTileBitmapIsSet(bitmap, i);
+            }
+            changedTiles = dirtyCount ? [dirtyTiles copy] : [NSData data];
+            *outSavedTiles = savedTiles;
+        }
+        memset([dirtyTiles mutableBytes], 0, [dirtyTiles length]);
+        isAllDirty = NO;
+        // nothing is known to be on disk until this save finishes
+        savedPath = nil;
+        savedTiles = nil;
+        return changedTiles;
+    }
+}
+
+- (void)finishSaveToPath:(NSString*)path withTiles:(JotInkTileSet*)tiles generation:(NSUInteger)saveGeneration {
+    @synchronized(self) {
+        if (saveGeneration != generation) {
+            // a newer save has started, and it'll
+            // be the one to decide what's on disk
+            return;
+        }
+        if (tiles && CGSizeEqualToSize(tiles.pixelSize, pixelSize)) {
+            savedPath = path;
+            savedTiles = tiles;
+        } else {
+            isAllDirty = YES;
+        }
+    }
+}
+
+@end
@@ -8,20 +8,56 @@
 
 #import <Foundation/Foundation.h>
 #import <UIKit/UIKit.h>
+#import "JotImageEncoder.h"
+#import "JotInkTileSet.h"
 
 
 @interface JotDiskAssetManager : NSObject
 
+// encodes images for writeImage:toPath:. defaults to
+// [JotPNGEncoder fastEncoder], and [JotPNGEncoder compactEncoder]
+// trades save time for smaller files
+@property(atomic, strong) NSObject<JotImageEncoder>* imageEncoder;
+
 - (instancetype)init NS_UNAVAILABLE;
 
 + (JotDiskAssetManager*)sharedManager;
 
 + (UIImage*)imageWithContentsOfFile:(NSString*)path;
 
+// returns the saved ink tiles for the image at path, ready to
+// upload to OpenGL, or nil if there aren't any. this will also return
+// nil if the image is still being written, in which case
+// imageWithContentsOfFile: will return the in-memory image
++ (JotInkTileSet*)inkTilesForImageAtPath:(NSString*)path withPixelSize:(CGSize)pixelSize;
+
 - (void)writeImage:(UIImage*)image toPath:(NSString*)path;
 
+// if withTextureSidecar is YES, then the image's pixels are also
+// saved for inkTilesForImageAtPath:withPixelSize:. this is
+// only useful for images that will be loaded into a texture
+- (void)writeImage:(UIImage*)image toPath:(NSString*)path withTextureSidecar:(BOOL)withTextureSidecar;
+
+// the completion block is called on a background thread, with NO if the
+// write failed or was replaced by a newer write to the same path
+- (void)writeImage:(UIImage*)image toPath:(NSString*)path withTextureSidecar:(BOOL)withTextureSidecar onComplete:(void (^)(BOOL success))completionBlock;
+
+// writes each image to its path, or removes the file at paths that have
+// an NSNull, as one group commit. the images are all renamed into place
+// together after they're written, with one sync of their directory.
+// sidecarPaths are the paths that also get a texture sidecar.
+//
+// writes are coalesced: a pending write that this replaces entirely is
+// cancelled. this never blocks: if too many writes are already queued,
+// this write waits in line until one of them finishes
+- (void)writeImages:(NSDictionary<NSString*, id>*)imagesByPath withTextureSidecarPaths:(NSSet<NSString*>*)sidecarPaths onComplete:(void (^)(BOOL success))completionBlock;
+
+- (BOOL)hasPendingWritesForPath:(NSString*)path;
+
+// waits only for the writes to path that are pending when called
 - (void)blockUntilCompletedForPath:(NSString*)path;
 
+// waits only for the pending writes to paths that start with dirPath
 - (void)blockUntilCompletedForDirectory:(NSString*)dirPath;
 
 - (void)blockUntilAllWritesHaveFinished;
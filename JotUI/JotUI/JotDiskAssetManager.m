@@ -8,11 +8,34 @@
 
 #import "JotDiskAssetManager.h"
 #import "JotImageWriteOperation.h"
+#import "JotPNGEncoder.h"
+#import "JotInkTextureSidecar.h"
+#import "JotFileBatch.h"
+
+// the number of writes that encode and sync at the same time. each
+// one holds a full page of pixels, and the disk gains nothing from more
+#define kJotDiskAssetMaxConcurrentWrites 2
+// at most this many writes are in the operation queue. newer writes
+// wait in line for a slot without blocking their caller, where a newer
+// write to the same paths can still cancel them before they encode
+#define kJotDiskAssetMaxQueuedWrites 8
 
 
 @implementation JotDiskAssetManager {
+    // path -> the newest write to that path. each write depends on
+    // the one it replaced, so it finishes after it
     NSMutableDictionary* inProcessDiskWrites;
+    // the paths in inProcessDiskWrites in literal order, so that
+    // every path with a given prefix is in one contiguous range
+    NSMutableArray* inProcessDiskWritePaths;
     NSOperationQueue* opQueue;
+    // writes that are waiting for a slot in opQueue, oldest first
+    NSMutableArray* waitingWrites;
+    NSUInteger queuedWriteCount;
+    // temp files in these directories from before the manager
+    // started have been cleaned up, or are being cleaned up
+    NSMutableSet* sweptDirectories;
+    time_t startTime;
 }
 
 #pragma mark - Queues
@@ -36,12 +59,22 @@ static const void* const kDiskAssetQueueIdentifier = &kDiskAssetQueueIdentifier;
     return [[JotDiskAssetManager sharedManager] imageWithContentsOfFileHelper:path];
 }
 
++ (JotInkTileSet*)inkTilesForImageAtPath:(NSString*)path withPixelSize:(CGSize)pixelSize {
+    return [[JotDiskAssetManager sharedManager] inkTilesForImageAtPathHelper:path withPixelSize:pixelSize];
+}
+
 #pragma mark - Singleton
 
 - (id)init {
     if (self = [super init]) {
         inProcessDiskWrites = [NSMutableDictionary dictionary];
+        inProcessDiskWritePaths = [NSMutableArray array];
         opQueue = [[NSOperationQueue alloc] init];
+        opQueue.maxConcurrentOperationCount = kJotDiskAssetMaxConcurrentWrites;
+        waitingWrites = [NSMutableArray array];
+        sweptDirectories = [NSMutableSet set];
+        startTime = time(NULL);
+        self.imageEncoder = [JotPNGEncoder fastEncoder];
     }
     return self;
 }
@@ -57,52 +90,146 @@ static const void* const kDiskAssetQueueIdentifier = &kDiskAssetQueueIdentifier;
 
 
 - (void)writeImage:(UIImage*)image toPath:(NSString*)path {
+    [self writeImage:image toPath:path withTextureSidecar:NO onComplete:nil];
+}
+
+- (void)writeImage:(UIImage*)image toPath:(NSString*)path withTextureSidecar:(BOOL)withTextureSidecar {
+    [self writeImage:image toPath:path withTextureSidecar:withTextureSidecar onComplete:nil];
+}
+
+- (void)writeImage:(UIImage*)image toPath:(NSString*)path withTextureSidecar:(BOOL)withTextureSidecar onComplete:(void (^)(BOOL success))completionBlock {
+    if (!path) {
+        return;
+    }
+    [self writeImages:@{ path: image ?: [NSNull null] }
+        withTextureSidecarPaths:withTextureSidecar ? [NSSet setWithObject:path] : nil
+                     onComplete:completionBlock];
+}
+
+- (void)writeImages:(NSDictionary<NSString*, id>*)imagesByPath withTextureSidecarPaths:(NSSet<NSString*>*)sidecarPaths onComplete:(void (^)(BOOL success))completionBlock {
     JotImageWriteOperation* operation = nil;
     @synchronized(inProcessDiskWrites) {
-        operation = [[JotImageWriteOperation alloc] initWithImage:image
-                                                          andPath:path
-                                                   andNotifyBlock:^(JotImageWriteOperation* operation) {
-                                                       [self operationHasCompleted:operation];
-                                                   }];
-
-        JotImageWriteOperation* currOp = [self cancelAnyOperationFor:path];
-        if (currOp) {
-            [operation addDependency:currOp];
+        operation = [[JotImageWriteOperation alloc] initWithImages:imagesByPath
+                                                        andEncoder:self.imageEncoder
+                                                    andNotifyBlock:^(JotImageWriteOperation* operation) {
+                                                        [self operationHasCompleted:operation];
+                                                        if (completionBlock) {
+                                                            completionBlock(operation.didSucceed);
+                                                        }
+                                                    }];
+        operation.textureSidecarPaths = sidecarPaths;
+
+        // coalesce with the pending writes to the same paths. each one has to
+        // finish first, and any that this write replaces entirely is cancelled
+        NSSet* paths = [NSSet setWithArray:operation.paths];
+        for (NSString* path in paths) {
+            JotImageWriteOperation* currOp = [inProcessDiskWrites objectForKey:path];
+            if (currOp && ![operation.dependencies containsObject:currOp]) {
+                [operation addDependency:currOp];
+                if ([[NSSet setWithArray:currOp.paths] isSubsetOfSet:paths]) {
+                    [currOp cancel];
+                }
+            }
+            [self setInProcessWrite:operation forPath:path];
+            [self sweepDirectoryIfNeeded:[path stringByDeletingLastPathComponent]];
         }
-        [inProcessDiskWrites setObject:operation forKey:path];
+
+        [waitingWrites addObject:operation];
+        [self enqueueWaitingWrites];
+    }
+}
+
+// must be called while synchronized on inProcessDiskWrites
+- (void)enqueueWaitingWrites {
+    // writes only depend on older writes, and the oldest go first, so
+    // a queued write never waits on one that doesn't have a slot
+    while ([waitingWrites count]) {
+        JotImageWriteOperation* operation = [waitingWrites firstObject];
+        if (![operation isCancelled]) {
+            if (queuedWriteCount >= kJotDiskAssetMaxQueuedWrites) {
+                break;
+            }
+            queuedWriteCount++;
+            operation.completionBlock = ^{
+                [self queuedWriteHasFinished];
+            };
+        }
+        // a cancelled write finishes without encoding, so it doesn't need a slot
+        [waitingWrites removeObjectAtIndex:0];
+        [opQueue addOperation:operation];
+    }
+}
+
+- (void)queuedWriteHasFinished {
+    @synchronized(inProcessDiskWrites) {
+        queuedWriteCount--;
+        [self enqueueWaitingWrites];
+    }
+}
+
+// must be called while synchronized on inProcessDiskWrites
+- (void)sweepDirectoryIfNeeded:(NSString*)dirPath {
+    if ([dirPath length] && ![sweptDirectories containsObject:dirPath]) {
+        [sweptDirectories addObject:dirPath];
+        // the temp files that a crash left behind are older than the manager,
+        // and any that are newer belong to writes that are in flight
+        time_t olderThan = startTime;
+        dispatch_async([JotDiskAssetManager diskAssetQueue], ^{
+            size_t removed = JotFileBatchRemoveStaleFiles([dirPath fileSystemRepresentation], olderThan);
+            if (removed) {
+                DebugLog(@"removed %zu stale temp files in %@", removed, dirPath);
+            }
+        });
+    }
+}
+
+- (BOOL)hasPendingWritesForPath:(NSString*)path {
+    @synchronized(inProcessDiskWrites) {
+        return path && [inProcessDiskWrites objectForKey:path] != nil;
     }
-    [opQueue addOperation:operation];
 }
 
 - (void)blockUntilCompletedForPath:(NSString*)path {
     if (path) {
-        BOOL needsBlock = NO;
+        JotImageWriteOperation* operation = nil;
         @synchronized(inProcessDiskWrites) {
-            needsBlock = [inProcessDiskWrites objectForKey:path] != nil;
-        }
-        if (needsBlock && opQueue.operationCount) {
-            // blocking thread until we're done working
-            [opQueue waitUntilAllOperationsAreFinished];
+            operation = [inProcessDiskWrites objectForKey:path];
         }
+        // blocking thread until this path is done. the newest write
+        // depends on any it replaced, so this waits for all of them
+        // but none of the writes to other paths
+        [operation waitUntilFinished];
     }
 }
 
 - (void)blockUntilCompletedForDirectory:(NSString*)dirPath {
-    BOOL needsBlock = NO;
     if (dirPath) {
+        NSMutableArray* operations = [NSMutableArray array];
         @synchronized(inProcessDiskWrites) {
-            needsBlock = [[[inProcessDiskWrites allKeys] filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(id evaluatedObject, NSDictionary* bindings) {
-                return [evaluatedObject hasPrefix:dirPath];
-            }]] count] > 0;
+            NSUInteger index = [self indexOfInProcessPath:dirPath];
+            for (; index < [inProcessDiskWritePaths count]; index++) {
+                NSString* path = [inProcessDiskWritePaths objectAtIndex:index];
+                if (![path hasPrefix:dirPath]) {
+                    break;
+                }
+                [operations addObject:[inProcessDiskWrites objectForKey:path]];
+            }
         }
-        if (needsBlock && opQueue.operationCount) {
-            // blocking thread until we're done working
-            [opQueue waitUntilAllOperationsAreFinished];
+        // blocking thread until we're done working
+        for (JotImageWriteOperation* operation in operations) {
+            [operation waitUntilFinished];
         }
     }
 }
 
 - (void)blockUntilAllWritesHaveFinished {
+    NSArray* operations = nil;
+    @synchronized(inProcessDiskWrites) {
+        operations = [waitingWrites copy];
+    }
+    // a waiting write is added to the queue when an older one finishes,
+    // so the newest waiting write is the last to be added
+    [[operations lastObject] waitUntilFinished];
     [opQueue waitUntilAllOperationsAreFinished];
 }
 
@@ -110,23 +237,40 @@ static const void* const kDiskAssetQueueIdentifier = &kDiskAssetQueueIdentifier;
 
 - (void)operationHasCompleted:(JotImageWriteOperation*)operation {
     @synchronized(inProcessDiskWrites) {
-        JotImageWriteOperation* currOpForPath = [inProcessDiskWrites objectForKey:operation.path];
-        if (currOpForPath == operation) {
-            [inProcessDiskWrites removeObjectForKey:operation.path];
+        for (NSString* path in operation.paths) {
+            JotImageWriteOperation* currOpForPath = [inProcessDiskWrites objectForKey:path];
+            if (currOpForPath == operation) {
+                [self setInProcessWrite:nil forPath:path];
+            }
         }
     }
 }
 
-- (JotImageWriteOperation*)cancelAnyOperationFor:(NSString*)path {
-    JotImageWriteOperation* currentOperation = nil;
-    @synchronized(inProcessDiskWrites) {
-        if(path){
-            currentOperation = [inProcessDiskWrites objectForKey:path];
-            [inProcessDiskWrites removeObjectForKey:path];
+#pragma mark - In Process Writes
+
+// the index of path in inProcessDiskWritePaths, or where it would be.
+// literal order sorts a prefix just before every path that starts with it
+- (NSUInteger)indexOfInProcessPath:(NSString*)path {
+    return [inProcessDiskWritePaths indexOfObject:path
+                                    inSortedRange:NSMakeRange(0, [inProcessDiskWritePaths count])
+                                          options:NSBinarySearchingFirstEqual | NSBinarySearchingInsertionIndex
+                                  usingComparator:^NSComparisonResult(NSString* path1, NSString* path2) {
+                                      return [path1 compare:path2 options:NSLiteralSearch];
+                                  }];
+}
+
+// must be called while synchronized on inProcessDiskWrites
+- (void)setInProcessWrite:(JotImageWriteOperation*)operation forPath:(NSString*)path {
+    BOOL wasInProcess = [inProcessDiskWrites objectForKey:path] != nil;
+    if (operation) {
+        [inProcessDiskWrites setObject:operation forKey:path];
+        if (!wasInProcess) {
+            [inProcessDiskWritePaths insertObject:path atIndex:[self indexOfInProcessPath:path]];
         }
+    } else if (wasInProcess) {
+        [inProcessDiskWrites removeObjectForKey:path];
+        [inProcessDiskWritePaths removeObjectAtIndex:[self indexOfInProcessPath:path]];
     }
-    [currentOperation cancel];
-    return currentOperation;
 }
 
 #pragma mark - Helper
@@ -135,11 +279,21 @@ static const void* const kDiskAssetQueueIdentifier = &kDiskAssetQueueIdentifier;
     @synchronized(inProcessDiskWrites) {
         JotImageWriteOperation* operation = [inProcessDiskWrites objectForKey:path];
         if (operation) {
-            return operation.image;
+            return [operation imageForPath:path];
         }
     }
     return [UIImage imageWithContentsOfFile:path];
 }
 
+- (JotInkTileSet*)inkTilesForImageAtPathHelper:(NSString*)path withPixelSize:(CGSize)pixelSize {
+    @synchronized(inProcessDiskWrites) {
+        if ([inProcessDiskWrites objectForKey:path]) {
+            // the sidecar on disk is about to be replaced
+            return nil;
+        }
+    }
+    return [JotInkTextureSidecar tilesForImagePath:path withPixelSize:pixelSize];
+}
+
 
 @end
@@ -0,0 +1,220 @@
+//
+//  JotFileBatch.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#include "JotFileBatch.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define kJotFileBatchTempSuffix ".jottmp.XXXXXX"
+
+typedef struct {
+    char* path;
+    // NULL if the file is removed at commit
+    char* tempPath;
+} JotFileBatchEntry;
+
+struct JotFileBatch {
+    JotFileBatchEntry* entries;
+    size_t count;
+    size_t capacity;
+    size_t directorySyncCount;
+};
+
+static bool JotFileBatchWriteAll(int fd, const void* bytes, size_t length) {
+    const unsigned char* next = bytes;
+    while (length) {
+        ssize_t written = write(fd, next, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        next += written;
+        length -= (size_t)written;
+    }
+    return true;
+}
+
+// the directory of path, which the caller frees
+static char* JotFileBatchCopyDirectory(const char* path) {
+    const char* slash = strrchr(path, '/');
+    if (!slash) {
+        return strdup(".");
+    }
+    if (slash == path) {
+        return strdup("/");
+    }
+    return strndup(path, (size_t)(slash - path));
+}
+
+static bool JotFileBatchAppend(JotFileBatch* batch, char* path, char* tempPath) {
+    if (batch->count == batch->capacity) {
+        size_t capacity = batch->capacity ? batch->capacity * 2 : 4;
+        JotFileBatchEntry* entries = realloc(batch->entries, capacity * sizeof(JotFileBatchEntry));
+        if (!entries) {
+            return false;
+        }
+        batch->entries = entries;
+        batch->capacity = capacity;
+    }
+    batch->entries[batch->count].path = path;
+    batch->entries[batch->count].tempPath = tempPath;
+    batch->count++;
+    return true;
+}
+
+JotFileBatch* JotFileBatchCreate(void) {
+    return calloc(1, sizeof(JotFileBatch));
+}
+
+const char* JotFileBatchAdd(JotFileBatch* batch, const char* path, const void* bytes, size_t length) {
+    size_t pathLength = strlen(path);
+    char* tempPath = malloc(pathLength + sizeof(kJotFileBatchTempSuffix));
+    char* pathCopy = strdup(path);
+    if (!tempPath || !pathCopy) {
+        free(tempPath);
+        free(pathCopy);
+        return NULL;
+    }
+    memcpy(tempPath, path, pathLength);
+    memcpy(tempPath + pathLength, kJotFileBatchTempSuffix, sizeof(kJotFileBatchTempSuffix));
+
+    int fd = mkstemp(tempPath);
+    if (fd < 0) {
+        free(tempPath);
+        free(pathCopy);
+        return NULL;
+    }
+    // mkstemp makes the file private, but atomic writes used to leave it readable
+    bool success = fchmod(fd, 0644) == 0 && JotFileBatchWriteAll(fd, bytes, length) && fsync(fd) == 0;
+    success = close(fd) == 0 && success;
+    if (!success || !JotFileBatchAppend(batch, pathCopy, tempPath)) {
+        unlink(tempPath);
+        free(tempPath);
+        free(pathCopy);
+        return NULL;
+    }
+    return tempPath;
+}
+
+bool JotFileBatchRemove(JotFileBatch* batch, const char* path) {
+    char* pathCopy = strdup(path);
+    if (!pathCopy || !JotFileBatchAppend(batch, pathCopy, NULL)) {
+        free(pathCopy);
+        return false;
+    }
+    return true;
+}
+
+bool JotFileBatchCommit(JotFileBatch* batch) {
+    bool success = true;
+    char** directories = calloc(batch->count ? batch->count : 1, sizeof(char*));
+    size_t directoryCount = 0;
+    if (!directories) {
+        return false;
+    }
+
+    for (size_t i = 0; i < batch->count; i++) {
+        JotFileBatchEntry* entry = &batch->entries[i];
+        if (entry->tempPath) {
+            if (rename(entry->tempPath, entry->path) == 0) {
+                free(entry->tempPath);
+                entry->tempPath = NULL;
+            } else {
+                success = false;
+                continue;
+            }
+        } else if (unlink(entry->path) != 0 && errno != ENOENT) {
+            success = false;
+            continue;
+        }
+
+        // a page's files are almost always in one directory
+        char* directory = JotFileBatchCopyDirectory(entry->path);
+        bool isNew = directory != NULL;
+        for (size_t d = 0; isNew && d < directoryCount; d++) {
+            isNew = strcmp(directories[d], directory) != 0;
+        }
+        if (isNew) {
+            directories[directoryCount++] = directory;
+        } else {
+            free(directory);
+        }
+    }
+
+    // one sync per directory makes all of the renames durable
+    batch->directorySyncCount = 0;
+    for (size_t d = 0; d < directoryCount; d++) {
+        int fd = open(directories[d], O_RDONLY);
+        if (fd < 0 || fsync(fd) != 0) {
+            success = false;
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        batch->directorySyncCount++;
+        free(directories[d]);
+    }
+    free(directories);
+    return success;
+}
+
+size_t JotFileBatchDirectorySyncCount(const JotFileBatch* batch) {
+    return batch->directorySyncCount;
+}
+
+void JotFileBatchFree(JotFileBatch* batch) {
+    if (!batch) {
+        return;
+    }
+    for (size_t i = 0; i < batch->count; i++) {
+        if (batch->entries[i].tempPath) {
+            // never committed, or its rename failed
+            unlink(batch->entries[i].tempPath);
+            free(batch->entries[i].tempPath);
+        }
+        free(batch->entries[i].path);
+    }
+    free(batch->entries);
+    free(batch);
+}
+
+// whether name ends with a temp suffix that mkstemp filled in
+static bool JotFileBatchIsTempName(const char* name) {
+    size_t length = strlen(name);
+    size_t suffixLength = sizeof(kJotFileBatchTempSuffix) - 1;
+    size_t prefixLength = suffixLength - strlen("XXXXXX");
+    return length > suffixLength && !memcmp(name + length - suffixLength, kJotFileBatchTempSuffix, prefixLength);
+}
+
+size_t JotFileBatchRemoveStaleFiles(const char* directory, time_t olderThan) {
+    DIR* dir = opendir(directory);
+    if (!dir) {
+        return 0;
+    }
+    size_t removed = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir))) {
+        struct stat info;
+        if (JotFileBatchIsTempName(entry->d_name) &&
+            fstatat(dirfd(dir), entry->d_name, &info, AT_SYMLINK_NOFOLLOW) == 0 &&
+            S_ISREG(info.st_mode) && info.st_mtime < olderThan &&
+            unlinkat(dirfd(dir), entry->d_name, 0) == 0) {
+            removed++;
+        }
+    }
+    closedir(dir);
+    return removed;
+}
@@ -0,0 +1,66 @@
+//
+//  JotFileBatch.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#ifndef JotFileBatch_h
+#define JotFileBatch_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Writes a group of files, such as the ink, sidecar and thumbnail of
+ * one page save, as a single group commit.
+ *
+ * Writing a file atomically on its own costs a temp file, an fsync,
+ * a rename and an fsync of its directory. A batch writes and fsyncs
+ * each file's temp file as it's added, and then commit renames all of
+ * them into place and fsyncs each directory once. So saving a page
+ * costs one directory sync instead of one per file.
+ *
+ * Until commit, nothing at the final paths changes, and freeing a batch
+ * that wasn't committed removes its temp files.
+ */
+typedef struct JotFileBatch JotFileBatch;
+
+JotFileBatch* JotFileBatchCreate(void);
+
+// writes and fsyncs bytes to a temp file next to path. returns the temp
+// file's path, which is valid until the batch is freed, or NULL if the
+// file couldn't be written. the temp file is renamed to path at commit,
+// which keeps its size and modification date
+const char* JotFileBatchAdd(JotFileBatch* batch, const char* path, const void* bytes, size_t length);
+
+// removes the file at path, if there is one, at commit
+bool JotFileBatchRemove(JotFileBatch* batch, const char* path);
+
+// renames every added file into place, removes the removed files,
+// and then fsyncs each of their directories once. returns false if
+// any of them failed
+bool JotFileBatchCommit(JotFileBatch* batch);
+
+// the number of directory fsyncs that the last commit made
+size_t JotFileBatchDirectorySyncCount(const JotFileBatch* batch);
+
+void JotFileBatchFree(JotFileBatch* batch);
+
+// a batch that's interrupted by a crash leaves its temp files behind.
+// this removes the temp files in directory that were last modified
+// before olderThan, and returns how many it removed. temp files from
+// batches that started since then are left alone
+size_t JotFileBatchRemoveStaleFiles(const char* directory, time_t olderThan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JotFileBatch_h */
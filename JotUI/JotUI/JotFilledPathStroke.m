@@ -10,6 +10,8 @@
 #import "FilledPathElement.h"
 #import "AbstractBezierPathElement.h"
 #import "AbstractBezierPathElement-Protected.h"
+#import "JotStrokeFile.h"
+#import "JotContentHash.h"
 
 
 @implementation JotFilledPathStroke {
@@ -65,34 +67,56 @@
 
 - (id)initFromDictionary:(NSDictionary*)dictionary {
     if (self = [super init]) {
-        hashCache = 1;
-        segments = [NSMutableArray arrayWithArray:[[dictionary objectForKey:@"segments"] jotMap:^id(id obj, NSUInteger index) {
-            NSString* className = [obj objectForKey:@"class"];
-            Class class = NSClassFromString(className);
-            // pass in target scale
-            [obj setObject:[dictionary objectForKey:@"scale"] forKey:@"scale"];
-            AbstractBezierPathElement* segment = [[class alloc] initFromDictionary:obj];
-            [self updateHashWithObject:segment];
-            return segment;
-        }]];
+        JotStrokeSegmentColumns* segmentColumns = [dictionary objectForKey:kJotStrokeSegmentColumnsKey];
+        if (!segmentColumns && [dictionary objectForKey:kJotStrokeSegmentDataKey]) {
+            // filled paths are a single segment, so there's no point loading them lazily
+            segmentColumns = [JotStrokeFile segmentColumnsFromData:[dictionary objectForKey:kJotStrokeSegmentDataKey]];
+        }
+        if (segmentColumns) {
+            // the fill ignores the target scale, and is drawn from its path
+            segments = [NSMutableArray arrayWithCapacity:[segmentColumns count]];
+            for (NSUInteger row = 0; row < [segmentColumns count]; row++) {
+                segmentColumns.row = row;
+                [self addSegmentFromStrokeValues:segmentColumns];
+            }
+        } else {
+            segments = [NSMutableArray array];
+            for (NSMutableDictionary* segmentDictionary in [dictionary objectForKey:@"segments"]) {
+                // pass in target scale
+                [segmentDictionary setObject:[dictionary objectForKey:@"scale"] forKey:@"scale"];
+                [self addSegmentFromStrokeValues:segmentDictionary];
+            }
+        }
     }
     return self;
 }
 
+- (void)addSegmentFromStrokeValues:(id<JotStrokeValues>)values {
+    Class class = NSClassFromString([values objectForKey:@"class"]);
+    AbstractBezierPathElement* segment = [[class alloc] initFromStrokeValues:values];
+    if (segment) {
+        [self updateHashWithObject:segment];
+        [segments addObject:segment];
+    }
+}
+
 
 #pragma mark - hashing and equality
 
-- (void)updateHashWithObject:(NSObject*)obj {
-    NSUInteger prime = 31;
-    hashCache = prime * hashCache + [obj hash];
+- (void)updateHashWithObject:(AbstractBezierPathElement*)element {
+    hashCache = JotContentHashCombine(hashCache, [element contentHash]);
 }
 
-- (NSUInteger)hash {
+- (uint64_t)contentHash {
     return hashCache;
 }
 
+- (NSUInteger)hash {
+    return (NSUInteger)[self contentHash];
+}
+
 - (NSString*)uuid {
-    return [NSString stringWithFormat:@"%lu", (unsigned long)[self hash]];
+    return [NSString stringWithFormat:@"%016llx", (unsigned long long)[self contentHash]];
 }
 
 - (BOOL)isEqual:(id)object {
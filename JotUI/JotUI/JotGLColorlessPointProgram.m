@@ -13,6 +13,10 @@
 @implementation JotGLColorlessPointProgram {
     BOOL hasCalculatedColorComponents;
     GLfloat brushColor[4];
+    GLuint uniformVertexColorIndex;
+    // the color last sent to the program
+    GLfloat uploadedBrushColor[4];
+    BOOL hasUploadedBrushColor;
 }
 
 - (id)init {
@@ -21,12 +25,13 @@
                                     withAttributes:@[]
                                        andUniforms:@[@"vertexColor"]]) {
         // add vertexColor uniform to the default uniforms
+        uniformVertexColorIndex = [self uniformIndex:@"vertexColor"];
     }
     return self;
 }
 
 - (GLuint)uniformVertexColorIndex {
-    return [self uniformIndex:@"vertexColor"];
+    return uniformVertexColorIndex;
 }
 
 - (void)use {
@@ -36,8 +41,14 @@
     brushColor[1] = self.colorGreen;
     brushColor[2] = self.colorBlue;
     brushColor[3] = self.colorAlpha;
-    // initialize brush color
-    glUniform4fv([self uniformVertexColorIndex], 1, brushColor);
+    // initialize brush color, if it's changed since the last use
+    if (!hasUploadedBrushColor || memcmp(uploadedBrushColor, brushColor, sizeof(brushColor))) {
+        JotGLProfileCall(JotGLCurrentProfiler(), JotGLCallUniform, glUniform4fv(uniformVertexColorIndex, 1, brushColor));
+        memcpy(uploadedBrushColor, brushColor, sizeof(brushColor));
+        hasUploadedBrushColor = YES;
+    } else {
+        JotGLProfileElided(JotGLCurrentProfiler(), JotGLCallUniform);
+    }
 }
 
 @end
@@ -0,0 +1,521 @@
+//
+//  JotGLCommandBuffer.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#include "JotGLCommandBuffer.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// which of the state's values are known
+enum {
+    JotGLKnownFramebuffer = 1 << 0,
+    JotGLKnownTexture = 1 << 1,
+    JotGLKnownArrayBuffer = 1 << 2,
+    JotGLKnownProgram = 1 << 3,
+    JotGLKnownBlendFunc = 1 << 4,
+    JotGLKnownViewport = 1 << 5,
+    JotGLKnownClearColor = 1 << 6,
+    JotGLKnownColorMask = 1 << 7,
+    JotGLKnownStencilMask = 1 << 8,
+    JotGLKnownStencilFunc = 1 << 9,
+    JotGLKnownStencilOp = 1 << 10
+};
+
+typedef struct {
+    bool known;
+    // the array buffer that was bound when the pointer was set, if it was known
+    bool arrayBufferKnown;
+    uint32_t arrayBuffer;
+    int32_t ints[5];
+    const void* pointer;
+} JotGLAttributePointer;
+
+struct JotGLCommandState {
+    uint32_t known;
+    int32_t framebuffer[1];
+    int32_t texture[1];
+    int32_t arrayBuffer[1];
+    int32_t program[1];
+    int32_t blendFunc[2];
+    int32_t viewport[4];
+    float clearColor[4];
+    int32_t colorMask[4];
+    int32_t stencilMask[1];
+    int32_t stencilFunc[3];
+    int32_t stencilOp[3];
+
+    uint32_t capabilities[kJotGLCommandMaxCapabilities];
+    bool capabilityEnabled[kJotGLCommandMaxCapabilities];
+    size_t capabilityCount;
+
+    uint32_t attributeArraysKnown;
+    uint32_t attributeArraysEnabled;
+    JotGLAttributePointer pointers[kJotGLCommandMaxAttributes];
+
+    uint64_t elidedCount;
+};
+
+struct JotGLCommandBuffer {
+    // each command is a header word, its ints, its floats, and then
+    // its pointer and bytes if it has them
+    uint32_t* words;
+    size_t wordCount;
+    size_t wordCapacity;
+    size_t commandCount;
+    size_t elidedCount;
+    // what the recorded commands have set so far
+    JotGLCommandState state;
+};
+
+typedef struct JotGLQueuedBuffer {
+    JotGLCommandBuffer* buffer;
+    struct JotGLQueuedBuffer* next;
+} JotGLQueuedBuffer;
+
+struct JotGLCommandQueue {
+    pthread_mutex_t lock;
+    JotGLQueuedBuffer* first;
+    JotGLQueuedBuffer* last;
+    size_t bufferCount;
+};
+
+// the header word is the type, then the count of ints and floats, and
+// then whether a pointer, or a length and bytes, follow the floats
+#define kJotGLHeaderIntShift 8
+#define kJotGLHeaderFloatShift 11
+#define kJotGLHeaderHasPointer (1 << 16)
+#define kJotGLHeaderHasBytes (1 << 17)
+
+#pragma mark - State
+
+// sets the values and returns true, or returns false
+// if they're known and already set to values
+static bool JotGLCommandStateSet(JotGLCommandState* state, uint32_t knownFlag, void* stored, const void* values, size_t size) {
+    if ((state->known & knownFlag) && !memcmp(stored, values, size)) {
+        return false;
+    }
+    memcpy(stored, values, size);
+    state->known |= knownFlag;
+    return true;
+}
+
+static bool JotGLCommandStateSetCapability(JotGLCommandState* state, uint32_t capability, bool enabled) {
+    for (size_t i = 0; i < state->capabilityCount; i++) {
+        if (state->capabilities[i] == capability) {
+            if (state->capabilityEnabled[i] == enabled) {
+                return false;
+            }
+            state->capabilityEnabled[i] = enabled;
+            return true;
+        }
+    }
+    if (state->capabilityCount < kJotGLCommandMaxCapabilities) {
+        state->capabilities[state->capabilityCount] = capability;
+        state->capabilityEnabled[state->capabilityCount] = enabled;
+        state->capabilityCount++;
+    }
+    return true;
+}
+
+static bool JotGLCommandStateSetAttributeArray(JotGLCommandState* state, uint32_t index, bool enabled) {
+    if (index >= kJotGLCommandMaxAttributes) {
+        return true;
+    }
+    uint32_t bit = 1u << index;
+    if ((state->attributeArraysKnown & bit) && ((state->attributeArraysEnabled & bit) != 0) == enabled) {
+        return false;
+    }
+    state->attributeArraysKnown |= bit;
+    state->attributeArraysEnabled = enabled ? (state->attributeArraysEnabled | bit) : (state->attributeArraysEnabled & ~bit);
+    return true;
+}
+
+static bool JotGLCommandStateSetAttributePointer(JotGLCommandState* state, const JotGLCommand* command) {
+    uint32_t index = (uint32_t)command->ints[0];
+    if (index >= kJotGLCommandMaxAttributes) {
+        return true;
+    }
+    JotGLAttributePointer* pointer = &state->pointers[index];
+    bool arrayBufferKnown = (state->known & JotGLKnownArrayBuffer) != 0;
+    // the pointer is an offset into whichever buffer was bound when it was set
+    if (pointer->known && pointer->arrayBufferKnown && arrayBufferKnown && pointer->arrayBuffer == (uint32_t)state->arrayBuffer[0] &&
+        pointer->pointer == command->pointer && !memcmp(pointer->ints, command->ints, sizeof(pointer->ints))) {
+        return false;
+    }
+    pointer->known = true;
+    pointer->arrayBufferKnown = arrayBufferKnown;
+    pointer->arrayBuffer = (uint32_t)state->arrayBuffer[0];
+    memcpy(pointer->ints, command->ints, sizeof(pointer->ints));
+    pointer->pointer = command->pointer;
+    return true;
+}
+
+// updates the state with the command, and returns false if
+// the command doesn't change it and can be stripped
+static bool JotGLCommandStateApply(JotGLCommandState* state, const JotGLCommand* command) {
+    switch (command->type) {
+        case JotGLCommandBindFramebuffer:
+            return JotGLCommandStateSet(state, JotGLKnownFramebuffer, state->framebuffer, command->ints, sizeof(state->framebuffer));
+        case JotGLCommandBindTexture:
+            return JotGLCommandStateSet(state, JotGLKnownTexture, state->texture, command->ints, sizeof(state->texture));
+        case JotGLCommandBindArrayBuffer:
+            return JotGLCommandStateSet(state, JotGLKnownArrayBuffer, state->arrayBuffer, command->ints, sizeof(state->arrayBuffer));
+        case JotGLCommandUseProgram:
+            return JotGLCommandStateSet(state, JotGLKnownProgram, state->program, command->ints, sizeof(state->program));
+        case JotGLCommandBlendFunc:
+            return JotGLCommandStateSet(state, JotGLKnownBlendFunc, state->blendFunc, command->ints, sizeof(state->blendFunc));
+        case JotGLCommandViewport:
+            return JotGLCommandStateSet(state, JotGLKnownViewport, state->viewport, command->ints, sizeof(state->viewport));
+        case JotGLCommandClearColor:
+            return JotGLCommandStateSet(state, JotGLKnownClearColor, state->clearColor, command->floats, sizeof(state->clearColor));
+        case JotGLCommandColorMask:
+            return JotGLCommandStateSet(state, JotGLKnownColorMask, state->colorMask, command->ints, sizeof(state->colorMask));
+        case JotGLCommandStencilMask:
+            return JotGLCommandStateSet(state, JotGLKnownStencilMask, state->stencilMask, command->ints, sizeof(state->stencilMask));
+        case JotGLCommandStencilFunc:
+            return JotGLCommandStateSet(state, JotGLKnownStencilFunc, state->stencilFunc, command->ints, sizeof(state->stencilFunc));
+        case JotGLCommandStencilOp:
+            return JotGLCommandStateSet(state, JotGLKnownStencilOp, state->stencilOp, command->ints, sizeof(state->stencilOp));
+        case JotGLCommandEnable:
+        case JotGLCommandDisable:
+            return JotGLCommandStateSetCapability(state, (uint32_t)command->ints[0], command->type == JotGLCommandEnable);
+        case JotGLCommandEnableVertexAttribArray:
+        case JotGLCommandDisableVertexAttribArray:
+            return JotGLCommandStateSetAttributeArray(state, (uint32_t)command->ints[0], command->type == JotGLCommandEnableVertexAttribArray);
+        case JotGLCommandVertexAttribPointer:
+            return JotGLCommandStateSetAttributePointer(state, command);
+        default:
+            return true;
+    }
+}
+
+JotGLCommandState* JotGLCommandStateCreate(void) {
+    return calloc(1, sizeof(JotGLCommandState));
+}
+
+void JotGLCommandStateInvalidate(JotGLCommandState* state) {
+    uint64_t elidedCount = state->elidedCount;
+    memset(state, 0, sizeof(JotGLCommandState));
+    state->elidedCount = elidedCount;
+}
+
+uint64_t JotGLCommandStateGetElidedCount(const JotGLCommandState* state) {
+    return state->elidedCount;
+}
+
+void JotGLCommandStateFree(JotGLCommandState* state) {
+    free(state);
+}
+
+#pragma mark - Recording
+
+JotGLCommandBuffer* JotGLCommandBufferCreate(void) {
+    return calloc(1, sizeof(JotGLCommandBuffer));
+}
+
+void JotGLCommandBufferReset(JotGLCommandBuffer* buffer) {
+    buffer->wordCount = 0;
+    buffer->commandCount = 0;
+    buffer->elidedCount = 0;
+    memset(&buffer->state, 0, sizeof(JotGLCommandState));
+}
+
+size_t JotGLCommandBufferGetCommandCount(const JotGLCommandBuffer* buffer) {
+    return buffer->commandCount;
+}
+
+size_t JotGLCommandBufferGetByteSize(const JotGLCommandBuffer* buffer) {
+    return buffer->wordCount * sizeof(uint32_t);
+}
+
+size_t JotGLCommandBufferGetElidedCount(const JotGLCommandBuffer* buffer) {
+    return buffer->elidedCount;
+}
+
+static bool JotGLCommandBufferReserve(JotGLCommandBuffer* buffer, size_t wordCount) {
+    if (buffer->wordCount + wordCount <= buffer->wordCapacity) {
+        return true;
+    }
+    size_t capacity = buffer->wordCapacity ? buffer->wordCapacity : 256;
+    while (capacity < buffer->wordCount + wordCount) {
+        capacity *= 2;
+    }
+    uint32_t* words = realloc(buffer->words, capacity * sizeof(uint32_t));
+    if (!words) {
+        return false;
+    }
+    buffer->words = words;
+    buffer->wordCapacity = capacity;
+    return true;
+}
+
+static void JotGLCommandBufferRecord(JotGLCommandBuffer* buffer, const JotGLCommand* command, uint32_t intCount, uint32_t floatCount, bool hasPointer) {
+    bool hasBytes = command->type == JotGLCommandBufferSubData;
+    size_t byteWords = hasBytes ? (command->length + sizeof(uint32_t) - 1) / sizeof(uint32_t) : 0;
+    size_t wordCount = 1 + intCount + floatCount + (hasPointer ? 2 : 0) + (hasBytes ? 2 + byteWords : 0);
+    if (!JotGLCommandBufferReserve(buffer, wordCount)) {
+        // the command is dropped, so forget what the
+        // buffer has set instead of trusting it
+        memset(&buffer->state, 0, sizeof(JotGLCommandState));
+        return;
+    }
+    if (!JotGLCommandStateApply(&buffer->state, command)) {
+        buffer->elidedCount++;
+        return;
+    }
+
+    uint32_t* words = buffer->words + buffer->wordCount;
+    *words++ = (uint32_t)command->type | (intCount << kJotGLHeaderIntShift) | (floatCount << kJotGLHeaderFloatShift) |
+        (hasPointer ? kJotGLHeaderHasPointer : 0) | (hasBytes ? kJotGLHeaderHasBytes : 0);
+    memcpy(words, command->ints, intCount * sizeof(uint32_t));
+    words += intCount;
+    memcpy(words, command->floats, floatCount * sizeof(uint32_t));
+    words += floatCount;
+    if (hasPointer) {
+        uint64_t pointer = (uint64_t)(uintptr_t)command->pointer;
+        memcpy(words, &pointer, sizeof(pointer));
+        words += 2;
+    }
+    if (hasBytes) {
+        uint64_t length = command->length;
+        memcpy(words, &length, sizeof(length));
+        words += 2;
+        if (byteWords) {
+            words[byteWords - 1] = 0;
+            memcpy(words, command->pointer, command->length);
+        }
+    }
+    buffer->wordCount += wordCount;
+    buffer->commandCount++;
+}
+
+static void JotGLCommandBufferRecordInts(JotGLCommandBuffer* buffer, JotGLCommandType type, uint32_t intCount, int32_t a, int32_t b, int32_t c, int32_t d) {
+    JotGLCommand command = { .type = type, .ints = { a, b, c, d } };
+    JotGLCommandBufferRecord(buffer, &command, intCount, 0, false);
+}
+
+void JotGLCommandBufferBindFramebuffer(JotGLCommandBuffer* buffer, uint32_t framebuffer) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandBindFramebuffer, 1, (int32_t)framebuffer, 0, 0, 0);
+}
+
+void JotGLCommandBufferBindTexture(JotGLCommandBuffer* buffer, uint32_t texture) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandBindTexture, 1, (int32_t)texture, 0, 0, 0);
+}
+
+void JotGLCommandBufferBindArrayBuffer(JotGLCommandBuffer* buffer, uint32_t arrayBuffer) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandBindArrayBuffer, 1, (int32_t)arrayBuffer, 0, 0, 0);
+}
+
+void JotGLCommandBufferUseProgram(JotGLCommandBuffer* buffer, uint32_t program) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandUseProgram, 1, (int32_t)program, 0, 0, 0);
+}
+
+void JotGLCommandBufferEnable(JotGLCommandBuffer* buffer, uint32_t capability) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandEnable, 1, (int32_t)capability, 0, 0, 0);
+}
+
+void JotGLCommandBufferDisable(JotGLCommandBuffer* buffer, uint32_t capability) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandDisable, 1, (int32_t)capability, 0, 0, 0);
+}
+
+void JotGLCommandBufferBlendFunc(JotGLCommandBuffer* buffer, uint32_t sfactor, uint32_t dfactor) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandBlendFunc, 2, (int32_t)sfactor, (int32_t)dfactor, 0, 0);
+}
+
+void JotGLCommandBufferViewport(JotGLCommandBuffer* buffer, int32_t x, int32_t y, int32_t width, int32_t height) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandViewport, 4, x, y, width, height);
+}
+
+void JotGLCommandBufferClearColor(JotGLCommandBuffer* buffer, float red, float green, float blue, float alpha) {
+    JotGLCommand command = { .type = JotGLCommandClearColor, .floats = { red, green, blue, alpha } };
+    JotGLCommandBufferRecord(buffer, &command, 0, 4, false);
+}
+
+void JotGLCommandBufferColorMask(JotGLCommandBuffer* buffer, bool red, bool green, bool blue, bool alpha) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandColorMask, 4, red, green, blue, alpha);
+}
+
+void JotGLCommandBufferStencilMask(JotGLCommandBuffer* buffer, uint32_t mask) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandStencilMask, 1, (int32_t)mask, 0, 0, 0);
+}
+
+void JotGLCommandBufferStencilFunc(JotGLCommandBuffer* buffer, uint32_t func, int32_t ref, uint32_t mask) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandStencilFunc, 3, (int32_t)func, ref, (int32_t)mask, 0);
+}
+
+void JotGLCommandBufferStencilOp(JotGLCommandBuffer* buffer, uint32_t fail, uint32_t zfail, uint32_t zpass) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandStencilOp, 3, (int32_t)fail, (int32_t)zfail, (int32_t)zpass, 0);
+}
+
+void JotGLCommandBufferEnableVertexAttribArray(JotGLCommandBuffer* buffer, uint32_t index) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandEnableVertexAttribArray, 1, (int32_t)index, 0, 0, 0);
+}
+
+void JotGLCommandBufferDisableVertexAttribArray(JotGLCommandBuffer* buffer, uint32_t index) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandDisableVertexAttribArray, 1, (int32_t)index, 0, 0, 0);
+}
+
+void JotGLCommandBufferVertexAttribPointer(JotGLCommandBuffer* buffer, uint32_t index, int32_t size, uint32_t type, bool normalized, int32_t stride, const void* pointer) {
+    JotGLCommand command = { .type = JotGLCommandVertexAttribPointer, .ints = { (int32_t)index, size, (int32_t)type, normalized, stride }, .pointer = pointer };
+    JotGLCommandBufferRecord(buffer, &command, 5, 0, true);
+}
+
+void JotGLCommandBufferUniform1i(JotGLCommandBuffer* buffer, int32_t location, int32_t value) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandUniform1i, 2, location, value, 0, 0);
+}
+
+void JotGLCommandBufferUniform1f(JotGLCommandBuffer* buffer, int32_t location, float value) {
+    JotGLCommand command = { .type = JotGLCommandUniform1f, .ints = { location }, .floats = { value } };
+    JotGLCommandBufferRecord(buffer, &command, 1, 1, false);
+}
+
+void JotGLCommandBufferUniform4fv(JotGLCommandBuffer* buffer, int32_t location, const float value[4]) {
+    JotGLCommand command = { .type = JotGLCommandUniform4fv, .ints = { location } };
+    memcpy(command.floats, value, 4 * sizeof(float));
+    JotGLCommandBufferRecord(buffer, &command, 1, 4, false);
+}
+
+void JotGLCommandBufferUniformMatrix4fv(JotGLCommandBuffer* buffer, int32_t location, const float matrix[16]) {
+    JotGLCommand command = { .type = JotGLCommandUniformMatrix4fv, .ints = { location } };
+    memcpy(command.floats, matrix, 16 * sizeof(float));
+    JotGLCommandBufferRecord(buffer, &command, 1, 16, false);
+}
+
+void JotGLCommandBufferBufferSubData(JotGLCommandBuffer* buffer, int32_t offset, const void* bytes, size_t length) {
+    JotGLCommand command = { .type = JotGLCommandBufferSubData, .ints = { offset }, .pointer = bytes, .length = length };
+    JotGLCommandBufferRecord(buffer, &command, 1, 0, false);
+}
+
+void JotGLCommandBufferClear(JotGLCommandBuffer* buffer, uint32_t mask) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandClear, 1, (int32_t)mask, 0, 0, 0);
+}
+
+void JotGLCommandBufferDrawArrays(JotGLCommandBuffer* buffer, uint32_t mode, int32_t first, int32_t count) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandDrawArrays, 3, (int32_t)mode, first, count, 0);
+}
+
+void JotGLCommandBufferFlush(JotGLCommandBuffer* buffer) {
+    JotGLCommandBufferRecordInts(buffer, JotGLCommandFlush, 0, 0, 0, 0, 0);
+}
+
+void JotGLCommandBufferFree(JotGLCommandBuffer* buffer) {
+    if (buffer) {
+        free(buffer->words);
+        free(buffer);
+    }
+}
+
+#pragma mark - Submitting
+
+size_t JotGLCommandBufferSubmit(const JotGLCommandBuffer* buffer, JotGLCommandState* state, JotGLCommandBackend backend) {
+    size_t executedCount = 0;
+    const uint32_t* words = buffer->words;
+    const uint32_t* end = buffer->words + buffer->wordCount;
+    while (words < end) {
+        uint32_t header = *words++;
+        uint32_t intCount = (header >> kJotGLHeaderIntShift) & 0x7;
+        uint32_t floatCount = (header >> kJotGLHeaderFloatShift) & 0x1F;
+        JotGLCommand command = { .type = (JotGLCommandType)(header & 0xFF) };
+        memcpy(command.ints, words, intCount * sizeof(uint32_t));
+        words += intCount;
+        memcpy(command.floats, words, floatCount * sizeof(uint32_t));
+        words += floatCount;
+        if (header & kJotGLHeaderHasPointer) {
+            uint64_t pointer;
+            memcpy(&pointer, words, sizeof(pointer));
+            command.pointer = (const void*)(uintptr_t)pointer;
+            words += 2;
+        }
+        if (header & kJotGLHeaderHasBytes) {
+            uint64_t length;
+            memcpy(&length, words, sizeof(length));
+            words += 2;
+            command.length = (size_t)length;
+            command.pointer = words;
+            words += (command.length + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+        }
+
+        if (state && !JotGLCommandStateApply(state, &command)) {
+            state->elidedCount++;
+            continue;
+        }
+        backend.execute(backend.context, &command);
+        executedCount++;
+    }
+    return executedCount;
+}
+
+#pragma mark - Queues
+
+JotGLCommandQueue* JotGLCommandQueueCreate(void) {
+    JotGLCommandQueue* queue = calloc(1, sizeof(JotGLCommandQueue));
+    if (queue) {
+        pthread_mutex_init(&queue->lock, NULL);
+    }
+    return queue;
+}
+
+void JotGLCommandQueueEnqueue(JotGLCommandQueue* queue, JotGLCommandBuffer* buffer) {
+    JotGLQueuedBuffer* queued = calloc(1, sizeof(JotGLQueuedBuffer));
+    if (!queued) {
+        JotGLCommandBufferFree(buffer);
+        return;
+    }
+    queued->buffer = buffer;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->last) {
+        queue->last->next = queued;
+    } else {
+        queue->first = queued;
+    }
+    queue->last = queued;
+    queue->bufferCount++;
+    pthread_mutex_unlock(&queue->lock);
+}
+
+size_t JotGLCommandQueueGetBufferCount(JotGLCommandQueue* queue) {
+    pthread_mutex_lock(&queue->lock);
+    size_t bufferCount = queue->bufferCount;
+    pthread_mutex_unlock(&queue->lock);
+    return bufferCount;
+}
+
+size_t JotGLCommandQueueSubmit(JotGLCommandQueue* queue, JotGLCommandState* state, JotGLCommandBackend backend) {
+    // take the buffers, so others can be enqueued while these run
+    pthread_mutex_lock(&queue->lock);
+    JotGLQueuedBuffer* queued = queue->first;
+    queue->first = NULL;
+    queue->last = NULL;
+    queue->bufferCount = 0;
+    pthread_mutex_unlock(&queue->lock);
+
+    size_t executedCount = 0;
+    while (queued) {
+        JotGLQueuedBuffer* next = queued->next;
+        executedCount += JotGLCommandBufferSubmit(queued->buffer, state, backend);
+        JotGLCommandBufferFree(queued->buffer);
+        free(queued);
+        queued = next;
+    }
+    return executedCount;
+}
+
+void JotGLCommandQueueFree(JotGLCommandQueue* queue) {
+    if (!queue) {
+        return;
+    }
+    JotGLQueuedBuffer* queued = queue->first;
+    while (queued) {
+        JotGLQueuedBuffer* next = queued->next;
+        JotGLCommandBufferFree(queued->buffer);
+        free(queued);
+        queued = next;
+    }
+    pthread_mutex_destroy(&queue->lock);
+    free(queue);
+}
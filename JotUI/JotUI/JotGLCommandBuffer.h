@@ -0,0 +1,211 @@
+//
+//  JotGLCommandBuffer.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#ifndef JotGLCommandBuffer_h
+#define JotGLCommandBuffer_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Records GL commands into a compact list, so that they can be built
+ * on any thread and run on the context's thread all at once.
+ *
+ * Recording doesn't call GL. Each command is a header word followed by
+ * its arguments, and uploads copy their bytes into the buffer. State
+ * that a command sets to what an earlier command in the buffer already
+ * set it to is stripped as it's recorded: binds, enables, blend,
+ * viewport, clear color, color mask, stencil and attribute arrays and
+ * pointers. Uniforms, clears, draws, uploads and flushes are always kept,
+ * since JotGLProgram already only uploads uniforms that change.
+ *
+ * A buffer is submitted to a backend, which runs each command, along
+ * with a command state that tracks what's been submitted since it was
+ * invalidated. Commands that set state to what it already is are
+ * stripped again, so that buffers recorded separately don't repeat
+ * each other's state. The state doesn't know about GL calls made around
+ * it, so it should be invalidated whenever GL is called directly.
+ *
+ * A buffer and a state are each used by one thread at a time. A queue
+ * collects finished buffers from any thread, and submits them in the
+ * order they were enqueued.
+ */
+typedef struct JotGLCommandBuffer JotGLCommandBuffer;
+typedef struct JotGLCommandState JotGLCommandState;
+typedef struct JotGLCommandQueue JotGLCommandQueue;
+
+typedef enum {
+    JotGLCommandBindFramebuffer,
+    JotGLCommandBindTexture,
+    JotGLCommandBindArrayBuffer,
+    JotGLCommandUseProgram,
+    JotGLCommandEnable,
+    JotGLCommandDisable,
+    JotGLCommandBlendFunc,
+    JotGLCommandViewport,
+    JotGLCommandClearColor,
+    JotGLCommandColorMask,
+    JotGLCommandStencilMask,
+    JotGLCommandStencilFunc,
+    JotGLCommandStencilOp,
+    JotGLCommandEnableVertexAttribArray,
+    JotGLCommandDisableVertexAttribArray,
+    JotGLCommandVertexAttribPointer,
+    JotGLCommandUniform1i,
+    JotGLCommandUniform1f,
+    JotGLCommandUniform4fv,
+    JotGLCommandUniformMatrix4fv,
+    JotGLCommandBufferSubData,
+    JotGLCommandClear,
+    JotGLCommandDrawArrays,
+    JotGLCommandFlush,
+    JotGLCommandTypeCount
+} JotGLCommandType;
+
+// the most vertex attributes whose arrays and pointers are tracked.
+// commands for higher indices are never stripped
+#define kJotGLCommandMaxAttributes 16
+// the most capabilities whose enables are tracked
+#define kJotGLCommandMaxCapabilities 8
+
+/**
+ * A decoded command. ints and floats are the gl call's arguments in
+ * order, after the target for binds and uploads, which is always
+ * GL_FRAMEBUFFER, GL_TEXTURE_2D or GL_ARRAY_BUFFER:
+ *
+ * VertexAttribPointer is index, size, type, normalized, stride, and
+ * its pointer. BufferSubData is the offset, and its bytes are in
+ * pointer and length. Matrices aren't transposed.
+ */
+typedef struct {
+    JotGLCommandType type;
+    int32_t ints[5];
+    float floats[16];
+    const void* pointer;
+    size_t length;
+} JotGLCommand;
+
+typedef void (*JotGLCommandFunction)(void* context, const JotGLCommand* command);
+
+typedef struct {
+    JotGLCommandFunction execute;
+    void* context;
+} JotGLCommandBackend;
+
+#pragma mark - Buffers
+
+JotGLCommandBuffer* JotGLCommandBufferCreate(void);
+
+// forgets every command and the state they set, but keeps the memory
+void JotGLCommandBufferReset(JotGLCommandBuffer* buffer);
+
+// the commands that were kept, and the bytes they take
+size_t JotGLCommandBufferGetCommandCount(const JotGLCommandBuffer* buffer);
+
+size_t JotGLCommandBufferGetByteSize(const JotGLCommandBuffer* buffer);
+
+// the commands that were stripped as they were recorded
+size_t JotGLCommandBufferGetElidedCount(const JotGLCommandBuffer* buffer);
+
+void JotGLCommandBufferBindFramebuffer(JotGLCommandBuffer* buffer, uint32_t framebuffer);
+
+void JotGLCommandBufferBindTexture(JotGLCommandBuffer* buffer, uint32_t texture);
+
+void JotGLCommandBufferBindArrayBuffer(JotGLCommandBuffer* buffer, uint32_t arrayBuffer);
+
+void JotGLCommandBufferUseProgram(JotGLCommandBuffer* buffer, uint32_t program);
+
+void JotGLCommandBufferEnable(JotGLCommandBuffer* buffer, uint32_t capability);
+
+void JotGLCommandBufferDisable(JotGLCommandBuffer* buffer, uint32_t capability);
+
+void JotGLCommandBufferBlendFunc(JotGLCommandBuffer* buffer, uint32_t sfactor, uint32_t dfactor);
+
+void JotGLCommandBufferViewport(JotGLCommandBuffer* buffer, int32_t x, int32_t y, int32_t width, int32_t height);
+
+void JotGLCommandBufferClearColor(JotGLCommandBuffer* buffer, float red, float green, float blue, float alpha);
+
+void JotGLCommandBufferColorMask(JotGLCommandBuffer* buffer, bool red, bool green, bool blue, bool alpha);
+
+void JotGLCommandBufferStencilMask(JotGLCommandBuffer* buffer, uint32_t mask);
+
+void JotGLCommandBufferStencilFunc(JotGLCommandBuffer* buffer, uint32_t func, int32_t ref, uint32_t mask);
+
+void JotGLCommandBufferStencilOp(JotGLCommandBuffer* buffer, uint32_t fail, uint32_t zfail, uint32_t zpass);
+
+void JotGLCommandBufferEnableVertexAttribArray(JotGLCommandBuffer* buffer, uint32_t index);
+
+void JotGLCommandBufferDisableVertexAttribArray(JotGLCommandBuffer* buffer, uint32_t index);
+
+// pointer is an offset into the bound array buffer, or client memory
+// that must stay valid until the buffer is submitted
+void JotGLCommandBufferVertexAttribPointer(JotGLCommandBuffer* buffer, uint32_t index, int32_t size, uint32_t type, bool normalized, int32_t stride, const void* pointer);
+
+void JotGLCommandBufferUniform1i(JotGLCommandBuffer* buffer, int32_t location, int32_t value);
+
+void JotGLCommandBufferUniform1f(JotGLCommandBuffer* buffer, int32_t location, float value);
+
+void JotGLCommandBufferUniform4fv(JotGLCommandBuffer* buffer, int32_t location, const float value[4]);
+
+void JotGLCommandBufferUniformMatrix4fv(JotGLCommandBuffer* buffer, int32_t location, const float matrix[16]);
+
+// uploads into the bound array buffer. the bytes are copied, so they
+// can be reused as soon as this returns
+void JotGLCommandBufferBufferSubData(JotGLCommandBuffer* buffer, int32_t offset, const void* bytes, size_t length);
+
+void JotGLCommandBufferClear(JotGLCommandBuffer* buffer, uint32_t mask);
+
+void JotGLCommandBufferDrawArrays(JotGLCommandBuffer* buffer, uint32_t mode, int32_t first, int32_t count);
+
+void JotGLCommandBufferFlush(JotGLCommandBuffer* buffer);
+
+// runs the buffer's commands with the backend, stripping those that
+// set the state to what it already is. state may be NULL to run
+// every command. returns the number of commands that were run
+size_t JotGLCommandBufferSubmit(const JotGLCommandBuffer* buffer, JotGLCommandState* state, JotGLCommandBackend backend);
+
+void JotGLCommandBufferFree(JotGLCommandBuffer* buffer);
+
+#pragma mark - State
+
+JotGLCommandState* JotGLCommandStateCreate(void);
+
+// forgets all of the state, so the next command to set anything is run
+void JotGLCommandStateInvalidate(JotGLCommandState* state);
+
+// the commands that were stripped as they were submitted
+uint64_t JotGLCommandStateGetElidedCount(const JotGLCommandState* state);
+
+void JotGLCommandStateFree(JotGLCommandState* state);
+
+#pragma mark - Queues
+
+JotGLCommandQueue* JotGLCommandQueueCreate(void);
+
+// takes ownership of the buffer, which is freed once it's submitted
+void JotGLCommandQueueEnqueue(JotGLCommandQueue* queue, JotGLCommandBuffer* buffer);
+
+size_t JotGLCommandQueueGetBufferCount(JotGLCommandQueue* queue);
+
+// submits every buffer that's been enqueued, in order, and frees
+// them. returns the number of commands that were run
+size_t JotGLCommandQueueSubmit(JotGLCommandQueue* queue, JotGLCommandState* state, JotGLCommandBackend backend);
+
+// frees any buffers that haven't been submitted
+void JotGLCommandQueueFree(JotGLCommandQueue* queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JotGLCommandBuffer_h */
@@ -10,6 +10,8 @@
 #import <OpenGLES/EAGL.h>
 #import "JotGLTypes.h"
 #import "JotGLProgram.h"
+#import "JotGLCommandBuffer.h"
+#import "JotGLProfiler.h"
 
 
 @class JotGLTexture, JotGLPointProgram, JotGLQuadProgram, JotGLColorlessPointProgram, JotGLColoredPointProgram;
@@ -18,6 +20,9 @@
 
 int printOglError(char* file, int line);
 
+// the profiler of the current context, for gl calls made outside of it
+#define JotGLCurrentProfiler() [(JotGLContext*)[JotGLContext currentContext] profiler]
+
 
 @interface JotGLContext : EAGLContext
 
@@ -52,12 +57,37 @@ int printOglError(char* file, int line);
 
 - (JotGLQuadProgram*)stencilProgram;
 
+// builds all of the context's programs, so that its first
+// stroke or export doesn't wait on them
+- (void)warmUpPrograms;
+
 #pragma mark - Context Properties
 
 - (void)flush;
 
 - (void)finish;
 
+// between these calls, deleted buffers, textures, framebuffers and
+// renderbuffers are queued, and then deleted with one gl call per kind
+// instead of one call each. batches can nest
+- (void)beginBatchedDeletes;
+
+- (void)endBatchedDeletes;
+
+// the number of gl objects that this context has deleted, including
+// those still queued in a batch
+@property(nonatomic, readonly) NSUInteger deletedObjectCount;
+
+#pragma mark - Profiling
+
+// counts and times this context's gl calls when kJotEnableGLProfiling
+// is set, and is NULL otherwise. frames end when the context presents,
+// or when JotGLContextPool takes back a context it lent out
+@property(nonatomic, readonly) JotGLProfiler* profiler;
+
+// the profiler's frames as CSV, see JotGLProfilerWriteTrace
+- (NSString*)profileTrace;
+
 - (void)runBlock:(void (^)(void))block
 forStenciledPath:(UIBezierPath*)clippingPath
             atP1:(CGPoint)p1
@@ -71,12 +101,27 @@ forStenciledPath:(UIBezierPath*)clippingPath
 
 - (void)runBlockAndMaintainCurrentFramebuffer:(void (^)(void))block;
 
+#pragma mark - Command Buffers
+
+// pushes this context and runs the recorded commands all at once, with
+// one error check after. state that a buffer repeats from an earlier
+// buffer in the same submit isn't set again, and the state this context
+// tracks is kept in sync. commands shouldn't set the uniforms of a
+// JotGLProgram, since it only uploads them when they've changed
+- (void)submitCommandBuffer:(JotGLCommandBuffer*)commandBuffer;
+
+// submits and frees every buffer in the queue
+- (void)submitCommandQueue:(JotGLCommandQueue*)commandQueue;
+
 - (void)runBlock:(void (^)(void))block withScissorRect:(CGRect)scissorRect;
 
 - (void)prepOpenGLBlendModeForColor:(UIColor*)color;
 
 - (GLuint)generateTextureForSize:(CGSize)size withBytes:(const GLvoid*)bytes;
 
+// bytes are tightly packed RGBA rows covering rect
+- (void)updateTexture:(GLuint)textureId inRect:(CGRect)rect withBytes:(const GLvoid*)bytes;
+
 - (void)bindTexture:(GLuint)textureId;
 
 - (void)unbindTexture;
@@ -105,6 +150,9 @@ forStenciledPath:(UIBezierPath*)clippingPath
 
 - (void)readPixelsInto:(GLubyte*)data ofSize:(GLSize)size;
 
+// reads tightly packed RGBA rows of rect from the bound framebuffer
+- (void)readPixelsInto:(GLubyte*)data inRect:(CGRect)rect;
+
 - (void)bindRenderbuffer:(GLuint)renderBufferId;
 
 - (void)unbindRenderbuffer;
@@ -24,7 +24,7 @@ int printOglError(char* file, int line) {
     GLenum glErr;
     int retCode = 0;
 
-    glErr = glGetError();
+    JotGLProfileCall(JotGLCurrentProfiler(), JotGLCallGetError, glErr = glGetError());
     if (glErr != GL_NO_ERROR) {
         DebugLog(@"glError in file %s @ line %d: %d\n",
                  file, line, glErr);
@@ -54,6 +54,38 @@ typedef enum UndfBOOL {
     UNKNOWN
 } UndfBOOL;
 
+// profiles a gl call with the context's profiler, see JotGLProfiler.h
+#define JotGLProfile(call, statement) JotGLProfileCall(profiler, call, statement)
+
+
+// the most gl objects of one kind that are queued before they're deleted
+#define kJotGLMaxBatchedDeletes 64
+
+typedef struct {
+    GLuint names[kJotGLMaxBatchedDeletes];
+    GLsizei count;
+} JotGLPendingDeletes;
+
+static void JotGLFlushDeletes(JotGLPendingDeletes* pending, void (*deleteNames)(GLsizei, const GLuint*)) {
+    if (pending->count) {
+        deleteNames(pending->count, pending->names);
+        printOpenGLError();
+        pending->count = 0;
+    }
+}
+
+// deletes name now if we're not batching, or queues it otherwise
+static void JotGLDeleteName(JotGLPendingDeletes* pending, BOOL batching, GLuint name, void (*deleteNames)(GLsizei, const GLuint*)) {
+    if (!batching) {
+        deleteNames(1, &name);
+        printOpenGLError();
+        return;
+    }
+    if (pending->count == kJotGLMaxBatchedDeletes) {
+        JotGLFlushDeletes(pending, deleteNames);
+    }
+    pending->names[pending->count++] = name;
+}
 
 @implementation JotGLContext {
     NSString* name;
@@ -150,9 +182,22 @@ typedef enum UndfBOOL {
     NSRecursiveLock* lock;
 
     NSMutableDictionary* contextProperties;
+
+    NSInteger batchedDeleteDepth;
+    JotGLPendingDeletes pendingBufferDeletes;
+    JotGLPendingDeletes pendingTextureDeletes;
+    JotGLPendingDeletes pendingFramebufferDeletes;
+    JotGLPendingDeletes pendingRenderbufferDeletes;
+
+    // what submitted command buffers have set, see submitCommandBuffer:
+    JotGLCommandState* commandState;
+
+    JotGLProfiler* profiler;
 }
 
 @synthesize contextProperties;
+@synthesize deletedObjectCount;
+@synthesize profiler;
 
 - (BOOL)validateThread {
     return validateThreadBlock();
@@ -230,6 +275,10 @@ typedef enum UndfBOOL {
     texparam_GL_TEXTURE_WRAP_T = 0;
     lock = [[NSRecursiveLock alloc] init];
     contextProperties = [NSMutableDictionary dictionary];
+    commandState = JotGLCommandStateCreate();
+#if kJotEnableGLProfiling
+    profiler = JotGLProfilerCreate();
+#endif
 }
 
 - (id)initWithName:(NSString*)_name andValidateThreadWith:(BOOL (^)(void))_validateThreadBlock {
@@ -290,6 +339,15 @@ typedef enum UndfBOOL {
     return stencilProgram;
 }
 
+- (void)warmUpPrograms {
+    [self runBlock:^{
+        [self colorlessPointProgram];
+        [self coloredPointProgram];
+        [self quadProgram];
+        [self stencilProgram];
+    }];
+}
+
 
 #pragma mark - Run Blocks
 
@@ -337,7 +395,7 @@ typedef enum UndfBOOL {
 
         if (!CGRectEqualToRect(scissorRect, CGRectZero)) {
             [self glEnableScissorTest];
-            glScissor(scissorRect.origin.x, scissorRect.origin.y, scissorRect.size.width, scissorRect.size.height);
+            JotGLProfile(JotGLCallScissor, glScissor(scissorRect.origin.x, scissorRect.origin.y, scissorRect.size.width, scissorRect.size.height));
         } else {
             // noop for scissors
         }
@@ -455,12 +513,35 @@ typedef enum UndfBOOL {
 - (void)flush {
     ValidateCurrentContext;
     needsFlush = NO;
-    glFlush();
+    JotGLProfile(JotGLCallFlush, glFlush());
 }
 - (void)finish {
     ValidateCurrentContext;
     needsFlush = NO;
-    glFinish();
+    JotGLProfile(JotGLCallFinish, glFinish());
+}
+
+- (void)beginBatchedDeletes {
+    ValidateCurrentContext;
+    batchedDeleteDepth++;
+}
+
+- (void)endBatchedDeletes {
+    ValidateCurrentContext;
+    NSAssert(batchedDeleteDepth > 0, @"must begin a batch of deletes before ending it");
+    batchedDeleteDepth--;
+    if (!batchedDeleteDepth) {
+        [self flushBatchedDeletes];
+    }
+}
+
+- (void)flushBatchedDeletes {
+    // framebuffers first, so that nothing is deleted while it's
+    // still attached to one
+    JotGLFlushDeletes(&pendingFramebufferDeletes, glDeleteFramebuffers);
+    JotGLFlushDeletes(&pendingRenderbufferDeletes, glDeleteRenderbuffers);
+    JotGLFlushDeletes(&pendingTextureDeletes, glDeleteTextures);
+    JotGLFlushDeletes(&pendingBufferDeletes, glDeleteBuffers);
 }
 
 #pragma mark - Enable Disable State
@@ -471,7 +552,9 @@ typedef enum UndfBOOL {
         stencilOpFail = fail;
         stencilOpZfail = zfail;
         stencilOpZpass = zpass;
-        glStencilOp(fail, zfail, zpass);
+        JotGLProfile(JotGLCallStencilOp, glStencilOp(fail, zfail, zpass));
+    } else {
+        JotGLProfileElided(profiler, JotGLCallStencilOp);
     }
     printOpenGLError();
 }
@@ -482,7 +565,9 @@ typedef enum UndfBOOL {
         stencilFuncFunc = func;
         stencilFuncRef = ref;
         stencilFuncMask = mask;
-        glStencilFunc(func, ref, mask);
+        JotGLProfile(JotGLCallStencilFunc, glStencilFunc(func, ref, mask));
+    } else {
+        JotGLProfileElided(profiler, JotGLCallStencilFunc);
     }
     printOpenGLError();
 }
@@ -490,8 +575,10 @@ typedef enum UndfBOOL {
 - (void)glStencilMask:(GLuint)mask {
     ValidateCurrentContext;
     if (mask != stencilMask) {
-        glStencilMask(mask);
+        JotGLProfile(JotGLCallStencilMask, glStencilMask(mask));
         stencilMask = mask;
+    } else {
+        JotGLProfileElided(profiler, JotGLCallStencilMask);
     }
     printOpenGLError();
 }
@@ -499,8 +586,10 @@ typedef enum UndfBOOL {
 - (void)glDisableDepthMask {
     ValidateCurrentContext;
     if (enabled_GL_DEPTH_MASK == YEP || enabled_GL_DEPTH_MASK == UNKNOWN) {
-        glDepthMask(GL_FALSE);
+        JotGLProfile(JotGLCallDepthMask, glDepthMask(GL_FALSE));
         enabled_GL_DEPTH_MASK = NOPE;
+    } else {
+        JotGLProfileElided(profiler, JotGLCallDepthMask);
     }
     printOpenGLError();
 }
@@ -508,8 +597,10 @@ typedef enum UndfBOOL {
 - (void)glEnableDepthMask {
     ValidateCurrentContext;
     if (enabled_GL_DEPTH_MASK == NOPE || enabled_GL_DEPTH_MASK == UNKNOWN) {
-        glDepthMask(GL_TRUE);
+        JotGLProfile(JotGLCallDepthMask, glDepthMask(GL_TRUE));
         enabled_GL_DEPTH_MASK = YEP;
+    } else {
+        JotGLProfileElided(profiler, JotGLCallDepthMask);
     }
     printOpenGLError();
 }
@@ -517,11 +608,13 @@ typedef enum UndfBOOL {
 - (void)glColorMaskRed:(GLboolean)red green:(GLboolean)green blue:(GLboolean)blue alpha:(GLboolean)alpha {
     ValidateCurrentContext;
     if (red != enabled_glColorMask_red || green != enabled_glColorMask_green || blue != enabled_glColorMask_blue || alpha != enabled_glColorMask_alpha) {
-        glColorMask(red, green, blue, alpha);
+        JotGLProfile(JotGLCallColorMask, glColorMask(red, green, blue, alpha));
         enabled_glColorMask_red = red ? YEP : NOPE;
         enabled_glColorMask_green = green ? YEP : NOPE;
         enabled_glColorMask_blue = blue ? YEP : NOPE;
         enabled_glColorMask_alpha = alpha ? YEP : NOPE;
+    } else {
+        JotGLProfileElided(profiler, JotGLCallColorMask);
     }
     printOpenGLError();
 }
@@ -529,8 +622,10 @@ typedef enum UndfBOOL {
 - (void)glDisableStencilTest {
     ValidateCurrentContext;
     if (enabled_GL_STENCIL_TEST == YEP || enabled_GL_STENCIL_TEST == UNKNOWN) {
-        glDisable(GL_STENCIL_TEST);
+        JotGLProfile(JotGLCallDisable, glDisable(GL_STENCIL_TEST));
         enabled_GL_STENCIL_TEST = NOPE;
+    } else {
+        JotGLProfileElided(profiler, JotGLCallDisable);
     }
     printOpenGLError();
 }
@@ -538,8 +633,10 @@ typedef enum UndfBOOL {
 - (void)glEnableStencilTest {
     ValidateCurrentContext;
     if (enabled_GL_STENCIL_TEST == NOPE || enabled_GL_STENCIL_TEST == UNKNOWN) {
-        glEnable(GL_STENCIL_TEST);
+        JotGLProfile(JotGLCallEnable, glEnable(GL_STENCIL_TEST));
         enabled_GL_STENCIL_TEST = YEP;
+    } else {
+        JotGLProfileElided(profiler, JotGLCallEnable);
     }
     printOpenGLError();
 }
@@ -547,8 +644,10 @@ typedef enum UndfBOOL {
 - (void)glDisableScissorTest {
     ValidateCurrentContext;
     if (enabled_GL_SCISSOR_TEST == YEP || enabled_GL_SCISSOR_TEST == UNKNOWN) {
-        glDisable(GL_SCISSOR_TEST);
+        JotGLProfile(JotGLCallDisable, glDisable(GL_SCISSOR_TEST));
         enabled_GL_SCISSOR_TEST = NOPE;
+    } else {
+        JotGLProfileElided(profiler, JotGLCallDisable);
     }
     printOpenGLError();
 }
@@ -556,8 +655,10 @@ typedef enum UndfBOOL {
 - (void)glEnableScissorTest {
     ValidateCurrentContext;
     if (enabled_GL_SCISSOR_TEST == NOPE || enabled_GL_SCISSOR_TEST == UNKNOWN) {
-        glEnable(GL_SCISSOR_TEST);
+        JotGLProfile(JotGLCallEnable, glEnable(GL_SCISSOR_TEST));
         enabled_GL_SCISSOR_TEST = YEP;
+    } else {
+        JotGLProfileElided(profiler, JotGLCallEnable);
     }
     printOpenGLError();
 }
@@ -565,8 +666,10 @@ typedef enum UndfBOOL {
 - (void)glDisableDither {
     ValidateCurrentContext;
     if (enabled_GL_DITHER == YEP || enabled_GL_DITHER == UNKNOWN) {
-        glDisable(GL_DITHER);
+        JotGLProfile(JotGLCallDisable, glDisable(GL_DITHER));
         enabled_GL_DITHER = NOPE;
+    } else {
+        JotGLProfileElided(profiler, JotGLCallDisable);
     }
     printOpenGLError();
 }
@@ -574,16 +677,18 @@ typedef enum UndfBOOL {
 - (void)glEnableBlend {
     ValidateCurrentContext;
     if (enabled_GL_BLEND == NOPE || enabled_GL_BLEND == UNKNOWN) {
-        glEnable(GL_BLEND);
+        JotGLProfile(JotGLCallEnable, glEnable(GL_BLEND));
         enabled_GL_BLEND = YEP;
+    } else {
+        JotGLProfileElided(profiler, JotGLCallEnable);
     }
     printOpenGLError();
 }
 
 - (void)enableVertexArrayAtIndex:(GLuint)index forSize:(GLint)size andStride:(GLsizei)stride andPointer:(const GLvoid*)pointer {
-    glEnableVertexAttribArray(index);
+    JotGLProfile(JotGLCallEnableVertexAttribArray, glEnableVertexAttribArray(index));
     printOpenGLError();
-    glVertexAttribPointer(index, size, GL_FLOAT, GL_FALSE, stride, pointer);
+    JotGLProfile(JotGLCallVertexAttribPointer, glVertexAttribPointer(index, size, GL_FLOAT, GL_FALSE, stride, pointer));
     vertex_pointer_size = size;
     vertex_pointer_type = GL_FLOAT;
     vertex_pointer_stride = stride;
@@ -592,9 +697,9 @@ typedef enum UndfBOOL {
 }
 
 - (void)enableColorArrayAtIndex:(GLuint)index forSize:(GLint)size andStride:(GLsizei)stride andPointer:(const GLvoid*)pointer {
-    glEnableVertexAttribArray(index);
+    JotGLProfile(JotGLCallEnableVertexAttribArray, glEnableVertexAttribArray(index));
     printOpenGLError();
-    glVertexAttribPointer(index, size, GL_FLOAT, GL_FALSE, stride, pointer);
+    JotGLProfile(JotGLCallVertexAttribPointer, glVertexAttribPointer(index, size, GL_FLOAT, GL_FALSE, stride, pointer));
     color_pointer_size = size;
     color_pointer_type = GL_FLOAT;
     color_pointer_stride = stride;
@@ -603,9 +708,9 @@ typedef enum UndfBOOL {
 }
 
 - (void)enablePointSizeArrayAtIndex:(GLuint)index forStride:(GLsizei)stride andPointer:(const GLvoid*)pointer {
-    glEnableVertexAttribArray(index);
+    JotGLProfile(JotGLCallEnableVertexAttribArray, glEnableVertexAttribArray(index));
     printOpenGLError();
-    glVertexAttribPointer(index, 1, GL_FLOAT, GL_FALSE, stride, pointer);
+    JotGLProfile(JotGLCallVertexAttribPointer, glVertexAttribPointer(index, 1, GL_FLOAT, GL_FALSE, stride, pointer));
     point_pointer_type = GL_FLOAT;
     point_pointer_stride = stride;
     point_pointer_pointer = pointer;
@@ -613,8 +718,8 @@ typedef enum UndfBOOL {
 }
 
 - (void)enableTextureCoordArrayAtIndex:(GLuint)index forSize:(GLint)size andStride:(GLsizei)stride andPointer:(const GLvoid*)pointer {
-    glEnableVertexAttribArray(index);
-    glVertexAttribPointer(index, size, GL_FLOAT, GL_FALSE, stride, pointer);
+    JotGLProfile(JotGLCallEnableVertexAttribArray, glEnableVertexAttribArray(index));
+    JotGLProfile(JotGLCallVertexAttribPointer, glVertexAttribPointer(index, size, GL_FLOAT, GL_FALSE, stride, pointer));
     texcoord_pointer_size = size;
     texcoord_pointer_type = GL_FLOAT;
     texcoord_pointer_stride = stride;
@@ -626,16 +731,16 @@ typedef enum UndfBOOL {
 - (void)glTexParameteriWithPname:(GLenum)pname param:(GLint)param {
     if (pname == GL_TEXTURE_MIN_FILTER) {
         texparam_GL_TEXTURE_MIN_FILTER = param;
-        glTexParameteri(GL_TEXTURE_2D, pname, param);
+        JotGLProfile(JotGLCallTexParameter, glTexParameteri(GL_TEXTURE_2D, pname, param));
     } else if (pname == GL_TEXTURE_MAG_FILTER) {
         texparam_GL_TEXTURE_MAG_FILTER = param;
-        glTexParameteri(GL_TEXTURE_2D, pname, param);
+        JotGLProfile(JotGLCallTexParameter, glTexParameteri(GL_TEXTURE_2D, pname, param));
     } else if (pname == GL_TEXTURE_WRAP_S) {
         texparam_GL_TEXTURE_WRAP_S = param;
-        glTexParameteri(GL_TEXTURE_2D, pname, param);
+        JotGLProfile(JotGLCallTexParameter, glTexParameteri(GL_TEXTURE_2D, pname, param));
     } else if (pname == GL_TEXTURE_WRAP_T) {
         texparam_GL_TEXTURE_WRAP_T = param;
-        glTexParameteri(GL_TEXTURE_2D, pname, param);
+        JotGLProfile(JotGLCallTexParameter, glTexParameteri(GL_TEXTURE_2D, pname, param));
     } else {
         @throw [NSException exceptionWithName:@"TextureParamException" reason:@"Unknown texture parameter" userInfo:nil];
     }
@@ -715,8 +820,8 @@ forStenciledPath:(UIBezierPath*)clippingPath
             // setup the stencil test and alpha test. the stencil test
             // ensures all pixels are turned "on" in the stencil buffer,
             // and the alpha test ensures we ignore transparent pixels
-            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-            glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+            JotGLProfile(JotGLCallClearColor, glClearColor(0.0f, 0.0f, 0.0f, 0.0f));
+            JotGLProfile(JotGLCallClear, glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT));
             glClearStencil(0);
             [self glEnableStencilTest];
             [self glColorMaskRed:GL_FALSE green:GL_FALSE blue:GL_FALSE alpha:GL_FALSE];
@@ -726,7 +831,7 @@ forStenciledPath:(UIBezierPath*)clippingPath
             [self glStencilOp:GL_KEEP zfail:GL_KEEP zpass:GL_REPLACE]; // draw 1s on test fail (always)
 
             [self glStencilMask:0xFF];
-            glClear(GL_STENCIL_BUFFER_BIT); // needs mask=0xFF
+            JotGLProfile(JotGLCallClear, glClear(GL_STENCIL_BUFFER_BIT)); // needs mask=0xFF
 
 
             // these vertices will stretch the stencil texture
@@ -793,16 +898,178 @@ forStenciledPath:(UIBezierPath*)clippingPath
     }];
 }
 
+#pragma mark - Profiling
+
+- (NSString*)profileTrace {
+    size_t length = JotGLProfilerWriteTrace(profiler, NULL, 0) + 1;
+    NSMutableData* trace = [NSMutableData dataWithLength:length];
+    JotGLProfilerWriteTrace(profiler, [trace mutableBytes], length);
+    return [NSString stringWithUTF8String:[trace bytes]];
+}
+
+#pragma mark - Command Buffers
+
+static UndfBOOL* JotGLContextEnabledCapability(JotGLContext* context, GLenum capability) {
+    switch (capability) {
+        case GL_BLEND:
+            return &context->enabled_GL_BLEND;
+        case GL_DITHER:
+            return &context->enabled_GL_DITHER;
+        case GL_SCISSOR_TEST:
+            return &context->enabled_GL_SCISSOR_TEST;
+        case GL_STENCIL_TEST:
+            return &context->enabled_GL_STENCIL_TEST;
+        default:
+            return NULL;
+    }
+}
+
+// runs a submitted command, and updates the state that the
+// context tracks so that its own methods don't skip anything
+static void JotGLContextExecuteCommand(void* contextPtr, const JotGLCommand* command) {
+    JotGLContext* context = (__bridge JotGLContext*)contextPtr;
+    __unused JotGLProfiler* profiler = context->profiler;
+    const int32_t* ints = command->ints;
+    const float* floats = command->floats;
+    switch (command->type) {
+        case JotGLCommandBindFramebuffer:
+            JotGLProfile(JotGLCallBindFramebuffer, glBindFramebuffer(GL_FRAMEBUFFER, ints[0]));
+            context->currentlyBoundFramebuffer = ints[0];
+            break;
+        case JotGLCommandBindTexture:
+            JotGLProfile(JotGLCallBindTexture, glBindTexture(GL_TEXTURE_2D, ints[0]));
+            break;
+        case JotGLCommandBindArrayBuffer:
+            JotGLProfile(JotGLCallBindBuffer, glBindBuffer(GL_ARRAY_BUFFER, ints[0]));
+            break;
+        case JotGLCommandUseProgram:
+            JotGLProfile(JotGLCallUseProgram, glUseProgram(ints[0]));
+            break;
+        case JotGLCommandEnable:
+        case JotGLCommandDisable: {
+            BOOL enabled = command->type == JotGLCommandEnable;
+            if (enabled) {
+                JotGLProfile(JotGLCallEnable, glEnable(ints[0]));
+            } else {
+                JotGLProfile(JotGLCallDisable, glDisable(ints[0]));
+            }
+            UndfBOOL* tracked = JotGLContextEnabledCapability(context, ints[0]);
+            if (tracked) {
+                *tracked = enabled ? YEP : NOPE;
+            }
+            break;
+        }
+        case JotGLCommandBlendFunc:
+            JotGLProfile(JotGLCallBlendFunc, glBlendFunc(ints[0], ints[1]));
+            context->blend_sfactor = ints[0];
+            context->blend_dfactor = ints[1];
+            break;
+        case JotGLCommandViewport:
+            JotGLProfile(JotGLCallViewport, glViewport(ints[0], ints[1], ints[2], ints[3]));
+            context->viewport_x = ints[0];
+            context->viewport_y = ints[1];
+            context->viewport_width = ints[2];
+            context->viewport_height = ints[3];
+            break;
+        case JotGLCommandClearColor:
+            JotGLProfile(JotGLCallClearColor, glClearColor(floats[0], floats[1], floats[2], floats[3]));
+            context->lastClearRed = floats[0];
+            context->lastClearGreen = floats[1];
+            context->lastClearBlue = floats[2];
+            context->lastClearAlpha = floats[3];
+            break;
+        case JotGLCommandColorMask:
+            JotGLProfile(JotGLCallColorMask, glColorMask(ints[0], ints[1], ints[2], ints[3]));
+            context->enabled_glColorMask_red = ints[0] ? YEP : NOPE;
+            context->enabled_glColorMask_green = ints[1] ? YEP : NOPE;
+            context->enabled_glColorMask_blue = ints[2] ? YEP : NOPE;
+            context->enabled_glColorMask_alpha = ints[3] ? YEP : NOPE;
+            break;
+        case JotGLCommandStencilMask:
+            JotGLProfile(JotGLCallStencilMask, glStencilMask(ints[0]));
+            context->stencilMask = ints[0];
+            break;
+        case JotGLCommandStencilFunc:
+            JotGLProfile(JotGLCallStencilFunc, glStencilFunc(ints[0], ints[1], ints[2]));
+            context->stencilFuncFunc = ints[0];
+            context->stencilFuncRef = ints[1];
+            context->stencilFuncMask = ints[2];
+            break;
+        case JotGLCommandStencilOp:
+            JotGLProfile(JotGLCallStencilOp, glStencilOp(ints[0], ints[1], ints[2]));
+            context->stencilOpFail = ints[0];
+            context->stencilOpZfail = ints[1];
+            context->stencilOpZpass = ints[2];
+            break;
+        case JotGLCommandEnableVertexAttribArray:
+            JotGLProfile(JotGLCallEnableVertexAttribArray, glEnableVertexAttribArray(ints[0]));
+            break;
+        case JotGLCommandDisableVertexAttribArray:
+            JotGLProfile(JotGLCallDisableVertexAttribArray, glDisableVertexAttribArray(ints[0]));
+            break;
+        case JotGLCommandVertexAttribPointer:
+            JotGLProfile(JotGLCallVertexAttribPointer, glVertexAttribPointer(ints[0], ints[1], ints[2], ints[3], ints[4], command->pointer));
+            break;
+        case JotGLCommandUniform1i:
+            JotGLProfile(JotGLCallUniform, glUniform1i(ints[0], ints[1]));
+            break;
+        case JotGLCommandUniform1f:
+            JotGLProfile(JotGLCallUniform, glUniform1f(ints[0], floats[0]));
+            break;
+        case JotGLCommandUniform4fv:
+            JotGLProfile(JotGLCallUniform, glUniform4fv(ints[0], 1, floats));
+            break;
+        case JotGLCommandUniformMatrix4fv:
+            JotGLProfile(JotGLCallUniform, glUniformMatrix4fv(ints[0], 1, GL_FALSE, floats));
+            break;
+        case JotGLCommandBufferSubData:
+            JotGLProfile(JotGLCallBufferSubData, glBufferSubData(GL_ARRAY_BUFFER, ints[0], command->length, command->pointer));
+            JotGLProfileUpload(profiler, command->length);
+            break;
+        case JotGLCommandClear:
+            JotGLProfile(JotGLCallClear, glClear(ints[0]));
+            break;
+        case JotGLCommandDrawArrays:
+            JotGLProfile(JotGLCallDrawArrays, glDrawArrays(ints[0], ints[1], ints[2]));
+            break;
+        case JotGLCommandFlush:
+            JotGLProfile(JotGLCallFlush, glFlush());
+            context->needsFlush = NO;
+            break;
+        default:
+            break;
+    }
+}
+
+- (void)submitCommandBuffer:(JotGLCommandBuffer*)commandBuffer {
+    [self runBlock:^{
+        // gl may have been called directly since the last submit
+        JotGLCommandStateInvalidate(commandState);
+        JotGLCommandBufferSubmit(commandBuffer, commandState, (JotGLCommandBackend){ &JotGLContextExecuteCommand, (__bridge void*)self });
+        printOpenGLError();
+    }];
+}
+
+- (void)submitCommandQueue:(JotGLCommandQueue*)commandQueue {
+    [self runBlock:^{
+        JotGLCommandStateInvalidate(commandState);
+        JotGLCommandQueueSubmit(commandQueue, commandState, (JotGLCommandBackend){ &JotGLContextExecuteCommand, (__bridge void*)self });
+        printOpenGLError();
+    }];
+}
+
 #pragma mark - Color and Blend Mode
 
 - (void)glClearColor:(GLfloat)red and:(GLfloat)green and:(GLfloat)blue and:(GLfloat)alpha {
     ValidateCurrentContext;
     if (red != lastClearRed || green != lastClearGreen || blue != lastClearBlue || alpha != lastClearAlpha) {
-        glClearColor(red, green, blue, alpha);
+        JotGLProfile(JotGLCallClearColor, glClearColor(red, green, blue, alpha));
         lastClearRed = red;
         lastClearGreen = green;
         lastClearBlue = blue;
         lastClearAlpha = alpha;
+    } else {
+        JotGLProfileElided(profiler, JotGLCallClearColor);
     }
     printOpenGLError();
 }
@@ -832,7 +1099,9 @@ forStenciledPath:(UIBezierPath*)clippingPath
         blend_dfactor != dfactor) {
         blend_sfactor = sfactor;
         blend_dfactor = dfactor;
-        glBlendFunc(blend_sfactor, blend_dfactor);
+        JotGLProfile(JotGLCallBlendFunc, glBlendFunc(blend_sfactor, blend_dfactor));
+    } else {
+        JotGLProfileElided(profiler, JotGLCallBlendFunc);
     }
     printOpenGLError();
 }
@@ -840,11 +1109,13 @@ forStenciledPath:(UIBezierPath*)clippingPath
 - (void)glViewportWithX:(GLint)x y:(GLint)y width:(GLsizei)width height:(GLsizei)height {
     ValidateCurrentContext;
     if (viewport_x != x || viewport_y != y || viewport_width != width || viewport_height != height) {
-        glViewport(x, y, width, height);
+        JotGLProfile(JotGLCallViewport, glViewport(x, y, width, height));
         viewport_x = x;
         viewport_y = y;
         viewport_width = width;
         viewport_height = height;
+    } else {
+        JotGLProfileElided(profiler, JotGLCallViewport);
     }
     printOpenGLError();
 }
@@ -852,20 +1123,20 @@ forStenciledPath:(UIBezierPath*)clippingPath
 - (void)clear {
     ValidateCurrentContext;
     [self glClearColor:0 and:0 and:0 and:0];
-    glClear(GL_COLOR_BUFFER_BIT);
+    JotGLProfile(JotGLCallClear, glClear(GL_COLOR_BUFFER_BIT));
 }
 
 - (void)drawTriangleStripCount:(GLsizei)count withProgram:(JotGLProgram*)program {
     ValidateCurrentContext;
     [program use];
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, count);
+    JotGLProfile(JotGLCallDrawArrays, glDrawArrays(GL_TRIANGLE_STRIP, 0, count));
     printOpenGLError();
 }
 
 - (void)drawPointCount:(GLsizei)count withProgram:(JotGLProgram*)program {
     ValidateCurrentContext;
     [program use];
-    glDrawArrays(GL_POINTS, 0, count);
+    JotGLProfile(JotGLCallDrawArrays, glDrawArrays(GL_POINTS, 0, count));
     printOpenGLError();
 }
 
@@ -875,7 +1146,7 @@ forStenciledPath:(UIBezierPath*)clippingPath
     @autoreleasepool {
         // timing start
         CGFloat duration = BNRTimeBlock2(^{
-            glReadPixels(0, 0, size.width, size.height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+            JotGLProfile(JotGLCallReadPixels, glReadPixels(0, 0, size.width, size.height, GL_RGBA, GL_UNSIGNED_BYTE, data));
         });
         DebugLog(@"total2 = %f", duration);
     }
@@ -883,6 +1154,12 @@ forStenciledPath:(UIBezierPath*)clippingPath
     printOpenGLError();
 }
 
+- (void)readPixelsInto:(GLubyte*)data inRect:(CGRect)rect {
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    JotGLProfile(JotGLCallReadPixels, glReadPixels(rect.origin.x, rect.origin.y, rect.size.width, rect.size.height, GL_RGBA, GL_UNSIGNED_BYTE, data));
+    printOpenGLError();
+}
+
 #pragma mark - Generate Assets
 
 - (GLuint)generateTextureForSize:(CGSize)fullPixelSize withBytes:(const GLvoid*)imageData {
@@ -906,7 +1183,8 @@ forStenciledPath:(UIBezierPath*)clippingPath
     printOpenGLError();
     [self glTexParameteriWithPname:GL_TEXTURE_WRAP_T param:GL_CLAMP_TO_EDGE];
     printOpenGLError();
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, fullPixelSize.width, fullPixelSize.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, imageData);
+    JotGLProfile(JotGLCallTexImage2D, glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, fullPixelSize.width, fullPixelSize.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, imageData));
+    JotGLProfileUpload(profiler, imageData ? (size_t)fullPixelSize.width * (size_t)fullPixelSize.height * 4 : 0);
     printOpenGLError();
 
     [self unbindTexture];
@@ -915,22 +1193,33 @@ forStenciledPath:(UIBezierPath*)clippingPath
     return textureID;
 }
 
+- (void)updateTexture:(GLuint)textureId inRect:(CGRect)rect withBytes:(const GLvoid*)bytes {
+    ValidateCurrentContext;
+    [self bindTexture:textureId];
+    printOpenGLError();
+    JotGLProfile(JotGLCallTexSubImage2D, glTexSubImage2D(GL_TEXTURE_2D, 0, rect.origin.x, rect.origin.y, rect.size.width, rect.size.height, GL_RGBA, GL_UNSIGNED_BYTE, bytes));
+    JotGLProfileUpload(profiler, (size_t)rect.size.width * (size_t)rect.size.height * 4);
+    printOpenGLError();
+    [self unbindTexture];
+    printOpenGLError();
+}
+
 - (void)bindTexture:(GLuint)textureId {
     ValidateCurrentContext;
-    glBindTexture(GL_TEXTURE_2D, textureId);
+    JotGLProfile(JotGLCallBindTexture, glBindTexture(GL_TEXTURE_2D, textureId));
     printOpenGLError();
 }
 
 - (void)unbindTexture {
     ValidateCurrentContext;
-    glBindTexture(GL_TEXTURE_2D, 0);
+    JotGLProfile(JotGLCallBindTexture, glBindTexture(GL_TEXTURE_2D, 0));
     printOpenGLError();
 }
 
 - (void)deleteTexture:(GLuint)textureId {
     ValidateCurrentContext;
-    glDeleteTextures(1, &textureId);
-    printOpenGLError();
+    deletedObjectCount++;
+    JotGLDeleteName(&pendingTextureDeletes, batchedDeleteDepth > 0, textureId, glDeleteTextures);
 }
 
 - (GLuint)generateFramebufferWithTextureBacking:(JotGLTexture*)texture {
@@ -1008,18 +1297,22 @@ forStenciledPath:(UIBezierPath*)clippingPath
 - (void)bindFramebuffer:(GLuint)framebuffer {
     ValidateCurrentContext;
     if (framebuffer && currentlyBoundFramebuffer != framebuffer) {
-        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        JotGLProfile(JotGLCallBindFramebuffer, glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
         currentlyBoundFramebuffer = framebuffer;
     } else if (!framebuffer) {
         @throw [NSException exceptionWithName:@"GLBindFramebufferExcpetion" reason:@"Trying to bind nil framebuffer" userInfo:nil];
+    } else {
+        JotGLProfileElided(profiler, JotGLCallBindFramebuffer);
     }
     printOpenGLError();
 }
 - (void)unbindFramebuffer {
     ValidateCurrentContext;
     if (currentlyBoundFramebuffer != 0) {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        JotGLProfile(JotGLCallBindFramebuffer, glBindFramebuffer(GL_FRAMEBUFFER, 0));
         currentlyBoundFramebuffer = 0;
+    } else {
+        JotGLProfileElided(profiler, JotGLCallBindFramebuffer);
     }
     printOpenGLError();
 }
@@ -1029,8 +1322,8 @@ forStenciledPath:(UIBezierPath*)clippingPath
     if (framebufferID && currentlyBoundFramebuffer == framebufferID) {
         @throw [NSException exceptionWithName:@"GLDeleteBoundBufferException" reason:@"deleting currently boudn buffer" userInfo:nil];
     }
-    glDeleteFramebuffers(1, &framebufferID);
-    printOpenGLError();
+    deletedObjectCount++;
+    JotGLDeleteName(&pendingFramebufferDeletes, batchedDeleteDepth > 0, framebufferID, glDeleteFramebuffers);
 }
 
 - (void)deleteRenderbuffer:(GLuint)viewRenderbuffer {
@@ -1038,17 +1331,19 @@ forStenciledPath:(UIBezierPath*)clippingPath
     if (viewRenderbuffer && currentlyBoundRenderbuffer == viewRenderbuffer) {
         @throw [NSException exceptionWithName:@"GLDeleteBoundBufferException" reason:@"deleting currently boudn buffer" userInfo:nil];
     }
-    glDeleteRenderbuffers(1, &viewRenderbuffer);
-    printOpenGLError();
+    deletedObjectCount++;
+    JotGLDeleteName(&pendingRenderbufferDeletes, batchedDeleteDepth > 0, viewRenderbuffer, glDeleteRenderbuffers);
 }
 
 - (void)bindRenderbuffer:(GLuint)renderBufferId {
     ValidateCurrentContext;
     if (renderBufferId && currentlyBoundRenderbuffer != renderBufferId) {
-        glBindRenderbuffer(GL_RENDERBUFFER, renderBufferId);
+        JotGLProfile(JotGLCallBindRenderbuffer, glBindRenderbuffer(GL_RENDERBUFFER, renderBufferId));
         currentlyBoundRenderbuffer = renderBufferId;
     } else if (!renderBufferId) {
         @throw [NSException exceptionWithName:@"GLBindRenderbufferExceptoin" reason:@"trying to bind nil renderbuffer" userInfo:nil];
+    } else {
+        JotGLProfileElided(profiler, JotGLCallBindRenderbuffer);
     }
     printOpenGLError();
 }
@@ -1056,8 +1351,10 @@ forStenciledPath:(UIBezierPath*)clippingPath
 - (void)unbindRenderbuffer {
     ValidateCurrentContext;
     if (currentlyBoundRenderbuffer) {
-        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        JotGLProfile(JotGLCallBindRenderbuffer, glBindRenderbuffer(GL_RENDERBUFFER, 0));
         currentlyBoundRenderbuffer = 0;
+    } else {
+        JotGLProfileElided(profiler, JotGLCallBindRenderbuffer);
     }
     printOpenGLError();
 }
@@ -1065,6 +1362,7 @@ forStenciledPath:(UIBezierPath*)clippingPath
 - (BOOL)presentRenderbuffer {
     ValidateCurrentContext;
     printOpenGLError();
+    JotGLProfileEndFrame(profiler);
     return [super presentRenderbuffer:GL_RENDERBUFFER];
 }
 
@@ -1122,7 +1420,8 @@ static void* zeroedDataCache = nil;
     [self bindArrayBuffer:vbo];
     @synchronized([JotGLContext class]) {
         // initialize the buffer to zero'd data
-        glBufferData(GL_ARRAY_BUFFER, mallocSize, zeroedDataCache, GL_DYNAMIC_DRAW);
+        JotGLProfile(JotGLCallBufferData, glBufferData(GL_ARRAY_BUFFER, mallocSize, zeroedDataCache, GL_DYNAMIC_DRAW));
+        JotGLProfileUpload(profiler, mallocSize);
     }
     // unbind after alloc
     [self unbindArrayBuffer];
@@ -1131,23 +1430,24 @@ static void* zeroedDataCache = nil;
 }
 
 - (void)bindArrayBuffer:(GLuint)buffer {
-    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    JotGLProfile(JotGLCallBindBuffer, glBindBuffer(GL_ARRAY_BUFFER, buffer));
     printOpenGLError();
 }
 
 - (void)updateArrayBufferWithBytes:(const GLvoid*)bytes atOffset:(GLintptr)offset andLength:(GLsizeiptr)len {
-    glBufferSubData(GL_ARRAY_BUFFER, offset, len, bytes);
+    JotGLProfile(JotGLCallBufferSubData, glBufferSubData(GL_ARRAY_BUFFER, offset, len, bytes));
+    JotGLProfileUpload(profiler, len);
     printOpenGLError();
 }
 
 - (void)unbindArrayBuffer {
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    JotGLProfile(JotGLCallBindBuffer, glBindBuffer(GL_ARRAY_BUFFER, 0));
     printOpenGLError();
 }
 
 - (void)deleteArrayBuffer:(GLuint)buffer {
-    glDeleteBuffers(1, &buffer);
-    printOpenGLError();
+    deletedObjectCount++;
+    JotGLDeleteName(&pendingBufferDeletes, batchedDeleteDepth > 0, buffer, glDeleteBuffers);
 }
 
 #pragma mark - Dealloc
@@ -1160,6 +1460,7 @@ static void* zeroedDataCache = nil;
 
     [self runBlock:^{
         @autoreleasepool {
+            [self flushBatchedDeletes];
             [contextProperties removeAllObjects];
             coloredPointProgram = nil;
             colorlessPointProgram = nil;
@@ -1167,6 +1468,8 @@ static void* zeroedDataCache = nil;
             stencilProgram = nil;
         }
     }];
+    JotGLCommandStateFree(commandState);
+    JotGLProfilerFree(profiler);
 }
 
 - (NSString*)description {
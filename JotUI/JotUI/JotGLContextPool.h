@@ -0,0 +1,53 @@
+//
+//  JotGLContextPool.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "JotGLContext.h"
+
+// the most contexts that are checked out at once by default
+#define kJotGLContextPoolDefaultMaxContexts 2
+
+
+/**
+ * A bounded pool of background contexts in the main context's
+ * sharegroup, for loading and exporting pages off the main thread.
+ *
+ * Contexts are built as they're needed and kept for reuse, so their
+ * programs are only compiled once instead of for every export. At most
+ * maxContexts are checked out at once, which bounds how many pages load
+ * and export in parallel. Any others wait for a context to be returned.
+ *
+ * A thread that already has a context checked out reuses it for nested
+ * blocks, instead of waiting on itself.
+ *
+ * warmUp builds the contexts and their programs ahead of time, so the
+ * first page load or export doesn't pay for them.
+ */
+@interface JotGLContextPool : NSObject
+
++ (JotGLContextPool*)sharedPool;
+
+@property(nonatomic, assign) NSUInteger maxContexts;
+
+// the sharegroup the contexts are built in, or nil
+// until setGLContext: is called
+@property(nonatomic, readonly) EAGLSharegroup* sharegroup;
+// the contexts that have been built and are kept for reuse
+@property(nonatomic, readonly) NSUInteger contextCount;
+
+- (void)setGLContext:(JotGLContext*)context;
+
+// checks out a context, waiting for one if needed, and runs the block
+// with it pushed. the context is flushed and returned to the pool after
+- (void)runBlock:(void (^)(JotGLContext* context))block;
+
+// builds up to maxContexts contexts and their programs in the
+// background. does nothing until setGLContext: is called
+- (void)warmUp;
+
+@end
@@ -0,0 +1,180 @@
+//
+//  JotGLContextPool.m
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import "JotGLContextPool.h"
+
+// the thread dictionary key for the context that a thread has checked out
+static NSString* const kJotGLContextPoolThreadKey = @"JotGLContextPoolContext";
+
+
+@implementation JotGLContextPool {
+    NSCondition* condition;
+    // contexts that aren't checked out, most recently returned last
+    NSMutableArray* idleContexts;
+    NSUInteger checkedOutCount;
+}
+
+@synthesize maxContexts;
+@synthesize sharegroup;
+@synthesize contextCount;
+
++ (JotGLContextPool*)sharedPool {
+    static dispatch_once_t onceToken;
+    static JotGLContextPool* sharedPool;
+    dispatch_once(&onceToken, ^{
+        sharedPool = [[JotGLContextPool alloc] init];
+    });
+    return sharedPool;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        condition = [[NSCondition alloc] init];
+        idleContexts = [NSMutableArray array];
+        maxContexts = kJotGLContextPoolDefaultMaxContexts;
+    }
+    return self;
+}
+
+- (void)setGLContext:(JotGLContext*)context {
+    [condition lock];
+    if (sharegroup != context.sharegroup) {
+        // contexts from another sharegroup can't see its textures
+        sharegroup = context.sharegroup;
+        contextCount -= [idleContexts count];
+        [idleContexts removeAllObjects];
+    }
+    [condition unlock];
+}
+
+- (EAGLSharegroup*)sharegroup {
+    [condition lock];
+    EAGLSharegroup* ret = sharegroup;
+    [condition unlock];
+    return ret;
+}
+
+- (NSUInteger)contextCount {
+    [condition lock];
+    NSUInteger ret = contextCount;
+    [condition unlock];
+    return ret;
+}
+
+- (void)setMaxContexts:(NSUInteger)_maxContexts {
+    if (!_maxContexts) {
+        @throw [NSException exceptionWithName:@"JotGLContextPoolException" reason:@"the pool needs at least one context" userInfo:nil];
+    }
+    [condition lock];
+    maxContexts = _maxContexts;
+    while ([idleContexts count] > maxContexts) {
+        [idleContexts removeObjectAtIndex:0];
+        contextCount--;
+    }
+    [condition broadcast];
+    [condition unlock];
+}
+
+#pragma mark - Running Blocks
+
+- (void)runBlock:(void (^)(JotGLContext* context))block {
+    NSMutableDictionary* threadDictionary = [[NSThread currentThread] threadDictionary];
+    JotGLContext* context = threadDictionary[kJotGLContextPoolThreadKey];
+    if (context) {
+        [context runBlock:^{
+            block(context);
+        }];
+        return;
+    }
+
+    context = [self checkOutContext];
+    threadDictionary[kJotGLContextPoolThreadKey] = context;
+    [context runBlock:^{
+        block(context);
+        // the next thread to check it out may
+        // not share its work with this one
+        [context flush];
+    }];
+    // pooled contexts never present, so each load or
+    // export they run is a profiler frame of its own
+    JotGLProfileEndFrame([context profiler]);
+    [threadDictionary removeObjectForKey:kJotGLContextPoolThreadKey];
+    [self returnContext:context];
+}
+
+- (void)warmUp {
+    if (![self sharegroup]) {
+        return;
+    }
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+        @autoreleasepool {
+            // check out every context before warming any, so that
+            // maxContexts are built instead of one being reused
+            NSUInteger count = [self maxContexts];
+            NSMutableArray* contexts = [NSMutableArray array];
+            for (NSUInteger i = 0; i < count; i++) {
+                [contexts addObject:[self checkOutContext]];
+            }
+            NSMutableDictionary* threadDictionary = [[NSThread currentThread] threadDictionary];
+            for (JotGLContext* context in contexts) {
+                threadDictionary[kJotGLContextPoolThreadKey] = context;
+                [context runBlock:^{
+                    [context warmUpPrograms];
+                    [context flush];
+                }];
+                [threadDictionary removeObjectForKey:kJotGLContextPoolThreadKey];
+                [self returnContext:context];
+            }
+        }
+    });
+}
+
+#pragma mark - Private
+
+- (JotGLContext*)checkOutContext {
+    [condition lock];
+    while (checkedOutCount >= maxContexts) {
+        [condition wait];
+    }
+    checkedOutCount++;
+    JotGLContext* context = [idleContexts lastObject];
+    EAGLSharegroup* contextSharegroup = sharegroup;
+    if (context) {
+        [idleContexts removeLastObject];
+    } else {
+        contextCount++;
+    }
+    [condition unlock];
+
+    if (!context) {
+        if (!contextSharegroup) {
+            @throw [NSException exceptionWithName:@"JotGLContextPoolException" reason:@"the pool can't build contexts until it's given a GL context" userInfo:nil];
+        }
+        __block __weak JotGLContext* weakContext;
+        context = [[JotGLContext alloc] initWithName:@"JotPooledContext" andSharegroup:contextSharegroup andValidateThreadWith:^BOOL {
+            // only the thread that checked it out can use it
+            return [[NSThread currentThread] threadDictionary][kJotGLContextPoolThreadKey] == weakContext;
+        }];
+        weakContext = context;
+    }
+    return context;
+}
+
+- (void)returnContext:(JotGLContext*)context {
+    [condition lock];
+    checkedOutCount--;
+    if (context.sharegroup == sharegroup && [idleContexts count] < maxContexts) {
+        [idleContexts addObject:context];
+    } else {
+        contextCount--;
+    }
+    [condition signal];
+    [condition unlock];
+}
+
+@end
@@ -0,0 +1,86 @@
+//
+//  JotGLMockBackend.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#include "JotGLMockBackend.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct JotGLMockBackend {
+    JotGLCommand* commands;
+    size_t commandCount;
+    size_t commandCapacity;
+    size_t countsByType[JotGLCommandTypeCount];
+    size_t uploadedBytes;
+};
+
+static void JotGLMockBackendExecute(void* context, const JotGLCommand* command) {
+    JotGLMockBackend* mock = context;
+    if (command->type < JotGLCommandTypeCount) {
+        mock->countsByType[command->type]++;
+    }
+    if (command->type == JotGLCommandBufferSubData) {
+        mock->uploadedBytes += command->length;
+    }
+    if (mock->commandCount == mock->commandCapacity) {
+        size_t capacity = mock->commandCapacity ? mock->commandCapacity * 2 : 64;
+        JotGLCommand* commands = realloc(mock->commands, capacity * sizeof(JotGLCommand));
+        if (commands) {
+            mock->commands = commands;
+            mock->commandCapacity = capacity;
+        }
+    }
+    if (mock->commandCount < mock->commandCapacity) {
+        JotGLCommand* kept = &mock->commands[mock->commandCount++];
+        *kept = *command;
+        if (command->type == JotGLCommandBufferSubData) {
+            kept->pointer = NULL;
+        }
+    }
+}
+
+JotGLMockBackend* JotGLMockBackendCreate(void) {
+    return calloc(1, sizeof(JotGLMockBackend));
+}
+
+JotGLCommandBackend JotGLMockBackendGetBackend(JotGLMockBackend* mock) {
+    JotGLCommandBackend backend = { &JotGLMockBackendExecute, mock };
+    return backend;
+}
+
+size_t JotGLMockBackendGetCommandCount(JotGLMockBackend* mock) {
+    return mock->commandCount;
+}
+
+size_t JotGLMockBackendGetCountOfType(JotGLMockBackend* mock, JotGLCommandType type) {
+    return type < JotGLCommandTypeCount ? mock->countsByType[type] : 0;
+}
+
+size_t JotGLMockBackendGetUploadedBytes(JotGLMockBackend* mock) {
+    return mock->uploadedBytes;
+}
+
+bool JotGLMockBackendGetCommand(JotGLMockBackend* mock, size_t index, JotGLCommand* command) {
+    if (index >= mock->commandCount) {
+        return false;
+    }
+    *command = mock->commands[index];
+    return true;
+}
+
+void JotGLMockBackendReset(JotGLMockBackend* mock) {
+    mock->commandCount = 0;
+    mock->uploadedBytes = 0;
+    memset(mock->countsByType, 0, sizeof(mock->countsByType));
+}
+
+void JotGLMockBackendFree(JotGLMockBackend* mock) {
+    if (mock) {
+        free(mock->commands);
+        free(mock);
+    }
+}
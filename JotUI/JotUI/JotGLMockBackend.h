@@ -0,0 +1,52 @@
+//
+//  JotGLMockBackend.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#ifndef JotGLMockBackend_h
+#define JotGLMockBackend_h
+
+#include "JotGLCommandBuffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A command backend that doesn't call GL, and instead keeps every
+ * command it's given so they can be counted and checked, such as in
+ * tests that run without a GPU.
+ *
+ * Commands are kept as they were submitted, except that uploads keep
+ * their length but not their bytes, which belong to the command buffer.
+ */
+typedef struct JotGLMockBackend JotGLMockBackend;
+
+JotGLMockBackend* JotGLMockBackendCreate(void);
+
+// a backend that records into the mock, which must outlive it
+JotGLCommandBackend JotGLMockBackendGetBackend(JotGLMockBackend* mock);
+
+size_t JotGLMockBackendGetCommandCount(JotGLMockBackend* mock);
+
+size_t JotGLMockBackendGetCountOfType(JotGLMockBackend* mock, JotGLCommandType type);
+
+// the bytes uploaded by every BufferSubData command
+size_t JotGLMockBackendGetUploadedBytes(JotGLMockBackend* mock);
+
+// copies the index'th command into command. returns false if
+// there aren't that many commands
+bool JotGLMockBackendGetCommand(JotGLMockBackend* mock, size_t index, JotGLCommand* command);
+
+void JotGLMockBackendReset(JotGLMockBackend* mock);
+
+void JotGLMockBackendFree(JotGLMockBackend* mock);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JotGLMockBackend_h */
@@ -19,6 +19,10 @@
 
 @property(nonatomic, assign) GLfloat rotation;
 
+// vertices are in page points. pointScale is the number
+// of pixels per point, and defaults to 1
+@property(nonatomic, assign) GLfloat pointScale;
+
 - (GLuint)attributeVertexIndex;
 
 - (GLuint)attributePointSizeIndex;
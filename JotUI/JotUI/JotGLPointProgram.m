@@ -10,16 +10,27 @@
 #import "JotGLProgram+Private.h"
 
 
-@implementation JotGLPointProgram
+@implementation JotGLPointProgram {
+    GLuint uniformRotationIndex;
+    GLuint uniformPointScaleIndex;
+    // the values last sent to the program
+    GLfloat uploadedRotation;
+    GLfloat uploadedPointScale;
+    BOOL hasUploadedUniforms;
+}
 
 @synthesize rotation;
+@synthesize pointScale;
 
 - (id)initWithVertexShaderFilename:(NSString*)vShaderFilename fragmentShaderFilename:(NSString*)fShaderFilename withAttributes:(NSArray<NSString*>*)attributes andUniforms:(NSArray<NSString*>*)uniforms {
     if (self = [super initWithVertexShaderFilename:vShaderFilename
                             fragmentShaderFilename:fShaderFilename
                                     withAttributes:[@[@"inVertex", @"pointSize"] arrayByAddingObjectsFromArray:attributes]
-                                       andUniforms:[@[@"MVP", @"texture", @"inRotation"] arrayByAddingObjectsFromArray:uniforms]]) {
+                                       andUniforms:[@[@"MVP", @"texture", @"inRotation", @"pointScale"] arrayByAddingObjectsFromArray:uniforms]]) {
         self.rotation = 0; // M_PI / 5;
+        self.pointScale = 1;
+        uniformRotationIndex = [self uniformIndex:@"inRotation"];
+        uniformPointScaleIndex = [self uniformIndex:@"pointScale"];
     }
     return self;
 }
@@ -37,13 +48,34 @@
 }
 
 - (GLuint)uniformRotationIndex {
-    return [self uniformIndex:@"inRotation"];
+    return uniformRotationIndex;
+}
+
+- (GLuint)uniformPointScaleIndex {
+    return uniformPointScaleIndex;
+}
+
+- (GLKMatrix4)modelViewMatrix {
+    // a new screen scale only changes the matrix, instead of every vertex
+    return GLKMatrix4MakeScale(self.pointScale, self.pointScale, 1);
 }
 
 - (void)use {
     [super use];
 
-    glUniform1f([self uniformRotationIndex], self.rotation);
+    if (!hasUploadedUniforms || uploadedRotation != self.rotation) {
+        JotGLProfileCall(JotGLCurrentProfiler(), JotGLCallUniform, glUniform1f(uniformRotationIndex, self.rotation));
+        uploadedRotation = self.rotation;
+    } else {
+        JotGLProfileElided(JotGLCurrentProfiler(), JotGLCallUniform);
+    }
+    if (!hasUploadedUniforms || uploadedPointScale != self.pointScale) {
+        JotGLProfileCall(JotGLCurrentProfiler(), JotGLCallUniform, glUniform1f(uniformPointScaleIndex, self.pointScale));
+        uploadedPointScale = self.pointScale;
+    } else {
+        JotGLProfileElided(JotGLCurrentProfiler(), JotGLCallUniform);
+    }
+    hasUploadedUniforms = YES;
 }
 
 @end
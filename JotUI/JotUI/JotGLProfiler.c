@@ -0,0 +1,261 @@
+//
+//  JotGLProfiler.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#include "JotGLProfiler.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char* JotGLCallNames[JotGLCallCount] = {
+    "glGetError",
+    "glFlush",
+    "glFinish",
+    "glClear",
+    "glDrawArrays",
+    "glReadPixels",
+    "glBindFramebuffer",
+    "glBindRenderbuffer",
+    "glBindTexture",
+    "glBindBuffer",
+    "glUseProgram",
+    "glEnable",
+    "glDisable",
+    "glBlendFunc",
+    "glViewport",
+    "glScissor",
+    "glClearColor",
+    "glColorMask",
+    "glDepthMask",
+    "glStencilMask",
+    "glStencilFunc",
+    "glStencilOp",
+    "glEnableVertexAttribArray",
+    "glDisableVertexAttribArray",
+    "glVertexAttribPointer",
+    "glTexParameteri",
+    "glUniform",
+    "glTexImage2D",
+    "glTexSubImage2D",
+    "glBufferData",
+    "glBufferSubData"
+};
+
+struct JotGLProfiler {
+    pthread_mutex_t lock;
+    JotGLProfileFrame current;
+    JotGLProfileFrame totals;
+    // a ring of the most recent frames
+    JotGLProfileFrame frames[kJotGLProfilerFrameHistory];
+    uint64_t frameCount;
+};
+
+const char* JotGLCallGetName(JotGLCall call) {
+    return call < JotGLCallCount ? JotGLCallNames[call] : "unknown";
+}
+
+uint64_t JotGLProfilerNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+JotGLProfiler* JotGLProfilerCreate(void) {
+    JotGLProfiler* profiler = calloc(1, sizeof(JotGLProfiler));
+    if (profiler) {
+        pthread_mutex_init(&profiler->lock, NULL);
+    }
+    return profiler;
+}
+
+#pragma mark - Recording
+
+void JotGLProfilerRecordCall(JotGLProfiler* profiler, JotGLCall call, uint64_t nanoseconds) {
+    if (!profiler || call >= JotGLCallCount) {
+        return;
+    }
+    pthread_mutex_lock(&profiler->lock);
+    profiler->current.callCounts[call]++;
+    profiler->current.callNanoseconds[call] += nanoseconds;
+    pthread_mutex_unlock(&profiler->lock);
+}
+
+void JotGLProfilerRecordElided(JotGLProfiler* profiler, JotGLCall call) {
+    if (!profiler || call >= JotGLCallCount) {
+        return;
+    }
+    pthread_mutex_lock(&profiler->lock);
+    profiler->current.elidedCounts[call]++;
+    pthread_mutex_unlock(&profiler->lock);
+}
+
+void JotGLProfilerRecordUpload(JotGLProfiler* profiler, size_t bytes) {
+    if (!profiler) {
+        return;
+    }
+    pthread_mutex_lock(&profiler->lock);
+    profiler->current.uploadedBytes += bytes;
+    pthread_mutex_unlock(&profiler->lock);
+}
+
+void JotGLProfilerEndFrame(JotGLProfiler* profiler) {
+    if (!profiler) {
+        return;
+    }
+    pthread_mutex_lock(&profiler->lock);
+    JotGLProfileFrame* current = &profiler->current;
+    JotGLProfileFrame* totals = &profiler->totals;
+    for (size_t call = 0; call < JotGLCallCount; call++) {
+        totals->callCounts[call] += current->callCounts[call];
+        totals->callNanoseconds[call] += current->callNanoseconds[call];
+        totals->elidedCounts[call] += current->elidedCounts[call];
+    }
+    totals->uploadedBytes += current->uploadedBytes;
+
+    profiler->frameCount++;
+    current->frameNumber = profiler->frameCount;
+    profiler->frames[(profiler->frameCount - 1) % kJotGLProfilerFrameHistory] = *current;
+    memset(current, 0, sizeof(JotGLProfileFrame));
+    pthread_mutex_unlock(&profiler->lock);
+}
+
+#pragma mark - Reading
+
+uint64_t JotGLProfilerGetFrameCount(JotGLProfiler* profiler) {
+    if (!profiler) {
+        return 0;
+    }
+    pthread_mutex_lock(&profiler->lock);
+    uint64_t frameCount = profiler->frameCount;
+    pthread_mutex_unlock(&profiler->lock);
+    return frameCount;
+}
+
+// must be called while holding the lock
+static bool JotGLProfilerCopyFrame(JotGLProfiler* profiler, size_t framesAgo, JotGLProfileFrame* frame) {
+    if (framesAgo >= kJotGLProfilerFrameHistory || framesAgo >= profiler->frameCount) {
+        return false;
+    }
+    *frame = profiler->frames[(profiler->frameCount - 1 - framesAgo) % kJotGLProfilerFrameHistory];
+    return true;
+}
+
+bool JotGLProfilerGetFrame(JotGLProfiler* profiler, size_t framesAgo, JotGLProfileFrame* frame) {
+    if (!profiler) {
+        return false;
+    }
+    pthread_mutex_lock(&profiler->lock);
+    bool found = JotGLProfilerCopyFrame(profiler, framesAgo, frame);
+    pthread_mutex_unlock(&profiler->lock);
+    return found;
+}
+
+void JotGLProfilerGetTotals(JotGLProfiler* profiler, JotGLProfileFrame* totals) {
+    if (!profiler) {
+        memset(totals, 0, sizeof(JotGLProfileFrame));
+        return;
+    }
+    pthread_mutex_lock(&profiler->lock);
+    *totals = profiler->totals;
+    pthread_mutex_unlock(&profiler->lock);
+}
+
+void JotGLProfilerReset(JotGLProfiler* profiler) {
+    if (!profiler) {
+        return;
+    }
+    pthread_mutex_lock(&profiler->lock);
+    memset(&profiler->current, 0, sizeof(JotGLProfileFrame));
+    memset(&profiler->totals, 0, sizeof(JotGLProfileFrame));
+    profiler->frameCount = 0;
+    pthread_mutex_unlock(&profiler->lock);
+}
+
+#pragma mark - Traces
+
+// appends like snprintf, and returns the length the trace needs so far
+static size_t JotGLProfilerAppend(char* buffer, size_t length, size_t written, const char* format, ...) __attribute__((format(printf, 4, 5)));
+
+static size_t JotGLProfilerAppend(char* buffer, size_t length, size_t written, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    char* end = written < length ? buffer + written : NULL;
+    int count = vsnprintf(end, end ? length - written : 0, format, args);
+    va_end(args);
+    return written + (count > 0 ? (size_t)count : 0);
+}
+
+static size_t JotGLProfilerAppendFrame(char* buffer, size_t length, size_t written, const char* label, const JotGLProfileFrame* frame) {
+    for (size_t call = 0; call < JotGLCallCount; call++) {
+        if (frame->callCounts[call] || frame->elidedCounts[call]) {
+            written = JotGLProfilerAppend(buffer, length, written, "%s,%s,%llu,%llu,%llu,\n", label, JotGLCallNames[call],
+                                          (unsigned long long)frame->callCounts[call], (unsigned long long)frame->callNanoseconds[call],
+                                          (unsigned long long)frame->elidedCounts[call]);
+        }
+    }
+    return JotGLProfilerAppend(buffer, length, written, "%s,uploads,,,,%llu\n", label, (unsigned long long)frame->uploadedBytes);
+}
+
+size_t JotGLProfilerWriteTrace(JotGLProfiler* profiler, char* buffer, size_t length) {
+    if (length) {
+        buffer[0] = '\0';
+    }
+    size_t written = JotGLProfilerAppend(buffer, length, 0, "frame,call,count,nanoseconds,elided,bytes\n");
+    if (!profiler) {
+        return written;
+    }
+
+    pthread_mutex_lock(&profiler->lock);
+    size_t keptCount = profiler->frameCount < kJotGLProfilerFrameHistory ? (size_t)profiler->frameCount : kJotGLProfilerFrameHistory;
+    for (size_t framesAgo = keptCount; framesAgo > 0; framesAgo--) {
+        JotGLProfileFrame frame;
+        if (JotGLProfilerCopyFrame(profiler, framesAgo - 1, &frame)) {
+            char label[24];
+            snprintf(label, sizeof(label), "%llu", (unsigned long long)frame.frameNumber);
+            written = JotGLProfilerAppendFrame(buffer, length, written, label, &frame);
+        }
+    }
+    written = JotGLProfilerAppendFrame(buffer, length, written, "total", &profiler->totals);
+    pthread_mutex_unlock(&profiler->lock);
+    return written;
+}
+
+void JotGLProfilerFree(JotGLProfiler* profiler) {
+    if (profiler) {
+        pthread_mutex_destroy(&profiler->lock);
+        free(profiler);
+    }
+}
+
+#pragma mark - Frames
+
+uint64_t JotGLProfileFrameGetCallCount(const JotGLProfileFrame* frame) {
+    uint64_t count = 0;
+    for (size_t call = 0; call < JotGLCallCount; call++) {
+        count += frame->callCounts[call];
+    }
+    return count;
+}
+
+uint64_t JotGLProfileFrameGetElidedCount(const JotGLProfileFrame* frame) {
+    uint64_t count = 0;
+    for (size_t call = 0; call < JotGLCallCount; call++) {
+        count += frame->elidedCounts[call];
+    }
+    return count;
+}
+
+uint64_t JotGLProfileFrameGetNanoseconds(const JotGLProfileFrame* frame) {
+    uint64_t nanoseconds = 0;
+    for (size_t call = 0; call < JotGLCallCount; call++) {
+        nanoseconds += frame->callNanoseconds[call];
+    }
+    return nanoseconds;
+}
@@ -0,0 +1,169 @@
+//
+//  JotGLProfiler.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#ifndef JotGLProfiler_h
+#define JotGLProfiler_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// set to 1, such as in the build's preprocessor macros, to count and
+// time the gl calls of every JotGLContext. when it's 0 the calls aren't
+// wrapped at all, and contexts don't have a profiler
+#ifndef kJotEnableGLProfiling
+#define kJotEnableGLProfiling 0
+#endif
+
+// the most recent frames that a profiler keeps
+#define kJotGLProfilerFrameHistory 60
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Counts and times the gl calls of one context, one frame at a time.
+ *
+ * For each gl entry point, a frame counts the calls that were made and
+ * the time spent in them, and the calls that the context's state cache
+ * skipped because they wouldn't have changed anything. Frames also count
+ * the bytes uploaded to textures and buffers. A frame ends each time the
+ * context presents, or whenever JotGLProfilerEndFrame is called.
+ * JotGLContextPool ends one each time a context is returned to it, so
+ * every background load and export is a frame of its own.
+ *
+ * The last kJotGLProfilerFrameHistory frames are kept, along with the
+ * totals of every frame since the profiler was reset, and can be read or
+ * written out as a trace from any thread. Every function does nothing
+ * when given a NULL profiler.
+ */
+typedef struct JotGLProfiler JotGLProfiler;
+
+typedef enum {
+    JotGLCallGetError,
+    JotGLCallFlush,
+    JotGLCallFinish,
+    JotGLCallClear,
+    JotGLCallDrawArrays,
+    JotGLCallReadPixels,
+    JotGLCallBindFramebuffer,
+    JotGLCallBindRenderbuffer,
+    JotGLCallBindTexture,
+    JotGLCallBindBuffer,
+    JotGLCallUseProgram,
+    JotGLCallEnable,
+    JotGLCallDisable,
+    JotGLCallBlendFunc,
+    JotGLCallViewport,
+    JotGLCallScissor,
+    JotGLCallClearColor,
+    JotGLCallColorMask,
+    JotGLCallDepthMask,
+    JotGLCallStencilMask,
+    JotGLCallStencilFunc,
+    JotGLCallStencilOp,
+    JotGLCallEnableVertexAttribArray,
+    JotGLCallDisableVertexAttribArray,
+    JotGLCallVertexAttribPointer,
+    JotGLCallTexParameter,
+    JotGLCallUniform,
+    JotGLCallTexImage2D,
+    JotGLCallTexSubImage2D,
+    JotGLCallBufferData,
+    JotGLCallBufferSubData,
+    JotGLCallCount
+} JotGLCall;
+
+typedef struct {
+    // counts every frame, starting at 1, and is 0 for totals
+    uint64_t frameNumber;
+    uint64_t callCounts[JotGLCallCount];
+    uint64_t callNanoseconds[JotGLCallCount];
+    // the calls that the state cache didn't make
+    uint64_t elidedCounts[JotGLCallCount];
+    uint64_t uploadedBytes;
+} JotGLProfileFrame;
+
+const char* JotGLCallGetName(JotGLCall call);
+
+// a monotonic clock, for timing calls
+uint64_t JotGLProfilerNow(void);
+
+JotGLProfiler* JotGLProfilerCreate(void);
+
+void JotGLProfilerRecordCall(JotGLProfiler* profiler, JotGLCall call, uint64_t nanoseconds);
+
+void JotGLProfilerRecordElided(JotGLProfiler* profiler, JotGLCall call);
+
+void JotGLProfilerRecordUpload(JotGLProfiler* profiler, size_t bytes);
+
+// keeps the current frame and starts the next
+void JotGLProfilerEndFrame(JotGLProfiler* profiler);
+
+// the number of frames that have ended since the last reset
+uint64_t JotGLProfilerGetFrameCount(JotGLProfiler* profiler);
+
+// copies a frame that's ended, 0 being the most recent. returns
+// false if that frame isn't kept
+bool JotGLProfilerGetFrame(JotGLProfiler* profiler, size_t framesAgo, JotGLProfileFrame* frame);
+
+// copies the sums of every frame that's ended since the last reset
+void JotGLProfilerGetTotals(JotGLProfiler* profiler, JotGLProfileFrame* totals);
+
+// forgets every frame and the totals
+void JotGLProfilerReset(JotGLProfiler* profiler);
+
+// writes the kept frames as CSV, one row for each of their gl entry points
+// that were called or elided, with the totals last. writes at most length
+// bytes including the terminator, and returns the length the whole trace
+// needs without it, like snprintf
+size_t JotGLProfilerWriteTrace(JotGLProfiler* profiler, char* buffer, size_t length);
+
+void JotGLProfilerFree(JotGLProfiler* profiler);
+
+// the totals of the frame, across every entry point
+uint64_t JotGLProfileFrameGetCallCount(const JotGLProfileFrame* frame);
+
+uint64_t JotGLProfileFrameGetElidedCount(const JotGLProfileFrame* frame);
+
+uint64_t JotGLProfileFrameGetNanoseconds(const JotGLProfileFrame* frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#pragma mark - Instrumentation
+
+// wraps gl calls so that they're profiled when profiling is enabled, and
+// compile to just the call when it isn't. profiler isn't evaluated when
+// profiling is disabled
+#if kJotEnableGLProfiling
+#define JotGLProfileCall(profiler, call, statement)                                     \
+    do {                                                                                \
+        JotGLProfiler* _jotProfiler = (profiler);                                       \
+        uint64_t _jotStart = _jotProfiler ? JotGLProfilerNow() : 0;                     \
+        statement;                                                                      \
+        if (_jotProfiler) {                                                             \
+            JotGLProfilerRecordCall(_jotProfiler, (call), JotGLProfilerNow() - _jotStart); \
+        }                                                                               \
+    } while (0)
+#define JotGLProfileElided(profiler, call) JotGLProfilerRecordElided((profiler), (call))
+#define JotGLProfileUpload(profiler, bytes) JotGLProfilerRecordUpload((profiler), (bytes))
+#define JotGLProfileEndFrame(profiler) JotGLProfilerEndFrame(profiler)
+#else
+#define JotGLProfileCall(profiler, call, statement) \
+    do {                                            \
+        statement;                                  \
+    } while (0)
+#define JotGLProfileElided(profiler, call)
+#define JotGLProfileUpload(profiler, bytes)
+#define JotGLProfileEndFrame(profiler)
+#endif
+
+#endif /* JotGLProfiler_h */
@@ -17,6 +17,9 @@
 + (GLuint)attributeIndex:(NSString*)attributeName;
 - (GLuint)uniformIndex:(NSString*)uniformName;
 
+// the model view matrix that use sends in the MVP
+- (GLKMatrix4)modelViewMatrix;
+
 @end
 
 
@@ -14,9 +14,17 @@
 @interface JotGLProgram : NSObject {
     NSMutableArray* _attributes;
     NSMutableArray* _uniforms;
+    // uniform name => NSNumber of its location
+    NSMutableDictionary* _uniformLocations;
     GLuint _programId;
-    GLuint _vertShader;
-    GLuint _fragShader;
+    GLuint _uniformMVPIndex;
+    // the MVP that was last sent to the program
+    GLKMatrix4 _uploadedMVP;
+    BOOL _hasUploadedMVP;
+    // the attributes to enable, by index, and how many
+    // attributes existed when the mask was built
+    uint32_t _attributeMask;
+    NSUInteger _attributeMaskCount;
 }
 
 @property(nonatomic, assign) GLSize canvasSize;
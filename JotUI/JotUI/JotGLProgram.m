@@ -26,6 +26,22 @@ typedef void (*GLLogFunction)(GLuint program, GLsizei bufsize, GLsizei* length,
 
 static NSMutableArray* _jotGLProgramAttributes;
 
+// filename.extension => shader source, for every context
+static NSMutableDictionary* _jotGLProgramSources;
+// sharegroup => filename.extension => NSNumber of a compiled shader.
+// shaders are shared across a sharegroup, but programs aren't, since
+// each context's program keeps its own uniform values
+static NSMapTable* _jotGLProgramShadersBySharegroup;
+
+static void JotGLProgramLoadStatics(void) {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _jotGLProgramAttributes = [NSMutableArray array];
+        _jotGLProgramSources = [NSMutableDictionary dictionary];
+        _jotGLProgramShadersBySharegroup = [NSMapTable weakToStrongObjectsMapTable];
+    });
+}
+
 
 @implementation JotGLProgram
 
@@ -34,50 +50,29 @@ static NSMutableArray* _jotGLProgramAttributes;
             fragmentShaderFilename:(NSString*)fShaderFilename
                     withAttributes:(NSArray<NSString*>*)attributes
                        andUniforms:(NSArray<NSString*>*)uniforms {
-    NSString* vertShaderPathname = [[NSBundle mainBundle] pathForResource:vShaderFilename ofType:@"vsh"];
-    NSString* vShaderString = [NSString stringWithContentsOfFile:vertShaderPathname encoding:NSUTF8StringEncoding error:nil];
-    NSURL* frameworkURL = [[NSBundle mainBundle] URLForResource:@"JotUI" withExtension:@"framework" subdirectory:@"Frameworks"];
-
-    if (!vShaderString) {
-        vertShaderPathname = [[NSBundle bundleWithURL:frameworkURL] pathForResource:vShaderFilename ofType:@"vsh"];
-        vShaderString = [NSString stringWithContentsOfFile:vertShaderPathname encoding:NSUTF8StringEncoding error:nil];
-    }
-
-    NSString* fragShaderPathname = [[NSBundle mainBundle] pathForResource:fShaderFilename ofType:@"fsh"];
-    NSString* fShaderString = [NSString stringWithContentsOfFile:fragShaderPathname encoding:NSUTF8StringEncoding error:nil];
-
-    if (!fShaderString) {
-        fragShaderPathname = [[NSBundle bundleWithURL:frameworkURL] pathForResource:fShaderFilename ofType:@"fsh"];
-        fShaderString = [NSString stringWithContentsOfFile:fragShaderPathname encoding:NSUTF8StringEncoding error:nil];
-    }
-
     if ((self = [super init])) {
-        static dispatch_once_t onceToken;
-        dispatch_once(&onceToken, ^{
-            _jotGLProgramAttributes = [NSMutableArray array];
-        });
+        JotGLProgramLoadStatics();
 
         _attributes = [NSMutableArray array];
         _programId = glCreateProgram();
         _uniforms = [NSMutableArray array];
+        _uniformLocations = [NSMutableDictionary dictionary];
 
-        if (![self compileShader:&_vertShader
-                            type:GL_VERTEX_SHADER
-                          string:vShaderString]) {
+        GLuint vertShader = [self sharedShaderWithFilename:vShaderFilename type:GL_VERTEX_SHADER];
+        if (!vertShader) {
             NSLog(@"Failed to compile vertex shader");
-            @throw [NSException exceptionWithName:@"JotGLProgramException" reason:@"Failed to compile vertex shader" userInfo:@{ @"log": _vertexShaderLog }];
+            @throw [NSException exceptionWithName:@"JotGLProgramException" reason:@"Failed to compile vertex shader" userInfo:@{ @"log": _vertexShaderLog ?: @"" }];
         }
 
         // Create and compile fragment shader
-        if (![self compileShader:&_fragShader
-                            type:GL_FRAGMENT_SHADER
-                          string:fShaderString]) {
+        GLuint fragShader = [self sharedShaderWithFilename:fShaderFilename type:GL_FRAGMENT_SHADER];
+        if (!fragShader) {
             NSLog(@"Failed to compile fragment shader");
-            @throw [NSException exceptionWithName:@"JotGLProgramException" reason:@"Failed to compile fragment shader" userInfo:@{ @"log": _fragmentShaderLog }];
+            @throw [NSException exceptionWithName:@"JotGLProgramException" reason:@"Failed to compile fragment shader" userInfo:@{ @"log": _fragmentShaderLog ?: @"" }];
         }
 
-        glAttachShader(_programId, _vertShader);
-        glAttachShader(_programId, _fragShader);
+        glAttachShader(_programId, vertShader);
+        glAttachShader(_programId, fragShader);
 
         for (NSString* attr in attributes) {
             [self addAttribute:attr];
@@ -89,12 +84,84 @@ static NSMutableArray* _jotGLProgramAttributes;
             @throw [NSException exceptionWithName:@"JotGLProgramException" reason:@"Failed to link program" userInfo:nil];
         }
 
+        // look each uniform up once, instead of every time it's set
+        for (NSString* uniform in _uniforms) {
+            _uniformLocations[uniform] = @(glGetUniformLocation(_programId, [uniform UTF8String]));
+        }
+        _uniformMVPIndex = [self uniformIndex:@"MVP"];
+
         [self validate];
     }
 
     return self;
 }
 
+#pragma mark - Step 0: Load and Share
+
+// returns the source of the shader file, looking in the main
+// bundle first and then the framework
++ (NSString*)sourceForShaderFilename:(NSString*)filename ofType:(NSString*)extension {
+    NSString* key = [filename stringByAppendingPathExtension:extension];
+    @synchronized(_jotGLProgramSources) {
+        NSString* source = _jotGLProgramSources[key];
+        if (source) {
+            return source;
+        }
+    }
+
+    NSString* pathname = [[NSBundle mainBundle] pathForResource:filename ofType:extension];
+    NSString* source = [NSString stringWithContentsOfFile:pathname encoding:NSUTF8StringEncoding error:nil];
+
+    if (!source) {
+        NSURL* frameworkURL = [[NSBundle mainBundle] URLForResource:@"JotUI" withExtension:@"framework" subdirectory:@"Frameworks"];
+        pathname = [[NSBundle bundleWithURL:frameworkURL] pathForResource:filename ofType:extension];
+        source = [NSString stringWithContentsOfFile:pathname encoding:NSUTF8StringEncoding error:nil];
+    }
+
+    if (source) {
+        @synchronized(_jotGLProgramSources) {
+            _jotGLProgramSources[key] = source;
+        }
+    }
+    return source;
+}
+
+// returns the shader compiled in the current context's sharegroup,
+// compiling it if no context in the sharegroup has yet. returns 0
+// if it doesn't compile
+- (GLuint)sharedShaderWithFilename:(NSString*)filename type:(GLenum)type {
+    NSString* extension = type == GL_VERTEX_SHADER ? @"vsh" : @"fsh";
+    NSString* key = [filename stringByAppendingPathExtension:extension];
+    EAGLSharegroup* sharegroup = [[JotGLContext currentContext] sharegroup];
+
+    @synchronized(_jotGLProgramShadersBySharegroup) {
+        NSMutableDictionary* shaders = sharegroup ? [_jotGLProgramShadersBySharegroup objectForKey:sharegroup] : nil;
+        if (shaders[key]) {
+            return [shaders[key] unsignedIntValue];
+        }
+
+        GLuint shader = 0;
+        if (![self compileShader:&shader type:type string:[JotGLProgram sourceForShaderFilename:filename ofType:extension]]) {
+            if (shader) {
+                glDeleteShader(shader);
+            }
+            return 0;
+        }
+        // other contexts in the sharegroup only see the
+        // shader once it's flushed
+        glFlush();
+
+        if (sharegroup) {
+            if (!shaders) {
+                shaders = [NSMutableDictionary dictionary];
+                [_jotGLProgramShadersBySharegroup setObject:shaders forKey:sharegroup];
+            }
+            shaders[key] = @(shader);
+        }
+        return shader;
+    }
+}
+
 #pragma mark - Step 1: Compile
 
 - (BOOL)compileShader:(GLuint*)shader
@@ -106,7 +173,7 @@ static NSMutableArray* _jotGLProgramAttributes;
     source =
         (GLchar*)[shaderString UTF8String];
     if (!source) {
-        NSLog(@"Failed to load vertex shader");
+        NSLog(@"Failed to load %@ shader", type == GL_VERTEX_SHADER ? @"vertex" : @"fragment");
         return NO;
     }
 
@@ -122,7 +189,7 @@ static NSMutableArray* _jotGLProgramAttributes;
         if (logLength > 0) {
             GLchar* log = (GLchar*)malloc(logLength);
             glGetShaderInfoLog(*shader, logLength, &logLength, log);
-            if (shader == &_vertShader) {
+            if (type == GL_VERTEX_SHADER) {
                 _vertexShaderLog = [NSString stringWithFormat:@"%s", log];
             } else {
                 _fragmentShaderLog = [NSString stringWithFormat:@"%s", log];
@@ -138,16 +205,21 @@ static NSMutableArray* _jotGLProgramAttributes;
 #pragma mark - Attributes and Uniforms
 
 + (GLuint)attributeIndex:(NSString*)attributeName {
-    if ([_jotGLProgramAttributes containsObject:attributeName]) {
-        return (GLuint)[_jotGLProgramAttributes indexOfObject:attributeName];
+    NSUInteger index;
+    @synchronized(_jotGLProgramAttributes) {
+        index = [_jotGLProgramAttributes indexOfObject:attributeName];
+    }
+    if (index != NSNotFound) {
+        return (GLuint)index;
     } else {
         @throw [NSException exceptionWithName:@"GLProgramException" reason:[NSString stringWithFormat:@"Program does not contain a attribute '%@'", attributeName] userInfo:nil];
     }
 }
 
 - (GLuint)uniformIndex:(NSString*)uniformName {
-    if ([_uniforms containsObject:uniformName]) {
-        return glGetUniformLocation(_programId, [uniformName UTF8String]);
+    NSNumber* location = _uniformLocations[uniformName];
+    if (location) {
+        return [location unsignedIntValue];
     } else {
         @throw [NSException exceptionWithName:@"GLProgramException" reason:[NSString stringWithFormat:@"Program does not contain a uniform '%@'", uniformName] userInfo:nil];
     }
@@ -156,7 +228,7 @@ static NSMutableArray* _jotGLProgramAttributes;
 #pragma mark - Public
 
 - (void)use {
-    glUseProgram(_programId);
+    JotGLProfileCall(JotGLCurrentProfiler(), JotGLCallUseProgram, glUseProgram(_programId));
 
     [self enableAndDisableAllAttributes];
 
@@ -169,14 +241,26 @@ static NSMutableArray* _jotGLProgramAttributes;
 
     // viewing matrices
     GLKMatrix4 projectionMatrix = GLKMatrix4MakeOrtho(0, self.canvasSize.width, 0, self.canvasSize.height, -1, 1);
-    GLKMatrix4 modelViewMatrix = GLKMatrix4Identity; // this sample uses a constant identity modelView matrix
+    GLKMatrix4 modelViewMatrix = [self modelViewMatrix];
     GLKMatrix4 MVPMatrix = GLKMatrix4Multiply(projectionMatrix, modelViewMatrix);
 
-    glUniformMatrix4fv([self uniformMVPIndex], 1, GL_FALSE, MVPMatrix.m);
+    // the program keeps its uniforms between uses, so
+    // only send the matrix when it changes
+    if (!_hasUploadedMVP || memcmp(_uploadedMVP.m, MVPMatrix.m, sizeof(MVPMatrix.m))) {
+        JotGLProfileCall(JotGLCurrentProfiler(), JotGLCallUniform, glUniformMatrix4fv(_uniformMVPIndex, 1, GL_FALSE, MVPMatrix.m));
+        _uploadedMVP = MVPMatrix;
+        _hasUploadedMVP = YES;
+    } else {
+        JotGLProfileElided(JotGLCurrentProfiler(), JotGLCallUniform);
+    }
+}
+
+- (GLKMatrix4)modelViewMatrix {
+    return GLKMatrix4Identity;
 }
 
 - (GLuint)uniformMVPIndex {
-    return [self uniformIndex:@"MVP"];
+    return _uniformMVPIndex;
 }
 
 #pragma mark - Private
@@ -190,14 +274,8 @@ static NSMutableArray* _jotGLProgramAttributes;
     if (status == GL_FALSE)
         return NO;
 
-    if (_vertShader) {
-        glDeleteShader(_vertShader);
-        _vertShader = 0;
-    }
-    if (_fragShader) {
-        glDeleteShader(_fragShader);
-        _fragShader = 0;
-    }
+    // the shaders stay attached and are kept for the
+    // sharegroup's other programs
 
     return YES;
 }
@@ -220,24 +298,38 @@ static NSMutableArray* _jotGLProgramAttributes;
 }
 
 - (void)addAttribute:(NSString*)attributeName {
-    if (![_jotGLProgramAttributes containsObject:attributeName]) {
-        [_jotGLProgramAttributes addObject:attributeName];
+    GLuint index;
+    @synchronized(_jotGLProgramAttributes) {
+        if (![_jotGLProgramAttributes containsObject:attributeName]) {
+            [_jotGLProgramAttributes addObject:attributeName];
+        }
+        index = (GLuint)[_jotGLProgramAttributes indexOfObject:attributeName];
     }
     if (![_attributes containsObject:attributeName]) {
         [_attributes addObject:attributeName];
     }
 
-    glBindAttribLocation(_programId,
-                         (GLuint)[_jotGLProgramAttributes indexOfObject:attributeName],
-                         [attributeName UTF8String]);
+    glBindAttribLocation(_programId, index, [attributeName UTF8String]);
 }
 
 - (void)enableAndDisableAllAttributes {
-    for (NSString* attr in _jotGLProgramAttributes) {
-        if ([_attributes containsObject:attr]) {
-            glEnableVertexAttribArray([JotGLProgram attributeIndex:attr]);
+    NSUInteger attributeCount;
+    @synchronized(_jotGLProgramAttributes) {
+        attributeCount = [_jotGLProgramAttributes count];
+        if (attributeCount != _attributeMaskCount) {
+            // another program has added attributes since the mask was built
+            _attributeMask = 0;
+            for (NSString* attr in _attributes) {
+                _attributeMask |= (1 << [_jotGLProgramAttributes indexOfObject:attr]);
+            }
+            _attributeMaskCount = attributeCount;
+        }
+    }
+    for (GLuint index = 0; index < attributeCount; index++) {
+        if (_attributeMask & (1 << index)) {
+            JotGLProfileCall(JotGLCurrentProfiler(), JotGLCallEnableVertexAttribArray, glEnableVertexAttribArray(index));
         } else {
-            glDisableVertexAttribArray([JotGLProgram attributeIndex:attr]);
+            JotGLProfileCall(JotGLCurrentProfiler(), JotGLCallDisableVertexAttribArray, glDisableVertexAttribArray(index));
         }
     }
 }
@@ -246,14 +338,8 @@ static NSMutableArray* _jotGLProgramAttributes;
 
 - (void)dealloc {
     [JotGLContext runBlock:^(JotGLContext* context) {
-        if (_vertShader) {
-            glDeleteShader(_vertShader);
-        }
-
-        if (_fragShader) {
-            glDeleteShader(_fragShader);
-        }
-
+        // the shaders belong to the sharegroup, and are
+        // freed when it is
         if (_programId) {
             glDeleteProgram(_programId);
         }
@@ -10,6 +10,7 @@
 #import <UIKit/UIKit.h>
 #import "JotGLContext.h"
 #import "DeleteAssets.h"
+#import "JotInkTileSet.h"
 
 
 @interface JotGLTexture : NSObject <DeleteAssets> {
@@ -22,6 +23,10 @@
 
 - (id)initForImage:(UIImage*)imageToLoad withSize:(CGSize)size;
 
+// tiles must be premultiplied RGBA with the bottom row
+// first, and exactly the size of the texture
+- (id)initForTiles:(JotInkTileSet*)tiles;
+
 - (id)initForTextureID:(GLuint)textureID withSize:(CGSize)size;
 
 - (void)bind;
@@ -14,9 +14,141 @@
 #import "AbstractBezierPathElement-Protected.h"
 #import "JotGLTexture+Private.h"
 #import "JotGLQuadProgram.h"
+#import "JotImageKernels.h"
+#import "JotMemoryManager.h"
 
 
-static int totalTextureBytes;
+/**
+ * the texture is drawn as device RGB, which is sRGB on iOS, so only
+ * images in those spaces can be copied without a color conversion
+ */
+static BOOL JotColorSpaceIsDeviceRGB(CGColorSpaceRef colorSpace) {
+    if (!colorSpace || CGColorSpaceGetModel(colorSpace) != kCGColorSpaceModelRGB) {
+        return NO;
+    }
+    static CGColorSpaceRef deviceRGB;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        deviceRGB = CGColorSpaceCreateDeviceRGB();
+    });
+    if (CFEqual(colorSpace, deviceRGB)) {
+        return YES;
+    }
+    BOOL isSRGB = NO;
+    if (@available(iOS 10.0, *)) {
+        CFStringRef name = CGColorSpaceCopyName(colorSpace);
+        if (name) {
+            isSRGB = CFEqual(name, kCGColorSpaceSRGB);
+            CFRelease(name);
+        }
+    }
+    return isSRGB;
+}
+
+/**
+ * copies an image's decoded bytes into a bottom-to-top, premultiplied
+ * RGBA texture buffer without going through CoreGraphics. this handles
+ * 8 bit sRGB images with alpha in either byte order, and resamples
+ * images that are a different size but the same aspect ratio.
+ *
+ * returns NO for anything else, such as Display P3 images, so that the
+ * caller can fall back to an aspect-fill draw into a bitmap context,
+ * which also converts the color
+ */
+static BOOL JotCopyImageIntoTextureBytes(CGImageRef image, void* textureBytes, CGSize textureSize) {
+    if (!image) {
+        return NO;
+    }
+    GLSize pixelSize = GLSizeFromCGSize(textureSize);
+    if (pixelSize.width != textureSize.width || pixelSize.height != textureSize.height) {
+        return NO;
+    }
+    size_t width = CGImageGetWidth(image);
+    size_t height = CGImageGetHeight(image);
+    if (!width || !height || CGImageGetBitsPerComponent(image) != 8 || CGImageGetBitsPerPixel(image) != 32 ||
+        !JotColorSpaceIsDeviceRGB(CGImageGetColorSpace(image))) {
+        return NO;
+    }
+    if (width * pixelSize.height != height * pixelSize.width) {
+        // aspect-fill would crop, so let CoreGraphics handle it
+        return NO;
+    }
+
+    CGImageAlphaInfo alphaInfo = CGImageGetAlphaInfo(image);
+    BOOL littleEndian = (CGImageGetBitmapInfo(image) & kCGBitmapByteOrderMask) == kCGBitmapByteOrder32Little;
+    BOOL alphaFirst;
+    BOOL premultiplied;
+    switch (alphaInfo) {
+        case kCGImageAlphaPremultipliedLast:
+            alphaFirst = NO;
+            premultiplied = YES;
+            break;
+        case kCGImageAlphaPremultipliedFirst:
+            alphaFirst = YES;
+            premultiplied = YES;
+            break;
+        case kCGImageAlphaLast:
+            alphaFirst = NO;
+            premultiplied = NO;
+            break;
+        case kCGImageAlphaFirst:
+            alphaFirst = YES;
+            premultiplied = NO;
+            break;
+        default:
+            return NO;
+    }
+
+    // in memory, the channels are RGBA, ARGB, or the reverse of those for little endian
+    static const uint8_t fromRGBA[4] = {0, 1, 2, 3};
+    static const uint8_t fromARGB[4] = {1, 2, 3, 0};
+    static const uint8_t fromABGR[4] = {3, 2, 1, 0};
+    static const uint8_t fromBGRA[4] = {2, 1, 0, 3};
+    const uint8_t* order = littleEndian ? (alphaFirst ? fromBGRA : fromABGR) : (alphaFirst ? fromARGB : fromRGBA);
+    BOOL needsSwizzle = order != fromRGBA;
+
+    CFDataRef imageBytes = CGDataProviderCopyData(CGImageGetDataProvider(image));
+    if (!imageBytes) {
+        return NO;
+    }
+    const uint8_t* src = CFDataGetBytePtr(imageBytes);
+    size_t srcBytesPerRow = CGImageGetBytesPerRow(image);
+    BOOL success = YES;
+
+    if (width == pixelSize.width && height == pixelSize.height) {
+        JotImageResample(src, width, height, srcBytesPerRow, textureBytes, width, height, width * 4, JotImageResampleBox, YES);
+        if (needsSwizzle) {
+            JotImageSwizzle(textureBytes, width * height, order);
+        }
+        if (!premultiplied) {
+            JotImagePremultiply(textureBytes, width * height);
+        }
+    } else {
+        // resampling needs premultiplied RGBA, so convert a copy first if needed
+        uint8_t* converted = NULL;
+        if (needsSwizzle || !premultiplied) {
+            converted = malloc(width * height * 4);
+            if (!converted) {
+                CFRelease(imageBytes);
+                return NO;
+            }
+            JotImageResample(src, width, height, srcBytesPerRow, converted, width, height, width * 4, JotImageResampleBox, NO);
+            if (needsSwizzle) {
+                JotImageSwizzle(converted, width * height, order);
+            }
+            if (!premultiplied) {
+                JotImagePremultiply(converted, width * height);
+            }
+            src = converted;
+            srcBytesPerRow = width * 4;
+        }
+        success = JotImageResample(src, width, height, srcBytesPerRow, textureBytes, pixelSize.width, pixelSize.height, pixelSize.width * 4, JotImageResampleLanczos, YES);
+        free(converted);
+    }
+
+    CFRelease(imageBytes);
+    return success;
+}
 
 
 @implementation JotGLTexture {
@@ -34,7 +166,7 @@ static int totalTextureBytes;
 @synthesize fullByteSize;
 
 + (int)totalTextureBytes {
-    return totalTextureBytes;
+    return (int)JotMemoryAccountantGetCategoryBytes([[JotMemoryManager sharedManager] accountant], JotMemoryCategoryTexture);
 }
 
 //
@@ -78,50 +210,52 @@ static int totalTextureBytes;
 
 
             fullByteSize = fullPixelSize.width * fullPixelSize.height * 4;
-            @synchronized([JotGLTexture class]) {
-                totalTextureBytes += fullByteSize;
-            }
+            JotMemoryAccountantAdjust([[JotMemoryManager sharedManager] accountant], JotMemoryCategoryTexture, fullByteSize);
 
             //
             // load the image data if we have some, or initialize to
             // a blank texture
             if (imageToLoad) {
                 //
-                // we have an image to load, so draw it to a bitmap context.
-                // then we can load those bytes into OpenGL directly.
-                // after they're loaded, we can free the memory for our cgcontext.
-                CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
-                void* imageData = calloc(fullPixelSize.height * fullPixelSize.width, 4);
+                // we have an image to load, so get its bytes into a buffer
+                // that's already flipped for OpenGL. when possible, we copy
+                // the decoded bytes directly. otherwise we draw it to a bitmap
+                // context. after they're loaded, we can free the memory.
+                void* imageData = malloc(fullPixelSize.height * fullPixelSize.width * 4);
                 if (!imageData) {
                     @throw [NSException exceptionWithName:@"Memory Exception" reason:@"can't malloc" userInfo:nil];
                 }
-                CGContextRef cgContext = CGBitmapContextCreate(imageData, fullPixelSize.width, fullPixelSize.height, 8, 4 * fullPixelSize.width, colorSpace, kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big);
-                if (!cgContext) {
-                    @throw [NSException exceptionWithName:@"CGContext Exception" reason:@"can't create new context" userInfo:nil];
+                CGContextRef cgContext = NULL;
+                if (!JotCopyImageIntoTextureBytes(imageToLoad.CGImage, imageData, fullPixelSize)) {
+                    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+                    cgContext = CGBitmapContextCreate(imageData, fullPixelSize.width, fullPixelSize.height, 8, 4 * fullPixelSize.width, colorSpace, kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big);
+                    if (!cgContext) {
+                        @throw [NSException exceptionWithName:@"CGContext Exception" reason:@"can't create new context" userInfo:nil];
+                    }
+                    CGContextTranslateCTM(cgContext, 0, fullPixelSize.height);
+                    CGContextScaleCTM(cgContext, 1.0, -1.0);
+                    CGColorSpaceRelease(colorSpace);
+                    if (currContext != [JotGLContext currentContext]) {
+                        @throw [NSException exceptionWithName:@"OpenGLException" reason:@"Mismatched Context" userInfo:nil];
+                    }
+                    CGContextClearRect(cgContext, CGRectMake(0, 0, fullPixelSize.width, fullPixelSize.height));
+
+                    // draw the new background in aspect-fill mode
+                    CGSize backgroundSize = CGSizeMake(CGImageGetWidth(imageToLoad.CGImage), CGImageGetHeight(imageToLoad.CGImage));
+                    CGFloat horizontalRatio = fullPixelSize.width / backgroundSize.width;
+                    CGFloat verticalRatio = fullPixelSize.height / backgroundSize.height;
+                    CGFloat ratio = MAX(horizontalRatio, verticalRatio); //AspectFill
+                    CGSize aspectFillSize = CGSizeMake(backgroundSize.width * ratio, backgroundSize.height * ratio);
+
+                    if (currContext != [JotGLContext currentContext]) {
+                        @throw [NSException exceptionWithName:@"OpenGLException" reason:@"Mismatched Context" userInfo:nil];
+                    }
+                    CGContextDrawImage(cgContext, CGRectMake((fullPixelSize.width - aspectFillSize.width) / 2,
+                                                             (fullPixelSize.height - aspectFillSize.height) / 2,
+                                                             aspectFillSize.width,
+                                                             aspectFillSize.height),
+                                       imageToLoad.CGImage);
                 }
-                CGContextTranslateCTM(cgContext, 0, fullPixelSize.height);
-                CGContextScaleCTM(cgContext, 1.0, -1.0);
-                CGColorSpaceRelease(colorSpace);
-                if (currContext != [JotGLContext currentContext]) {
-                    @throw [NSException exceptionWithName:@"OpenGLException" reason:@"Mismatched Context" userInfo:nil];
-                }
-                CGContextClearRect(cgContext, CGRectMake(0, 0, fullPixelSize.width, fullPixelSize.height));
-
-                // draw the new background in aspect-fill mode
-                CGSize backgroundSize = CGSizeMake(CGImageGetWidth(imageToLoad.CGImage), CGImageGetHeight(imageToLoad.CGImage));
-                CGFloat horizontalRatio = fullPixelSize.width / backgroundSize.width;
-                CGFloat verticalRatio = fullPixelSize.height / backgroundSize.height;
-                CGFloat ratio = MAX(horizontalRatio, verticalRatio); //AspectFill
-                CGSize aspectFillSize = CGSizeMake(backgroundSize.width * ratio, backgroundSize.height * ratio);
-
-                if (currContext != [JotGLContext currentContext]) {
-                    @throw [NSException exceptionWithName:@"OpenGLException" reason:@"Mismatched Context" userInfo:nil];
-                }
-                CGContextDrawImage(cgContext, CGRectMake((fullPixelSize.width - aspectFillSize.width) / 2,
-                                                         (fullPixelSize.height - aspectFillSize.height) / 2,
-                                                         aspectFillSize.width,
-                                                         aspectFillSize.height),
-                                   imageToLoad.CGImage);
                 if (currContext != [JotGLContext currentContext]) {
                     @throw [NSException exceptionWithName:@"OpenGLException" reason:@"Mismatched Context" userInfo:nil];
                 }
@@ -130,7 +264,9 @@ static int totalTextureBytes;
                 textureID = [context generateTextureForSize:fullPixelSize withBytes:imageData];
 
                 // cleanup
-                CGContextRelease(cgContext);
+                if (cgContext) {
+                    CGContextRelease(cgContext);
+                }
                 free(imageData);
             } else {
                 void* zeroedDataCache = calloc(fullPixelSize.height * fullPixelSize.width, 4);
@@ -147,12 +283,38 @@ static int totalTextureBytes;
     return self;
 }
 
+- (id)initForTiles:(JotInkTileSet*)tiles {
+    if (self = [super init]) {
+        [JotGLContext runBlock:^(JotGLContext* context) {
+            fullPixelSize = tiles.pixelSize;
+            lock = [[NSRecursiveLock alloc] init];
+            lockCount = 0;
+
+            fullByteSize = fullPixelSize.width * fullPixelSize.height * 4;
+            JotMemoryAccountantAdjust([[JotMemoryManager sharedManager] accountant], JotMemoryCategoryTexture, fullByteSize);
+
+            // upload a band of tiles at a time, so that we only ever
+            // hold one row of tiles instead of the whole page. the
+            // bands cover every pixel, so there's nothing to clear
+            textureID = [context generateTextureForSize:fullPixelSize withBytes:NULL];
+            [tiles enumerateTileRowsUsingBlock:^(CGRect pixelRect, const uint8_t* band) {
+                [context updateTexture:textureID inRect:pixelRect withBytes:band];
+            }];
+        }];
+    }
+
+    return self;
+}
+
 - (id)initForTextureID:(GLuint)_textureID withSize:(CGSize)_size {
     if (self = [super init]) {
         fullPixelSize = _size;
         textureID = _textureID;
         lock = [[NSRecursiveLock alloc] init];
         lockCount = 0;
+
+        fullByteSize = fullPixelSize.width * fullPixelSize.height * 4;
+        JotMemoryAccountantAdjust([[JotMemoryManager sharedManager] accountant], JotMemoryCategoryTexture, fullByteSize);
     }
     return self;
 }
@@ -192,12 +354,12 @@ static int totalTextureBytes;
 
     [program use];
     printOpenGLError();
-    glBindTexture(GL_TEXTURE_2D, self.textureID);
+    JotGLProfileCall(JotGLCurrentProfiler(), JotGLCallBindTexture, glBindTexture(GL_TEXTURE_2D, self.textureID));
     printOpenGLError();
-    glDisable(GL_CULL_FACE);
+    JotGLProfileCall(JotGLCurrentProfiler(), JotGLCallDisable, glDisable(GL_CULL_FACE));
     printOpenGLError();
     // TODO: shouldn't this be inside the Program?
-    glUniform1i([program uniformTextureIndex], 0);
+    JotGLProfileCall(JotGLCurrentProfiler(), JotGLCallUniform, glUniform1i([program uniformTextureIndex], 0));
     printOpenGLError();
 }
 
@@ -340,9 +502,7 @@ static int totalTextureBytes;
 - (void)dealloc {
     [lock lock];
     NSAssert([JotGLContext currentContext] != nil, @"must be on glcontext");
-    @synchronized([JotGLTexture class]) {
-        totalTextureBytes -= fullByteSize;
-    }
+    JotMemoryAccountantAdjust([[JotMemoryManager sharedManager] accountant], JotMemoryCategoryTexture, -fullByteSize);
     [self deleteAssets];
     [lock unlock];
 }
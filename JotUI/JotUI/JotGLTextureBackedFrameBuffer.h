@@ -10,12 +10,17 @@
 #import "JotGLTexture.h"
 #import "DeleteAssets.h"
 #import "AbstractJotGLFrameBuffer.h"
+#import "JotDirtyTileTracker.h"
 
 
 @interface JotGLTextureBackedFrameBuffer : AbstractJotGLFrameBuffer <DeleteAssets>
 
 @property(readonly) JotGLTexture* texture;
 
+// whoever draws into this framebuffer marks what they've drawn
+// here, so that saves only need to write the changed tiles
+@property(readonly) JotDirtyTileTracker* dirtyTileTracker;
+
 - (instancetype)init NS_UNAVAILABLE;
 
 // initialize a new framebuffer that has its color buffer
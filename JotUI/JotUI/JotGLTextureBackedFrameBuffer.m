@@ -11,6 +11,7 @@
 #import <OpenGLES/EAGL.h>
 #import "JotGLLayerBackedFrameBuffer.h"
 #import "JotGLTextureBackedFrameBuffer+Private.h"
+#import "JotGLContextPool.h"
 
 dispatch_queue_t importExportTextureQueue;
 
@@ -28,14 +29,17 @@ dispatch_queue_t importExportTextureQueue;
  */
 @implementation JotGLTextureBackedFrameBuffer {
     __strong JotGLTexture* texture;
+    JotDirtyTileTracker* dirtyTileTracker;
 }
 
 @synthesize texture;
+@synthesize dirtyTileTracker;
 
 - (id)initForTexture:(JotGLTexture*)_texture {
     if (self = [super init]) {
         [JotGLContext runBlock:^(JotGLContext* context) {
             texture = _texture;
+            dirtyTileTracker = [[JotDirtyTileTracker alloc] initWithPixelSize:texture.pixelSize];
             framebufferID = [context generateFramebufferWithTextureBacking:texture];
         }];
     }
@@ -75,6 +79,7 @@ dispatch_queue_t importExportTextureQueue;
         [texture bind];
         [currentContext bindFramebuffer:framebufferID];
         [currentContext clear];
+        [dirtyTileTracker markAllDirty];
 
         [currentContext unbindFramebuffer];
         [texture unbind];
@@ -82,10 +87,9 @@ dispatch_queue_t importExportTextureQueue;
 }
 
 - (void)clear {
-    JotGLContext* subContext = [[JotGLContext alloc] initWithName:@"JotTextureBackedFBOSubContext" andSharegroup:[JotGLContext currentContext].sharegroup andValidateThreadWith:^BOOL {
-        return [JotView isImportExportImageQueue];
-    }];
-    [subContext runBlock:^{
+    // reuses the context a loading page already has checked out,
+    // instead of building a new one for every clear
+    [[JotGLContextPool sharedPool] runBlock:^(JotGLContext* context) {
         [self clearOnCurrentContext];
     }];
 }
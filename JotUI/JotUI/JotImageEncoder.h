@@ -0,0 +1,25 @@
+//
+//  JotImageEncoder.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+@protocol JotImageEncoder <NSObject>
+
+// returns the bytes to write to disk for the image, or nil on failure.
+// this is called from the disk queue, and must be thread safe
+- (NSData*)encodedDataForImage:(UIImage*)image;
+
+@optional
+
+// like encodedDataForImage:, but previousData is what's on disk at the
+// image's path now, and the parts of it that still match the image can
+// be reused. previousData may be nil, or anything at all
+- (NSData*)encodedDataForImage:(UIImage*)image reusingEncodedData:(NSData*)previousData;
+
+@end
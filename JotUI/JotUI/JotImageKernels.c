@@ -0,0 +1,515 @@
+//
+//  JotImageKernels.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "JotImageKernels.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define JOT_KERNELS_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define JOT_KERNELS_SSE2 1
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define JOT_KERNELS_SSSE3 1
+#endif
+#endif
+
+#if defined(JOT_KERNELS_NEON) || defined(JOT_KERNELS_SSE2)
+static bool useVectorKernels = true;
+#else
+static bool useVectorKernels = false;
+#endif
+
+
+void JotImageKernelsSetVectorized(bool vectorized) {
+#if defined(JOT_KERNELS_NEON) || defined(JOT_KERNELS_SSE2)
+    useVectorKernels = vectorized;
+#else
+    useVectorKernels = false;
+#endif
+}
+
+bool JotImageKernelsIsVectorized(void) {
+    return useVectorKernels;
+}
+
+
+#pragma mark - Flip
+
+void JotImageFlipVertical(uint8_t* pixels, size_t bytesPerRow, size_t height) {
+    for (size_t y = 0; y < height / 2; y++) {
+        uint8_t* top = pixels + y * bytesPerRow;
+        uint8_t* bottom = pixels + (height - 1 - y) * bytesPerRow;
+        size_t i = 0;
+        if (useVectorKernels) {
+#if defined(JOT_KERNELS_NEON)
+            for (; i + 16 <= bytesPerRow; i += 16) {
+                uint8x16_t a = vld1q_u8(top + i);
+                uint8x16_t b = vld1q_u8(bottom + i);
+                vst1q_u8(top + i, b);
+                vst1q_u8(bottom + i, a);
+            }
+#elif defined(JOT_KERNELS_SSE2)
+            for (; i + 16 <= bytesPerRow; i += 16) {
+                __m128i a = _mm_loadu_si128((const __m128i*)(top + i));
+                __m128i b = _mm_loadu_si128((const __m128i*)(bottom + i));
+                _mm_storeu_si128((__m128i*)(top + i), b);
+                _mm_storeu_si128((__m128i*)(bottom + i), a);
+            }
+#endif
+        }
+        for (; i < bytesPerRow; i++) {
+            uint8_t t = top[i];
+            top[i] = bottom[i];
+            bottom[i] = t;
+        }
+    }
+}
+
+
+#pragma mark - Premultiply
+
+// exactly rounded c * a / 255
+static inline uint8_t jotMul255(uint32_t c, uint32_t a) {
+    uint32_t t = c * a + 128;
+    return (uint8_t)((t + (t >> 8)) >> 8);
+}
+
+// rounded c * 255 / a, clamped for pixels that weren't
+// validly premultiplied to begin with
+static inline uint8_t jotDiv255(uint32_t c, uint32_t a) {
+    uint32_t v = (c * 255 + a / 2) / a;
+    return (uint8_t)(v > 255 ? 255 : v);
+}
+
+void JotImagePremultiply(uint8_t* rgba, size_t pixelCount) {
+    size_t i = 0;
+    if (useVectorKernels) {
+#if defined(JOT_KERNELS_NEON)
+        for (; i + 16 <= pixelCount; i += 16) {
+            uint8x16x4_t px = vld4q_u8(rgba + i * 4);
+            uint8x16_t a = px.val[3];
+            for (int c = 0; c < 3; c++) {
+                uint16x8_t lo = vmull_u8(vget_low_u8(px.val[c]), vget_low_u8(a));
+                uint16x8_t hi = vmull_u8(vget_high_u8(px.val[c]), vget_high_u8(a));
+                // (x + ((x + 128) >> 8) + 128) >> 8 is the same rounding as jotMul255
+                px.val[c] = vcombine_u8(vraddhn_u16(lo, vrshrq_n_u16(lo, 8)), vraddhn_u16(hi, vrshrq_n_u16(hi, 8)));
+            }
+            vst4q_u8(rgba + i * 4, px);
+        }
+#elif defined(JOT_KERNELS_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i half = _mm_set1_epi16(128);
+        const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+        for (; i + 4 <= pixelCount; i += 4) {
+            __m128i px = _mm_loadu_si128((const __m128i*)(rgba + i * 4));
+            __m128i lo = _mm_unpacklo_epi8(px, zero);
+            __m128i hi = _mm_unpackhi_epi8(px, zero);
+            // copy each pixel's alpha into all four of its lanes
+            __m128i loAlpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xFF), 0xFF);
+            __m128i hiAlpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xFF), 0xFF);
+            lo = _mm_add_epi16(_mm_mullo_epi16(lo, loAlpha), half);
+            hi = _mm_add_epi16(_mm_mullo_epi16(hi, hiAlpha), half);
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+            hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+            // and keep the alpha as it was
+            __m128i rgb = _mm_andnot_si128(alphaMask, _mm_packus_epi16(lo, hi));
+            _mm_storeu_si128((__m128i*)(rgba + i * 4), _mm_or_si128(rgb, _mm_and_si128(px, alphaMask)));
+        }
+#endif
+    }
+    for (; i < pixelCount; i++) {
+        uint8_t* p = rgba + i * 4;
+        uint32_t a = p[3];
+        p[0] = jotMul255(p[0], a);
+        p[1] = jotMul255(p[1], a);
+        p[2] = jotMul255(p[2], a);
+    }
+}
+
+static inline void jotUnpremultiplyPixel(uint8_t* p) {
+    uint32_t a = p[3];
+    if (a != 0 && a != 255) {
+        p[0] = jotDiv255(p[0], a);
+        p[1] = jotDiv255(p[1], a);
+        p[2] = jotDiv255(p[2], a);
+    }
+}
+
+void JotImageUnpremultiply(uint8_t* rgba, size_t pixelCount) {
+    size_t i = 0;
+    if (useVectorKernels) {
+        // ink pages are almost entirely fully transparent or fully
+        // opaque pixels, which don't change. only do the division
+        // for blocks that have an antialiased edge in them
+#if defined(JOT_KERNELS_NEON)
+        const uint32x4_t alphaMask = vdupq_n_u32(0xFF000000);
+        for (; i + 4 <= pixelCount; i += 4) {
+            uint32x4_t alpha = vandq_u32(vld1q_u32((const uint32_t*)(rgba + i * 4)), alphaMask);
+            uint32x4_t unchanged = vorrq_u32(vceqq_u32(alpha, vdupq_n_u32(0)), vceqq_u32(alpha, alphaMask));
+            uint64x2_t both = vreinterpretq_u64_u32(unchanged);
+            if ((vgetq_lane_u64(both, 0) & vgetq_lane_u64(both, 1)) != UINT64_MAX) {
+                for (size_t j = 0; j < 4; j++) {
+                    jotUnpremultiplyPixel(rgba + (i + j) * 4);
+                }
+            }
+        }
+#elif defined(JOT_KERNELS_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+        const __m128 max = _mm_set1_ps(255);
+        for (; i + 4 <= pixelCount; i += 4) {
+            __m128i px = _mm_loadu_si128((const __m128i*)(rgba + i * 4));
+            __m128i alpha = _mm_and_si128(px, alphaMask);
+            __m128i transparent = _mm_cmpeq_epi32(alpha, zero);
+            if (_mm_movemask_epi8(_mm_or_si128(transparent, _mm_cmpeq_epi32(alpha, alphaMask))) == 0xFFFF) {
+                continue;
+            }
+            // the division is exact in floats, and truncates like jotDiv255
+            __m128i lo = _mm_unpacklo_epi8(px, zero);
+            __m128i hi = _mm_unpackhi_epi8(px, zero);
+            __m128i words[4] = {_mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero), _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero)};
+            for (int j = 0; j < 4; j++) {
+                __m128 c = _mm_cvtepi32_ps(words[j]);
+                __m128 a = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 3, 3));
+                __m128 roundingHalf = _mm_cvtepi32_ps(_mm_srli_epi32(_mm_cvttps_epi32(a), 1));
+                words[j] = _mm_cvttps_epi32(_mm_div_ps(_mm_add_ps(_mm_mul_ps(c, max), roundingHalf), a));
+            }
+            // the packs clamp to 255, and transparent pixels and alpha keep their bytes
+            __m128i rgb = _mm_packus_epi16(_mm_packs_epi32(words[0], words[1]), _mm_packs_epi32(words[2], words[3]));
+            __m128i keep = _mm_or_si128(transparent, alphaMask);
+            _mm_storeu_si128((__m128i*)(rgba + i * 4), _mm_or_si128(_mm_andnot_si128(keep, rgb), _mm_and_si128(px, keep)));
+        }
+#endif
+    }
+    for (; i < pixelCount; i++) {
+        jotUnpremultiplyPixel(rgba + i * 4);
+    }
+}
+
+
+#pragma mark - Swizzle
+
+void JotImageSwizzle(uint8_t* pixels, size_t pixelCount, const uint8_t order[4]) {
+    size_t i = 0;
+    if (useVectorKernels) {
+#if defined(JOT_KERNELS_NEON)
+        for (; i + 16 <= pixelCount; i += 16) {
+            uint8x16x4_t in = vld4q_u8(pixels + i * 4);
+            uint8x16x4_t out;
+            out.val[0] = in.val[order[0] & 3];
+            out.val[1] = in.val[order[1] & 3];
+            out.val[2] = in.val[order[2] & 3];
+            out.val[3] = in.val[order[3] & 3];
+            vst4q_u8(pixels + i * 4, out);
+        }
+#elif defined(JOT_KERNELS_SSSE3)
+        uint8_t shuffle[16];
+        for (int p = 0; p < 4; p++) {
+            for (int c = 0; c < 4; c++) {
+                shuffle[p * 4 + c] = (uint8_t)(p * 4 + (order[c] & 3));
+            }
+        }
+        const __m128i mask = _mm_loadu_si128((const __m128i*)shuffle);
+        for (; i + 4 <= pixelCount; i += 4) {
+            __m128i px = _mm_loadu_si128((const __m128i*)(pixels + i * 4));
+            _mm_storeu_si128((__m128i*)(pixels + i * 4), _mm_shuffle_epi8(px, mask));
+        }
+#elif defined(JOT_KERNELS_SSE2)
+        // without a byte shuffle, shift each output channel's byte down
+        // out of the input pixel, mask it, and shift it up into place
+        const __m128i byteMask = _mm_set1_epi32(0xFF);
+        const __m128i from0 = _mm_cvtsi32_si128((order[0] & 3) * 8);
+        const __m128i from1 = _mm_cvtsi32_si128((order[1] & 3) * 8);
+        const __m128i from2 = _mm_cvtsi32_si128((order[2] & 3) * 8);
+        const __m128i from3 = _mm_cvtsi32_si128((order[3] & 3) * 8);
+        for (; i + 4 <= pixelCount; i += 4) {
+            __m128i px = _mm_loadu_si128((const __m128i*)(pixels + i * 4));
+            __m128i c0 = _mm_and_si128(_mm_srl_epi32(px, from0), byteMask);
+            __m128i c1 = _mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(px, from1), byteMask), 8);
+            __m128i c2 = _mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(px, from2), byteMask), 16);
+            __m128i c3 = _mm_slli_epi32(_mm_srl_epi32(px, from3), 24);
+            _mm_storeu_si128((__m128i*)(pixels + i * 4), _mm_or_si128(_mm_or_si128(c0, c1), _mm_or_si128(c2, c3)));
+        }
+#endif
+    }
+    for (; i < pixelCount; i++) {
+        uint8_t* p = pixels + i * 4;
+        uint8_t in[4] = {p[0], p[1], p[2], p[3]};
+        p[0] = in[order[0] & 3];
+        p[1] = in[order[1] & 3];
+        p[2] = in[order[2] & 3];
+        p[3] = in[order[3] & 3];
+    }
+}
+
+
+#pragma mark - Resample
+
+/**
+ * the weights for one axis of a separable resample. output
+ * pixel i is the sum of weights[i * maxCount + k] * input[starts[i] + k]
+ * for k < counts[i]
+ */
+typedef struct {
+    int* starts;
+    int* counts;
+    float* weights;
+    int maxCount;
+} JotResampleAxis;
+
+static float jotSinc(float x) {
+    if (x == 0) {
+        return 1;
+    }
+    x *= (float)M_PI;
+    return sinf(x) / x;
+}
+
+static float jotLanczos3(float x) {
+    if (x <= -3 || x >= 3) {
+        return 0;
+    }
+    return jotSinc(x) * jotSinc(x / 3);
+}
+
+static void jotFreeAxis(JotResampleAxis* axis) {
+    free(axis->starts);
+    free(axis->counts);
+    free(axis->weights);
+}
+
+static bool jotBuildAxis(JotResampleAxis* axis, size_t srcSize, size_t dstSize, JotImageResampleFilter filter) {
+    float scale = (float)dstSize / (float)srcSize;
+    // when shrinking, stretch the filter so that every source pixel contributes
+    float filterScale = scale < 1 ? 1 / scale : 1;
+    float support = (filter == JotImageResampleBox ? 0.5f : 3.0f) * filterScale;
+
+    axis->maxCount = (int)ceilf(support * 2) + 2;
+    axis->starts = malloc(dstSize * sizeof(int));
+    axis->counts = malloc(dstSize * sizeof(int));
+    axis->weights = calloc(dstSize * axis->maxCount, sizeof(float));
+    if (!axis->starts || !axis->counts || !axis->weights) {
+        jotFreeAxis(axis);
+        return false;
+    }
+
+    for (size_t i = 0; i < dstSize; i++) {
+        float center = ((float)i + 0.5f) / scale;
+        int left = (int)floorf(center - support);
+        int right = (int)ceilf(center + support);
+        if (left < 0) {
+            left = 0;
+        }
+        if (right > (int)srcSize) {
+            right = (int)srcSize;
+        }
+        if (right - left > axis->maxCount) {
+            right = left + axis->maxCount;
+        }
+
+        float* weights = axis->weights + i * axis->maxCount;
+        float total = 0;
+        for (int j = left; j < right; j++) {
+            float w;
+            if (filter == JotImageResampleBox) {
+                // exact coverage of source pixel [j, j+1) by the output pixel's footprint
+                float lo = fmaxf((float)j, center - support);
+                float hi = fminf((float)j + 1, center + support);
+                w = hi > lo ? hi - lo : 0;
+            } else {
+                w = jotLanczos3(((float)j + 0.5f - center) / filterScale);
+            }
+            weights[j - left] = w;
+            total += w;
+        }
+        if (total != 0) {
+            for (int j = 0; j < right - left; j++) {
+                weights[j] /= total;
+            }
+        }
+        axis->starts[i] = left;
+        axis->counts[i] = right - left;
+    }
+    return true;
+}
+
+// resample one source row horizontally into dstWidth float4 pixels
+static void jotResampleRow(const uint8_t* src, float* out, const JotResampleAxis* axis, size_t dstWidth) {
+    for (size_t x = 0; x < dstWidth; x++) {
+        const uint8_t* p = src + axis->starts[x] * 4;
+        const float* w = axis->weights + x * axis->maxCount;
+        int count = axis->counts[x];
+        int k = 0;
+        if (useVectorKernels) {
+#if defined(JOT_KERNELS_NEON)
+            float32x4_t acc = vdupq_n_f32(0);
+            for (; k < count; k++) {
+                uint32x2_t word = vld1_dup_u32((const uint32_t*)(p + k * 4));
+                uint32x4_t wide = vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(word))));
+                acc = vaddq_f32(acc, vmulq_n_f32(vcvtq_f32_u32(wide), w[k]));
+            }
+            vst1q_f32(out + x * 4, acc);
+#elif defined(JOT_KERNELS_SSE2)
+            const __m128i zero = _mm_setzero_si128();
+            __m128 acc = _mm_setzero_ps();
+            for (; k < count; k++) {
+                int word;
+                memcpy(&word, p + k * 4, 4);
+                __m128i wide = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(word), zero), zero);
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_cvtepi32_ps(wide), _mm_set1_ps(w[k])));
+            }
+            _mm_storeu_ps(out + x * 4, acc);
+#endif
+        }
+        if (k < count || !useVectorKernels) {
+            float acc[4] = {0, 0, 0, 0};
+            for (; k < count; k++) {
+                for (int c = 0; c < 4; c++) {
+                    acc[c] += (float)p[k * 4 + c] * w[k];
+                }
+            }
+            memcpy(out + x * 4, acc, sizeof(acc));
+        }
+    }
+}
+
+// clamps each float4 pixel to a valid premultiplied byte pixel
+static void jotStoreRow(const float* in, uint8_t* dst, size_t width) {
+    size_t x = 0;
+    if (useVectorKernels) {
+#if defined(JOT_KERNELS_NEON)
+        const float32x4_t zero = vdupq_n_f32(0);
+        const float32x4_t max = vdupq_n_f32(255);
+        const float32x4_t half = vdupq_n_f32(0.5f);
+        for (; x < width; x++) {
+            float32x4_t v = vminq_f32(vmaxq_f32(vld1q_f32(in + x * 4), zero), max);
+            // lanczos can ring past the alpha, so clamp rgb to alpha
+            v = vminq_f32(v, vdupq_n_f32(vgetq_lane_f32(v, 3)));
+            uint16x4_t narrow = vmovn_u32(vcvtq_u32_f32(vaddq_f32(v, half)));
+            uint8x8_t bytes = vmovn_u16(vcombine_u16(narrow, narrow));
+            vst1_lane_u32((uint32_t*)(dst + x * 4), vreinterpret_u32_u8(bytes), 0);
+        }
+#elif defined(JOT_KERNELS_SSE2)
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 max = _mm_set1_ps(255);
+        const __m128 half = _mm_set1_ps(0.5f);
+        for (; x < width; x++) {
+            __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + x * 4), zero), max);
+            // lanczos can ring past the alpha, so clamp rgb to alpha
+            v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)));
+            __m128i ints = _mm_cvttps_epi32(_mm_add_ps(v, half));
+            ints = _mm_packs_epi32(ints, ints);
+            int word = _mm_cvtsi128_si32(_mm_packus_epi16(ints, ints));
+            memcpy(dst + x * 4, &word, 4);
+        }
+#endif
+    }
+    for (; x < width; x++) {
+        float v[4];
+        for (int c = 0; c < 4; c++) {
+            v[c] = fminf(fmaxf(in[x * 4 + c], 0), 255);
+        }
+        for (int c = 0; c < 4; c++) {
+            dst[x * 4 + c] = (uint8_t)(fminf(v[c], v[3]) + 0.5f);
+        }
+    }
+}
+
+bool JotImageResample(const uint8_t* src, size_t srcWidth, size_t srcHeight, size_t srcBytesPerRow,
+                      uint8_t* dst, size_t dstWidth, size_t dstHeight, size_t dstBytesPerRow,
+                      JotImageResampleFilter filter, bool flipVertical) {
+    if (!srcWidth || !srcHeight || !dstWidth || !dstHeight) {
+        return true;
+    }
+
+    if (srcWidth == dstWidth && srcHeight == dstHeight) {
+        // nothing to resample, so this is just a (maybe flipped) row copy
+        for (size_t y = 0; y < dstHeight; y++) {
+            size_t dstY = flipVertical ? dstHeight - 1 - y : y;
+            memcpy(dst + dstY * dstBytesPerRow, src + y * srcBytesPerRow, dstWidth * 4);
+        }
+        return true;
+    }
+
+    JotResampleAxis horizontal;
+    JotResampleAxis vertical;
+    if (!jotBuildAxis(&horizontal, srcWidth, dstWidth, filter)) {
+        return false;
+    }
+    if (!jotBuildAxis(&vertical, srcHeight, dstHeight, filter)) {
+        jotFreeAxis(&horizontal);
+        return false;
+    }
+
+    // only keep as many horizontally resampled rows as one
+    // output row needs, instead of a full intermediate image.
+    // source rows are requested in increasing order, so a ring works.
+    size_t ringSize = (size_t)vertical.maxCount;
+    size_t rowFloats = dstWidth * 4;
+    float* ring = malloc(ringSize * rowFloats * sizeof(float));
+    long* ringRows = malloc(ringSize * sizeof(long));
+    float* accumulator = malloc(rowFloats * sizeof(float));
+    if (!ring || !ringRows || !accumulator) {
+        free(ring);
+        free(ringRows);
+        free(accumulator);
+        jotFreeAxis(&horizontal);
+        jotFreeAxis(&vertical);
+        return false;
+    }
+    for (size_t i = 0; i < ringSize; i++) {
+        ringRows[i] = -1;
+    }
+
+    for (size_t y = 0; y < dstHeight; y++) {
+        const float* w = vertical.weights + y * vertical.maxCount;
+        memset(accumulator, 0, rowFloats * sizeof(float));
+
+        for (int k = 0; k < vertical.counts[y]; k++) {
+            long srcY = vertical.starts[y] + k;
+            size_t slot = (size_t)srcY % ringSize;
+            float* row = ring + slot * rowFloats;
+            if (ringRows[slot] != srcY) {
+                jotResampleRow(src + srcY * srcBytesPerRow, row, &horizontal, dstWidth);
+                ringRows[slot] = srcY;
+            }
+
+            size_t i = 0;
+            if (useVectorKernels) {
+#if defined(JOT_KERNELS_NEON)
+                for (; i + 4 <= rowFloats; i += 4) {
+                    vst1q_f32(accumulator + i, vaddq_f32(vld1q_f32(accumulator + i), vmulq_n_f32(vld1q_f32(row + i), w[k])));
+                }
+#elif defined(JOT_KERNELS_SSE2)
+                const __m128 weight = _mm_set1_ps(w[k]);
+                for (; i + 4 <= rowFloats; i += 4) {
+                    _mm_storeu_ps(accumulator + i, _mm_add_ps(_mm_loadu_ps(accumulator + i), _mm_mul_ps(_mm_loadu_ps(row + i), weight)));
+                }
+#endif
+            }
+            for (; i < rowFloats; i++) {
+                accumulator[i] += row[i] * w[k];
+            }
+        }
+
+        size_t dstY = flipVertical ? dstHeight - 1 - y : y;
+        jotStoreRow(accumulator, dst + dstY * dstBytesPerRow, dstWidth);
+    }
+
+    free(ring);
+    free(ringRows);
+    free(accumulator);
+    jotFreeAxis(&horizontal);
+    jotFreeAxis(&vertical);
+    return true;
+}
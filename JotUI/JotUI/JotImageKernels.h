@@ -0,0 +1,89 @@
+//
+//  JotImageKernels.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#ifndef JotImageKernels_h
+#define JotImageKernels_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * These are small pixel kernels for the 8 bit RGBA buffers that
+ * we read back from and upload to OpenGL. They replace the
+ * CoreGraphics passes that we used to do only to flip and resize
+ * those buffers.
+ *
+ * Everything here is plain C, and uses NEON or SSE2 (and SSSE3
+ * when available) with a scalar fallback, so the same file will
+ * build on device, in the simulator, and on a desktop for
+ * benchmarking.
+ */
+
+typedef enum {
+    // area average. fast, and best for integer-ish downscales like thumbnails
+    JotImageResampleBox = 0,
+    // 3-lobe lanczos. slower, but sharper for upscales and odd ratios
+    JotImageResampleLanczos = 1
+} JotImageResampleFilter;
+
+/**
+ * turns the image upside down in place. OpenGL returns rows
+ * bottom-to-top, and CoreGraphics expects them top-to-bottom
+ */
+void JotImageFlipVertical(uint8_t* pixels, size_t bytesPerRow, size_t height);
+
+/**
+ * multiplies the RGB of each RGBA pixel by its alpha, in place.
+ * the result is rounded exactly, matching CoreGraphics' output
+ */
+void JotImagePremultiply(uint8_t* rgba, size_t pixelCount);
+
+/**
+ * divides the RGB of each premultiplied RGBA pixel by its alpha,
+ * in place. fully transparent and fully opaque runs are skipped
+ */
+void JotImageUnpremultiply(uint8_t* rgba, size_t pixelCount);
+
+/**
+ * reorders the channels of each 4 byte pixel in place, so that
+ * output channel i is input channel order[i]. {2, 1, 0, 3} converts
+ * between BGRA and RGBA
+ */
+void JotImageSwizzle(uint8_t* pixels, size_t pixelCount, const uint8_t order[4]);
+
+/**
+ * resamples premultiplied RGBA from src into dst. if the sizes
+ * match, this is a straight copy. if flipVertical is set, then
+ * the rows are written to dst bottom-to-top in the same pass.
+ *
+ * src and dst must not overlap.
+ *
+ * returns false if the scratch memory couldn't be allocated
+ */
+bool JotImageResample(const uint8_t* src, size_t srcWidth, size_t srcHeight, size_t srcBytesPerRow,
+                      uint8_t* dst, size_t dstWidth, size_t dstHeight, size_t dstBytesPerRow,
+                      JotImageResampleFilter filter, bool flipVertical);
+
+/**
+ * the vector paths are on by default when the compiler
+ * targets NEON or SSE2. turning them off forces the scalar
+ * reference code, which is useful for tests and benchmarks
+ */
+void JotImageKernelsSetVectorized(bool vectorized);
+bool JotImageKernelsIsVectorized(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JotImageKernels_h */
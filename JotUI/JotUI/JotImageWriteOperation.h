@@ -8,15 +8,35 @@
 
 #import <Foundation/Foundation.h>
 #import <UIKit/UIKit.h>
+#import "JotImageEncoder.h"
 
 
+/**
+ * Writes one or more images, such as a page's ink and thumbnail, as a
+ * single JotFileBatch group commit. Each image and sidecar goes to a
+ * synced temp file, and then they're all renamed into place and their
+ * directory is synced once.
+ */
 @interface JotImageWriteOperation : NSOperation
 
-@property(nonatomic, readonly) NSString* path;
-@property(nonatomic, readonly) UIImage* image;
+// every path that this operation writes or removes
+@property(nonatomic, readonly) NSArray<NSString*>* paths;
+@property(nonatomic, readonly) NSObject<JotImageEncoder>* encoder;
+// the paths that also get a JotInkTextureSidecar, so that
+// they can be loaded into a texture without a decode
+@property(nonatomic, copy) NSSet<NSString*>* textureSidecarPaths;
+// YES once the images, and their sidecars if asked for, are on disk
+@property(nonatomic, readonly) BOOL didSucceed;
 
 - (instancetype)init NS_UNAVAILABLE;
 
 - (id)initWithImage:(UIImage*)image andPath:(NSString*)path andNotifyBlock:(void (^)(JotImageWriteOperation*))block;
 
+// imagesByPath holds the image to write to each path, or NSNull
+// to remove the file at that path
+- (id)initWithImages:(NSDictionary<NSString*, id>*)imagesByPath andEncoder:(NSObject<JotImageEncoder>*)encoder andNotifyBlock:(void (^)(JotImageWriteOperation*))block;
+
+// the image that's being written to path, or nil if it's being removed
+- (UIImage*)imageForPath:(NSString*)path;
+
 @end
@@ -7,33 +7,83 @@
 //
 
 #import "JotImageWriteOperation.h"
+#import "JotPNGEncoder.h"
+#import "JotInkTextureSidecar.h"
+#import "JotFileBatch.h"
 
 
 @implementation JotImageWriteOperation {
-    UIImage* imageToWrite;
-    NSString* pathToWriteImageTo;
+    NSDictionary* imagesToWrite;
+    NSObject<JotImageEncoder>* encoder;
     void (^notifyBlock)(JotImageWriteOperation*);
     BOOL isRunning;
     NSObject* lock;
 }
 
+@synthesize textureSidecarPaths;
+@synthesize didSucceed;
+
 /** Initialize with the provided block. */
 - (id)initWithImage:(UIImage*)image andPath:(NSString*)path andNotifyBlock:(void (^)(JotImageWriteOperation*))block {
+    return [self initWithImages:@{ path: image ?: [NSNull null] } andEncoder:[JotPNGEncoder fastEncoder] andNotifyBlock:block];
+}
+
+- (id)initWithImages:(NSDictionary<NSString*, id>*)imagesByPath andEncoder:(NSObject<JotImageEncoder>*)_encoder andNotifyBlock:(void (^)(JotImageWriteOperation*))block {
     if ((self = [super init])) {
-        pathToWriteImageTo = path;
-        imageToWrite = image;
+        imagesToWrite = [imagesByPath copy];
+        encoder = _encoder ?: [JotPNGEncoder fastEncoder];
         notifyBlock = block;
         lock = [[NSObject alloc] init];
     }
     return self;
 }
 
-- (NSString*)path {
-    return pathToWriteImageTo;
+- (NSArray<NSString*>*)paths {
+    return [imagesToWrite allKeys];
+}
+
+- (UIImage*)imageForPath:(NSString*)path {
+    id image = [imagesToWrite objectForKey:path];
+    return [image isKindOfClass:[UIImage class]] ? image : nil;
 }
 
-- (UIImage*)image {
-    return imageToWrite;
+- (NSObject<JotImageEncoder>*)encoder {
+    return encoder;
+}
+
+// adds the image and its sidecar to the batch. returns NO if the image
+// couldn't be written. a sidecar that can't be made is removed instead,
+// and only clears success, since the image can still be decoded
+- (BOOL)addImage:(UIImage*)image toPath:(NSString*)path inBatch:(JotFileBatch*)batch success:(BOOL*)success {
+    NSString* sidecarPath = [JotInkTextureSidecar sidecarPathForImagePath:path];
+    if (!image) {
+        // we don't have an image so delete anything off disk if needed
+        return JotFileBatchRemove(batch, [path fileSystemRepresentation]) && JotFileBatchRemove(batch, [sidecarPath fileSystemRepresentation]);
+    }
+    NSData* encodedImage = nil;
+    if ([encoder respondsToSelector:@selector(encodedDataForImage:reusingEncodedData:)]) {
+        // the file that's there now may share most of its bytes with this one.
+        // it's only read, and renaming the new file over it leaves the mapping valid
+        NSData* previousData = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+        encodedImage = [encoder encodedDataForImage:image reusingEncodedData:previousData];
+    } else {
+        encodedImage = [encoder encodedDataForImage:image];
+    }
+    const char* tempPath = encodedImage ? JotFileBatchAdd(batch, [path fileSystemRepresentation], [encodedImage bytes], [encodedImage length]) : NULL;
+    if (!tempPath) {
+        return NO;
+    }
+    NSData* sidecar = nil;
+    if ([textureSidecarPaths containsObject:path]) {
+        // the sidecar records the new file's size and date, which the
+        // temp file already has and keeps when it's renamed
+        sidecar = [JotInkTextureSidecar sidecarDataForImage:image withImageFileAtPath:[[NSFileManager defaultManager] stringWithFileSystemRepresentation:tempPath length:strlen(tempPath)]];
+        *success = *success && sidecar != nil;
+    }
+    if (sidecar) {
+        return JotFileBatchAdd(batch, [sidecarPath fileSystemRepresentation], [sidecar bytes], [sidecar length]) != NULL;
+    }
+    return JotFileBatchRemove(batch, [sidecarPath fileSystemRepresentation]);
 }
 
 // from NSOperation
@@ -49,13 +99,18 @@
         }
     }
     if (![self isCancelled]) {
-        if (imageToWrite) {
-            // if we have an image, then write it to disk
-            [UIImagePNGRepresentation(imageToWrite) writeToFile:pathToWriteImageTo atomically:YES];
-        } else {
-            // otherwise, we don't have an image so delete anything off disk if needed
-            [[NSFileManager defaultManager] removeItemAtPath:pathToWriteImageTo error:nil];
+        JotFileBatch* batch = JotFileBatchCreate();
+        BOOL success = batch != NULL;
+        BOOL didAddAll = success;
+        for (NSString* path in [[imagesToWrite allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+            if (!didAddAll) {
+                break;
+            }
+            didAddAll = [self addImage:[self imageForPath:path] toPath:path inBatch:batch success:&success];
         }
+        // nothing on disk changes unless every image was written
+        didSucceed = didAddAll && JotFileBatchCommit(batch) && success;
+        JotFileBatchFree(batch);
     } else {
         // cancelled this operation, so we don't need to do anything at all
     }
@@ -16,23 +16,51 @@
     // this is the texture to use when drawing the stroke
     JotBrushTexture* texture;
     NSString* uuid;
+    uint64_t strokeHash;
     //
     NSString* strokeClassName;
+    // a saved stroke that hasn't loaded its segments yet. saved
+    // strokes don't change, so its segments are read when needed
+    JotStroke* unloadedStroke;
+    NSInteger totalNumberOfBytes;
 }
 
 - (id)initWithJotStroke:(JotStroke*)stroke {
     if (self = [super init]) {
         segmentSmoother = stroke.segmentSmoother;
-        segments = [NSArray arrayWithArray:stroke.segments];
+        if ([stroke hasLoadedSegments]) {
+            segments = [NSArray arrayWithArray:stroke.segments];
+        } else {
+            unloadedStroke = stroke;
+        }
         texture = stroke.texture;
         uuid = [stroke uuid];
+        strokeHash = [stroke contentHash];
+        totalNumberOfBytes = [stroke totalNumberOfBytes];
         strokeClassName = NSStringFromClass([stroke class]);
     }
     return self;
 }
 
 - (NSMutableArray*)segments {
-    return [NSMutableArray arrayWithArray:segments];
+    return [NSMutableArray arrayWithArray:segments ?: unloadedStroke.segments];
+}
+
+- (CGRect)bounds {
+    // an unloaded stroke knows its bounds without loading its segments
+    return unloadedStroke ? [unloadedStroke bounds] : [super bounds];
+}
+
+- (BOOL)hasLoadedSegments {
+    return !unloadedStroke || [unloadedStroke hasLoadedSegments];
+}
+
+- (BOOL)hasCorruptSegments {
+    return [unloadedStroke hasCorruptSegments];
+}
+
+- (NSInteger)totalNumberOfBytes {
+    return totalNumberOfBytes;
 }
 
 - (SegmentSmoother*)segmentSmoother {
@@ -43,12 +71,20 @@
     return texture;
 }
 
+- (uint64_t)contentHash {
+    return strokeHash;
+}
+
 - (NSString*)uuid {
     return uuid;
 }
 
 - (NSDictionary*)asDictionary {
-    NSMutableDictionary* dict = [NSMutableDictionary dictionaryWithDictionary:[super asDictionary]];
+    NSDictionary* strokeDictionary = [super asDictionary];
+    if (!strokeDictionary) {
+        return nil;
+    }
+    NSMutableDictionary* dict = [NSMutableDictionary dictionaryWithDictionary:strokeDictionary];
     [dict setObject:strokeClassName forKey:@"class"];
     return dict;
 }
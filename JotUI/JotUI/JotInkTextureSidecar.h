@@ -0,0 +1,50 @@
+//
+//  JotInkTextureSidecar.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+#import "JotInkTileSet.h"
+
+#define kJotInkTextureSidecarExt @"jottex"
+
+/**
+ * The sidecar is a copy of a saved ink image's pixels in the exact
+ * layout that we upload to OpenGL: premultiplied RGBA, bottom row
+ * first. Only the non-empty tiles are stored (see JotInkTileSet),
+ * and they're LZ4 compressed when that helps.
+ *
+ * It's written next to the PNG after the PNG is written, and records
+ * the PNG's size and modification date. If those don't match at load
+ * time, then the sidecar is stale and we decode the PNG instead.
+ *
+ * The PNG is always the complete ink, and the sidecar is only a cache
+ * of it. Deleting the sidecar costs a PNG decode at the next load.
+ */
+@interface JotInkTextureSidecar : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
++ (NSString*)sidecarPathForImagePath:(NSString*)imagePath;
+
+// writes the sidecar for an image that was just written to imagePath.
+// returns NO, and removes any stale sidecar, if the image isn't 8 bit
+// premultiplied RGBA or couldn't be written
++ (BOOL)writeSidecarForImage:(UIImage*)image atImagePath:(NSString*)imagePath;
+
+// the sidecar for an image that was just written to imageFilePath, which
+// can be a temp file that's renamed into place later, since a rename keeps
+// the file's size and date. returns nil for the same images as above
++ (NSData*)sidecarDataForImage:(UIImage*)image withImageFileAtPath:(NSString*)imageFilePath;
+
+// returns the ink tiles for the image at imagePath, or nil if the
+// sidecar is missing, stale, corrupt, or a different pixel size
++ (JotInkTileSet*)tilesForImagePath:(NSString*)imagePath withPixelSize:(CGSize)pixelSize;
+
++ (void)removeSidecarForImagePath:(NSString*)imagePath;
+
+@end
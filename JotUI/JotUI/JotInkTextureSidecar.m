@@ -0,0 +1,206 @@
+//
+//  JotInkTextureSidecar.m
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import "JotInkTextureSidecar.h"
+#import "JotImageKernels.h"
+#import "JotLZ4.h"
+#import <zlib.h>
+
+#define kJotInkTextureSidecarVersion 2
+#define kJotInkTextureSidecarCompressed 1
+
+// all fields are little endian, which is every platform we run on
+struct JotInkTextureSidecarHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t tileSize;
+    uint32_t flags;
+    // adler32 of the payload that follows the header
+    uint32_t checksum;
+    // the payload is the tile bitmap followed by the packed tiles
+    uint32_t bitmapLength;
+    // size and modification date of the image this was saved with
+    uint64_t imageFileSize;
+    double imageModificationTime;
+    // the payload's length before and after compression
+    uint64_t rawLength;
+    uint64_t payloadLength;
+};
+typedef struct JotInkTextureSidecarHeader JotInkTextureSidecarHeader;
+
+static const char kJotInkTextureSidecarMagic[4] = {'J', 'T', 'E', 'X'};
+
+
+@implementation JotInkTextureSidecar
+
++ (NSString*)sidecarPathForImagePath:(NSString*)imagePath {
+    return [imagePath stringByAppendingPathExtension:kJotInkTextureSidecarExt];
+}
+
++ (BOOL)getImageFileSize:(uint64_t*)fileSize andModificationTime:(double*)modificationTime atPath:(NSString*)imagePath {
+    NSDictionary* attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:imagePath error:nil];
+    if (!attributes) {
+        return NO;
+    }
+    *fileSize = [attributes fileSize];
+    *modificationTime = [[attributes fileModificationDate] timeIntervalSinceReferenceDate];
+    return YES;
+}
+
+#pragma mark - Writing
+
++ (BOOL)writeSidecarForImage:(UIImage*)image atImagePath:(NSString*)imagePath {
+    NSData* sidecar = [self sidecarDataForImage:image withImageFileAtPath:imagePath];
+    if (!sidecar || ![sidecar writeToFile:[self sidecarPathForImagePath:imagePath] atomically:YES]) {
+        [self removeSidecarForImagePath:imagePath];
+        return NO;
+    }
+    return YES;
+}
+
++ (NSData*)sidecarDataForImage:(UIImage*)image withImageFileAtPath:(NSString*)imageFilePath {
+    CGImageRef cgImage = image.CGImage;
+    size_t width = CGImageGetWidth(cgImage);
+    size_t height = CGImageGetHeight(cgImage);
+    CGBitmapInfo byteOrder = CGImageGetBitmapInfo(cgImage) & kCGBitmapByteOrderMask;
+
+    uint64_t imageFileSize;
+    double imageModificationTime;
+    if (!cgImage || !width || !height || CGImageGetBitsPerComponent(cgImage) != 8 || CGImageGetBitsPerPixel(cgImage) != 32 ||
+        CGImageGetAlphaInfo(cgImage) != kCGImageAlphaPremultipliedLast ||
+        (byteOrder != kCGBitmapByteOrderDefault && byteOrder != kCGBitmapByteOrder32Big) ||
+        ![self getImageFileSize:&imageFileSize andModificationTime:&imageModificationTime atPath:imageFilePath]) {
+        return nil;
+    }
+
+    CFDataRef imageBytes = CGDataProviderCopyData(CGImageGetDataProvider(cgImage));
+    if (!imageBytes) {
+        return nil;
+    }
+
+    // flip into the bottom-to-top order that OpenGL wants
+    uint8_t* texture = malloc(width * height * 4);
+    if (!texture) {
+        CFRelease(imageBytes);
+        return nil;
+    }
+    JotImageResample(CFDataGetBytePtr(imageBytes), width, height, CGImageGetBytesPerRow(cgImage), texture, width, height, width * 4, JotImageResampleBox, YES);
+    CFRelease(imageBytes);
+
+    JotInkTileSet* tiles = [JotInkTileSet tileSetWithPixels:texture bytesPerRow:width * 4 pixelSize:CGSizeMake(width, height)];
+    free(texture);
+
+    return [self sidecarDataForTiles:tiles withImageFileSize:imageFileSize andModificationTime:imageModificationTime];
+}
+
++ (NSData*)sidecarDataForTiles:(JotInkTileSet*)tiles withImageFileSize:(uint64_t)imageFileSize andModificationTime:(double)imageModificationTime {
+    NSMutableData* raw = [NSMutableData dataWithData:tiles.bitmap];
+    [raw appendData:tiles.packedTiles];
+    size_t rawLength = [raw length];
+
+    size_t capacity = JotLZ4CompressBound(rawLength);
+    NSMutableData* sidecar = [NSMutableData dataWithLength:sizeof(JotInkTextureSidecarHeader) + capacity];
+    uint8_t* payload = (uint8_t*)[sidecar mutableBytes] + sizeof(JotInkTextureSidecarHeader);
+    size_t payloadLength = JotLZ4Compress([raw bytes], rawLength, payload, capacity);
+    uint32_t flags = kJotInkTextureSidecarCompressed;
+    if (!payloadLength || payloadLength > rawLength * 9 / 10) {
+        // dense ink doesn't compress enough to be worth decompressing
+        memcpy(payload, [raw bytes], rawLength);
+        payloadLength = rawLength;
+        flags = 0;
+    }
+    [sidecar setLength:sizeof(JotInkTextureSidecarHeader) + payloadLength];
+
+    JotInkTextureSidecarHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kJotInkTextureSidecarMagic, 4);
+    header.version = kJotInkTextureSidecarVersion;
+    header.width = (uint32_t)tiles.pixelSize.width;
+    header.height = (uint32_t)tiles.pixelSize.height;
+    header.tileSize = (uint32_t)tiles.tileSize;
+    header.flags = flags;
+    header.checksum = (uint32_t)adler32(adler32(0L, Z_NULL, 0), payload, (uInt)payloadLength);
+    header.bitmapLength = (uint32_t)[tiles.bitmap length];
+    header.imageFileSize = imageFileSize;
+    header.imageModificationTime = imageModificationTime;
+    header.rawLength = rawLength;
+    header.payloadLength = payloadLength;
+    [sidecar replaceBytesInRange:NSMakeRange(0, sizeof(header)) withBytes:&header];
+    return sidecar;
+}
+
++ (void)removeSidecarForImagePath:(NSString*)imagePath {
+    NSString* sidecarPath = [self sidecarPathForImagePath:imagePath];
+    if ([[NSFileManager defaultManager] fileExistsAtPath:sidecarPath]) {
+        [[NSFileManager defaultManager] removeItemAtPath:sidecarPath error:nil];
+    }
+}
+
+#pragma mark - Reading
+
++ (JotInkTileSet*)tilesForImagePath:(NSString*)imagePath withPixelSize:(CGSize)pixelSize {
+    NSData* sidecar = [NSData dataWithContentsOfFile:[self sidecarPathForImagePath:imagePath] options:NSDataReadingMappedIfSafe error:nil];
+    if ([sidecar length] < sizeof(JotInkTextureSidecarHeader)) {
+        return nil;
+    }
+
+    JotInkTextureSidecarHeader header;
+    memcpy(&header, [sidecar bytes], sizeof(header));
+    if (memcmp(header.magic, kJotInkTextureSidecarMagic, 4) != 0 || header.version != kJotInkTextureSidecarVersion ||
+        header.width != pixelSize.width || header.height != pixelSize.height ||
+        header.payloadLength != [sidecar length] - sizeof(header) || header.bitmapLength > header.rawLength ||
+        header.rawLength > (uint64_t)header.width * header.height * 4 + header.bitmapLength) {
+        return nil;
+    }
+
+    uint64_t imageFileSize;
+    double imageModificationTime;
+    if (![self getImageFileSize:&imageFileSize andModificationTime:&imageModificationTime atPath:imagePath] ||
+        imageFileSize != header.imageFileSize || imageModificationTime != header.imageModificationTime) {
+        // the image has been written since this sidecar was
+        return nil;
+    }
+
+    const uint8_t* payload = (const uint8_t*)[sidecar bytes] + sizeof(header);
+    if ((uint32_t)adler32(adler32(0L, Z_NULL, 0), payload, (uInt)header.payloadLength) != header.checksum) {
+        DebugLog(@"corrupt ink texture sidecar for %@", imagePath);
+        return nil;
+    }
+
+    // raw payloads are used straight from the mapped file
+    NSData* raw = sidecar;
+    const uint8_t* rawBytes = payload;
+    if (header.flags & kJotInkTextureSidecarCompressed) {
+        NSMutableData* decompressed = [NSMutableData dataWithLength:(NSUInteger)header.rawLength];
+        if (!decompressed || !JotLZ4Decompress(payload, (size_t)header.payloadLength, [decompressed mutableBytes], (size_t)header.rawLength)) {
+            DebugLog(@"corrupt ink texture sidecar for %@", imagePath);
+            return nil;
+        }
+        raw = decompressed;
+        rawBytes = [decompressed bytes];
+    } else if (header.payloadLength != header.rawLength) {
+        return nil;
+    }
+
+    // the tiles keep whichever buffer they point into alive
+    NSData* bitmap = [NSData dataWithBytes:rawBytes length:header.bitmapLength];
+    NSData* packedTiles = [[NSData alloc] initWithBytesNoCopy:(void*)(rawBytes + header.bitmapLength)
+                                                       length:(NSUInteger)(header.rawLength - header.bitmapLength)
+                                                  deallocator:^(void* bytes, NSUInteger length) {
+                                                      [raw length];
+                                                  }];
+    JotInkTileSet* tiles = [[JotInkTileSet alloc] initWithPixelSize:pixelSize andTileSize:header.tileSize andBitmap:bitmap andPackedTiles:packedTiles];
+    if (!tiles) {
+        DebugLog(@"corrupt ink texture sidecar for %@", imagePath);
+    }
+    return tiles;
+}
+
+@end
@@ -0,0 +1,67 @@
+//
+//  JotInkTileSet.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+#import "JotInkTiles.h"
+
+/**
+ * The ink of a page, stored as only its non-empty tiles. Pixels
+ * are premultiplied RGBA in the same row order as the buffer they
+ * were cut from, which for saved ink is bottom-up for OpenGL.
+ *
+ * A blank page is just its tile bitmap, and a page with a single
+ * stroke costs roughly the tiles that stroke touches.
+ */
+@interface JotInkTileSet : NSObject
+
+@property(nonatomic, readonly) CGSize pixelSize;
+@property(nonatomic, readonly) NSUInteger tileSize;
+@property(nonatomic, readonly) NSUInteger nonEmptyTileCount;
+// one bit per tile, see JotInkTiles.h
+@property(nonatomic, readonly) NSData* bitmap;
+@property(nonatomic, readonly) NSData* packedTiles;
+// the bytes this tile set holds, as opposed to the dense page's
+@property(nonatomic, readonly) int fullByteSize;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+// returns nil if the bitmap and packed tiles don't match the size
+- (instancetype)initWithPixelSize:(CGSize)pixelSize andTileSize:(NSUInteger)tileSize andBitmap:(NSData*)bitmap andPackedTiles:(NSData*)packedTiles;
+
+// cuts a dense premultiplied RGBA buffer into tiles
++ (JotInkTileSet*)tileSetWithPixels:(const uint8_t*)rgba bytesPerRow:(size_t)bytesPerRow pixelSize:(CGSize)pixelSize;
+
+/**
+ * builds a tile set from only the tiles in tilesToRead. for each row
+ * of tiles that has any, readBand is asked to fill band with tightly
+ * packed pixels for pixelRect, which runs from the first wanted tile
+ * to the right edge. wanted tiles that are empty are left out
+ */
++ (JotInkTileSet*)tileSetWithPixelSize:(CGSize)pixelSize readingTiles:(NSData*)tilesToRead fromBands:(void (^)(CGRect pixelRect, uint8_t* band))readBand;
+
+- (JotInkTileGrid)grid;
+
+// returns these tiles with every tile in dirtyTiles replaced by
+// patch's version of it, or nil if patch is a different size
+- (JotInkTileSet*)tileSetByApplyingPatch:(JotInkTileSet*)patch inTiles:(NSData*)dirtyTiles;
+
+/**
+ * unpacks one row of tiles at a time into a reused band of full
+ * width rows, so that a page can be uploaded without ever holding
+ * all of its pixels. empty tiles in the band are cleared.
+ */
+- (void)enumerateTileRowsUsingBlock:(void (^)(CGRect pixelRect, const uint8_t* band))block;
+
+// the full page of pixels, tightly packed
+- (NSData*)denseBytes;
+
+// writes the full page into pixels, which must hold width * height * 4 bytes
+- (void)unpackIntoPixels:(uint8_t*)pixels;
+
+@end
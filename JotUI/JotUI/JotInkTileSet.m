@@ -0,0 +1,146 @@
+//
+//  JotInkTileSet.m
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import "JotInkTileSet.h"
+
+
+@implementation JotInkTileSet {
+    JotInkTileGrid grid;
+}
+
+@synthesize pixelSize;
+@synthesize tileSize;
+@synthesize nonEmptyTileCount;
+@synthesize bitmap;
+@synthesize packedTiles;
+
+- (instancetype)initWithPixelSize:(CGSize)_pixelSize andTileSize:(NSUInteger)_tileSize andBitmap:(NSData*)_bitmap andPackedTiles:(NSData*)_packedTiles {
+    if (_pixelSize.width < 1 || _pixelSize.height < 1 || _pixelSize.width != floor(_pixelSize.width) || _pixelSize.height != floor(_pixelSize.height) || !_tileSize) {
+        return nil;
+    }
+    JotInkTileGrid _grid = JotInkTileGridMake(_pixelSize.width, _pixelSize.height, _tileSize);
+    if ([_bitmap length] != JotInkTileGridBitmapLength(&_grid) ||
+        [_packedTiles length] != JotInkPackTiles(&_grid, NULL, 0, [_bitmap bytes], NULL)) {
+        return nil;
+    }
+    if (self = [super init]) {
+        pixelSize = _pixelSize;
+        tileSize = _tileSize;
+        grid = _grid;
+        bitmap = _bitmap;
+        packedTiles = _packedTiles;
+
+        const uint8_t* bits = [bitmap bytes];
+        for (size_t i = 0; i < grid.columns * grid.rows; i++) {
+            nonEmptyTileCount += JotInkTileBitmapIsSet(bits, i);
+        }
+    }
+    return self;
+}
+
++ (JotInkTileSet*)tileSetWithPixels:(const uint8_t*)rgba bytesPerRow:(size_t)bytesPerRow pixelSize:(CGSize)pixelSize {
+    JotInkTileGrid grid = JotInkTileGridMake(pixelSize.width, pixelSize.height, kJotInkTileSize);
+    NSMutableData* bitmap = [NSMutableData dataWithLength:JotInkTileGridBitmapLength(&grid)];
+    JotInkFindNonEmptyTiles(&grid, rgba, bytesPerRow, [bitmap mutableBytes]);
+
+    NSMutableData* packedTiles = [NSMutableData dataWithLength:JotInkPackTiles(&grid, NULL, 0, [bitmap bytes], NULL)];
+    JotInkPackTiles(&grid, rgba, bytesPerRow, [bitmap bytes], [packedTiles mutableBytes]);
+
+    return [[JotInkTileSet alloc] initWithPixelSize:pixelSize andTileSize:grid.tileSize andBitmap:bitmap andPackedTiles:packedTiles];
+}
+
++ (JotInkTileSet*)tileSetWithPixelSize:(CGSize)pixelSize readingTiles:(NSData*)tilesToRead fromBands:(void (^)(CGRect pixelRect, uint8_t* band))readBand {
+    JotInkTileGrid grid = JotInkTileGridMake(pixelSize.width, pixelSize.height, kJotInkTileSize);
+    if ([tilesToRead length] != JotInkTileGridBitmapLength(&grid)) {
+        return nil;
+    }
+    const uint8_t* wanted = [tilesToRead bytes];
+    NSMutableData* bitmap = [NSMutableData dataWithLength:[tilesToRead length]];
+    NSMutableData* packedTiles = [NSMutableData dataWithLength:JotInkPackTiles(&grid, NULL, 0, wanted, NULL)];
+    size_t length = 0;
+
+    uint8_t* band = NULL;
+    for (size_t row = 0; row < grid.rows; row++) {
+        size_t firstColumn = grid.columns;
+        for (size_t column = 0; column < grid.columns; column++) {
+            if (JotInkTileBitmapIsSet(wanted, row * grid.columns + column)) {
+                firstColumn = column;
+                break;
+            }
+        }
+        if (firstColumn == grid.columns) {
+            continue;
+        }
+        if (!band) {
+            band = malloc(grid.width * grid.tileSize * 4);
+            if (!band) {
+                @throw [NSException exceptionWithName:@"Memory Exception" reason:@"can't malloc" userInfo:nil];
+            }
+        }
+        size_t x = firstColumn * grid.tileSize;
+        size_t y = row * grid.tileSize;
+        CGRect pixelRect = CGRectMake(x, y, grid.width - x, MIN(grid.tileSize, grid.height - y));
+        readBand(pixelRect, band);
+        length += JotInkPackTileRow(&grid, row, band, (grid.width - x) * 4, firstColumn, wanted, [bitmap mutableBytes], (uint8_t*)[packedTiles mutableBytes] + length);
+    }
+    free(band);
+    [packedTiles setLength:length];
+
+    return [[JotInkTileSet alloc] initWithPixelSize:pixelSize andTileSize:grid.tileSize andBitmap:bitmap andPackedTiles:packedTiles];
+}
+
+- (JotInkTileGrid)grid {
+    return grid;
+}
+
+- (JotInkTileSet*)tileSetByApplyingPatch:(JotInkTileSet*)patch inTiles:(NSData*)dirtyTiles {
+    if (!CGSizeEqualToSize(patch.pixelSize, pixelSize) || patch.tileSize != tileSize || [dirtyTiles length] != [bitmap length]) {
+        return nil;
+    }
+    NSMutableData* mergedBitmap = [NSMutableData dataWithLength:[bitmap length]];
+    size_t length = JotInkMergeTiles(&grid, [bitmap bytes], [packedTiles bytes], [patch.bitmap bytes], [patch.packedTiles bytes], [dirtyTiles bytes], [mergedBitmap mutableBytes], NULL);
+    NSMutableData* mergedTiles = [NSMutableData dataWithLength:length];
+    JotInkMergeTiles(&grid, [bitmap bytes], [packedTiles bytes], [patch.bitmap bytes], [patch.packedTiles bytes], [dirtyTiles bytes], [mergedBitmap mutableBytes], [mergedTiles mutableBytes]);
+
+    return [[JotInkTileSet alloc] initWithPixelSize:pixelSize andTileSize:tileSize andBitmap:mergedBitmap andPackedTiles:mergedTiles];
+}
+
+- (int)fullByteSize {
+    return (int)([bitmap length] + [packedTiles length]);
+}
+
+- (void)enumerateTileRowsUsingBlock:(void (^)(CGRect pixelRect, const uint8_t* band))block {
+    size_t bandBytesPerRow = grid.width * 4;
+    uint8_t* band = malloc(bandBytesPerRow * grid.tileSize);
+    if (!band) {
+        @throw [NSException exceptionWithName:@"Memory Exception" reason:@"can't malloc" userInfo:nil];
+    }
+    const uint8_t* packed = [packedTiles bytes];
+    for (size_t row = 0; row < grid.rows; row++) {
+        packed = JotInkUnpackTileRow(&grid, [bitmap bytes], row, packed, band, bandBytesPerRow);
+        size_t y = row * grid.tileSize;
+        block(CGRectMake(0, y, grid.width, MIN(grid.tileSize, grid.height - y)), band);
+    }
+    free(band);
+}
+
+- (NSData*)denseBytes {
+    NSMutableData* dense = [NSMutableData dataWithLength:grid.width * grid.height * 4];
+    [self unpackIntoPixels:[dense mutableBytes]];
+    return dense;
+}
+
+- (void)unpackIntoPixels:(uint8_t*)pixels {
+    const uint8_t* packed = [packedTiles bytes];
+    for (size_t row = 0; row < grid.rows; row++) {
+        uint8_t* band = pixels + row * grid.tileSize * grid.width * 4;
+        packed = JotInkUnpackTileRow(&grid, [bitmap bytes], row, packed, band, grid.width * 4);
+    }
+}
+
+@end
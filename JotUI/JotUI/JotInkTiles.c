@@ -0,0 +1,215 @@
+//
+//  JotInkTiles.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#include <string.h>
+#include "JotInkTiles.h"
+#include "JotImageKernels.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define JOT_TILES_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define JOT_TILES_SSE2 1
+#endif
+
+
+JotInkTileGrid JotInkTileGridMake(size_t width, size_t height, size_t tileSize) {
+    JotInkTileGrid grid;
+    grid.width = width;
+    grid.height = height;
+    grid.tileSize = tileSize ? tileSize : kJotInkTileSize;
+    grid.columns = (width + grid.tileSize - 1) / grid.tileSize;
+    grid.rows = (height + grid.tileSize - 1) / grid.tileSize;
+    return grid;
+}
+
+size_t JotInkTileGridBitmapLength(const JotInkTileGrid* grid) {
+    return (grid->columns * grid->rows + 7) / 8;
+}
+
+static inline size_t jotTileWidth(const JotInkTileGrid* grid, size_t column) {
+    size_t x = column * grid->tileSize;
+    return grid->width - x < grid->tileSize ? grid->width - x : grid->tileSize;
+}
+
+static inline size_t jotTileHeight(const JotInkTileGrid* grid, size_t row) {
+    size_t y = row * grid->tileSize;
+    return grid->height - y < grid->tileSize ? grid->height - y : grid->tileSize;
+}
+
+
+#pragma mark - Detection
+
+static bool jotSpanIsEmpty(const uint8_t* bytes, size_t length) {
+    size_t i = 0;
+    if (JotImageKernelsIsVectorized()) {
+#if defined(JOT_TILES_NEON)
+        uint8x16_t acc = vdupq_n_u8(0);
+        for (; i + 16 <= length; i += 16) {
+            acc = vorrq_u8(acc, vld1q_u8(bytes + i));
+        }
+        uint64x2_t wide = vreinterpretq_u64_u8(acc);
+        if (vgetq_lane_u64(wide, 0) | vgetq_lane_u64(wide, 1)) {
+            return false;
+        }
+#elif defined(JOT_TILES_SSE2)
+        __m128i acc = _mm_setzero_si128();
+        for (; i + 16 <= length; i += 16) {
+            acc = _mm_or_si128(acc, _mm_loadu_si128((const __m128i*)(bytes + i)));
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) != 0xFFFF) {
+            return false;
+        }
+#endif
+    }
+    uint64_t acc = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        acc |= word;
+    }
+    for (; i < length; i++) {
+        acc |= bytes[i];
+    }
+    return acc == 0;
+}
+
+static bool jotTileIsEmpty(const uint8_t* tile, size_t bytesPerRow, size_t spanLength, size_t tileHeight) {
+    for (size_t y = 0; y < tileHeight; y++) {
+        // stop at the first inked row, which is usually near the top
+        if (!jotSpanIsEmpty(tile + y * bytesPerRow, spanLength)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t JotInkFindNonEmptyTiles(const JotInkTileGrid* grid, const uint8_t* rgba, size_t bytesPerRow, uint8_t* bitmap) {
+    memset(bitmap, 0, JotInkTileGridBitmapLength(grid));
+    size_t count = 0;
+    for (size_t row = 0; row < grid->rows; row++) {
+        size_t y0 = row * grid->tileSize;
+        size_t tileHeight = jotTileHeight(grid, row);
+        for (size_t column = 0; column < grid->columns; column++) {
+            const uint8_t* tile = rgba + y0 * bytesPerRow + column * grid->tileSize * 4;
+            if (!jotTileIsEmpty(tile, bytesPerRow, jotTileWidth(grid, column) * 4, tileHeight)) {
+                JotInkTileBitmapSet(bitmap, row * grid->columns + column);
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+
+#pragma mark - Packing
+
+size_t JotInkPackTiles(const JotInkTileGrid* grid, const uint8_t* rgba, size_t bytesPerRow, const uint8_t* bitmap, uint8_t* packed) {
+    size_t length = 0;
+    for (size_t row = 0; row < grid->rows; row++) {
+        size_t y0 = row * grid->tileSize;
+        size_t tileHeight = jotTileHeight(grid, row);
+        for (size_t column = 0; column < grid->columns; column++) {
+            if (!JotInkTileBitmapIsSet(bitmap, row * grid->columns + column)) {
+                continue;
+            }
+            size_t spanLength = jotTileWidth(grid, column) * 4;
+            if (packed) {
+                const uint8_t* tile = rgba + y0 * bytesPerRow + column * grid->tileSize * 4;
+                for (size_t y = 0; y < tileHeight; y++) {
+                    memcpy(packed + length + y * spanLength, tile + y * bytesPerRow, spanLength);
+                }
+            }
+            length += spanLength * tileHeight;
+        }
+    }
+    return length;
+}
+
+const uint8_t* JotInkUnpackTileRow(const JotInkTileGrid* grid, const uint8_t* bitmap, size_t tileRow,
+                                   const uint8_t* packed, uint8_t* band, size_t bandBytesPerRow) {
+    size_t tileHeight = jotTileHeight(grid, tileRow);
+    for (size_t column = 0; column < grid->columns; column++) {
+        uint8_t* tile = band + column * grid->tileSize * 4;
+        size_t spanLength = jotTileWidth(grid, column) * 4;
+        if (JotInkTileBitmapIsSet(bitmap, tileRow * grid->columns + column)) {
+            for (size_t y = 0; y < tileHeight; y++) {
+                memcpy(tile + y * bandBytesPerRow, packed + y * spanLength, spanLength);
+            }
+            packed += spanLength * tileHeight;
+        } else {
+            for (size_t y = 0; y < tileHeight; y++) {
+                memset(tile + y * bandBytesPerRow, 0, spanLength);
+            }
+        }
+    }
+    return packed;
+}
+
+size_t JotInkPackTileRow(const JotInkTileGrid* grid, size_t tileRow, const uint8_t* band, size_t bandBytesPerRow,
+                         size_t firstColumn, const uint8_t* wanted, uint8_t* bitmap, uint8_t* packed) {
+    size_t length = 0;
+    size_t tileHeight = jotTileHeight(grid, tileRow);
+    for (size_t column = firstColumn; column < grid->columns; column++) {
+        size_t index = tileRow * grid->columns + column;
+        if (!JotInkTileBitmapIsSet(wanted, index)) {
+            continue;
+        }
+        const uint8_t* tile = band + (column - firstColumn) * grid->tileSize * 4;
+        size_t spanLength = jotTileWidth(grid, column) * 4;
+        if (jotTileIsEmpty(tile, bandBytesPerRow, spanLength, tileHeight)) {
+            continue;
+        }
+        JotInkTileBitmapSet(bitmap, index);
+        for (size_t y = 0; y < tileHeight; y++) {
+            memcpy(packed + length + y * spanLength, tile + y * bandBytesPerRow, spanLength);
+        }
+        length += spanLength * tileHeight;
+    }
+    return length;
+}
+
+
+#pragma mark - Merging
+
+size_t JotInkMergeTiles(const JotInkTileGrid* grid, const uint8_t* baseBitmap, const uint8_t* basePacked,
+                        const uint8_t* patchBitmap, const uint8_t* patchPacked, const uint8_t* dirty,
+                        uint8_t* bitmap, uint8_t* packed) {
+    memset(bitmap, 0, JotInkTileGridBitmapLength(grid));
+    size_t length = 0;
+    size_t baseOffset = 0;
+    size_t patchOffset = 0;
+    for (size_t row = 0; row < grid->rows; row++) {
+        size_t tileHeight = jotTileHeight(grid, row);
+        for (size_t column = 0; column < grid->columns; column++) {
+            size_t index = row * grid->columns + column;
+            size_t tileLength = jotTileWidth(grid, column) * 4 * tileHeight;
+            bool inBase = JotInkTileBitmapIsSet(baseBitmap, index);
+            bool inPatch = JotInkTileBitmapIsSet(patchBitmap, index);
+
+            const uint8_t* tile = NULL;
+            if (JotInkTileBitmapIsSet(dirty, index)) {
+                tile = inPatch ? patchPacked + patchOffset : NULL;
+            } else {
+                tile = inBase ? basePacked + baseOffset : NULL;
+            }
+            if (tile) {
+                JotInkTileBitmapSet(bitmap, index);
+                if (packed) {
+                    memcpy(packed + length, tile, tileLength);
+                }
+                length += tileLength;
+            }
+
+            baseOffset += inBase ? tileLength : 0;
+            patchOffset += inPatch ? tileLength : 0;
+        }
+    }
+    return length;
+}
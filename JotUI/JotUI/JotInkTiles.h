@@ -0,0 +1,100 @@
+//
+//  JotInkTiles.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#ifndef JotInkTiles_h
+#define JotInkTiles_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Most pages are mostly empty, so instead of storing every pixel of
+ * the ink, we cut it into square tiles and only keep the tiles that
+ * have ink in them. A bitmap, one bit per tile in row-major order,
+ * records which tiles were kept.
+ *
+ * Kept tiles are packed back to back in the same row-major order.
+ * Each tile is stored as tightly packed RGBA rows, and tiles on the
+ * right and bottom edges are cropped to the image.
+ */
+
+#define kJotInkTileSize 64
+
+typedef struct {
+    size_t width;
+    size_t height;
+    size_t tileSize;
+    size_t columns;
+    size_t rows;
+} JotInkTileGrid;
+
+JotInkTileGrid JotInkTileGridMake(size_t width, size_t height, size_t tileSize);
+
+// the number of bytes in the grid's tile bitmap
+size_t JotInkTileGridBitmapLength(const JotInkTileGrid* grid);
+
+static inline bool JotInkTileBitmapIsSet(const uint8_t* bitmap, size_t index) {
+    return (bitmap[index >> 3] >> (index & 7)) & 1;
+}
+
+static inline void JotInkTileBitmapSet(uint8_t* bitmap, size_t index) {
+    bitmap[index >> 3] |= (uint8_t)(1 << (index & 7));
+}
+
+/**
+ * sets a bit in bitmap for every tile that has a non-zero byte. since
+ * ink is premultiplied, that's every tile with a visible pixel.
+ * returns the number of non-empty tiles
+ */
+size_t JotInkFindNonEmptyTiles(const JotInkTileGrid* grid, const uint8_t* rgba, size_t bytesPerRow, uint8_t* bitmap);
+
+/**
+ * copies the tiles in bitmap out of rgba into packed, and returns the
+ * number of bytes written. if packed is NULL, this only returns the
+ * length that the packed tiles would need, and rgba isn't read
+ */
+size_t JotInkPackTiles(const JotInkTileGrid* grid, const uint8_t* rgba, size_t bytesPerRow, const uint8_t* bitmap, uint8_t* packed);
+
+/**
+ * fills band with one full row of tiles, which is tileSize rows of
+ * pixels (fewer for the last row). tiles that aren't in bitmap are
+ * cleared. packed must point at the first packed tile of tileRow, and
+ * this returns where the next tile row's packed tiles begin
+ */
+const uint8_t* JotInkUnpackTileRow(const JotInkTileGrid* grid, const uint8_t* bitmap, size_t tileRow,
+                                   const uint8_t* packed, uint8_t* band, size_t bandBytesPerRow);
+
+/**
+ * packs the tiles of tileRow that are set in wanted out of band, which
+ * holds that row of tiles starting at firstColumn. wanted tiles that
+ * turn out to be empty aren't added to bitmap. tileRow's tiles must be
+ * the last ones packed so far, and this returns the bytes written
+ */
+size_t JotInkPackTileRow(const JotInkTileGrid* grid, size_t tileRow, const uint8_t* band, size_t bandBytesPerRow,
+                         size_t firstColumn, const uint8_t* wanted, uint8_t* bitmap, uint8_t* packed);
+
+/**
+ * builds the tiles for base with every tile in dirty replaced by the
+ * tile from patch, or cleared if patch doesn't have it. bitmap is
+ * always filled in, and packed only if it isn't NULL. returns the
+ * length of the merged packed tiles
+ */
+size_t JotInkMergeTiles(const JotInkTileGrid* grid, const uint8_t* baseBitmap, const uint8_t* basePacked,
+                        const uint8_t* patchBitmap, const uint8_t* patchPacked, const uint8_t* dirty,
+                        uint8_t* bitmap, uint8_t* packed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JotInkTiles_h */
@@ -0,0 +1,207 @@
+//
+//  JotLZ4.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include "JotLZ4.h"
+
+#define kJotLZ4HashLog 16
+#define kJotLZ4MinMatch 4
+// the format requires the last 5 bytes to be literals, and
+// the last match to start at least 12 bytes before the end
+#define kJotLZ4LastLiterals 5
+#define kJotLZ4MatchFindLimit 12
+#define kJotLZ4MaxOffset 65535
+
+
+static inline uint32_t jotRead32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint32_t jotHash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - kJotLZ4HashLog);
+}
+
+static inline uint8_t* jotWriteLength(uint8_t* op, size_t length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+size_t JotLZ4CompressBound(size_t srcLength) {
+    return srcLength + srcLength / 255 + 16;
+}
+
+// writes one sequence, or returns NULL if it won't fit
+static uint8_t* jotWriteSequence(uint8_t* op, const uint8_t* opEnd, const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength) {
+    size_t needed = 1 + literalLength / 255 + 1 + literalLength + (matchLength ? 2 + matchLength / 255 + 1 : 0);
+    if ((size_t)(opEnd - op) < needed) {
+        return NULL;
+    }
+    size_t matchCode = matchLength ? matchLength - kJotLZ4MinMatch : 0;
+    uint8_t* token = op++;
+    *token = (uint8_t)((literalLength >= 15 ? 15 : literalLength) << 4);
+    if (literalLength >= 15) {
+        op = jotWriteLength(op, literalLength - 15);
+    }
+    if (literalLength) {
+        memcpy(op, literals, literalLength);
+        op += literalLength;
+    }
+    if (matchLength) {
+        *op++ = (uint8_t)offset;
+        *op++ = (uint8_t)(offset >> 8);
+        *token |= (uint8_t)(matchCode >= 15 ? 15 : matchCode);
+        if (matchCode >= 15) {
+            op = jotWriteLength(op, matchCode - 15);
+        }
+    }
+    return op;
+}
+
+size_t JotLZ4Compress(const uint8_t* src, size_t srcLength, uint8_t* dst, size_t dstCapacity) {
+    if (srcLength > 0x7FFFFFFF) {
+        return 0;
+    }
+    uint32_t* table = calloc((size_t)1 << kJotLZ4HashLog, sizeof(uint32_t));
+    if (!table) {
+        return 0;
+    }
+
+    const uint8_t* ip = src;
+    const uint8_t* anchor = src;
+    const uint8_t* end = src + srcLength;
+    uint8_t* op = dst;
+    uint8_t* opEnd = dst + dstCapacity;
+
+    if (srcLength > kJotLZ4MatchFindLimit) {
+        const uint8_t* matchFindLimit = end - kJotLZ4MatchFindLimit;
+        const uint8_t* matchLimit = end - kJotLZ4LastLiterals;
+        while (ip < matchFindLimit) {
+            uint32_t sequence = jotRead32(ip);
+            uint32_t hash = jotHash(sequence);
+            // positions are stored + 1, so that 0 means empty
+            uint32_t candidate = table[hash];
+            table[hash] = (uint32_t)(ip - src) + 1;
+
+            if (!candidate || (size_t)(ip - src) - (candidate - 1) > kJotLZ4MaxOffset || jotRead32(src + candidate - 1) != sequence) {
+                // skip ahead faster through data that isn't matching
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            const uint8_t* match = src + candidate - 1;
+            while (ip > anchor && match > src && ip[-1] == match[-1]) {
+                ip--;
+                match--;
+            }
+            size_t matchLength = kJotLZ4MinMatch;
+            while (ip + matchLength < matchLimit && ip[matchLength] == match[matchLength]) {
+                matchLength++;
+            }
+
+            op = jotWriteSequence(op, opEnd, anchor, ip - anchor, ip - match, matchLength);
+            if (!op) {
+                free(table);
+                return 0;
+            }
+            ip += matchLength;
+            anchor = ip;
+            if (ip - 2 > src && ip < matchFindLimit) {
+                table[jotHash(jotRead32(ip - 2))] = (uint32_t)(ip - 2 - src) + 1;
+            }
+        }
+    }
+
+    op = jotWriteSequence(op, opEnd, anchor, end - anchor, 0, 0);
+    free(table);
+    return op ? (size_t)(op - dst) : 0;
+}
+
+bool JotLZ4Decompress(const uint8_t* src, size_t srcLength, uint8_t* dst, size_t dstLength) {
+    const uint8_t* ip = src;
+    const uint8_t* ipEnd = src + srcLength;
+    uint8_t* op = dst;
+    uint8_t* opEnd = dst + dstLength;
+
+    while (ip < ipEnd) {
+        uint8_t token = *ip++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15) {
+            uint8_t b;
+            do {
+                if (ip >= ipEnd) {
+                    return false;
+                }
+                b = *ip++;
+                literalLength += b;
+            } while (b == 255);
+        }
+        if ((size_t)(ipEnd - ip) < literalLength || (size_t)(opEnd - op) < literalLength) {
+            return false;
+        }
+        memcpy(op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+
+        if (ip == ipEnd) {
+            // the last sequence is only literals
+            break;
+        }
+
+        if (ipEnd - ip < 2) {
+            return false;
+        }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst)) {
+            return false;
+        }
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15) {
+            uint8_t b;
+            do {
+                if (ip >= ipEnd) {
+                    return false;
+                }
+                b = *ip++;
+                matchLength += b;
+            } while (b == 255);
+        }
+        matchLength += kJotLZ4MinMatch;
+        if ((size_t)(opEnd - op) < matchLength) {
+            return false;
+        }
+
+        if (offset == 1) {
+            memset(op, op[-1], matchLength);
+            op += matchLength;
+        } else {
+            // copy the repeating pattern in chunks that never overlap,
+            // doubling the chunk size each time
+            const uint8_t* start = op - offset;
+            while (matchLength) {
+                size_t chunk = (size_t)(op - start);
+                if (chunk > matchLength) {
+                    chunk = matchLength;
+                }
+                memcpy(op, start, chunk);
+                op += chunk;
+                matchLength -= chunk;
+            }
+        }
+    }
+    return op == opEnd;
+}
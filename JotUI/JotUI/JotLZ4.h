@@ -0,0 +1,49 @@
+//
+//  JotLZ4.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#ifndef JotLZ4_h
+#define JotLZ4_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A small compressor and decompressor for the LZ4 block format.
+ *
+ * It's a single greedy pass with a 4 byte hash, which is what we
+ * want for texture bytes: transparent runs collapse into long
+ * matches, and decompression runs at close to memcpy speed.
+ * Blocks are compatible with the reference LZ4_decompress_safe.
+ */
+
+// the most bytes that JotLZ4Compress can write for srcLength input
+size_t JotLZ4CompressBound(size_t srcLength);
+
+/**
+ * compresses src into dst, and returns the compressed length,
+ * or 0 if dst wasn't large enough or the input is over 2GB
+ */
+size_t JotLZ4Compress(const uint8_t* src, size_t srcLength, uint8_t* dst, size_t dstCapacity);
+
+/**
+ * decompresses src into dst, which must be exactly as large as
+ * the original input. returns false for malformed input, and never
+ * reads or writes out of bounds
+ */
+bool JotLZ4Decompress(const uint8_t* src, size_t srcLength, uint8_t* dst, size_t dstLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JotLZ4_h */
@@ -0,0 +1,371 @@
+//
+//  JotMemoryAccountant.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#include "JotMemoryAccountant.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    JotMemoryPoolID poolID;
+    JotMemoryCategory category;
+    int priority;
+    JotMemoryTrimFunction trimFunction;
+    JotMemorySizeFunction sizeFunction;
+    void* context;
+} JotMemoryPool;
+
+typedef struct {
+    const void* page;
+    size_t bytes[JotMemoryCategoryCount];
+} JotMemoryPage;
+
+struct JotMemoryAccountant {
+    // guards everything but the pools' functions
+    pthread_mutex_t lock;
+    // held while calling the pools' functions, so that only one trim
+    // runs at a time, and a pool isn't removed while it's being called
+    pthread_mutex_t trimLock;
+
+    int64_t adjustedBytes[JotMemoryCategoryCount];
+    size_t budgets[JotMemoryDomainCount];
+
+    JotMemoryOverBudgetFunction overBudgetHandler;
+    void* overBudgetContext;
+    // set when the handler is called, and cleared when the budget is enforced
+    bool overBudgetPending;
+
+    // sorted by priority, lowest first
+    JotMemoryPool* pools;
+    size_t poolCount;
+    size_t poolCapacity;
+    JotMemoryPoolID lastPoolID;
+
+    JotMemoryPage* pages;
+    size_t pageCount;
+    size_t pageCapacity;
+
+    uint64_t trimCount;
+    uint64_t trimmedBytes;
+};
+
+JotMemoryDomain JotMemoryCategoryGetDomain(JotMemoryCategory category) {
+    switch (category) {
+        case JotMemoryCategoryTexture:
+        case JotMemoryCategoryVertexBuffer:
+            return JotMemoryDomainGPU;
+        default:
+            return JotMemoryDomainCPU;
+    }
+}
+
+JotMemoryAccountant* JotMemoryAccountantCreate(void) {
+    JotMemoryAccountant* accountant = calloc(1, sizeof(JotMemoryAccountant));
+    if (accountant) {
+        pthread_mutex_init(&accountant->lock, NULL);
+        pthread_mutex_init(&accountant->trimLock, NULL);
+    }
+    return accountant;
+}
+
+#pragma mark - Budgets
+
+void JotMemoryAccountantSetBudget(JotMemoryAccountant* accountant, JotMemoryDomain domain, size_t budget) {
+    pthread_mutex_lock(&accountant->lock);
+    accountant->budgets[domain] = budget;
+    pthread_mutex_unlock(&accountant->lock);
+}
+
+size_t JotMemoryAccountantGetBudget(JotMemoryAccountant* accountant, JotMemoryDomain domain) {
+    pthread_mutex_lock(&accountant->lock);
+    size_t budget = accountant->budgets[domain];
+    pthread_mutex_unlock(&accountant->lock);
+    return budget;
+}
+
+void JotMemoryAccountantSetOverBudgetHandler(JotMemoryAccountant* accountant, JotMemoryOverBudgetFunction handler, void* context) {
+    pthread_mutex_lock(&accountant->lock);
+    accountant->overBudgetHandler = handler;
+    accountant->overBudgetContext = context;
+    pthread_mutex_unlock(&accountant->lock);
+}
+
+// must be called while holding the lock
+static size_t JotMemoryAdjustedDomainBytes(JotMemoryAccountant* accountant, JotMemoryDomain domain) {
+    int64_t bytes = 0;
+    for (int category = 0; category < JotMemoryCategoryCount; category++) {
+        if (JotMemoryCategoryGetDomain(category) == domain) {
+            bytes += accountant->adjustedBytes[category];
+        }
+    }
+    return bytes > 0 ? (size_t)bytes : 0;
+}
+
+void JotMemoryAccountantAdjust(JotMemoryAccountant* accountant, JotMemoryCategory category, int64_t delta) {
+    JotMemoryOverBudgetFunction handler = NULL;
+    void* context = NULL;
+
+    pthread_mutex_lock(&accountant->lock);
+    accountant->adjustedBytes[category] += delta;
+    JotMemoryDomain domain = JotMemoryCategoryGetDomain(category);
+    size_t budget = accountant->budgets[domain];
+    // only the adjusted bytes are checked, since the pools can't be
+    // asked for their size while holding the lock
+    if (delta > 0 && budget && !accountant->overBudgetPending && accountant->overBudgetHandler &&
+        JotMemoryAdjustedDomainBytes(accountant, domain) > budget) {
+        accountant->overBudgetPending = true;
+        handler = accountant->overBudgetHandler;
+        context = accountant->overBudgetContext;
+    }
+    pthread_mutex_unlock(&accountant->lock);
+
+    if (handler) {
+        handler(accountant, context);
+    }
+}
+
+#pragma mark - Pools
+
+JotMemoryPoolID JotMemoryAccountantAddPool(JotMemoryAccountant* accountant,
+                                           JotMemoryCategory category,
+                                           int priority,
+                                           JotMemoryTrimFunction trimFunction,
+                                           JotMemorySizeFunction sizeFunction,
+                                           void* context) {
+    JotMemoryPoolID poolID = 0;
+
+    pthread_mutex_lock(&accountant->trimLock);
+    pthread_mutex_lock(&accountant->lock);
+    if (accountant->poolCount == accountant->poolCapacity) {
+        size_t capacity = accountant->poolCapacity ? accountant->poolCapacity * 2 : 8;
+        JotMemoryPool* pools = realloc(accountant->pools, capacity * sizeof(JotMemoryPool));
+        if (pools) {
+            accountant->pools = pools;
+            accountant->poolCapacity = capacity;
+        }
+    }
+    if (accountant->poolCount < accountant->poolCapacity) {
+        // after every pool of the same priority, so they're trimmed in the order they're added
+        size_t index = accountant->poolCount;
+        while (index > 0 && accountant->pools[index - 1].priority > priority) {
+            index--;
+        }
+        memmove(&accountant->pools[index + 1], &accountant->pools[index], (accountant->poolCount - index) * sizeof(JotMemoryPool));
+        poolID = ++accountant->lastPoolID;
+        accountant->pools[index] = (JotMemoryPool){ poolID, category, priority, trimFunction, sizeFunction, context };
+        accountant->poolCount++;
+    }
+    pthread_mutex_unlock(&accountant->lock);
+    pthread_mutex_unlock(&accountant->trimLock);
+    return poolID;
+}
+
+void JotMemoryAccountantRemovePool(JotMemoryAccountant* accountant, JotMemoryPoolID poolID) {
+    pthread_mutex_lock(&accountant->trimLock);
+    pthread_mutex_lock(&accountant->lock);
+    for (size_t i = 0; i < accountant->poolCount; i++) {
+        if (accountant->pools[i].poolID == poolID) {
+            memmove(&accountant->pools[i], &accountant->pools[i + 1], (accountant->poolCount - i - 1) * sizeof(JotMemoryPool));
+            accountant->poolCount--;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&accountant->lock);
+    pthread_mutex_unlock(&accountant->trimLock);
+}
+
+#pragma mark - Pages
+
+// must be called while holding the lock
+static JotMemoryPage* JotMemoryFindPage(JotMemoryAccountant* accountant, const void* page) {
+    for (size_t i = 0; i < accountant->pageCount; i++) {
+        if (accountant->pages[i].page == page) {
+            return &accountant->pages[i];
+        }
+    }
+    return NULL;
+}
+
+void JotMemoryAccountantSetPageBytes(JotMemoryAccountant* accountant, const void* page, JotMemoryCategory category, size_t bytes) {
+    pthread_mutex_lock(&accountant->lock);
+    JotMemoryPage* entry = JotMemoryFindPage(accountant, page);
+    if (!entry && bytes) {
+        if (accountant->pageCount == accountant->pageCapacity) {
+            size_t capacity = accountant->pageCapacity ? accountant->pageCapacity * 2 : 8;
+            JotMemoryPage* pages = realloc(accountant->pages, capacity * sizeof(JotMemoryPage));
+            if (pages) {
+                accountant->pages = pages;
+                accountant->pageCapacity = capacity;
+            }
+        }
+        if (accountant->pageCount < accountant->pageCapacity) {
+            entry = &accountant->pages[accountant->pageCount++];
+            memset(entry, 0, sizeof(JotMemoryPage));
+            entry->page = page;
+        }
+    }
+    if (entry) {
+        entry->bytes[category] = bytes;
+    }
+    pthread_mutex_unlock(&accountant->lock);
+}
+
+size_t JotMemoryAccountantGetPageBytes(JotMemoryAccountant* accountant, const void* page, JotMemoryCategory category) {
+    pthread_mutex_lock(&accountant->lock);
+    JotMemoryPage* entry = JotMemoryFindPage(accountant, page);
+    size_t bytes = entry ? entry->bytes[category] : 0;
+    pthread_mutex_unlock(&accountant->lock);
+    return bytes;
+}
+
+void JotMemoryAccountantRemovePage(JotMemoryAccountant* accountant, const void* page) {
+    pthread_mutex_lock(&accountant->lock);
+    JotMemoryPage* entry = JotMemoryFindPage(accountant, page);
+    if (entry) {
+        // order doesn't matter, so the last page fills the gap
+        *entry = accountant->pages[--accountant->pageCount];
+    }
+    pthread_mutex_unlock(&accountant->lock);
+}
+
+#pragma mark - Totals
+
+// must be called while holding the trimLock, but not the lock. fills
+// in the bytes of every category, including the pools' sizes
+static void JotMemoryGetCategoryBytes(JotMemoryAccountant* accountant, size_t bytes[JotMemoryCategoryCount]) {
+    int64_t totals[JotMemoryCategoryCount];
+    pthread_mutex_lock(&accountant->lock);
+    memcpy(totals, accountant->adjustedBytes, sizeof(totals));
+    pthread_mutex_unlock(&accountant->lock);
+
+    // the pools only change while holding the trimLock, which the caller holds
+    for (size_t i = 0; i < accountant->poolCount; i++) {
+        JotMemoryPool* pool = &accountant->pools[i];
+        if (pool->sizeFunction) {
+            totals[pool->category] += (int64_t)pool->sizeFunction(pool->context);
+        }
+    }
+    for (int category = 0; category < JotMemoryCategoryCount; category++) {
+        bytes[category] = totals[category] > 0 ? (size_t)totals[category] : 0;
+    }
+}
+
+static void JotMemoryGetDomainBytes(JotMemoryAccountant* accountant, size_t bytes[JotMemoryDomainCount]) {
+    size_t categoryBytes[JotMemoryCategoryCount];
+    JotMemoryGetCategoryBytes(accountant, categoryBytes);
+    memset(bytes, 0, JotMemoryDomainCount * sizeof(size_t));
+    for (int category = 0; category < JotMemoryCategoryCount; category++) {
+        bytes[JotMemoryCategoryGetDomain(category)] += categoryBytes[category];
+    }
+}
+
+size_t JotMemoryAccountantGetCategoryBytes(JotMemoryAccountant* accountant, JotMemoryCategory category) {
+    size_t bytes[JotMemoryCategoryCount];
+    pthread_mutex_lock(&accountant->trimLock);
+    JotMemoryGetCategoryBytes(accountant, bytes);
+    pthread_mutex_unlock(&accountant->trimLock);
+    return bytes[category];
+}
+
+size_t JotMemoryAccountantGetDomainBytes(JotMemoryAccountant* accountant, JotMemoryDomain domain) {
+    size_t bytes[JotMemoryDomainCount];
+    pthread_mutex_lock(&accountant->trimLock);
+    JotMemoryGetDomainBytes(accountant, bytes);
+    pthread_mutex_unlock(&accountant->trimLock);
+    return bytes[domain];
+}
+
+#pragma mark - Trimming
+
+// must be called while holding the trimLock. trims pools, lowest
+// priority first, until each domain is at or below its target
+static size_t JotMemoryTrimToTargets(JotMemoryAccountant* accountant, const size_t targets[JotMemoryDomainCount]) {
+    size_t bytes[JotMemoryDomainCount];
+    size_t overage[JotMemoryDomainCount];
+    JotMemoryGetDomainBytes(accountant, bytes);
+    for (int domain = 0; domain < JotMemoryDomainCount; domain++) {
+        overage[domain] = bytes[domain] > targets[domain] ? bytes[domain] - targets[domain] : 0;
+    }
+
+    size_t freedBytes = 0;
+    uint64_t trimCount = 0;
+    for (size_t i = 0; i < accountant->poolCount; i++) {
+        JotMemoryPool* pool = &accountant->pools[i];
+        JotMemoryDomain domain = JotMemoryCategoryGetDomain(pool->category);
+        if (!overage[domain]) {
+            continue;
+        }
+        size_t freed = pool->trimFunction(pool->context, overage[domain]);
+        overage[domain] -= freed < overage[domain] ? freed : overage[domain];
+        freedBytes += freed;
+        trimCount++;
+    }
+
+    pthread_mutex_lock(&accountant->lock);
+    accountant->trimCount += trimCount;
+    accountant->trimmedBytes += freedBytes;
+    pthread_mutex_unlock(&accountant->lock);
+    return freedBytes;
+}
+
+size_t JotMemoryAccountantEnforceBudget(JotMemoryAccountant* accountant) {
+    size_t targets[JotMemoryDomainCount];
+    pthread_mutex_lock(&accountant->trimLock);
+    pthread_mutex_lock(&accountant->lock);
+    accountant->overBudgetPending = false;
+    for (int domain = 0; domain < JotMemoryDomainCount; domain++) {
+        targets[domain] = accountant->budgets[domain] ? accountant->budgets[domain] : SIZE_MAX;
+    }
+    pthread_mutex_unlock(&accountant->lock);
+    size_t freed = JotMemoryTrimToTargets(accountant, targets);
+    pthread_mutex_unlock(&accountant->trimLock);
+    return freed;
+}
+
+size_t JotMemoryAccountantHandlePressure(JotMemoryAccountant* accountant, JotMemoryPressure pressure) {
+    size_t targets[JotMemoryDomainCount] = { 0 };
+    pthread_mutex_lock(&accountant->trimLock);
+    if (pressure == JotMemoryPressureWarning) {
+        size_t bytes[JotMemoryDomainCount];
+        JotMemoryGetDomainBytes(accountant, bytes);
+        pthread_mutex_lock(&accountant->lock);
+        for (int domain = 0; domain < JotMemoryDomainCount; domain++) {
+            size_t budget = accountant->budgets[domain];
+            targets[domain] = (budget && budget < bytes[domain] ? budget : bytes[domain]) / 2;
+        }
+        pthread_mutex_unlock(&accountant->lock);
+    }
+    size_t freed = JotMemoryTrimToTargets(accountant, targets);
+    pthread_mutex_unlock(&accountant->trimLock);
+    return freed;
+}
+
+uint64_t JotMemoryAccountantGetTrimCount(JotMemoryAccountant* accountant) {
+    pthread_mutex_lock(&accountant->lock);
+    uint64_t trimCount = accountant->trimCount;
+    pthread_mutex_unlock(&accountant->lock);
+    return trimCount;
+}
+
+uint64_t JotMemoryAccountantGetTrimmedBytes(JotMemoryAccountant* accountant) {
+    pthread_mutex_lock(&accountant->lock);
+    uint64_t trimmedBytes = accountant->trimmedBytes;
+    pthread_mutex_unlock(&accountant->lock);
+    return trimmedBytes;
+}
+
+void JotMemoryAccountantFree(JotMemoryAccountant* accountant) {
+    if (!accountant) {
+        return;
+    }
+    pthread_mutex_destroy(&accountant->lock);
+    pthread_mutex_destroy(&accountant->trimLock);
+    free(accountant->pools);
+    free(accountant->pages);
+    free(accountant);
+}
@@ -0,0 +1,137 @@
+//
+//  JotMemoryAccountant.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#ifndef JotMemoryAccountant_h
+#define JotMemoryAccountant_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Tracks the bytes of every cache and resource in one place, and frees
+ * cached memory when it's over budget or under memory pressure.
+ *
+ * Resources adjust the bytes of their category as they're created and
+ * destroyed, and each category counts against either the CPU or the
+ * GPU budget. Pages can also report how many of a category's bytes
+ * they hold, which is a view into the category's bytes and isn't added
+ * to them.
+ *
+ * Caches register as pools with a priority and a trim function. Pools
+ * are trimmed lowest priority first, each asked for whatever its
+ * domain is still over by, until the domain is back under its target.
+ * A pool's trim function returns how many bytes it freed, or will free
+ * once the trash manager deletes them, so trimming doesn't wait on the
+ * category's bytes to go down.
+ *
+ * Adjusting bytes never trims. When a domain's adjusted bytes go over
+ * budget, the over budget handler is called once, and it should
+ * schedule a call to JotMemoryAccountantEnforceBudget on another
+ * thread. The pools' sizes are only counted when the budget is
+ * enforced or the bytes are asked for.
+ *
+ * Every function is thread safe. Trim and size functions are called
+ * without the accountant's lock, so they can adjust bytes, but they
+ * can't trim or ask for a domain's or category's bytes.
+ */
+typedef struct JotMemoryAccountant JotMemoryAccountant;
+
+typedef enum {
+    JotMemoryDomainCPU,
+    JotMemoryDomainGPU,
+    JotMemoryDomainCount
+} JotMemoryDomain;
+
+typedef enum {
+    // every JotGLTexture, including those in the texture cache
+    JotMemoryCategoryTexture,
+    // every OpenGLVBO, including those only holding cached buffers
+    JotMemoryCategoryVertexBuffer,
+    // the buffers of MMDataCache, in use and cached
+    JotMemoryCategoryDataCache,
+    // the compressed ink of unloaded pages, see JotWarmTextureCache
+    JotMemoryCategoryWarmTextures,
+    JotMemoryCategoryCount
+} JotMemoryCategory;
+
+typedef enum {
+    // trims each domain to half of its budget, or half of what it
+    // holds if that's less or it has no budget
+    JotMemoryPressureWarning,
+    // trims every pool as far as it'll go
+    JotMemoryPressureCritical
+} JotMemoryPressure;
+
+// returns the bytes that were freed, which may be more or less than
+// bytesToFree
+typedef size_t (*JotMemoryTrimFunction)(void* context, size_t bytesToFree);
+typedef size_t (*JotMemorySizeFunction)(void* context);
+typedef void (*JotMemoryOverBudgetFunction)(JotMemoryAccountant* accountant, void* context);
+
+typedef uint32_t JotMemoryPoolID;
+
+JotMemoryDomain JotMemoryCategoryGetDomain(JotMemoryCategory category);
+
+JotMemoryAccountant* JotMemoryAccountantCreate(void);
+
+// a budget of 0 is no budget
+void JotMemoryAccountantSetBudget(JotMemoryAccountant* accountant, JotMemoryDomain domain, size_t budget);
+
+size_t JotMemoryAccountantGetBudget(JotMemoryAccountant* accountant, JotMemoryDomain domain);
+
+void JotMemoryAccountantSetOverBudgetHandler(JotMemoryAccountant* accountant, JotMemoryOverBudgetFunction handler, void* context);
+
+void JotMemoryAccountantAdjust(JotMemoryAccountant* accountant, JotMemoryCategory category, int64_t delta);
+
+// registers a cache that can be trimmed. sizeFunction, if not NULL, reports
+// bytes that the pool holds that aren't adjusted into its category, and are
+// added to it. returns 0 if the pool can't be added
+JotMemoryPoolID JotMemoryAccountantAddPool(JotMemoryAccountant* accountant,
+                                           JotMemoryCategory category,
+                                           int priority,
+                                           JotMemoryTrimFunction trimFunction,
+                                           JotMemorySizeFunction sizeFunction,
+                                           void* context);
+
+// waits for any trim that's in progress
+void JotMemoryAccountantRemovePool(JotMemoryAccountant* accountant, JotMemoryPoolID pool);
+
+// sets how many of the category's bytes a page holds
+void JotMemoryAccountantSetPageBytes(JotMemoryAccountant* accountant, const void* page, JotMemoryCategory category, size_t bytes);
+
+size_t JotMemoryAccountantGetPageBytes(JotMemoryAccountant* accountant, const void* page, JotMemoryCategory category);
+
+void JotMemoryAccountantRemovePage(JotMemoryAccountant* accountant, const void* page);
+
+size_t JotMemoryAccountantGetCategoryBytes(JotMemoryAccountant* accountant, JotMemoryCategory category);
+
+size_t JotMemoryAccountantGetDomainBytes(JotMemoryAccountant* accountant, JotMemoryDomain domain);
+
+// trims each domain that's over its budget back down to it. returns the bytes freed
+size_t JotMemoryAccountantEnforceBudget(JotMemoryAccountant* accountant);
+
+// returns the bytes freed
+size_t JotMemoryAccountantHandlePressure(JotMemoryAccountant* accountant, JotMemoryPressure pressure);
+
+// the number of times any pool has been trimmed, and the bytes they freed
+uint64_t JotMemoryAccountantGetTrimCount(JotMemoryAccountant* accountant);
+
+uint64_t JotMemoryAccountantGetTrimmedBytes(JotMemoryAccountant* accountant);
+
+void JotMemoryAccountantFree(JotMemoryAccountant* accountant);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JotMemoryAccountant_h */
@@ -0,0 +1,46 @@
+//
+//  JotMemoryManager.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "JotMemoryAccountant.h"
+
+// cache priorities, lowest is trimmed first
+#define kJotMemoryPriorityDataCache 0
+#define kJotMemoryPriorityWarmTextures 5
+#define kJotMemoryPriorityTextureCache 10
+#define kJotMemoryPriorityVertexBufferCache 20
+#define kJotMemoryPriorityResidentPages 100
+
+
+/**
+ * Owns the accountant that every texture, vertex buffer and cache
+ * reports its bytes to.
+ *
+ * Memory warnings trim every cache as far as it'll go. When either
+ * budget is exceeded, the caches are trimmed back under it on the main
+ * queue, instead of on whichever thread went over.
+ */
+@interface JotMemoryManager : NSObject
+
++ (JotMemoryManager*)sharedManager;
+
+@property(nonatomic, readonly) JotMemoryAccountant* accountant;
+
+// 0, the default, is no budget
+@property(nonatomic, assign) NSUInteger cpuBudget;
+@property(nonatomic, assign) NSUInteger gpuBudget;
+
+@property(nonatomic, readonly) NSUInteger cpuBytes;
+@property(nonatomic, readonly) NSUInteger gpuBytes;
+
+// trims the caches as if for a memory warning, or a critical one
+- (void)handleMemoryPressure:(JotMemoryPressure)pressure;
+
+- (void)enforceBudget;
+
+@end
@@ -0,0 +1,96 @@
+//
+//  JotMemoryManager.m
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import "JotMemoryManager.h"
+#import <UIKit/UIKit.h>
+
+
+@implementation JotMemoryManager
+
+@synthesize accountant;
+
+static JotMemoryManager* sharedManager;
+
++ (JotMemoryManager*)sharedManager {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedManager = [[JotMemoryManager alloc] init];
+    });
+    return sharedManager;
+}
+
+static void JotMemoryManagerOverBudget(JotMemoryAccountant* accountant, void* context) {
+    JotMemoryManager* manager = (__bridge JotMemoryManager*)context;
+    // the bytes that went over budget may have been adjusted while
+    // holding any of the caches' locks, so trim on the main queue
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [manager enforceBudget];
+    });
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        accountant = JotMemoryAccountantCreate();
+        JotMemoryAccountantSetOverBudgetHandler(accountant, &JotMemoryManagerOverBudget, (__bridge void*)self);
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(didReceiveMemoryWarning) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    JotMemoryAccountantFree(accountant);
+}
+
+#pragma mark - Budgets
+
+- (NSUInteger)cpuBudget {
+    return JotMemoryAccountantGetBudget(accountant, JotMemoryDomainCPU);
+}
+
+- (void)setCpuBudget:(NSUInteger)cpuBudget {
+    JotMemoryAccountantSetBudget(accountant, JotMemoryDomainCPU, cpuBudget);
+    [self enforceBudget];
+}
+
+- (NSUInteger)gpuBudget {
+    return JotMemoryAccountantGetBudget(accountant, JotMemoryDomainGPU);
+}
+
+- (void)setGpuBudget:(NSUInteger)gpuBudget {
+    JotMemoryAccountantSetBudget(accountant, JotMemoryDomainGPU, gpuBudget);
+    [self enforceBudget];
+}
+
+- (NSUInteger)cpuBytes {
+    return JotMemoryAccountantGetDomainBytes(accountant, JotMemoryDomainCPU);
+}
+
+- (NSUInteger)gpuBytes {
+    return JotMemoryAccountantGetDomainBytes(accountant, JotMemoryDomainGPU);
+}
+
+#pragma mark - Trimming
+
+- (void)enforceBudget {
+    size_t freed = JotMemoryAccountantEnforceBudget(accountant);
+    if (freed) {
+        DebugLog(@"trimmed %zu bytes to stay under budget", freed);
+    }
+}
+
+- (void)handleMemoryPressure:(JotMemoryPressure)pressure {
+    size_t freed = JotMemoryAccountantHandlePressure(accountant, pressure);
+    DebugLog(@"trimmed %zu bytes for memory pressure", freed);
+}
+
+- (void)didReceiveMemoryWarning {
+    [self handleMemoryPressure:JotMemoryPressureCritical];
+}
+
+@end
@@ -0,0 +1,38 @@
+//
+//  JotPNGEncoder.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "JotImageEncoder.h"
+
+typedef NS_ENUM(NSInteger, JotPNGEncoderMode) {
+    // UIImagePNGRepresentation
+    JotPNGEncoderModeSystem,
+    // JotPNGWriter with its fast options, tuned for autosave
+    JotPNGEncoderModeFast,
+    // JotPNGWriter with zlib's default level and every filter
+    JotPNGEncoderModeCompact
+};
+
+
+@interface JotPNGEncoder : NSObject <JotImageEncoder>
+
+@property(nonatomic, readonly) JotPNGEncoderMode mode;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+- (id)initWithMode:(JotPNGEncoderMode)mode;
+
++ (JotPNGEncoder*)fastEncoder;
+
+// smaller files, written more slowly. for archives and exports
+// rather than autosave
++ (JotPNGEncoder*)compactEncoder;
+
++ (JotPNGEncoder*)systemEncoder;
+
+@end
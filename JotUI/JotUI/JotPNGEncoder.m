@@ -0,0 +1,145 @@
+//
+//  JotPNGEncoder.m
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import "JotPNGEncoder.h"
+#import "JotPNGWriter.h"
+#import "JotImageKernels.h"
+#import "JotInkTiles.h"
+
+
+@implementation JotPNGEncoder {
+    JotPNGEncoderMode mode;
+}
+
+@synthesize mode;
+
+- (id)initWithMode:(JotPNGEncoderMode)_mode {
+    if (self = [super init]) {
+        mode = _mode;
+    }
+    return self;
+}
+
++ (JotPNGEncoder*)fastEncoder {
+    static dispatch_once_t onceToken;
+    static JotPNGEncoder* encoder;
+    dispatch_once(&onceToken, ^{
+        encoder = [[JotPNGEncoder alloc] initWithMode:JotPNGEncoderModeFast];
+    });
+    return encoder;
+}
+
++ (JotPNGEncoder*)compactEncoder {
+    static dispatch_once_t onceToken;
+    static JotPNGEncoder* encoder;
+    dispatch_once(&onceToken, ^{
+        encoder = [[JotPNGEncoder alloc] initWithMode:JotPNGEncoderModeCompact];
+    });
+    return encoder;
+}
+
++ (JotPNGEncoder*)systemEncoder {
+    static dispatch_once_t onceToken;
+    static JotPNGEncoder* encoder;
+    dispatch_once(&onceToken, ^{
+        encoder = [[JotPNGEncoder alloc] initWithMode:JotPNGEncoderModeSystem];
+    });
+    return encoder;
+}
+
+#pragma mark - JotImageEncoder
+
+- (NSData*)encodedDataForImage:(UIImage*)image {
+    return [self encodedDataForImage:image reusingEncodedData:nil];
+}
+
+- (NSData*)encodedDataForImage:(UIImage*)image reusingEncodedData:(NSData*)previousData {
+    if (mode == JotPNGEncoderModeSystem) {
+        return UIImagePNGRepresentation(image);
+    }
+
+    CGImageRef cgImage = image.CGImage;
+    size_t width = CGImageGetWidth(cgImage);
+    size_t height = CGImageGetHeight(cgImage);
+    uint8_t* pixels = [self copyStraightRGBAFromImage:cgImage];
+    if (!pixels) {
+        return UIImagePNGRepresentation(image);
+    }
+
+    JotPNGWriterOptions options = mode == JotPNGEncoderModeCompact ? JotPNGWriterCompactOptions() : JotPNGWriterFastOptions();
+    options.threadCount = (int)MIN(MAX([[NSProcessInfo processInfo] activeProcessorCount], 1), (NSUInteger)options.threadCount);
+
+    size_t length = 0;
+    uint8_t* png = NULL;
+    if (height >= kJotInkTileSize) {
+        // bands of one row of ink tiles, so that a save after a
+        // few strokes only deflates the rows those strokes touched
+        png = JotPNGWriterEncodeBands(pixels, width, height, width * 4, kJotInkTileSize, [previousData bytes], [previousData length], &options, &length, NULL);
+    } else {
+        png = JotPNGWriterEncode(pixels, width, height, width * 4, &options, &length);
+    }
+    free(pixels);
+
+    if (!png) {
+        return UIImagePNGRepresentation(image);
+    }
+    return [NSData dataWithBytesNoCopy:png length:length freeWhenDone:YES];
+}
+
+#pragma mark - Pixels
+
+/**
+ * PNG stores straight alpha, so this returns a malloc'd, tightly packed,
+ * top-to-bottom RGBA buffer that isn't premultiplied. our exported images
+ * are already premultiplied RGBA, so those are copied directly. anything
+ * else is drawn into a bitmap context first.
+ */
+- (uint8_t*)copyStraightRGBAFromImage:(CGImageRef)cgImage {
+    size_t width = CGImageGetWidth(cgImage);
+    size_t height = CGImageGetHeight(cgImage);
+    if (!cgImage || !width || !height) {
+        return NULL;
+    }
+    uint8_t* pixels = malloc(width * height * 4);
+    if (!pixels) {
+        return NULL;
+    }
+
+    CGImageAlphaInfo alphaInfo = CGImageGetAlphaInfo(cgImage);
+    CGBitmapInfo byteOrder = CGImageGetBitmapInfo(cgImage) & kCGBitmapByteOrderMask;
+    BOOL isRGBA = CGImageGetBitsPerComponent(cgImage) == 8 && CGImageGetBitsPerPixel(cgImage) == 32 &&
+        CGColorSpaceGetModel(CGImageGetColorSpace(cgImage)) == kCGColorSpaceModelRGB &&
+        (byteOrder == kCGBitmapByteOrderDefault || byteOrder == kCGBitmapByteOrder32Big) &&
+        (alphaInfo == kCGImageAlphaPremultipliedLast || alphaInfo == kCGImageAlphaLast);
+
+    CFDataRef imageBytes = isRGBA ? CGDataProviderCopyData(CGImageGetDataProvider(cgImage)) : NULL;
+    if (imageBytes) {
+        JotImageResample(CFDataGetBytePtr(imageBytes), width, height, CGImageGetBytesPerRow(cgImage), pixels, width, height, width * 4, JotImageResampleBox, NO);
+        CFRelease(imageBytes);
+        if (alphaInfo == kCGImageAlphaPremultipliedLast) {
+            JotImageUnpremultiply(pixels, width * height);
+        }
+        return pixels;
+    }
+
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef bitmapContext = CGBitmapContextCreate(pixels, width, height, 8, width * 4, colorSpace, kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big);
+    CGColorSpaceRelease(colorSpace);
+    if (!bitmapContext) {
+        free(pixels);
+        return NULL;
+    }
+    CGContextClearRect(bitmapContext, CGRectMake(0, 0, width, height));
+    CGContextDrawImage(bitmapContext, CGRectMake(0, 0, width, height), cgImage);
+    CGContextRelease(bitmapContext);
+
+    JotImageUnpremultiply(pixels, width * height);
+    return pixels;
+}
+
+@end
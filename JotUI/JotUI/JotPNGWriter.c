@@ -0,0 +1,750 @@
+//
+//  JotPNGWriter.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <zlib.h>
+#include "JotPNGWriter.h"
+#include "JotImageKernels.h"
+#include "JotContentHash.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define JOT_PNG_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define JOT_PNG_SSE2 1
+#endif
+
+// deflate can look back at most 32k, so that's all a slice needs from the one above it
+#define kJotPNGWindowSize 32768
+// slices smaller than this aren't worth a thread
+#define kJotPNGMinSliceBytes (256 * 1024)
+#define kJotPNGMaxThreads 16
+
+enum {
+    JotPNGFilterNone = 0,
+    JotPNGFilterSub = 1,
+    JotPNGFilterUp = 2,
+    JotPNGFilterAverage = 3,
+    JotPNGFilterPaeth = 4
+};
+
+
+JotPNGWriterOptions JotPNGWriterFastOptions(void) {
+    JotPNGWriterOptions options;
+    options.level = 1;
+    options.runLengthEncoding = true;
+    options.fastFilters = true;
+    options.threadCount = 4;
+    return options;
+}
+
+JotPNGWriterOptions JotPNGWriterCompactOptions(void) {
+    JotPNGWriterOptions options;
+    options.level = Z_DEFAULT_COMPRESSION;
+    options.runLengthEncoding = false;
+    options.fastFilters = false;
+    options.threadCount = 1;
+    return options;
+}
+
+
+#pragma mark - Filters
+
+// sum of |b| for each byte read as signed, the usual filter heuristic
+static uint32_t jotFilterScore(const uint8_t* bytes, size_t length) {
+    uint32_t score = 0;
+    size_t i = 0;
+    if (JotImageKernelsIsVectorized()) {
+#if defined(JOT_PNG_NEON)
+        uint32x4_t total = vdupq_n_u32(0);
+        while (i + 16 <= length) {
+            // u16 lanes can hold 256 pairs of bytes <= 128 before overflowing
+            uint16x8_t partial = vdupq_n_u16(0);
+            for (int n = 0; n < 128 && i + 16 <= length; n++, i += 16) {
+                uint8x16_t v = vld1q_u8(bytes + i);
+                uint8x16_t magnitude = vminq_u8(v, vreinterpretq_u8_s8(vnegq_s8(vreinterpretq_s8_u8(v))));
+                partial = vpadalq_u8(partial, magnitude);
+            }
+            total = vpadalq_u16(total, partial);
+        }
+        uint64x2_t sum = vpaddlq_u32(total);
+        score = (uint32_t)(vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1));
+#elif defined(JOT_PNG_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        __m128i total = zero;
+        for (; i + 16 <= length; i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(bytes + i));
+            __m128i magnitude = _mm_min_epu8(v, _mm_sub_epi8(zero, v));
+            total = _mm_add_epi64(total, _mm_sad_epu8(magnitude, zero));
+        }
+        score = (uint32_t)(_mm_cvtsi128_si32(total) + _mm_cvtsi128_si32(_mm_srli_si128(total, 8)));
+#endif
+    }
+    for (; i < length; i++) {
+        uint8_t v = bytes[i];
+        score += v < 128 ? v : 256 - v;
+    }
+    return score;
+}
+
+static void jotFilterSub(const uint8_t* row, size_t length, uint8_t* out) {
+    size_t i = 0;
+    for (; i < 4 && i < length; i++) {
+        out[i] = row[i];
+    }
+    if (JotImageKernelsIsVectorized()) {
+#if defined(JOT_PNG_NEON)
+        for (; i + 16 <= length; i += 16) {
+            vst1q_u8(out + i, vsubq_u8(vld1q_u8(row + i), vld1q_u8(row + i - 4)));
+        }
+#elif defined(JOT_PNG_SSE2)
+        for (; i + 16 <= length; i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(row + i));
+            __m128i left = _mm_loadu_si128((const __m128i*)(row + i - 4));
+            _mm_storeu_si128((__m128i*)(out + i), _mm_sub_epi8(x, left));
+        }
+#endif
+    }
+    for (; i < length; i++) {
+        out[i] = (uint8_t)(row[i] - row[i - 4]);
+    }
+}
+
+static void jotFilterUp(const uint8_t* row, const uint8_t* prior, size_t length, uint8_t* out) {
+    size_t i = 0;
+    if (JotImageKernelsIsVectorized()) {
+#if defined(JOT_PNG_NEON)
+        for (; i + 16 <= length; i += 16) {
+            vst1q_u8(out + i, vsubq_u8(vld1q_u8(row + i), vld1q_u8(prior + i)));
+        }
+#elif defined(JOT_PNG_SSE2)
+        for (; i + 16 <= length; i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(row + i));
+            __m128i up = _mm_loadu_si128((const __m128i*)(prior + i));
+            _mm_storeu_si128((__m128i*)(out + i), _mm_sub_epi8(x, up));
+        }
+#endif
+    }
+    for (; i < length; i++) {
+        out[i] = (uint8_t)(row[i] - prior[i]);
+    }
+}
+
+static void jotFilterAverage(const uint8_t* row, const uint8_t* prior, size_t length, uint8_t* out) {
+    for (size_t i = 0; i < length; i++) {
+        int left = i >= 4 ? row[i - 4] : 0;
+        int up = prior ? prior[i] : 0;
+        out[i] = (uint8_t)(row[i] - ((left + up) >> 1));
+    }
+}
+
+static void jotFilterPaeth(const uint8_t* row, const uint8_t* prior, size_t length, uint8_t* out) {
+    for (size_t i = 0; i < length; i++) {
+        int a = i >= 4 ? row[i - 4] : 0;
+        int b = prior ? prior[i] : 0;
+        int c = (prior && i >= 4) ? prior[i - 4] : 0;
+        int p = a + b - c;
+        int pa = abs(p - a);
+        int pb = abs(p - b);
+        int pc = abs(p - c);
+        int predictor = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+        out[i] = (uint8_t)(row[i] - predictor);
+    }
+}
+
+/**
+ * writes the filter type byte and the filtered row to out.
+ * scratch must hold 2 * length bytes
+ */
+static void jotFilterRow(const uint8_t* row, const uint8_t* prior, size_t length, bool fastFilters, uint8_t* out, uint8_t* scratch) {
+    uint8_t* best = out + 1;
+    uint8_t bestType = JotPNGFilterNone;
+    memcpy(best, row, length);
+    uint32_t bestScore = jotFilterScore(best, length);
+
+    // transparent rows are the common case, and can't do any better
+    if (bestScore != 0) {
+        uint8_t* candidate = scratch;
+        uint8_t* spare = scratch + length;
+        int lastType = fastFilters ? JotPNGFilterUp : JotPNGFilterPaeth;
+        for (int type = JotPNGFilterSub; type <= lastType && bestScore; type++) {
+            if (!prior && (type == JotPNGFilterUp || type == JotPNGFilterPaeth)) {
+                // on the first row these are the same as None and Sub
+                continue;
+            }
+            switch (type) {
+                case JotPNGFilterSub:
+                    jotFilterSub(row, length, candidate);
+                    break;
+                case JotPNGFilterUp:
+                    jotFilterUp(row, prior, length, candidate);
+                    break;
+                case JotPNGFilterAverage:
+                    jotFilterAverage(row, prior, length, candidate);
+                    break;
+                default:
+                    jotFilterPaeth(row, prior, length, candidate);
+                    break;
+            }
+            uint32_t score = jotFilterScore(candidate, length);
+            if (score < bestScore) {
+                uint8_t* previousBest = best;
+                best = candidate;
+                bestScore = score;
+                bestType = (uint8_t)type;
+                // the old best is free to write into now, unless it's
+                // the output row itself, in which case use our spare
+                candidate = previousBest == out + 1 ? spare : previousBest;
+                spare = previousBest == out + 1 ? NULL : spare;
+            }
+        }
+        if (best != out + 1) {
+            memcpy(out + 1, best, length);
+        }
+    }
+    out[0] = bestType;
+}
+
+
+#pragma mark - Slices
+
+typedef struct {
+    const uint8_t* rgba;
+    size_t width;
+    size_t bytesPerRow;
+    size_t rowStart;
+    size_t rowEnd;
+    const JotPNGWriterOptions* options;
+    bool last;
+
+    // filtered rows are written into the shared buffer here,
+    // or into the slice's own buffer if this is NULL
+    uint8_t* filtered;
+
+    uint8_t* output;
+    size_t outputLength;
+    uLong adler;
+    bool failed;
+} JotPNGSlice;
+
+static void jotFilterRows(const JotPNGSlice* slice, size_t rowStart, size_t rowEnd, uint8_t* out, uint8_t* scratch) {
+    size_t rowBytes = slice->width * 4;
+    for (size_t y = rowStart; y < rowEnd; y++) {
+        const uint8_t* row = slice->rgba + y * slice->bytesPerRow;
+        const uint8_t* prior = y ? row - slice->bytesPerRow : NULL;
+        jotFilterRow(row, prior, rowBytes, slice->options->fastFilters, out + (y - rowStart) * (rowBytes + 1), scratch);
+    }
+}
+
+// the rows above a slice that deflate can refer back to
+static size_t jotDictionaryRows(size_t stride, size_t rowStart) {
+    size_t dictionaryRows = (kJotPNGWindowSize + stride - 1) / stride;
+    return dictionaryRows > rowStart ? rowStart : dictionaryRows;
+}
+
+static void* jotDeflateSlice(void* arg) {
+    JotPNGSlice* slice = arg;
+    size_t stride = slice->width * 4 + 1;
+    size_t inputLength = (slice->rowEnd - slice->rowStart) * stride;
+    uint8_t* filtered = slice->filtered ? slice->filtered : malloc(inputLength);
+    uint8_t* scratch = malloc(2 * slice->width * 4);
+    if (!filtered || !scratch) {
+        if (filtered != slice->filtered) {
+            free(filtered);
+        }
+        free(scratch);
+        slice->failed = true;
+        return NULL;
+    }
+
+    jotFilterRows(slice, slice->rowStart, slice->rowEnd, filtered, scratch);
+    slice->adler = adler32(adler32(0L, Z_NULL, 0), filtered, (uInt)inputLength);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    int strategy = slice->options->runLengthEncoding ? Z_RLE : Z_DEFAULT_STRATEGY;
+    // negative window bits writes a raw deflate stream, so
+    // the slices can be concatenated into one zlib stream
+    if (deflateInit2(&stream, slice->options->level, Z_DEFLATED, -15, 8, strategy) != Z_OK) {
+        if (filtered != slice->filtered) {
+            free(filtered);
+        }
+        free(scratch);
+        slice->failed = true;
+        return NULL;
+    }
+
+    if (slice->rowStart > 0) {
+        // prime the window with the tail of the slice above us. filtering
+        // is deterministic, so re-filtering those rows gives the same bytes
+        // that the other thread is producing
+        size_t dictionaryRows = jotDictionaryRows(stride, slice->rowStart);
+        uint8_t* dictionary = malloc(dictionaryRows * stride);
+        if (dictionary) {
+            jotFilterRows(slice, slice->rowStart - dictionaryRows, slice->rowStart, dictionary, scratch);
+            size_t dictionaryLength = dictionaryRows * stride;
+            size_t skip = dictionaryLength > kJotPNGWindowSize ? dictionaryLength - kJotPNGWindowSize : 0;
+            deflateSetDictionary(&stream, dictionary + skip, (uInt)(dictionaryLength - skip));
+            free(dictionary);
+        }
+    }
+    free(scratch);
+
+    // a sync flush adds an empty stored block to end on a byte boundary
+    size_t bound = deflateBound(&stream, (uLong)inputLength) + 16;
+    slice->output = malloc(bound);
+    if (!slice->output) {
+        deflateEnd(&stream);
+        if (filtered != slice->filtered) {
+            free(filtered);
+        }
+        slice->failed = true;
+        return NULL;
+    }
+    stream.next_in = filtered;
+    stream.avail_in = (uInt)inputLength;
+    stream.next_out = slice->output;
+    stream.avail_out = (uInt)bound;
+    int result = deflate(&stream, slice->last ? Z_FINISH : Z_SYNC_FLUSH);
+    if ((slice->last && result != Z_STREAM_END) || (!slice->last && (result != Z_OK || stream.avail_in))) {
+        slice->failed = true;
+    }
+    slice->outputLength = bound - stream.avail_out;
+    deflateEnd(&stream);
+    if (filtered != slice->filtered) {
+        free(filtered);
+    }
+    return NULL;
+}
+
+typedef struct {
+    JotPNGSlice** slices;
+    size_t count;
+    size_t next;
+    pthread_mutex_t lock;
+} JotPNGSliceQueue;
+
+static void* jotDeflateQueuedSlices(void* arg) {
+    JotPNGSliceQueue* queue = arg;
+    while (true) {
+        pthread_mutex_lock(&queue->lock);
+        size_t index = queue->next++;
+        pthread_mutex_unlock(&queue->lock);
+        if (index >= queue->count) {
+            return NULL;
+        }
+        jotDeflateSlice(queue->slices[index]);
+    }
+}
+
+// deflates the slices on up to threadCount threads, one of which is
+// this one. threads that can't be started leave their slices to the rest
+static void jotDeflateSlices(JotPNGSlice** slices, size_t count, int threadCount) {
+    JotPNGSliceQueue queue;
+    queue.slices = slices;
+    queue.count = count;
+    queue.next = 0;
+    pthread_mutex_init(&queue.lock, NULL);
+
+    size_t threadsToStart = threadCount < 1 ? 1 : (size_t)threadCount;
+    threadsToStart = threadsToStart > count ? count : threadsToStart;
+    threadsToStart = threadsToStart > kJotPNGMaxThreads ? kJotPNGMaxThreads : threadsToStart;
+    pthread_t threads[kJotPNGMaxThreads];
+    bool started[kJotPNGMaxThreads] = {false};
+    for (size_t i = 1; i < threadsToStart; i++) {
+        started[i] = pthread_create(&threads[i], NULL, jotDeflateQueuedSlices, &queue) == 0;
+    }
+    jotDeflateQueuedSlices(&queue);
+    for (size_t i = 1; i < threadsToStart; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+    pthread_mutex_destroy(&queue.lock);
+}
+
+
+#pragma mark - Chunks
+
+static uint8_t* jotWriteUInt32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+    return out + 4;
+}
+
+static uint32_t jotReadUInt32(const uint8_t* bytes) {
+    return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | (uint32_t)bytes[3];
+}
+
+// writes the chunk's length, type and data, and returns where its crc goes
+static uint8_t* jotBeginChunk(uint8_t* out, const char* type, size_t length, const uint8_t* data) {
+    out = jotWriteUInt32(out, (uint32_t)length);
+    memcpy(out, type, 4);
+    if (data) {
+        memcpy(out + 4, data, length);
+    }
+    return out + 4 + length;
+}
+
+static uint8_t* jotEndChunk(uint8_t* crcLocation, size_t length) {
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, crcLocation - length - 4, (uInt)(length + 4));
+    return jotWriteUInt32(crcLocation, (uint32_t)crc);
+}
+
+// a run of deflate output, from a slice or copied from an earlier PNG
+typedef struct {
+    const uint8_t* bytes;
+    size_t length;
+    uLong adler;
+    // the filtered bytes that it inflates to
+    size_t inflatedLength;
+} JotPNGSegment;
+
+/**
+ * writes the PNG around the segments, which are joined into one zlib
+ * stream. the extra chunk, if there is one, goes just before IDAT
+ */
+static uint8_t* jotWritePNG(size_t width, size_t height, int level, const JotPNGSegment* segments, size_t segmentCount,
+                            const char* extraType, const uint8_t* extra, size_t extraLength, size_t* outLength) {
+    size_t compressedLength = 2 + 4;
+    uLong adler = adler32(0L, Z_NULL, 0);
+    for (size_t i = 0; i < segmentCount; i++) {
+        compressedLength += segments[i].length;
+        adler = adler32_combine(adler, segments[i].adler, (z_off_t)segments[i].inflatedLength);
+    }
+
+    size_t pngLength = 8 + (12 + 13) + (extraType ? 12 + extraLength : 0) + (12 + compressedLength) + 12;
+    uint8_t* png = malloc(pngLength);
+    if (!png) {
+        return NULL;
+    }
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    memcpy(png, signature, 8);
+
+    uint8_t header[13];
+    jotWriteUInt32(header, (uint32_t)width);
+    jotWriteUInt32(header + 4, (uint32_t)height);
+    header[8] = 8; // bits per channel
+    header[9] = 6; // RGBA
+    header[10] = 0; // deflate
+    header[11] = 0; // adaptive filtering
+    header[12] = 0; // not interlaced
+    uint8_t* out = jotEndChunk(jotBeginChunk(png + 8, "IHDR", 13, header), 13);
+
+    if (extraType) {
+        out = jotEndChunk(jotBeginChunk(out, extraType, extraLength, extra), extraLength);
+    }
+
+    uint8_t* data = jotBeginChunk(out, "IDAT", compressedLength, NULL) - compressedLength;
+    level = level == Z_DEFAULT_COMPRESSION ? 6 : level;
+    int levelHint = level < 2 ? 0 : (level < 6 ? 1 : (level == 6 ? 2 : 3));
+    data[0] = 0x78;
+    data[1] = (uint8_t)(levelHint << 6);
+    data[1] += 31 - ((data[0] << 8) + data[1]) % 31;
+    uint8_t* cursor = data + 2;
+    for (size_t i = 0; i < segmentCount; i++) {
+        memcpy(cursor, segments[i].bytes, segments[i].length);
+        cursor += segments[i].length;
+    }
+    cursor = jotWriteUInt32(cursor, (uint32_t)adler);
+    out = jotEndChunk(cursor, compressedLength);
+
+    out = jotEndChunk(jotBeginChunk(out, "IEND", 0, NULL), 0);
+    *outLength = (size_t)(out - png);
+    return png;
+}
+
+
+#pragma mark - Encoding
+
+uint8_t* JotPNGWriterEncode(const uint8_t* rgba, size_t width, size_t height, size_t bytesPerRow,
+                            const JotPNGWriterOptions* options, size_t* outLength) {
+    if (!rgba || !width || !height || width > 0x7FFFFFFF || height > 0x7FFFFFFF) {
+        return NULL;
+    }
+    JotPNGWriterOptions defaults = JotPNGWriterFastOptions();
+    if (!options) {
+        options = &defaults;
+    }
+
+    size_t stride = width * 4 + 1;
+    int sliceCount = options->threadCount < 1 ? 1 : options->threadCount;
+    if (sliceCount > kJotPNGMaxThreads) {
+        sliceCount = kJotPNGMaxThreads;
+    }
+    while (sliceCount > 1 && (height * stride) / sliceCount < kJotPNGMinSliceBytes) {
+        sliceCount--;
+    }
+    if ((size_t)sliceCount > height) {
+        sliceCount = (int)height;
+    }
+
+    uint8_t* filtered = malloc(height * stride);
+    if (!filtered) {
+        return NULL;
+    }
+
+    JotPNGSlice slices[kJotPNGMaxThreads];
+    JotPNGSlice* queuedSlices[kJotPNGMaxThreads];
+    memset(slices, 0, sizeof(slices));
+    size_t rowsPerSlice = height / sliceCount;
+    for (int i = 0; i < sliceCount; i++) {
+        JotPNGSlice* slice = &slices[i];
+        slice->rgba = rgba;
+        slice->width = width;
+        slice->bytesPerRow = bytesPerRow;
+        slice->rowStart = i * rowsPerSlice;
+        slice->rowEnd = (i == sliceCount - 1) ? height : (i + 1) * rowsPerSlice;
+        slice->options = options;
+        slice->last = (i == sliceCount - 1);
+        slice->filtered = filtered + slice->rowStart * stride;
+        queuedSlices[i] = slice;
+    }
+
+    // one slice per thread
+    jotDeflateSlices(queuedSlices, (size_t)sliceCount, sliceCount);
+    free(filtered);
+
+    bool failed = false;
+    JotPNGSegment segments[kJotPNGMaxThreads];
+    for (int i = 0; i < sliceCount; i++) {
+        failed = failed || slices[i].failed;
+        segments[i].bytes = slices[i].output;
+        segments[i].length = slices[i].outputLength;
+        segments[i].adler = slices[i].adler;
+        segments[i].inflatedLength = (slices[i].rowEnd - slices[i].rowStart) * stride;
+    }
+
+    uint8_t* png = failed ? NULL : jotWritePNG(width, height, options->level, segments, (size_t)sliceCount, NULL, NULL, 0, outLength);
+    for (int i = 0; i < sliceCount; i++) {
+        free(slices[i].output);
+    }
+    return png;
+}
+
+
+#pragma mark - Bands
+
+// the private chunk that indexes the bands. it's ancillary, so decoders
+// skip it, and unsafe to copy, since editors that change IDAT break it
+static const char kJotPNGBandChunkType[5] = "jtBD";
+#define kJotPNGBandChunkVersion 1
+// version, band height, flags and band count
+#define kJotPNGBandChunkHeaderLength 16
+// the deflate length, adler32 and row hash of each band
+#define kJotPNGBandChunkEntryLength 16
+#define kJotPNGBandFastFilters 1
+
+typedef struct {
+    size_t rowStart;
+    size_t rowEnd;
+    uint64_t rowHash;
+    // NULL until it's either copied or encoded
+    const uint8_t* compressed;
+    size_t compressedLength;
+    uLong adler;
+} JotPNGBand;
+
+// hashes the straight RGBA of the band's rows, which is what
+// decides whether its encoding from an earlier PNG can be reused
+static uint64_t jotHashBandRows(const uint8_t* rgba, size_t width, size_t bytesPerRow, size_t rowStart, size_t rowEnd) {
+    uint64_t hash = 0;
+    for (size_t y = rowStart; y < rowEnd; y++) {
+        hash = JotContentHash(rgba + y * bytesPerRow, width * 4, hash);
+    }
+    return hash;
+}
+
+/**
+ * finds the bands that previous was written with, if it was written by
+ * JotPNGWriterEncodeBands at this size, band height and filter set, and
+ * checks that its image data is intact. on success, each band's
+ * compressed bytes point into previous
+ */
+static bool jotReadPreviousBands(const uint8_t* previous, size_t previousLength, size_t width, size_t height, size_t bandHeight,
+                                 bool fastFilters, JotPNGBand* previousBands, size_t bandCount) {
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (!previous || previousLength < 8 || memcmp(previous, signature, 8)) {
+        return false;
+    }
+    const uint8_t* index = NULL;
+    const uint8_t* imageData = NULL;
+    size_t imageDataLength = 0;
+    bool hasHeader = false;
+    for (size_t offset = 8; offset + 12 <= previousLength;) {
+        size_t length = jotReadUInt32(previous + offset);
+        if (length > previousLength - offset - 12) {
+            return false;
+        }
+        const uint8_t* type = previous + offset + 4;
+        const uint8_t* data = type + 4;
+        bool isHeader = !memcmp(type, "IHDR", 4);
+        bool isIndex = !memcmp(type, kJotPNGBandChunkType, 4);
+        bool isImageData = !memcmp(type, "IDAT", 4);
+        if (isHeader || isIndex || isImageData) {
+            uLong crc = crc32(crc32(0L, Z_NULL, 0), type, (uInt)(length + 4));
+            if (crc != jotReadUInt32(data + length)) {
+                return false;
+            }
+        }
+        if (isHeader) {
+            static const uint8_t format[5] = {8, 6, 0, 0, 0};
+            hasHeader = length == 13 && jotReadUInt32(data) == width && jotReadUInt32(data + 4) == height && !memcmp(data + 8, format, 5);
+        } else if (isIndex) {
+            if (length != kJotPNGBandChunkHeaderLength + bandCount * kJotPNGBandChunkEntryLength) {
+                return false;
+            }
+            index = data;
+        } else if (isImageData) {
+            if (imageData) {
+                // we only ever write one IDAT
+                return false;
+            }
+            imageData = data;
+            imageDataLength = length;
+        }
+        offset += 12 + length;
+    }
+    if (!hasHeader || !index || !imageData || jotReadUInt32(index) != kJotPNGBandChunkVersion || jotReadUInt32(index + 4) != bandHeight ||
+        (jotReadUInt32(index + 8) & kJotPNGBandFastFilters) != (fastFilters ? kJotPNGBandFastFilters : 0) || jotReadUInt32(index + 12) != bandCount) {
+        return false;
+    }
+
+    // the bands have to add up to the zlib stream, checksum and all
+    size_t stride = width * 4 + 1;
+    size_t offset = 2;
+    uLong adler = adler32(0L, Z_NULL, 0);
+    for (size_t b = 0; b < bandCount; b++) {
+        const uint8_t* entry = index + kJotPNGBandChunkHeaderLength + b * kJotPNGBandChunkEntryLength;
+        JotPNGBand* band = &previousBands[b];
+        band->compressedLength = jotReadUInt32(entry);
+        band->adler = jotReadUInt32(entry + 4);
+        band->rowHash = (uint64_t)jotReadUInt32(entry + 8) << 32 | jotReadUInt32(entry + 12);
+        if (band->compressedLength > imageDataLength || offset > imageDataLength - band->compressedLength) {
+            return false;
+        }
+        band->compressed = imageData + offset;
+        offset += band->compressedLength;
+        adler = adler32_combine(adler, band->adler, (z_off_t)((band->rowEnd - band->rowStart) * stride));
+    }
+    return offset + 4 == imageDataLength && jotReadUInt32(imageData + offset) == (uint32_t)adler;
+}
+
+uint8_t* JotPNGWriterEncodeBands(const uint8_t* rgba, size_t width, size_t height, size_t bytesPerRow, size_t bandHeight,
+                                 const uint8_t* previous, size_t previousLength, const JotPNGWriterOptions* options,
+                                 size_t* outLength, size_t* encodedBandCount) {
+    if (!rgba || !width || !height || !bandHeight || width > 0x7FFFFFFF || height > 0x7FFFFFFF || bandHeight > height) {
+        return NULL;
+    }
+    JotPNGWriterOptions defaults = JotPNGWriterFastOptions();
+    if (!options) {
+        options = &defaults;
+    }
+
+    size_t stride = width * 4 + 1;
+    size_t bandCount = (height + bandHeight - 1) / bandHeight;
+    JotPNGBand* bands = calloc(bandCount, sizeof(JotPNGBand));
+    JotPNGBand* previousBands = calloc(bandCount, sizeof(JotPNGBand));
+    JotPNGSlice* slices = calloc(bandCount, sizeof(JotPNGSlice));
+    JotPNGSlice** queuedSlices = calloc(bandCount, sizeof(JotPNGSlice*));
+    JotPNGSegment* segments = calloc(bandCount, sizeof(JotPNGSegment));
+    uint8_t* index = malloc(kJotPNGBandChunkHeaderLength + bandCount * kJotPNGBandChunkEntryLength);
+    uint8_t* png = NULL;
+    if (!bands || !previousBands || !slices || !queuedSlices || !segments || !index) {
+        goto done;
+    }
+
+    for (size_t b = 0; b < bandCount; b++) {
+        bands[b].rowStart = previousBands[b].rowStart = b * bandHeight;
+        bands[b].rowEnd = previousBands[b].rowEnd = b == bandCount - 1 ? height : (b + 1) * bandHeight;
+        bands[b].rowHash = jotHashBandRows(rgba, width, bytesPerRow, bands[b].rowStart, bands[b].rowEnd);
+    }
+
+    if (jotReadPreviousBands(previous, previousLength, width, height, bandHeight, options->fastFilters, previousBands, bandCount)) {
+        // a band can be copied if its rows are the same, and so are the
+        // rows above it that deflate primed its window with
+        size_t lastChangedBand = SIZE_MAX;
+        for (size_t b = 0; b < bandCount; b++) {
+            if (bands[b].rowHash != previousBands[b].rowHash) {
+                lastChangedBand = b;
+                continue;
+            }
+            size_t firstDictionaryRow = bands[b].rowStart - jotDictionaryRows(stride, bands[b].rowStart);
+            if (lastChangedBand == SIZE_MAX || previousBands[lastChangedBand].rowEnd <= firstDictionaryRow) {
+                bands[b].compressed = previousBands[b].compressed;
+                bands[b].compressedLength = previousBands[b].compressedLength;
+                bands[b].adler = previousBands[b].adler;
+            }
+        }
+    }
+
+    size_t bandsToEncode = 0;
+    for (size_t b = 0; b < bandCount; b++) {
+        if (!bands[b].compressed) {
+            JotPNGSlice* slice = &slices[b];
+            slice->rgba = rgba;
+            slice->width = width;
+            slice->bytesPerRow = bytesPerRow;
+            slice->rowStart = bands[b].rowStart;
+            slice->rowEnd = bands[b].rowEnd;
+            slice->options = options;
+            slice->last = b == bandCount - 1;
+            queuedSlices[bandsToEncode++] = slice;
+        }
+    }
+    jotDeflateSlices(queuedSlices, bandsToEncode, options->threadCount);
+
+    uint8_t* entry = index;
+    entry = jotWriteUInt32(entry, kJotPNGBandChunkVersion);
+    entry = jotWriteUInt32(entry, (uint32_t)bandHeight);
+    entry = jotWriteUInt32(entry, options->fastFilters ? kJotPNGBandFastFilters : 0);
+    entry = jotWriteUInt32(entry, (uint32_t)bandCount);
+    bool failed = false;
+    for (size_t b = 0; b < bandCount; b++) {
+        if (!bands[b].compressed) {
+            failed = failed || slices[b].failed;
+            bands[b].compressed = slices[b].output;
+            bands[b].compressedLength = slices[b].outputLength;
+            bands[b].adler = slices[b].adler;
+        }
+        segments[b].bytes = bands[b].compressed;
+        segments[b].length = bands[b].compressedLength;
+        segments[b].adler = bands[b].adler;
+        segments[b].inflatedLength = (bands[b].rowEnd - bands[b].rowStart) * stride;
+        entry = jotWriteUInt32(entry, (uint32_t)bands[b].compressedLength);
+        entry = jotWriteUInt32(entry, (uint32_t)bands[b].adler);
+        entry = jotWriteUInt32(entry, (uint32_t)(bands[b].rowHash >> 32));
+        entry = jotWriteUInt32(entry, (uint32_t)bands[b].rowHash);
+    }
+    if (!failed) {
+        png = jotWritePNG(width, height, options->level, segments, bandCount, kJotPNGBandChunkType, index, (size_t)(entry - index), outLength);
+        if (png && encodedBandCount) {
+            *encodedBandCount = bandsToEncode;
+        }
+    }
+
+done:
+    if (slices) {
+        for (size_t b = 0; b < bandCount; b++) {
+            free(slices[b].output);
+        }
+    }
+    free(bands);
+    free(previousBands);
+    free(slices);
+    free(queuedSlices);
+    free(segments);
+    free(index);
+    return png;
+}
@@ -0,0 +1,88 @@
+//
+//  JotPNGWriter.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#ifndef JotPNGWriter_h
+#define JotPNGWriter_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A PNG writer tuned for ink pages, which are mostly
+ * transparent with a small amount of antialiased ink.
+ *
+ * Rows are filtered with a per-row heuristic (the filtered row
+ * with the smallest sum of absolute values wins), and the image
+ * is cut into horizontal slices that are filtered and deflated
+ * on separate threads. Each slice is primed with the tail of
+ * the slice above it, and the slices are joined into a single
+ * zlib stream, so the output is an ordinary 8 bit RGBA PNG.
+ */
+
+typedef struct {
+    // zlib compression level, 1 (fastest) to 9 (smallest)
+    int level;
+    // use zlib's run length strategy, which is much faster
+    // on transparent pages and compresses them nearly as well
+    bool runLengthEncoding;
+    // only consider the None, Sub and Up filters. Average and
+    // Paeth compress a bit better, but cost far more to try
+    bool fastFilters;
+    // number of slices to filter and deflate in parallel
+    int threadCount;
+} JotPNGWriterOptions;
+
+/**
+ * the options used for autosave: run length deflate at
+ * level 1 with the fast filters across 4 threads
+ */
+JotPNGWriterOptions JotPNGWriterFastOptions(void);
+
+/**
+ * zlib's default level and strategy with every filter.
+ * slower, but closer to what ImageIO produces
+ */
+JotPNGWriterOptions JotPNGWriterCompactOptions(void);
+
+/**
+ * encodes straight (not premultiplied) RGBA pixels, with the
+ * first row at the top of the image.
+ *
+ * returns a malloc'd buffer that the caller must free(), and
+ * sets outLength to its size. returns NULL on failure
+ */
+uint8_t* JotPNGWriterEncode(const uint8_t* rgba, size_t width, size_t height, size_t bytesPerRow,
+                            const JotPNGWriterOptions* options, size_t* outLength);
+
+/**
+ * encodes like JotPNGWriterEncode, but deflates each band of
+ * bandHeight rows on its own, and records the bands in a private
+ * chunk that decoders ignore.
+ *
+ * if previous is a PNG that this wrote at the same size and band
+ * height, bands whose rows haven't changed are copied from it
+ * instead of being encoded again. previous is checked against its
+ * own checksums first, so any file can be passed in, or NULL.
+ *
+ * sets encodedBandCount, if it's not NULL, to the number of bands
+ * that weren't copied. returns a malloc'd buffer, or NULL on failure
+ */
+uint8_t* JotPNGWriterEncodeBands(const uint8_t* rgba, size_t width, size_t height, size_t bytesPerRow, size_t bandHeight,
+                                 const uint8_t* previous, size_t previousLength, const JotPNGWriterOptions* options,
+                                 size_t* outLength, size_t* encodedBandCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JotPNGWriter_h */
@@ -0,0 +1,75 @@
+//
+//  JotPageJournal.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#define kJotPageJournalExt @"jotjournal"
+
+/**
+ * A page's strokes and undo state used to be saved as a file per stroke
+ * plus a state plist, and every save checked each stroke's file, swept
+ * the directory for deleted strokes, and rewrote the plist.
+ *
+ * The journal saves all of that into a single append only file instead.
+ * Each save appends a record for every new stroke, then the state, then
+ * a record for every stroke that's no longer used, and fsyncs once.
+ * Reading the journal replays the records, so a stroke's latest record
+ * wins and the last state is the page's state.
+ *
+ * Every record has a checksum. A save that's cut short by a crash
+ * leaves a torn record at the end of the file, which is truncated away
+ * when the journal is next read, so the page opens to its last complete
+ * save. Once the records that have been replaced or removed outweigh the
+ * live ones, the journal is compacted into a new file that's swapped in
+ * with a rename.
+ */
+@interface JotPageJournal : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+// the journal is saved next to the state file, as state.jotjournal
++ (NSString*)journalPathForStatePath:(NSString*)statePath;
+
+// journals are cached, so the file is only read again if it's changed
+// since it was last read or written
++ (JotPageJournal*)journalForStatePath:(NSString*)statePath;
+
+// the journal at path, for other per page files with keyed records
++ (JotPageJournal*)journalAtPath:(NSString*)path;
+
+@property(nonatomic, readonly) NSString* path;
+
+// the state from the last save, or nil if the page hasn't been saved to a journal
+@property(nonatomic, readonly) NSDictionary* state;
+
+// the bytes of the records that are still used, and of the ones
+// that have been replaced or removed since the last compaction
+@property(nonatomic, readonly) uint64_t liveBytes;
+@property(nonatomic, readonly) uint64_t deadBytes;
+
+// the uuids of every stroke in the journal
+@property(nonatomic, readonly) NSArray* strokeUUIDs;
+
+- (BOOL)containsStroke:(NSString*)uuid;
+
+// the data that was saved for the stroke, mapped from the journal
+// without copying. returns nil if the journal doesn't have the stroke
+- (NSData*)dataForStroke:(NSString*)uuid;
+
+// saves the state with one append and one fsync. strokeData has the
+// saved data for each stroke that's new or changed, keyed by uuid, and
+// strokeUUIDs is every stroke that the state uses. any other stroke in
+// the journal is removed.
+//
+// compacts the journal afterward if enough of it is dead
+- (BOOL)saveState:(NSDictionary*)state withStrokes:(NSArray*)strokeUUIDs andStrokeData:(NSDictionary*)strokeData;
+
+// rewrites the journal with only its live strokes and latest state
+- (BOOL)compact;
+
+@end
@@ -0,0 +1,492 @@
+//
+//  JotPageJournal.m
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import "JotPageJournal.h"
+#import <zlib.h>
+#import <fcntl.h>
+#import <unistd.h>
+#import <sys/stat.h>
+
+#define kJotPageJournalVersion 1
+// saves compact the journal once its dead records are at least
+// this large and outweigh the records that are still live
+#define kJotPageJournalMinDeadBytes (256 * 1024)
+// the number of page journals to keep indexed in memory
+#define kJotPageJournalCacheLimit 32
+
+typedef enum : uint8_t {
+    // the saved data of a stroke, keyed by its uuid. this
+    // replaces any earlier record for the same stroke
+    JotPageJournalRecordStroke = 1,
+    // the stroke with this uuid isn't used anymore
+    JotPageJournalRecordRemoved = 2,
+    // the page's state as a binary plist, with an empty key
+    JotPageJournalRecordState = 3
+} JotPageJournalRecordType;
+
+// all fields are little endian, which is every platform we run on
+struct JotPageJournalHeader {
+    char magic[4];
+    uint32_t version;
+};
+typedef struct JotPageJournalHeader JotPageJournalHeader;
+
+// each record is this header, then its key, then its payload
+struct JotPageJournalRecordHeader {
+    uint8_t type;
+    uint8_t reserved[3];
+    uint32_t keyLength;
+    uint32_t payloadLength;
+    // crc32 of the fields above, the key and the payload
+    uint32_t checksum;
+};
+typedef struct JotPageJournalRecordHeader JotPageJournalRecordHeader;
+
+static const char kJotPageJournalMagic[4] = {'J', 'J', 'R', 'N'};
+
+static uint32_t JotPageJournalRecordChecksum(const JotPageJournalRecordHeader* record, const uint8_t* key, const uint8_t* payload) {
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (const Bytef*)record, offsetof(JotPageJournalRecordHeader, checksum));
+    // crc32 resets to 0 when given a NULL buffer, so skip empty parts
+    if (record->keyLength) {
+        crc = crc32(crc, key, record->keyLength);
+    }
+    if (record->payloadLength) {
+        crc = crc32(crc, payload, record->payloadLength);
+    }
+    return (uint32_t)crc;
+}
+
+// appends the record to batch, and returns its range within batch
+static NSRange JotPageJournalAppendRecord(NSMutableData* batch, JotPageJournalRecordType type, NSString* key, NSData* payload) {
+    NSData* keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+    JotPageJournalRecordHeader record;
+    memset(&record, 0, sizeof(record));
+    record.type = type;
+    record.keyLength = (uint32_t)[keyData length];
+    record.payloadLength = (uint32_t)[payload length];
+    record.checksum = JotPageJournalRecordChecksum(&record, [keyData bytes], [payload bytes]);
+
+    NSRange range = NSMakeRange([batch length], sizeof(record) + record.keyLength + record.payloadLength);
+    [batch appendBytes:&record length:sizeof(record)];
+    [batch appendData:keyData];
+    [batch appendData:payload];
+    return range;
+}
+
+static BOOL JotPageJournalWrite(int fd, const void* bytes, size_t length) {
+    const uint8_t* next = bytes;
+    while (length) {
+        ssize_t written = write(fd, next, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return NO;
+        }
+        next += written;
+        length -= written;
+    }
+    return YES;
+}
+
+// makes a rename into the directory durable
+static BOOL JotPageJournalSyncDirectory(NSString* directory) {
+    int fd = open([directory fileSystemRepresentation], O_RDONLY);
+    if (fd < 0) {
+        return NO;
+    }
+    BOOL success = fsync(fd) == 0;
+    close(fd);
+    return success;
+}
+
+
+@implementation JotPageJournal {
+    // the length of the journal's valid records, and the
+    // inode of the file, as of the last read or write
+    uint64_t fileLength;
+    ino_t fileInode;
+    // uuid -> NSValue with the NSRange of the stroke's latest record
+    NSMutableDictionary* strokeRecords;
+    NSRange stateRecord;
+    // the journal up to fileLength, mapped. it's mapped again if
+    // a stroke is asked for that was appended after it was mapped
+    dispatch_data_t mappedJournal;
+}
+
+@synthesize path;
+@synthesize state;
+
++ (NSString*)journalPathForStatePath:(NSString*)statePath {
+    return [[statePath stringByDeletingPathExtension] stringByAppendingPathExtension:kJotPageJournalExt];
+}
+
++ (JotPageJournal*)journalForStatePath:(NSString*)statePath {
+    return [self journalAtPath:[self journalPathForStatePath:statePath]];
+}
+
++ (JotPageJournal*)journalAtPath:(NSString*)journalPath {
+    static NSCache* journals;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        journals = [[NSCache alloc] init];
+        journals.countLimit = kJotPageJournalCacheLimit;
+    });
+
+    @synchronized(journals) {
+        JotPageJournal* journal = [journals objectForKey:journalPath];
+        if (!journal || ![journal matchesFile]) {
+            journal = [[JotPageJournal alloc] initWithPath:journalPath];
+            [journals setObject:journal forKey:journalPath];
+        }
+        return journal;
+    }
+}
+
+- (instancetype)initWithPath:(NSString*)journalPath {
+    if (self = [super init]) {
+        path = journalPath;
+        [self readJournal];
+    }
+    return self;
+}
+
+#pragma mark - Reading
+
+// the index is only good for the file we read or wrote last. if the
+// page's files were deleted or replaced since then, it needs reading again
+- (BOOL)matchesFile {
+    @synchronized(self) {
+        struct stat info;
+        if (stat([path fileSystemRepresentation], &info) != 0) {
+            return fileLength == 0;
+        }
+        return info.st_ino == fileInode && (uint64_t)info.st_size == fileLength;
+    }
+}
+
+// maps the journal up to fileLength, and returns the mapped bytes
+- (NSData*)mapJournal {
+    NSData* data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+    if (!data) {
+        mappedJournal = nil;
+        return nil;
+    }
+    // the dispatch data keeps the mapping alive for as long as
+    // any stroke data that's a subrange of it
+    dispatch_data_t mapped = dispatch_data_create([data bytes], [data length], NULL, ^{
+        (void)data;
+    });
+    mappedJournal = dispatch_data_create_subrange(mapped, 0, MIN([data length], fileLength));
+    return data;
+}
+
+- (void)readJournal {
+    strokeRecords = [NSMutableDictionary dictionary];
+    stateRecord = NSMakeRange(0, 0);
+    state = nil;
+    fileLength = 0;
+    fileInode = 0;
+    mappedJournal = nil;
+
+    struct stat info;
+    if (stat([path fileSystemRepresentation], &info) != 0) {
+        // nothing has been saved yet
+        return;
+    }
+    fileLength = info.st_size;
+    NSData* data = [self mapJournal];
+    const uint8_t* bytes = [data bytes];
+    size_t length = [data length];
+
+    JotPageJournalHeader header;
+    if (length < sizeof(header)) {
+        DebugLog(@"unreadable page journal %@", path);
+        fileLength = 0;
+        return;
+    }
+    memcpy(&header, bytes, sizeof(header));
+    if (memcmp(header.magic, kJotPageJournalMagic, sizeof(header.magic)) != 0 || header.version != kJotPageJournalVersion) {
+        // the next save will replace it
+        DebugLog(@"unreadable page journal %@", path);
+        fileLength = 0;
+        return;
+    }
+
+    size_t offset = sizeof(header);
+    while (length - offset >= sizeof(JotPageJournalRecordHeader)) {
+        JotPageJournalRecordHeader record;
+        memcpy(&record, bytes + offset, sizeof(record));
+        size_t available = length - offset - sizeof(record);
+        if (record.keyLength > available || record.payloadLength > available - record.keyLength) {
+            break;
+        }
+        const uint8_t* key = bytes + offset + sizeof(record);
+        const uint8_t* payload = key + record.keyLength;
+        if (JotPageJournalRecordChecksum(&record, key, payload) != record.checksum) {
+            break;
+        }
+        NSRange range = NSMakeRange(offset, sizeof(record) + record.keyLength + record.payloadLength);
+        if (record.type == JotPageJournalRecordStroke || record.type == JotPageJournalRecordRemoved) {
+            NSString* uuid = [[NSString alloc] initWithBytes:key length:record.keyLength encoding:NSUTF8StringEncoding];
+            if (!uuid) {
+                break;
+            }
+            if (record.type == JotPageJournalRecordStroke) {
+                [strokeRecords setObject:[NSValue valueWithRange:range] forKey:uuid];
+            } else {
+                [strokeRecords removeObjectForKey:uuid];
+            }
+        } else if (record.type == JotPageJournalRecordState) {
+            stateRecord = range;
+        }
+        offset = NSMaxRange(range);
+    }
+
+    if (offset < length) {
+        // the end of the journal is from a save that didn't finish.
+        // drop it, so that the next save appends after the last good record
+        DebugLog(@"truncating torn page journal %@ from %zu to %zu bytes", path, length, offset);
+        if (truncate([path fileSystemRepresentation], offset) != 0) {
+            fileLength = 0;
+            return;
+        }
+    }
+    fileLength = offset;
+    fileInode = info.st_ino;
+    if (mappedJournal) {
+        mappedJournal = dispatch_data_create_subrange(mappedJournal, 0, offset);
+    }
+
+    if (stateRecord.length) {
+        NSUInteger headerLength = sizeof(JotPageJournalRecordHeader);
+        NSData* stateData = [NSData dataWithBytesNoCopy:(void*)(bytes + stateRecord.location + headerLength) length:stateRecord.length - headerLength freeWhenDone:NO];
+        state = [NSPropertyListSerialization propertyListWithData:stateData options:NSPropertyListImmutable format:NULL error:nil];
+    }
+}
+
+- (uint64_t)liveBytes {
+    @synchronized(self) {
+        uint64_t liveBytes = fileLength ? sizeof(JotPageJournalHeader) + stateRecord.length : 0;
+        for (NSValue* record in [strokeRecords allValues]) {
+            liveBytes += [record rangeValue].length;
+        }
+        return liveBytes;
+    }
+}
+
+- (uint64_t)deadBytes {
+    @synchronized(self) {
+        return fileLength - [self liveBytes];
+    }
+}
+
+- (NSArray*)strokeUUIDs {
+    @synchronized(self) {
+        return [strokeRecords allKeys];
+    }
+}
+
+- (BOOL)containsStroke:(NSString*)uuid {
+    @synchronized(self) {
+        return [strokeRecords objectForKey:uuid] != nil;
+    }
+}
+
+- (NSData*)dataForStroke:(NSString*)uuid {
+    @synchronized(self) {
+        NSValue* record = [strokeRecords objectForKey:uuid];
+        if (!record) {
+            return nil;
+        }
+        NSRange range = [record rangeValue];
+        if (!mappedJournal || NSMaxRange(range) > dispatch_data_get_size(mappedJournal)) {
+            [self mapJournal];
+            if (!mappedJournal || NSMaxRange(range) > dispatch_data_get_size(mappedJournal)) {
+                return nil;
+            }
+        }
+        NSUInteger headerLength = sizeof(JotPageJournalRecordHeader) + [uuid lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+        // a subrange shares the mapping instead of copying it
+        return (NSData*)dispatch_data_create_subrange(mappedJournal, range.location + headerLength, range.length - headerLength);
+    }
+}
+
+#pragma mark - Writing
+
+// writes the header and then chunks to a new file, and swaps it in for the journal
+- (BOOL)replaceJournalWithChunks:(NSArray*)chunks {
+    NSString* tempPath = [path stringByAppendingPathExtension:@"tmp"];
+    int fd = open([tempPath fileSystemRepresentation], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return NO;
+    }
+    JotPageJournalHeader header;
+    memcpy(header.magic, kJotPageJournalMagic, sizeof(header.magic));
+    header.version = kJotPageJournalVersion;
+    BOOL success = JotPageJournalWrite(fd, &header, sizeof(header));
+    for (NSData* chunk in chunks) {
+        success = success && JotPageJournalWrite(fd, [chunk bytes], [chunk length]);
+    }
+    success = success && fsync(fd) == 0;
+    close(fd);
+    if (!success || rename([tempPath fileSystemRepresentation], [path fileSystemRepresentation]) != 0) {
+        unlink([tempPath fileSystemRepresentation]);
+        return NO;
+    }
+    // without this, a crash can leave the old journal in place after
+    // the caller has dropped the records it replaced. the new journal
+    // is in place either way, so the index has to follow it
+    if (!JotPageJournalSyncDirectory([path stringByDeletingLastPathComponent])) {
+        DebugLog(@"couldn't sync the directory of page journal %@", path);
+    }
+    return YES;
+}
+
+// appends batch to the journal in one write, and returns NO without
+// changing the journal if it can't
+- (BOOL)appendBatch:(NSData*)batch {
+    int fd = open([path fileSystemRepresentation], O_WRONLY | O_APPEND);
+    if (fd < 0) {
+        return NO;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_ino != fileInode || (uint64_t)info.st_size != fileLength) {
+        // the journal changed underneath us, so our index is stale
+        close(fd);
+        return NO;
+    }
+    if (!JotPageJournalWrite(fd, [batch bytes], [batch length]) || fsync(fd) != 0) {
+        // don't leave part of the batch for the next save to append after
+        ftruncate(fd, fileLength);
+        close(fd);
+        return NO;
+    }
+    close(fd);
+    return YES;
+}
+
+- (BOOL)saveState:(NSDictionary*)newState withStrokes:(NSArray*)strokeUUIDs andStrokeData:(NSDictionary*)strokeData {
+    @synchronized(self) {
+        NSData* stateData = [NSPropertyListSerialization dataWithPropertyList:newState format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+        if (!stateData) {
+            return NO;
+        }
+
+        // the new strokes go before the state, and the removals go after it.
+        // that way a save that's cut short never leaves the last complete
+        // state without one of its strokes
+        NSMutableData* batch = [NSMutableData data];
+        NSMutableDictionary* addedRecords = [NSMutableDictionary dictionary];
+        for (NSString* uuid in [[strokeData allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+            NSRange range = JotPageJournalAppendRecord(batch, JotPageJournalRecordStroke, uuid, [strokeData objectForKey:uuid]);
+            [addedRecords setObject:[NSValue valueWithRange:range] forKey:uuid];
+        }
+        NSRange newStateRecord = JotPageJournalAppendRecord(batch, JotPageJournalRecordState, @"", stateData);
+        NSSet* usedStrokes = [NSSet setWithArray:strokeUUIDs];
+        NSMutableArray* removedStrokes = [NSMutableArray array];
+        for (NSString* uuid in [strokeRecords allKeys]) {
+            if (![usedStrokes containsObject:uuid] && ![addedRecords objectForKey:uuid]) {
+                JotPageJournalAppendRecord(batch, JotPageJournalRecordRemoved, uuid, nil);
+                [removedStrokes addObject:uuid];
+            }
+        }
+
+        uint64_t batchOffset;
+        if (fileLength) {
+            if (![self appendBatch:batch]) {
+                DebugLog(@"couldn't append to page journal %@", path);
+                return NO;
+            }
+            batchOffset = fileLength;
+        } else {
+            // there isn't a journal yet, or it's one we can't read
+            if (![self replaceJournalWithChunks:@[batch]]) {
+                DebugLog(@"couldn't write page journal %@", path);
+                return NO;
+            }
+            batchOffset = sizeof(JotPageJournalHeader);
+            [strokeRecords removeAllObjects];
+            mappedJournal = nil;
+        }
+
+        for (NSString* uuid in addedRecords) {
+            NSRange range = [[addedRecords objectForKey:uuid] rangeValue];
+            range.location += batchOffset;
+            [strokeRecords setObject:[NSValue valueWithRange:range] forKey:uuid];
+        }
+        [strokeRecords removeObjectsForKeys:removedStrokes];
+        stateRecord = NSMakeRange(batchOffset + newStateRecord.location, newStateRecord.length);
+        state = [newState copy];
+        fileLength = batchOffset + [batch length];
+
+        struct stat info;
+        if (stat([path fileSystemRepresentation], &info) == 0) {
+            fileInode = info.st_ino;
+        }
+
+        uint64_t deadBytes = [self deadBytes];
+        if (deadBytes >= kJotPageJournalMinDeadBytes && deadBytes > [self liveBytes]) {
+            [self compact];
+        }
+        return YES;
+    }
+}
+
+- (BOOL)compact {
+    @synchronized(self) {
+        if (!fileLength) {
+            return NO;
+        }
+        NSData* journal = [self mapJournal];
+        if ([journal length] < fileLength) {
+            return NO;
+        }
+
+        // copy the live records in the order they were written, so a
+        // page's strokes stay in about the order they're loaded in
+        NSArray* uuids = [[strokeRecords allKeys] sortedArrayUsingComparator:^NSComparisonResult(NSString* uuid1, NSString* uuid2) {
+            NSUInteger location1 = [[strokeRecords objectForKey:uuid1] rangeValue].location;
+            NSUInteger location2 = [[strokeRecords objectForKey:uuid2] rangeValue].location;
+            return location1 < location2 ? NSOrderedAscending : location1 > location2 ? NSOrderedDescending : NSOrderedSame;
+        }];
+        NSMutableArray* chunks = [NSMutableArray array];
+        NSMutableDictionary* compactedRecords = [NSMutableDictionary dictionary];
+        uint64_t offset = sizeof(JotPageJournalHeader);
+        for (NSString* uuid in uuids) {
+            NSRange range = [[strokeRecords objectForKey:uuid] rangeValue];
+            [chunks addObject:[NSData dataWithBytesNoCopy:(void*)((const uint8_t*)[journal bytes] + range.location) length:range.length freeWhenDone:NO]];
+            [compactedRecords setObject:[NSValue valueWithRange:NSMakeRange(offset, range.length)] forKey:uuid];
+            offset += range.length;
+        }
+        NSRange compactedStateRecord = NSMakeRange(offset, stateRecord.length);
+        if (stateRecord.length) {
+            [chunks addObject:[NSData dataWithBytesNoCopy:(void*)((const uint8_t*)[journal bytes] + stateRecord.location) length:stateRecord.length freeWhenDone:NO]];
+            offset += stateRecord.length;
+        }
+
+        if (![self replaceJournalWithChunks:chunks]) {
+            DebugLog(@"couldn't compact page journal %@", path);
+            return NO;
+        }
+
+        strokeRecords = compactedRecords;
+        stateRecord = compactedStateRecord;
+        fileLength = offset;
+        struct stat info;
+        if (stat([path fileSystemRepresentation], &info) == 0) {
+            fileInode = info.st_ino;
+        }
+        // the old mapping is of the file we just replaced
+        mappedJournal = nil;
+        return YES;
+    }
+}
+
+@end
@@ -0,0 +1,68 @@
+//
+//  JotPageResidencyManager.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "JotViewStateProxy.h"
+
+// pages on either side of the visible page that are loaded ahead of time
+#define kJotPageResidencyDefaultPrefetchDistance 1
+// the most pages that are kept loaded, including the visible page
+#define kJotPageResidencyDefaultMaxLoadedPages 5
+
+
+/**
+ * Decides which of a notebook's pages to keep loaded, so that flipping
+ * through it finds pages already loaded instead of loading them cold.
+ *
+ * The visible page and the pages within prefetchDistance of it are
+ * loaded in the background. Every other page that was loaded stays
+ * loaded until it's one of the least recently visible pages over
+ * maxLoadedPages or byteBudget, and is then unloaded. A prefetch for a
+ * page that's no longer near the visible page is canceled if it hasn't
+ * finished loading.
+ *
+ * Pages with edits that haven't been saved are never unloaded. The
+ * manager also registers with the memory manager, so that it can unload
+ * every page but the visible one when memory is short.
+ *
+ * The manager must only be used from the main thread.
+ */
+@interface JotPageResidencyManager : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithPageSize:(CGSize)pagePtSize
+                        andScale:(CGFloat)scale
+                      andContext:(JotGLContext*)context
+                andBufferManager:(JotBufferManager*)bufferManager;
+
+// every page of the notebook, in the order they're flipped through
+@property(nonatomic, copy) NSArray* pages;
+
+@property(nonatomic, assign) NSUInteger prefetchDistance;
+@property(nonatomic, assign) NSUInteger maxLoadedPages;
+// the most bytes of loaded pages, as reported to the memory manager.
+// 0, the default, is no limit
+@property(nonatomic, assign) NSUInteger byteBudget;
+
+@property(nonatomic, readonly) JotViewStateProxy* visiblePage;
+
+// pages that were already loaded or loading when they were shown, and
+// those that weren't
+@property(nonatomic, readonly) NSUInteger hitCount;
+@property(nonatomic, readonly) NSUInteger missCount;
+
+// loads the page if needed, prefetches its neighbors, and unloads the
+// least recently visible pages that are over the limits
+- (void)showPage:(JotViewStateProxy*)page;
+
+// unloads the least recently visible pages, other than the visible
+// page, until about bytesToFree are unloaded. returns the bytes unloaded
+- (NSUInteger)unloadPagesToFreeBytes:(NSUInteger)bytesToFree;
+
+@end
@@ -0,0 +1,235 @@
+//
+//  JotPageResidencyManager.m
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import "JotPageResidencyManager.h"
+#import "JotMemoryManager.h"
+
+
+@implementation JotPageResidencyManager {
+    CGSize pagePtSize;
+    CGFloat scale;
+    JotGLContext* context;
+    JotBufferManager* bufferManager;
+
+    // every page that's been shown or prefetched and not unloaded since,
+    // least recently visible first
+    NSMutableOrderedSet* pagesByAge;
+    // the pages that were prefetched and haven't been shown yet
+    NSMutableSet* prefetchedPages;
+
+    JotMemoryPoolID memoryPoolID;
+}
+
+@synthesize pages;
+@synthesize prefetchDistance;
+@synthesize maxLoadedPages;
+@synthesize byteBudget;
+@synthesize visiblePage;
+@synthesize hitCount;
+@synthesize missCount;
+
+static size_t JotPageResidencyTrim(void* context, size_t bytesToFree) {
+    return [(__bridge JotPageResidencyManager*)context unloadPagesToFreeBytes:bytesToFree];
+}
+
+- (instancetype)initWithPageSize:(CGSize)_pagePtSize
+                        andScale:(CGFloat)_scale
+                      andContext:(JotGLContext*)_context
+                andBufferManager:(JotBufferManager*)_bufferManager {
+    if (self = [super init]) {
+        pagePtSize = _pagePtSize;
+        scale = _scale;
+        context = _context;
+        bufferManager = _bufferManager;
+        pages = @[];
+        pagesByAge = [NSMutableOrderedSet orderedSet];
+        prefetchedPages = [NSMutableSet set];
+        prefetchDistance = kJotPageResidencyDefaultPrefetchDistance;
+        maxLoadedPages = kJotPageResidencyDefaultMaxLoadedPages;
+        // loaded pages are the last thing to give up when memory is short
+        memoryPoolID = JotMemoryAccountantAddPool([[JotMemoryManager sharedManager] accountant], JotMemoryCategoryTexture, kJotMemoryPriorityResidentPages,
+                                                  &JotPageResidencyTrim, NULL, (__bridge void*)self);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    JotMemoryAccountantRemovePool([[JotMemoryManager sharedManager] accountant], memoryPoolID);
+}
+
+#pragma mark - Properties
+
+- (void)setPages:(NSArray*)_pages {
+    @synchronized(self) {
+        pages = [_pages copy];
+        // forget the pages that aren't in the notebook anymore
+        NSSet* pageSet = [NSSet setWithArray:pages];
+        for (JotViewStateProxy* page in [pagesByAge array]) {
+            if (![pageSet containsObject:page]) {
+                [pagesByAge removeObject:page];
+                [prefetchedPages removeObject:page];
+            }
+        }
+        if (visiblePage && ![pageSet containsObject:visiblePage]) {
+            visiblePage = nil;
+        }
+    }
+}
+
+- (void)setMaxLoadedPages:(NSUInteger)_maxLoadedPages {
+    @synchronized(self) {
+        maxLoadedPages = _maxLoadedPages;
+        [self unloadPagesOverLimits];
+    }
+}
+
+- (void)setByteBudget:(NSUInteger)_byteBudget {
+    @synchronized(self) {
+        byteBudget = _byteBudget;
+        [self unloadPagesOverLimits];
+    }
+}
+
+#pragma mark - Residency
+
+- (void)showPage:(JotViewStateProxy*)page {
+    if (!page) {
+        return;
+    }
+    @synchronized(self) {
+        visiblePage = page;
+        if ([page isStateLoaded] || [page isStateLoading]) {
+            hitCount++;
+        } else {
+            missCount++;
+        }
+        [prefetchedPages removeObject:page];
+        [pagesByAge removeObject:page];
+        [pagesByAge addObject:page];
+        [self loadPage:page];
+
+        NSArray* neighbors = [self neighborsOfPage:page];
+        for (JotViewStateProxy* neighbor in neighbors) {
+            if (![pagesByAge containsObject:neighbor]) {
+                // a page that's only been prefetched is worth less than
+                // any page that's been seen
+                [pagesByAge insertObject:neighbor atIndex:0];
+                [prefetchedPages addObject:neighbor];
+            }
+            [self loadPage:neighbor];
+        }
+
+        [self cancelStalePrefetches];
+        [self unloadPagesOverLimits];
+    }
+}
+
+- (NSUInteger)unloadPagesToFreeBytes:(NSUInteger)bytesToFree {
+    NSUInteger freedBytes = 0;
+    @synchronized(self) {
+        // the neighbors are given up too, since they're
+        // cheaper to load again than running out of memory
+        for (JotViewStateProxy* page in [pagesByAge array]) {
+            if (freedBytes >= bytesToFree) {
+                break;
+            }
+            if (page != visiblePage && ![page hasEditsToSave]) {
+                freedBytes += [self bytesForPage:page];
+                [self unloadPage:page];
+            }
+        }
+    }
+    return freedBytes;
+}
+
+#pragma mark - Private
+
+// must be called while synchronized on self. the pages within
+// prefetchDistance of page, nearest first, and the next page before
+// the previous one
+- (NSArray*)neighborsOfPage:(JotViewStateProxy*)page {
+    NSUInteger index = [pages indexOfObjectIdenticalTo:page];
+    if (index == NSNotFound) {
+        return @[];
+    }
+    NSMutableArray* neighbors = [NSMutableArray array];
+    for (NSUInteger distance = 1; distance <= prefetchDistance; distance++) {
+        if (index + distance < [pages count]) {
+            [neighbors addObject:pages[index + distance]];
+        }
+        if (index >= distance) {
+            [neighbors addObject:pages[index - distance]];
+        }
+    }
+    return neighbors;
+}
+
+- (NSUInteger)bytesForPage:(JotViewStateProxy*)page {
+    JotMemoryAccountant* accountant = [[JotMemoryManager sharedManager] accountant];
+    return JotMemoryAccountantGetPageBytes(accountant, (__bridge void*)page, JotMemoryCategoryTexture) +
+        JotMemoryAccountantGetPageBytes(accountant, (__bridge void*)page, JotMemoryCategoryVertexBuffer);
+}
+
+- (void)loadPage:(JotViewStateProxy*)page {
+    // this is a noop if the page is already loaded or loading
+    [page loadJotStateAsynchronously:YES withSize:pagePtSize andScale:scale andContext:context andBufferManager:bufferManager];
+}
+
+// must be called while synchronized on self
+- (void)unloadPage:(JotViewStateProxy*)page {
+    [pagesByAge removeObject:page];
+    [prefetchedPages removeObject:page];
+    // if the page is still loading, this cancels the load
+    [page unload];
+}
+
+// must be called while synchronized on self
+- (void)cancelStalePrefetches {
+    NSMutableSet* nearbyPages = [NSMutableSet setWithArray:[self neighborsOfPage:visiblePage]];
+    for (JotViewStateProxy* page in [prefetchedPages allObjects]) {
+        if (![nearbyPages containsObject:page]) {
+            [prefetchedPages removeObject:page];
+            if ([page isStateLoading]) {
+                [self unloadPage:page];
+            }
+        }
+    }
+}
+
+// must be called while synchronized on self
+- (void)unloadPagesOverLimits {
+    NSUInteger loadedCount = 0;
+    NSUInteger loadedBytes = 0;
+    for (JotViewStateProxy* page in [pagesByAge array]) {
+        if ([page isStateLoaded] || [page isStateLoading]) {
+            loadedCount++;
+            loadedBytes += [self bytesForPage:page];
+        } else {
+            // unloaded by someone else
+            [pagesByAge removeObject:page];
+            [prefetchedPages removeObject:page];
+        }
+    }
+
+    NSMutableSet* protectedPages = [NSMutableSet setWithArray:[self neighborsOfPage:visiblePage]];
+    if (visiblePage) {
+        [protectedPages addObject:visiblePage];
+    }
+    for (JotViewStateProxy* page in [pagesByAge array]) {
+        if (loadedCount <= maxLoadedPages && (!byteBudget || loadedBytes <= byteBudget)) {
+            break;
+        }
+        if (![protectedPages containsObject:page] && ![page hasEditsToSave]) {
+            loadedCount--;
+            loadedBytes -= [self bytesForPage:page];
+            [self unloadPage:page];
+        }
+    }
+}
+
+@end
@@ -25,7 +25,7 @@
     // this will store all the segments in drawn order
     NSMutableArray* segments;
     // cache the hash, since it's expenseive to calculate
-    NSUInteger hashCache;
+    uint64_t hashCache;
 }
 
 @property(nonatomic, readonly) SegmentSmoother* segmentSmoother;
@@ -43,6 +43,26 @@
 
 - (CGRect)bounds;
 
+/**
+ * strokes loaded from disk may leave their segments in the stroke
+ * file until they're first used. this is NO until then
+ */
+- (BOOL)hasLoadedSegments;
+
+/**
+ * YES if the stroke's segments failed their checksum when they were
+ * decoded. the stroke draws nothing and stays unloaded, and asDictionary
+ * returns nil, so the damaged file is never replaced by an empty stroke
+ */
+- (BOOL)hasCorruptSegments;
+
+/**
+ * a hash of the brush texture and of each segment's width, step
+ * width, rotation and color, which the vertex buffers depend on
+ * as much as the points. see JotVertexCache
+ */
+- (uint64_t)brushHash;
+
 /**
  * will add the input bezier element to the end of the stroke
  */
@@ -63,6 +83,12 @@
  */
 - (void)empty;
 
+/**
+ * a 64 bit hash of the stroke's segments, in order. this
+ * is also its uuid, so it's kept by saved strokes
+ */
+- (uint64_t)contentHash;
+
 - (NSString*)uuid;
 
 - (void)lock;
@@ -70,4 +96,6 @@
 
 - (void)scaleSegmentsForWidth:(CGFloat)widthRatio andHeight:(CGFloat)heightRatio;
 
+- (void)setRotationOfSegments:(CGFloat)rotation;
+
 @end
@@ -17,6 +17,9 @@
 #import <OpenGLES/EAGLDrawable.h>
 #import <OpenGLES/EAGL.h>
 #import "JotUI.h"
+#import "JotStrokeFile.h"
+#import "JotVertexCache.h"
+#import "JotContentHash.h"
 
 
 @implementation JotStroke {
@@ -31,9 +34,20 @@
     JotBufferManager* bufferManager;
     // lock
     NSRecursiveLock* lock;
+    // strokes that are loaded lazily keep their segments in
+    // their mapped stroke file until they're first used. until
+    // then, the bounds and scale are tracked here instead
+    NSData* lazySegmentData;
+    // the stroke's cached vertex buffers, if any, to
+    // give the segments when they're decoded
+    NSData* lazyVertexData;
+    CGRect lazyBounds;
+    CGSize lazyScale;
+    // set if the lazy segments failed their checksum. the mapped
+    // file is kept, so that the stroke is never saved without them
+    BOOL lazySegmentsAreCorrupt;
 }
 
-@synthesize segments;
 @synthesize segmentSmoother;
 @synthesize texture;
 @synthesize delegate;
@@ -49,6 +63,7 @@
         segmentSmoother = [[SegmentSmoother alloc] init];
         texture = _texture;
         bufferManager = _bufferManager;
+        hashCache = [self hashOfEmptyStroke];
     }
     return self;
 }
@@ -56,13 +71,20 @@
 - (id)init {
     if (self = [super init]) {
         segments = [NSMutableArray array];
-        hashCache = 1;
+        hashCache = [self hashOfEmptyStroke];
         lock = [[NSRecursiveLock alloc] init];
     }
     return self;
 }
 
 - (int)fullByteSize {
+    @synchronized(self) {
+        if (lazySegmentData) {
+            // count the vertex buffers the stroke will need once it's
+            // drawn, so a page's bytes don't grow as its strokes load
+            return (int)totalNumberOfBytes;
+        }
+    }
     int totalBytes = 0;
     @synchronized(segments) {
         if (segments && [segments count]) {
@@ -75,7 +97,60 @@
 }
 
 
+- (NSArray*)segments {
+    [self loadSegmentsIfNeeded];
+    return segments;
+}
+
+- (BOOL)hasLoadedSegments {
+    @synchronized(self) {
+        return !lazySegmentData;
+    }
+}
+
+- (BOOL)hasCorruptSegments {
+    @synchronized(self) {
+        return lazySegmentsAreCorrupt;
+    }
+}
+
+/**
+ * decodes the segments of a lazily loaded stroke. their vertex
+ * data and VBOs are generated when they're first bound
+ */
+- (void)loadSegmentsIfNeeded {
+    @synchronized(self) {
+        if (!lazySegmentData || lazySegmentsAreCorrupt) {
+            return;
+        }
+        JotStrokeSegmentColumns* segmentColumns = [JotStrokeFile segmentColumnsFromData:lazySegmentData];
+        if (!segmentColumns) {
+            // leave the stroke unloaded, instead of an empty
+            // stroke that would replace the file when saved
+            DebugLog(@"couldn't load the segments for stroke %@", [self uuid]);
+            lazySegmentsAreCorrupt = YES;
+            return;
+        }
+        NSData* vertexData = lazyVertexData;
+        lazySegmentData = nil;
+        lazyVertexData = nil;
+        // replaces the estimate that was saved with the stroke
+        totalNumberOfBytes = 0;
+
+        NSArray* loadedSegments = [self elementsFromSegmentColumns:segmentColumns withVertexData:vertexData];
+        if (!CGSizeEqualToSize(lazyScale, CGSizeMake(1, 1))) {
+            for (AbstractBezierPathElement* ele in loadedSegments) {
+                [ele scaleForWidth:lazyScale.width andHeight:lazyScale.height];
+            }
+        }
+        @synchronized(segments) {
+            [segments addObjectsFromArray:loadedSegments];
+        }
+    }
+}
+
 - (void)addElement:(AbstractBezierPathElement*)element {
+    [self loadSegmentsIfNeeded];
     [self lock];
     element.bufferManager = self.bufferManager;
     NSInteger numOfElementBytes = [element numberOfBytes];
@@ -104,6 +179,7 @@
  * dealloc situation
  */
 - (void)removeElementAtIndex:(NSInteger)index {
+    [self loadSegmentsIfNeeded];
     [self lock];
     @synchronized(segments) {
         [segments removeObjectAtIndex:index];
@@ -116,20 +192,31 @@
 }
 
 - (void)empty {
+    @synchronized(self) {
+        lazySegmentData = nil;
+        lazyVertexData = nil;
+        lazySegmentsAreCorrupt = NO;
+    }
     @synchronized(segments) {
         [segments removeAllObjects];
     }
 }
 
 - (CGRect)bounds {
-    if ([self.segments count]) {
-        CGRect bounds = [[self.segments objectAtIndex:0] bounds];
-        @synchronized(segments) {
-            for (AbstractBezierPathElement* ele in self.segments) {
+    @synchronized(self) {
+        if (lazySegmentData) {
+            return lazyBounds;
+        }
+    }
+    [self loadSegmentsIfNeeded];
+    @synchronized(segments) {
+        if ([segments count]) {
+            CGRect bounds = [[segments objectAtIndex:0] bounds];
+            for (AbstractBezierPathElement* ele in segments) {
                 bounds = CGRectUnion(bounds, ele.bounds);
             }
+            return bounds;
         }
-        return bounds;
     }
     return CGRectZero;
 }
@@ -137,51 +224,163 @@
 #pragma mark - PlistSaving
 
 - (NSDictionary*)asDictionary {
+    // load before locking the segments, and read the ivar inside the
+    // lock, so that self is never locked while holding the segments
+    [self loadSegmentsIfNeeded];
+    if ([self hasCorruptSegments]) {
+        return nil;
+    }
+    // the hash and bounds let the stroke be loaded
+    // without decoding its segments. the hash is saved
+    // signed, since plists can't hold every unsigned value
+    CGRect bounds = [self bounds];
     @synchronized(segments) {
         return [NSDictionary dictionaryWithObjectsAndKeys:@"JotStroke", @"class",
-                                                          [self.segments jotMapWithSelector:@selector(asDictionary)], @"segments",
+                                                          [segments jotMapWithSelector:@selector(asDictionary)], @"segments",
                                                           [self.segmentSmoother asDictionary], @"segmentSmoother",
-                                                          [self.texture asDictionary], @"texture", nil];
+                                                          [self.texture asDictionary], @"texture",
+                                                          [NSNumber numberWithLongLong:(int64_t)[self contentHash]], @"contentHash",
+                                                          [NSNumber numberWithFloat:bounds.origin.x], @"bounds.x",
+                                                          [NSNumber numberWithFloat:bounds.origin.y], @"bounds.y",
+                                                          [NSNumber numberWithFloat:bounds.size.width], @"bounds.width",
+                                                          [NSNumber numberWithFloat:bounds.size.height], @"bounds.height",
+                                                          [NSNumber numberWithInteger:[self totalNumberOfBytes]], @"totalNumberOfBytes", nil];
     }
 }
 
 - (id)initFromDictionary:(NSDictionary*)dictionary {
     if (self = [super init]) {
-        hashCache = 1;
+        texture = [[JotBrushTexture alloc] initFromDictionary:[dictionary objectForKey:@"texture"]];
+        hashCache = [self hashOfEmptyStroke];
         segmentSmoother = [[SegmentSmoother alloc] initFromDictionary:[dictionary objectForKey:@"segmentSmoother"]];
         bufferManager = [dictionary objectForKey:@"bufferManager"];
-        __block AbstractBezierPathElement* previousElement = nil;
-        segments = [NSMutableArray arrayWithArray:[[dictionary objectForKey:@"segments"] jotMap:^id(id obj, NSUInteger index) {
-            NSString* className = [obj objectForKey:@"class"];
-            Class class = NSClassFromString(className);
-            AbstractBezierPathElement* segment = [[class alloc] initFromDictionary:obj];
-            [segment setBufferManager:bufferManager];
-            [self updateHashWithObject:segment];
-            totalNumberOfBytes += [segment numberOfBytes];
-            [segment validateDataGivenPreviousElement:previousElement]; // nil out our dictionary loaded data if it's the wrong size
-            [segment loadDataIntoVBOIfNeeded]; // generate if if needed
-            previousElement = segment;
-            return segment;
-        }]];
-        texture = [[JotBrushTexture alloc] initFromDictionary:[dictionary objectForKey:@"texture"]];
+        NSData* segmentData = [dictionary objectForKey:kJotStrokeSegmentDataKey];
+        if (segmentData && ![dictionary objectForKey:@"segments"] && ![dictionary objectForKey:kJotStrokeSegmentColumnsKey]) {
+            // the segments are decoded on first use
+            segments = [NSMutableArray array];
+            lazySegmentData = segmentData;
+            lazyVertexData = [dictionary objectForKey:kJotStrokeVertexCacheKey];
+            hashCache = (uint64_t)[[dictionary objectForKey:@"contentHash"] longLongValue];
+            lazyBounds = CGRectMake([[dictionary objectForKey:@"bounds.x"] floatValue], [[dictionary objectForKey:@"bounds.y"] floatValue],
+                                    [[dictionary objectForKey:@"bounds.width"] floatValue], [[dictionary objectForKey:@"bounds.height"] floatValue]);
+            lazyScale = CGSizeMake(1, 1);
+            // the vertex bytes the segments will need, so the stroke
+            // is counted before it loads. older files didn't save it
+            totalNumberOfBytes = [[dictionary objectForKey:@"totalNumberOfBytes"] integerValue] ?: (NSInteger)[lazyVertexData length];
+        } else {
+            JotStrokeSegmentColumns* segmentColumns = [dictionary objectForKey:kJotStrokeSegmentColumnsKey];
+            NSData* vertexData = [dictionary objectForKey:kJotStrokeVertexCacheKey];
+            if (segmentColumns) {
+                segments = [self elementsFromSegmentColumns:segmentColumns withVertexData:vertexData];
+            } else {
+                segments = [self elementsFromDictionaries:[dictionary objectForKey:@"segments"] withVertexData:vertexData];
+            }
+            for (AbstractBezierPathElement* segment in segments) {
+                [self updateHashWithObject:segment];
+                [segment loadDataIntoVBOIfNeeded]; // generate if if needed
+            }
+        }
     }
     return self;
 }
 
+/**
+ * vertexData is the stroke's encoded vertex buffers from the
+ * page's JotVertexCache. they're only used if there's one
+ * for each segment, and are otherwise generated as needed
+ */
+- (NSMutableArray*)elementsFromDictionaries:(NSArray*)segmentDictionaries withVertexData:(NSData*)vertexData {
+    NSMutableArray* elements = [NSMutableArray arrayWithCapacity:[segmentDictionaries count]];
+    for (NSDictionary* segmentDictionary in segmentDictionaries) {
+        [self addElementFromStrokeValues:segmentDictionary toElements:elements];
+    }
+    [self prepareElements:elements withVertexData:vertexData];
+    return elements;
+}
+
+- (NSMutableArray*)elementsFromSegmentColumns:(JotStrokeSegmentColumns*)segmentColumns withVertexData:(NSData*)vertexData {
+    NSUInteger count = [segmentColumns count];
+    NSMutableArray* elements = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger index = 0; index < count; index++) {
+        segmentColumns.row = index;
+        [self addElementFromStrokeValues:segmentColumns toElements:elements];
+    }
+    [self prepareElements:elements withVertexData:vertexData];
+    return elements;
+}
+
+- (void)addElementFromStrokeValues:(id<JotStrokeValues>)values toElements:(NSMutableArray*)elements {
+    Class class = NSClassFromString([values objectForKey:@"class"]);
+    AbstractBezierPathElement* segment = [[class alloc] initFromStrokeValues:values];
+    if (segment) {
+        [segment setBufferManager:bufferManager];
+        [elements addObject:segment];
+    }
+}
+
+/**
+ * hands the cached vertex buffers to the elements, if they were
+ * made for these segments drawn with this brush, and checks them
+ * against each element's previous element
+ */
+- (void)prepareElements:(NSArray*)elements withVertexData:(NSData*)vertexData {
+    NSArray* vertexBuffers = nil;
+    if (vertexData) {
+        vertexBuffers = [JotVertexCache vertexBuffersFromData:vertexData withBrushHash:[self brushHashOfElements:elements]];
+        if ([vertexBuffers count] != [elements count]) {
+            DebugLog(@"ignoring cached vertex buffers for stroke %@", [self uuid]);
+            vertexBuffers = nil;
+        }
+    }
+    AbstractBezierPathElement* previousElement = nil;
+    for (NSUInteger index = 0; index < [elements count]; index++) {
+        AbstractBezierPathElement* segment = [elements objectAtIndex:index];
+        NSData* vertexBuffer = [vertexBuffers objectAtIndex:index];
+        if ([vertexBuffer isKindOfClass:[NSData class]]) {
+            [segment useCachedVertexBuffer:vertexBuffer];
+        }
+        totalNumberOfBytes += [segment numberOfBytes];
+        [segment validateDataGivenPreviousElement:previousElement]; // nil out our dictionary loaded data if it's the wrong size
+        previousElement = segment;
+    }
+}
+
 
 #pragma mark - hashing and equality
 
-- (void)updateHashWithObject:(NSObject*)obj {
-    NSUInteger prime = 31;
-    hashCache = prime * hashCache + [obj hash];
+- (uint64_t)brushHashOfElements:(NSArray*)elements {
+    uint64_t brushHash = [self hashOfEmptyStroke];
+    for (AbstractBezierPathElement* element in elements) {
+        brushHash = JotContentHashCombine(brushHash, [element brushHash]);
+    }
+    return brushHash;
 }
 
-- (NSUInteger)hash {
+- (uint64_t)brushHash {
+    return [self brushHashOfElements:[self segments]];
+}
+
+// strokes start from the hash of their brush texture's class, which
+// is what's saved of it, so that empty strokes don't all share a uuid
+- (uint64_t)hashOfEmptyStroke {
+    NSData* brush = [NSStringFromClass([self texture] ? [[self texture] class] : [self class]) dataUsingEncoding:NSUTF8StringEncoding];
+    return JotContentHash([brush bytes], [brush length], 0);
+}
+
+- (void)updateHashWithObject:(AbstractBezierPathElement*)element {
+    hashCache = JotContentHashCombine(hashCache, [element contentHash]);
+}
+
+- (uint64_t)contentHash {
     return hashCache;
 }
 
+- (NSUInteger)hash {
+    return (NSUInteger)[self contentHash];
+}
+
 - (NSString*)uuid {
-    return [NSString stringWithFormat:@"%lu", (unsigned long)[self hash]];
+    return [NSString stringWithFormat:@"%016llx", (unsigned long long)[self contentHash]];
 }
 
 - (BOOL)isEqual:(id)object {
@@ -201,9 +400,33 @@
 - (void)scaleSegmentsForWidth:(CGFloat)widthRatio andHeight:(CGFloat)heightRatio {
     [segmentSmoother scaleForWidth:widthRatio andHeight:heightRatio];
 
-    [segments enumerateObjectsUsingBlock:^(AbstractBezierPathElement* ele, NSUInteger idx, BOOL* _Nonnull stop) {
-        [ele scaleForWidth:widthRatio andHeight:heightRatio];
-    }];
+    @synchronized(self) {
+        if (lazySegmentData) {
+            // scaled once they're loaded
+            lazyScale = CGSizeMake(lazyScale.width * widthRatio, lazyScale.height * heightRatio);
+            lazyBounds = CGRectMake(lazyBounds.origin.x * widthRatio, lazyBounds.origin.y * heightRatio,
+                                    lazyBounds.size.width * widthRatio, lazyBounds.size.height * heightRatio);
+            return;
+        }
+    }
+
+    @synchronized(segments) {
+        [segments enumerateObjectsUsingBlock:^(AbstractBezierPathElement* ele, NSUInteger idx, BOOL* _Nonnull stop) {
+            [ele scaleForWidth:widthRatio andHeight:heightRatio];
+        }];
+    }
+}
+
+- (void)setRotationOfSegments:(CGFloat)rotation {
+    [self loadSegmentsIfNeeded];
+    @synchronized(segments) {
+        // the rotation is part of each segment's hash
+        hashCache = [self hashOfEmptyStroke];
+        for (AbstractBezierPathElement* ele in segments) {
+            ele.rotation = rotation;
+            [self updateHashWithObject:ele];
+        }
+    }
 }
 
 @end
@@ -0,0 +1,400 @@
+//
+//  JotStrokeCodec.c
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#include "JotStrokeCodec.h"
+
+// fixed point floats keep at most this many fractional bits
+#define kJotStrokeMaxFractionBits 24
+// and this is the mode byte for floats written as bit patterns
+#define kJotStrokeFloatBitsMode 0xFF
+
+static const char kJotStrokeFileMagic[4] = {'J', 'S', 'T', 'K'};
+
+
+#pragma mark - Buffer
+
+void JotStrokeBufferInit(JotStrokeBuffer* buffer) {
+    memset(buffer, 0, sizeof(*buffer));
+}
+
+void JotStrokeBufferFree(JotStrokeBuffer* buffer) {
+    free(buffer->bytes);
+    memset(buffer, 0, sizeof(*buffer));
+}
+
+static bool jotReserve(JotStrokeBuffer* buffer, size_t length) {
+    if (buffer->failed) {
+        return false;
+    }
+    if (buffer->capacity - buffer->length >= length) {
+        return true;
+    }
+    size_t capacity = buffer->capacity ? buffer->capacity : 256;
+    while (capacity - buffer->length < length) {
+        capacity *= 2;
+    }
+    uint8_t* bytes = realloc(buffer->bytes, capacity);
+    if (!bytes) {
+        buffer->failed = true;
+        return false;
+    }
+    buffer->bytes = bytes;
+    buffer->capacity = capacity;
+    return true;
+}
+
+void JotStrokeBufferAppend(JotStrokeBuffer* buffer, const void* bytes, size_t length) {
+    if (length && jotReserve(buffer, length)) {
+        memcpy(buffer->bytes + buffer->length, bytes, length);
+        buffer->length += length;
+    }
+}
+
+void JotStrokeBufferAppendVarint(JotStrokeBuffer* buffer, uint64_t value) {
+    if (!jotReserve(buffer, 10)) {
+        return;
+    }
+    uint8_t* op = buffer->bytes + buffer->length;
+    while (value >= 0x80) {
+        *op++ = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
+    *op++ = (uint8_t)value;
+    buffer->length = op - buffer->bytes;
+}
+
+static inline uint64_t jotZigZag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t jotUnZigZag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static inline size_t jotVarintLength(uint64_t value) {
+    size_t length = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        length++;
+    }
+    return length;
+}
+
+static inline uint32_t jotFloatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline float jotBitsFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+
+#pragma mark - Columns
+
+/**
+ * the number of fractional bits needed to write value as an exact
+ * fixed point integer, or -1 if it can't be
+ */
+static int jotFractionBits(float value) {
+    if (value == 0) {
+        // fixed point can't tell -0 from 0
+        return signbit(value) ? -1 : 0;
+    }
+    if (!isfinite(value) || fabsf(value) >= 0x1p40f) {
+        return -1;
+    }
+    int exponent;
+    // value == mantissa * 2^(exponent - 24), for a 24 bit mantissa
+    uint32_t mantissa = (uint32_t)fabsf(ldexpf(frexpf(value, &exponent), 24));
+    int bits = 24 - exponent;
+    while (bits > 0 && !(mantissa & 1)) {
+        mantissa >>= 1;
+        bits--;
+    }
+    return bits > 0 ? bits : 0;
+}
+
+void JotStrokeEncodeFloats(const float* values, size_t count, JotStrokeBuffer* buffer) {
+    int fractionBits = 0;
+    float magnitude = 0;
+    for (size_t i = 0; i < count && fractionBits >= 0; i++) {
+        int bits = jotFractionBits(values[i]);
+        fractionBits = bits < 0 || bits > kJotStrokeMaxFractionBits ? -1 : (bits > fractionBits ? bits : fractionBits);
+        magnitude = fmaxf(magnitude, fabsf(values[i]));
+    }
+    if (fractionBits >= 0 && ldexp(magnitude, fractionBits) >= 0x1p60) {
+        // too large for the deltas to fit
+        fractionBits = -1;
+    }
+
+    // find how large each encoding is, and use the smaller one
+    size_t fixedLength = SIZE_MAX;
+    size_t bitsLength = 0;
+    int64_t previousFixed = 0;
+    int64_t previousBits = 0;
+    // a power of two, so multiplying by it is exact
+    double scale = fractionBits >= 0 ? ldexp(1, fractionBits) : 0;
+    if (fractionBits >= 0) {
+        fixedLength = 0;
+        for (size_t i = 0; i < count; i++) {
+            int64_t fixed = (int64_t)(values[i] * scale);
+            fixedLength += jotVarintLength(jotZigZag(fixed - previousFixed));
+            previousFixed = fixed;
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        int64_t bits = jotFloatBits(values[i]);
+        bitsLength += jotVarintLength(jotZigZag(bits - previousBits));
+        previousBits = bits;
+    }
+
+    if (fixedLength <= bitsLength) {
+        uint8_t mode = (uint8_t)fractionBits;
+        JotStrokeBufferAppend(buffer, &mode, 1);
+        previousFixed = 0;
+        for (size_t i = 0; i < count; i++) {
+            int64_t fixed = (int64_t)(values[i] * scale);
+            JotStrokeBufferAppendVarint(buffer, jotZigZag(fixed - previousFixed));
+            previousFixed = fixed;
+        }
+    } else {
+        uint8_t mode = kJotStrokeFloatBitsMode;
+        JotStrokeBufferAppend(buffer, &mode, 1);
+        previousBits = 0;
+        for (size_t i = 0; i < count; i++) {
+            int64_t bits = jotFloatBits(values[i]);
+            JotStrokeBufferAppendVarint(buffer, jotZigZag(bits - previousBits));
+            previousBits = bits;
+        }
+    }
+}
+
+void JotStrokeEncodeDoubles(const double* values, size_t count, JotStrokeBuffer* buffer) {
+    JotStrokeBufferAppend(buffer, values, count * sizeof(double));
+}
+
+void JotStrokeEncodeIntegers(const int64_t* values, size_t count, JotStrokeBuffer* buffer) {
+    uint64_t previous = 0;
+    for (size_t i = 0; i < count; i++) {
+        // deltas wrap, so that they can't overflow
+        JotStrokeBufferAppendVarint(buffer, jotZigZag((int64_t)((uint64_t)values[i] - previous)));
+        previous = (uint64_t)values[i];
+    }
+}
+
+void JotStrokeEncodeBits(const bool* values, size_t count, JotStrokeBuffer* buffer) {
+    for (size_t i = 0; i < count; i += 8) {
+        uint8_t byte = 0;
+        for (size_t bit = 0; bit < 8 && i + bit < count; bit++) {
+            byte |= (uint8_t)(values[i + bit] << bit);
+        }
+        JotStrokeBufferAppend(buffer, &byte, 1);
+    }
+}
+
+bool JotStrokeReadVarint(JotStrokeCursor* cursor, uint64_t* value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (cursor->bytes >= cursor->end) {
+            return false;
+        }
+        uint8_t byte = *cursor->bytes++;
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JotStrokeReadBytes(JotStrokeCursor* cursor, size_t length, const uint8_t** bytes) {
+    if ((size_t)(cursor->end - cursor->bytes) < length) {
+        return false;
+    }
+    *bytes = cursor->bytes;
+    cursor->bytes += length;
+    return true;
+}
+
+bool JotStrokeDecodeFloats(JotStrokeCursor* cursor, float* values, size_t count) {
+    const uint8_t* mode;
+    if (!JotStrokeReadBytes(cursor, 1, &mode) || (*mode > kJotStrokeMaxFractionBits && *mode != kJotStrokeFloatBitsMode)) {
+        return false;
+    }
+    bool asBits = *mode == kJotStrokeFloatBitsMode;
+    double scale = asBits ? 0 : ldexp(1, -(int)*mode);
+    uint64_t previous = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t delta;
+        if (!JotStrokeReadVarint(cursor, &delta)) {
+            return false;
+        }
+        previous += (uint64_t)jotUnZigZag(delta);
+        values[i] = asBits ? jotBitsFloat((uint32_t)previous) : (float)((double)(int64_t)previous * scale);
+    }
+    return true;
+}
+
+bool JotStrokeDecodeDoubles(JotStrokeCursor* cursor, double* values, size_t count) {
+    const uint8_t* bytes;
+    if (count > SIZE_MAX / sizeof(double) || !JotStrokeReadBytes(cursor, count * sizeof(double), &bytes)) {
+        return false;
+    }
+    memcpy(values, bytes, count * sizeof(double));
+    return true;
+}
+
+bool JotStrokeDecodeIntegers(JotStrokeCursor* cursor, int64_t* values, size_t count) {
+    uint64_t previous = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t delta;
+        if (!JotStrokeReadVarint(cursor, &delta)) {
+            return false;
+        }
+        previous += (uint64_t)jotUnZigZag(delta);
+        values[i] = (int64_t)previous;
+    }
+    return true;
+}
+
+bool JotStrokeDecodeBits(JotStrokeCursor* cursor, bool* values, size_t count) {
+    const uint8_t* bytes;
+    if (!JotStrokeReadBytes(cursor, (count + 7) / 8, &bytes)) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        values[i] = (bytes[i >> 3] >> (i & 7)) & 1;
+    }
+    return true;
+}
+
+
+#pragma mark - Tables
+
+void JotStrokeWriteTable(const JotStrokeTable* table, JotStrokeBuffer* buffer) {
+    JotStrokeBufferAppendVarint(buffer, table->rowCount);
+    JotStrokeBufferAppendVarint(buffer, table->columnCount);
+    for (uint32_t i = 0; i < table->columnCount; i++) {
+        const JotStrokeColumn* column = &table->columns[i];
+        uint8_t kindAndFlags[2] = {(uint8_t)column->kind, column->flags};
+        JotStrokeBufferAppendVarint(buffer, column->nameIndex);
+        JotStrokeBufferAppend(buffer, kindAndFlags, 2);
+        JotStrokeBufferAppendVarint(buffer, column->length);
+    }
+    for (uint32_t i = 0; i < table->columnCount; i++) {
+        JotStrokeBufferAppend(buffer, table->columns[i].bytes, table->columns[i].length);
+    }
+}
+
+static bool jotReadTable(JotStrokeCursor* cursor, JotStrokeTable* table) {
+    uint64_t rowCount, columnCount;
+    if (!JotStrokeReadVarint(cursor, &rowCount) || !JotStrokeReadVarint(cursor, &columnCount) ||
+        rowCount > UINT32_MAX || columnCount > kJotStrokeMaxColumns) {
+        return false;
+    }
+    table->rowCount = (uint32_t)rowCount;
+    table->columnCount = (uint32_t)columnCount;
+    for (uint32_t i = 0; i < table->columnCount; i++) {
+        JotStrokeColumn* column = &table->columns[i];
+        uint64_t nameIndex, length;
+        const uint8_t* kindAndFlags;
+        if (!JotStrokeReadVarint(cursor, &nameIndex) || !JotStrokeReadBytes(cursor, 2, &kindAndFlags) ||
+            !JotStrokeReadVarint(cursor, &length) || nameIndex > UINT32_MAX || length > SIZE_MAX) {
+            return false;
+        }
+        column->nameIndex = (uint32_t)nameIndex;
+        column->kind = (JotStrokeColumnKind)kindAndFlags[0];
+        column->flags = kindAndFlags[1];
+        column->length = (size_t)length;
+    }
+    for (uint32_t i = 0; i < table->columnCount; i++) {
+        if (!JotStrokeReadBytes(cursor, table->columns[i].length, &table->columns[i].bytes)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+#pragma mark - File
+
+void JotStrokeFileHeaderMake(JotStrokeFileHeader* header, const uint8_t* payload, size_t payloadLength,
+                             uint32_t flags, uint32_t segmentCount, uint32_t stringCount, uint32_t colorCount) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, kJotStrokeFileMagic, sizeof(header->magic));
+    header->version = kJotStrokeFileVersion;
+    header->headerLength = sizeof(*header);
+    header->flags = flags;
+    header->payloadLength = (uint32_t)payloadLength;
+    header->checksum = (uint32_t)crc32(crc32(0L, Z_NULL, 0), payload, (uInt)payloadLength);
+    header->segmentCount = segmentCount;
+    header->stringCount = stringCount;
+    header->colorCount = colorCount;
+}
+
+bool JotStrokeFileHasHeader(const uint8_t* bytes, size_t length) {
+    return length >= sizeof(JotStrokeFileHeader) && !memcmp(bytes, kJotStrokeFileMagic, sizeof(kJotStrokeFileMagic));
+}
+
+bool JotStrokeReaderOpen(const uint8_t* bytes, size_t length, JotStrokeReader* reader) {
+    memset(reader, 0, sizeof(*reader));
+    if (!JotStrokeFileHasHeader(bytes, length)) {
+        return false;
+    }
+    memcpy(&reader->header, bytes, sizeof(reader->header));
+    const JotStrokeFileHeader* header = &reader->header;
+    // later versions may grow the header, but
+    // have to bump the version to change it
+    if (header->version != kJotStrokeFileVersion || header->headerLength < sizeof(*header) ||
+        header->headerLength > length || header->payloadLength != length - header->headerLength) {
+        return false;
+    }
+    const uint8_t* payload = bytes + header->headerLength;
+    reader->payload = payload;
+
+    JotStrokeCursor cursor = {payload, payload + header->payloadLength};
+    reader->strings.bytes = cursor.bytes;
+    for (uint32_t i = 0; i < header->stringCount; i++) {
+        uint64_t stringLength;
+        const uint8_t* string;
+        if (!JotStrokeReadVarint(&cursor, &stringLength) || !JotStrokeReadBytes(&cursor, (size_t)stringLength, &string)) {
+            return false;
+        }
+    }
+    reader->strings.end = cursor.bytes;
+
+    if (!JotStrokeReadBytes(&cursor, (size_t)header->colorCount * 4 * sizeof(float), &reader->colors) ||
+        !jotReadTable(&cursor, &reader->stroke) || reader->stroke.rowCount != 1) {
+        return false;
+    }
+    if (header->flags & kJotStrokeFileHasSegments) {
+        if (!jotReadTable(&cursor, &reader->segments) || reader->segments.rowCount != header->segmentCount) {
+            return false;
+        }
+    } else if (header->segmentCount) {
+        return false;
+    }
+    return cursor.bytes == cursor.end;
+}
+
+bool JotStrokeReaderVerify(const JotStrokeReader* reader) {
+    return (uint32_t)crc32(crc32(0L, Z_NULL, 0), reader->payload, (uInt)reader->header.payloadLength) == reader->header.checksum;
+}
+
+void JotStrokeReaderGetColor(const JotStrokeReader* reader, uint32_t index, float rgba[4]) {
+    memcpy(rgba, reader->colors + (size_t)index * 4 * sizeof(float), 4 * sizeof(float));
+}
@@ -0,0 +1,179 @@
+//
+//  JotStrokeCodec.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#ifndef JotStrokeCodec_h
+#define JotStrokeCodec_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The byte level pieces of the binary stroke file (see JotStrokeFile).
+ *
+ * A stroke file is a fixed header followed by a payload:
+ *
+ *   - a string table: varint length + UTF8 bytes for each string.
+ *     column names and string values are indexes into it
+ *   - a color palette: 4 little endian floats (RGBA) per color
+ *   - the stroke table, with a single row for the stroke's own values
+ *   - the segment table, with one row per segment
+ *
+ * A table is a varint row count and column count, then a directory
+ * with each column's name, kind, flags and byte length, then each
+ * column's bytes back to back. A column only stores the rows that have
+ * a value, and a presence bitmap says which those are if it isn't all
+ * of them.
+ *
+ * Numbers are delta encoded down their column and written as zigzag
+ * varints, so a stroke's points, which move a little at a time, and its
+ * widths and colors, which rarely change at all, are a byte or two each.
+ */
+
+#define kJotStrokeFileVersion 1
+#define kJotStrokeMaxColumns 64
+
+// the file has a segment table
+#define kJotStrokeFileHasSegments 1
+
+// the column doesn't have a value in every row
+#define kJotStrokeColumnHasPresence 1
+
+typedef enum {
+    JotStrokeColumnKindFloat = 1,
+    JotStrokeColumnKindDouble = 2,
+    JotStrokeColumnKindInteger = 3,
+    JotStrokeColumnKindBool = 4,
+    JotStrokeColumnKindString = 5,
+    JotStrokeColumnKindColor = 6,
+    JotStrokeColumnKindData = 7,
+    // a value we don't have a column type for, as a binary plist
+    JotStrokeColumnKindPlist = 8
+} JotStrokeColumnKind;
+
+// all fields are little endian, which is every platform we run on
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t headerLength;
+    uint32_t flags;
+    uint32_t payloadLength;
+    // crc32 of the payload that follows the header
+    uint32_t checksum;
+    uint32_t segmentCount;
+    uint32_t stringCount;
+    uint32_t colorCount;
+} JotStrokeFileHeader;
+
+#pragma mark - Writing
+
+typedef struct {
+    uint8_t* bytes;
+    size_t length;
+    size_t capacity;
+    // set if an allocation failed. everything appended after
+    // that is dropped, so this only needs checking at the end
+    bool failed;
+} JotStrokeBuffer;
+
+void JotStrokeBufferInit(JotStrokeBuffer* buffer);
+void JotStrokeBufferFree(JotStrokeBuffer* buffer);
+void JotStrokeBufferAppend(JotStrokeBuffer* buffer, const void* bytes, size_t length);
+void JotStrokeBufferAppendVarint(JotStrokeBuffer* buffer, uint64_t value);
+
+/**
+ * floats are written as fixed point when every value has few enough
+ * fractional bits, and as the deltas of their bit patterns otherwise,
+ * whichever is smaller. both are exact, including -0 and NaN
+ */
+void JotStrokeEncodeFloats(const float* values, size_t count, JotStrokeBuffer* buffer);
+void JotStrokeEncodeDoubles(const double* values, size_t count, JotStrokeBuffer* buffer);
+void JotStrokeEncodeIntegers(const int64_t* values, size_t count, JotStrokeBuffer* buffer);
+void JotStrokeEncodeBits(const bool* values, size_t count, JotStrokeBuffer* buffer);
+
+typedef struct {
+    uint32_t nameIndex;
+    JotStrokeColumnKind kind;
+    uint8_t flags;
+    const uint8_t* bytes;
+    size_t length;
+} JotStrokeColumn;
+
+typedef struct {
+    uint32_t rowCount;
+    uint32_t columnCount;
+    JotStrokeColumn columns[kJotStrokeMaxColumns];
+} JotStrokeTable;
+
+void JotStrokeWriteTable(const JotStrokeTable* table, JotStrokeBuffer* buffer);
+
+// fills in the header for the payload, including its checksum
+void JotStrokeFileHeaderMake(JotStrokeFileHeader* header, const uint8_t* payload, size_t payloadLength,
+                             uint32_t flags, uint32_t segmentCount, uint32_t stringCount, uint32_t colorCount);
+
+#pragma mark - Reading
+
+/**
+ * reads never copy the file. a cursor walks the bytes in place, and
+ * every read fails instead of reading past its end
+ */
+typedef struct {
+    const uint8_t* bytes;
+    const uint8_t* end;
+} JotStrokeCursor;
+
+bool JotStrokeReadVarint(JotStrokeCursor* cursor, uint64_t* value);
+bool JotStrokeReadBytes(JotStrokeCursor* cursor, size_t length, const uint8_t** bytes);
+
+bool JotStrokeDecodeFloats(JotStrokeCursor* cursor, float* values, size_t count);
+bool JotStrokeDecodeDoubles(JotStrokeCursor* cursor, double* values, size_t count);
+bool JotStrokeDecodeIntegers(JotStrokeCursor* cursor, int64_t* values, size_t count);
+bool JotStrokeDecodeBits(JotStrokeCursor* cursor, bool* values, size_t count);
+
+typedef struct {
+    JotStrokeFileHeader header;
+    const uint8_t* payload;
+    // the string table, for walking with JotStrokeReadVarint
+    // and JotStrokeReadBytes
+    JotStrokeCursor strings;
+    const uint8_t* colors;
+    JotStrokeTable stroke;
+    JotStrokeTable segments;
+} JotStrokeReader;
+
+/**
+ * true if bytes start with a stroke file header. this doesn't
+ * check the rest of the file
+ */
+bool JotStrokeFileHasHeader(const uint8_t* bytes, size_t length);
+
+/**
+ * checks the header and reads the table directories. the columns point
+ * into bytes, which must outlive the reader. returns false if the file
+ * is truncated, malformed, or a newer version.
+ *
+ * this only touches the start of the file, so that a stroke's own
+ * values can be read without paging in its segments. it doesn't check
+ * the checksum, so call JotStrokeReaderVerify before trusting the values
+ */
+bool JotStrokeReaderOpen(const uint8_t* bytes, size_t length, JotStrokeReader* reader);
+
+// true if the payload matches the header's checksum
+bool JotStrokeReaderVerify(const JotStrokeReader* reader);
+
+void JotStrokeReaderGetColor(const JotStrokeReader* reader, uint32_t index, float rgba[4]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JotStrokeCodec_h */
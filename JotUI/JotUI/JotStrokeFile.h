@@ -0,0 +1,87 @@
+//
+//  JotStrokeFile.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "PlistSaving.h"
+
+#define kJotStrokeBinaryFileExt @"jotstroke"
+// holds the mapped file of a stroke whose segments haven't been decoded
+#define kJotStrokeSegmentDataKey @"segmentData"
+// holds the JotStrokeSegmentColumns of a stroke that was read for loading
+#define kJotStrokeSegmentColumnsKey @"segmentColumns"
+
+/**
+ * The segments of a stroke file, decoded into one array of values
+ * for each column. Each segment reads its row with initFromStrokeValues:,
+ * so loading a stroke doesn't box every value into an NSNumber and
+ * build a dictionary for every segment.
+ */
+@interface JotStrokeSegmentColumns : NSObject <JotStrokeValues>
+
+@property(nonatomic, readonly) NSUInteger count;
+// the segment that the JotStrokeValues methods read
+@property(nonatomic, assign) NSUInteger row;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+
+/**
+ * Strokes used to be saved as the plist of their asDictionary, which
+ * boxes ~20 numbers per segment and is slow to parse. This saves the
+ * same dictionary in a binary, columnar file instead (see JotStrokeCodec.h):
+ * each segment key becomes a column of that key's values across all of
+ * the segments, so the points, controls, widths and colors of a stroke
+ * are each stored together and delta encoded.
+ *
+ * The conversion is lossless. Reading a file gives back a dictionary
+ * equal to the one that was saved. Strokes that are read to be loaded
+ * keep their segments in columns instead (see JotStrokeSegmentColumns).
+ * Colors are kept in a palette, and values that don't fit a column
+ * type are kept as small plists.
+ */
+@interface JotStrokeFile : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+// returns nil if the dictionary can't be saved, for instance if
+// it has more segment keys than kJotStrokeMaxColumns
++ (NSData*)dataForStrokeDictionary:(NSDictionary*)strokeDictionary;
+
+// returns nil if the data is corrupt or not a stroke file. the
+// dictionary and its segments are mutable, like they are when
+// loaded with dictionaryWithContentsOfFile:
++ (NSMutableDictionary*)strokeDictionaryFromData:(NSData*)data;
+
++ (BOOL)writeStrokeDictionary:(NSDictionary*)strokeDictionary toPath:(NSString*)path;
+
+// the file is memory mapped, and its columns are decoded in place
++ (NSMutableDictionary*)strokeDictionaryAtPath:(NSString*)path;
+
+/**
+ * reads a stroke to load with -[JotStroke initFromDictionary:]. its
+ * segments are decoded into kJotStrokeSegmentColumnsKey instead of the
+ * dictionaries in "segments". with lazySegments, a stroke that saved its
+ * hash and bounds (see -[JotStroke asDictionary]) isn't decoded at all.
+ * only the start of the file is read, and kJotStrokeSegmentDataKey holds
+ * the mapped file to decode the segments from with segmentColumnsFromData:
+ */
++ (NSMutableDictionary*)strokeDictionaryAtPath:(NSString*)path withLazySegments:(BOOL)lazySegments;
+
+// the same as strokeDictionaryAtPath:withLazySegments: for a stroke
+// file that's already in memory, like one mapped from a page journal
++ (NSMutableDictionary*)strokeDictionaryFromData:(NSData*)data withLazySegments:(BOOL)lazySegments;
+
+// returns the segments of the stroke file in data, or nil if it's corrupt
++ (JotStrokeSegmentColumns*)segmentColumnsFromData:(NSData*)data;
+
+// rewrites a plist stroke file as a binary stroke file
++ (BOOL)convertPlistAtPath:(NSString*)plistPath toPath:(NSString*)path;
+
+@end
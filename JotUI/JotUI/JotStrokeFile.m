@@ -0,0 +1,805 @@
+//
+//  JotStrokeFile.m
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import "JotStrokeFile.h"
+#import "JotStrokeCodec.h"
+#import "UIColor+JotHelper.h"
+#import "NSArray+JotMapReduce.h"
+
+
+static JotStrokeColumnKind jotKindOfNumber(NSNumber* number) {
+    if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID()) {
+        return JotStrokeColumnKindBool;
+    }
+    if (!CFNumberIsFloatType((__bridge CFNumberRef)number)) {
+        return JotStrokeColumnKindInteger;
+    }
+    // plists store every float as a double, so this
+    // keeps doubles that were floats as floats
+    double value = [number doubleValue];
+    return (double)(float)value == value || isnan(value) ? JotStrokeColumnKindFloat : JotStrokeColumnKindDouble;
+}
+
+/**
+ * colors are saved as an empty dictionary if they're nil,
+ * or as their red, green, blue and alpha floats
+ */
+static BOOL jotIsColorDictionary(NSDictionary* dictionary) {
+    if (![dictionary count]) {
+        return YES;
+    }
+    if ([dictionary count] != 4) {
+        return NO;
+    }
+    for (NSString* key in @[@"red", @"green", @"blue", @"alpha"]) {
+        id component = [dictionary objectForKey:key];
+        if (![component isKindOfClass:[NSNumber class]] || jotKindOfNumber(component) != JotStrokeColumnKindFloat) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+static JotStrokeColumnKind jotKindOfValue(id value) {
+    if ([value isKindOfClass:[NSNumber class]]) {
+        return jotKindOfNumber(value);
+    } else if ([value isKindOfClass:[NSString class]]) {
+        return JotStrokeColumnKindString;
+    } else if ([value isKindOfClass:[NSData class]]) {
+        return JotStrokeColumnKindData;
+    } else if ([value isKindOfClass:[NSDictionary class]] && jotIsColorDictionary(value)) {
+        return JotStrokeColumnKindColor;
+    }
+    return JotStrokeColumnKindPlist;
+}
+
+static JotStrokeColumnKind jotCombinedKind(JotStrokeColumnKind kind, JotStrokeColumnKind otherKind) {
+    if (!kind || kind == otherKind) {
+        return otherKind;
+    }
+    if ((kind == JotStrokeColumnKindFloat && otherKind == JotStrokeColumnKindDouble) ||
+        (kind == JotStrokeColumnKindDouble && otherKind == JotStrokeColumnKindFloat)) {
+        return JotStrokeColumnKindDouble;
+    }
+    // keep each value's own type
+    return JotStrokeColumnKindPlist;
+}
+
+
+@interface JotStrokeSegmentColumns ()
+
+- (instancetype)initWithTable:(const JotStrokeTable*)table andStrings:(NSArray*)strings andColors:(NSArray*)colors;
+
+@end
+
+
+@implementation JotStrokeFile {
+    // the string table and color palette are
+    // shared by the stroke and segment tables
+    NSMutableArray* strings;
+    NSMutableDictionary* stringIndexes;
+    NSMutableData* palette;
+    NSMutableDictionary* paletteIndexes;
+}
+
+- (instancetype)initForEncoding {
+    if (self = [super init]) {
+        strings = [NSMutableArray array];
+        stringIndexes = [NSMutableDictionary dictionary];
+        palette = [NSMutableData data];
+        paletteIndexes = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+#pragma mark - Writing
+
++ (NSData*)dataForStrokeDictionary:(NSDictionary*)strokeDictionary {
+    return [[[JotStrokeFile alloc] initForEncoding] encodeStrokeDictionary:strokeDictionary];
+}
+
++ (BOOL)writeStrokeDictionary:(NSDictionary*)strokeDictionary toPath:(NSString*)path {
+    return [[self dataForStrokeDictionary:strokeDictionary] writeToFile:path atomically:YES];
+}
+
++ (BOOL)convertPlistAtPath:(NSString*)plistPath toPath:(NSString*)path {
+    NSDictionary* strokeDictionary = [NSDictionary dictionaryWithContentsOfFile:plistPath];
+    return strokeDictionary && [self writeStrokeDictionary:strokeDictionary toPath:path];
+}
+
+- (NSData*)encodeStrokeDictionary:(NSDictionary*)strokeDictionary {
+    NSArray* segments = [strokeDictionary objectForKey:@"segments"];
+    BOOL hasSegments = [segments isKindOfClass:[NSArray class]] && [segments count] <= UINT32_MAX;
+    if (hasSegments) {
+        for (id segment in segments) {
+            if (![segment isKindOfClass:[NSDictionary class]]) {
+                // it'll be saved as a plist in the stroke table instead
+                hasSegments = NO;
+                break;
+            }
+        }
+    }
+    NSMutableDictionary* strokeRow = [NSMutableDictionary dictionaryWithDictionary:strokeDictionary];
+    if (hasSegments) {
+        [strokeRow removeObjectForKey:@"segments"];
+    }
+
+    JotStrokeBuffer tables;
+    JotStrokeBufferInit(&tables);
+    BOOL encoded = [self encodeRows:@[strokeRow] intoBuffer:&tables] && (!hasSegments || [self encodeRows:segments intoBuffer:&tables]);
+
+    // the strings and colors come first in the file, but
+    // aren't all known until the tables are encoded
+    JotStrokeBuffer payload;
+    JotStrokeBufferInit(&payload);
+    for (NSString* string in strings) {
+        NSData* utf8 = [string dataUsingEncoding:NSUTF8StringEncoding];
+        JotStrokeBufferAppendVarint(&payload, [utf8 length]);
+        JotStrokeBufferAppend(&payload, [utf8 bytes], [utf8 length]);
+    }
+    JotStrokeBufferAppend(&payload, [palette bytes], [palette length]);
+    JotStrokeBufferAppend(&payload, tables.bytes, tables.length);
+
+    NSMutableData* data = nil;
+    if (encoded && !tables.failed && !payload.failed && payload.length <= UINT32_MAX) {
+        JotStrokeFileHeader header;
+        JotStrokeFileHeaderMake(&header, payload.bytes, payload.length, hasSegments ? kJotStrokeFileHasSegments : 0,
+                                hasSegments ? (uint32_t)[segments count] : 0, (uint32_t)[strings count],
+                                (uint32_t)([palette length] / (4 * sizeof(float))));
+        data = [NSMutableData dataWithCapacity:sizeof(header) + payload.length];
+        [data appendBytes:&header length:sizeof(header)];
+        [data appendBytes:payload.bytes length:payload.length];
+    }
+    JotStrokeBufferFree(&tables);
+    JotStrokeBufferFree(&payload);
+    return data;
+}
+
+- (uint32_t)indexOfString:(NSString*)string {
+    NSNumber* index = [stringIndexes objectForKey:string];
+    if (!index) {
+        index = [NSNumber numberWithUnsignedInteger:[strings count]];
+        [strings addObject:string];
+        [stringIndexes setObject:index forKey:string];
+    }
+    return [index unsignedIntValue];
+}
+
+// 0 is an empty color dictionary, and
+// palette entries are numbered from 1
+- (uint32_t)indexOfColor:(NSDictionary*)color {
+    if (![color count]) {
+        return 0;
+    }
+    float rgba[4] = {[[color objectForKey:@"red"] floatValue], [[color objectForKey:@"green"] floatValue],
+                     [[color objectForKey:@"blue"] floatValue], [[color objectForKey:@"alpha"] floatValue]};
+    NSData* key = [NSData dataWithBytes:rgba length:sizeof(rgba)];
+    NSNumber* index = [paletteIndexes objectForKey:key];
+    if (!index) {
+        [palette appendData:key];
+        index = [NSNumber numberWithUnsignedInteger:[palette length] / sizeof(rgba)];
+        [paletteIndexes setObject:index forKey:key];
+    }
+    return [index unsignedIntValue];
+}
+
+/**
+ * writes a table with a column for every key in rows. keys are
+ * sorted so that the same dictionary always saves the same bytes
+ */
+- (BOOL)encodeRows:(NSArray*)rows intoBuffer:(JotStrokeBuffer*)buffer {
+    NSMutableSet* keySet = [NSMutableSet set];
+    for (NSDictionary* row in rows) {
+        [keySet addObjectsFromArray:[row allKeys]];
+    }
+    for (id key in keySet) {
+        if (![key isKindOfClass:[NSString class]]) {
+            return NO;
+        }
+    }
+    if ([keySet count] > kJotStrokeMaxColumns) {
+        return NO;
+    }
+    NSArray* keys = [[keySet allObjects] sortedArrayUsingSelector:@selector(compare:)];
+
+    NSUInteger rowCount = [rows count];
+    NSMutableData* present = [NSMutableData dataWithLength:rowCount * sizeof(bool)];
+    bool* isPresent = [present mutableBytes];
+
+    JotStrokeTable table;
+    JotStrokeBuffer columns[kJotStrokeMaxColumns];
+    table.rowCount = (uint32_t)rowCount;
+    table.columnCount = (uint32_t)[keys count];
+
+    BOOL encoded = YES;
+    for (uint32_t i = 0; i < table.columnCount; i++) {
+        NSString* key = [keys objectAtIndex:i];
+        JotStrokeBuffer* column = &columns[i];
+        JotStrokeBufferInit(column);
+
+        NSMutableArray* values = [NSMutableArray arrayWithCapacity:rowCount];
+        JotStrokeColumnKind kind = 0;
+        for (NSUInteger row = 0; row < rowCount; row++) {
+            id value = [[rows objectAtIndex:row] objectForKey:key];
+            isPresent[row] = value != nil;
+            if (value) {
+                [values addObject:value];
+                kind = jotCombinedKind(kind, jotKindOfValue(value));
+            }
+        }
+
+        uint8_t flags = 0;
+        if ([values count] < rowCount) {
+            flags |= kJotStrokeColumnHasPresence;
+            JotStrokeEncodeBits(isPresent, rowCount, column);
+        }
+        encoded = encoded && [self encodeValues:values ofKind:kind intoBuffer:column];
+
+        table.columns[i] = (JotStrokeColumn){[self indexOfString:key], kind, flags, column->bytes, column->length};
+    }
+
+    if (encoded) {
+        JotStrokeWriteTable(&table, buffer);
+    }
+    for (uint32_t i = 0; i < table.columnCount; i++) {
+        encoded = encoded && !columns[i].failed;
+        JotStrokeBufferFree(&columns[i]);
+    }
+    return encoded;
+}
+
+- (BOOL)encodeValues:(NSArray*)values ofKind:(JotStrokeColumnKind)kind intoBuffer:(JotStrokeBuffer*)buffer {
+    NSUInteger count = [values count];
+    switch (kind) {
+        case JotStrokeColumnKindFloat: {
+            NSMutableData* scratch = [NSMutableData dataWithLength:count * sizeof(float)];
+            float* floats = [scratch mutableBytes];
+            [values enumerateObjectsUsingBlock:^(NSNumber* value, NSUInteger index, BOOL* stop) {
+                floats[index] = [value floatValue];
+            }];
+            JotStrokeEncodeFloats(floats, count, buffer);
+            break;
+        }
+        case JotStrokeColumnKindDouble: {
+            NSMutableData* scratch = [NSMutableData dataWithLength:count * sizeof(double)];
+            double* doubles = [scratch mutableBytes];
+            [values enumerateObjectsUsingBlock:^(NSNumber* value, NSUInteger index, BOOL* stop) {
+                doubles[index] = [value doubleValue];
+            }];
+            JotStrokeEncodeDoubles(doubles, count, buffer);
+            break;
+        }
+        case JotStrokeColumnKindBool: {
+            NSMutableData* scratch = [NSMutableData dataWithLength:count * sizeof(bool)];
+            bool* bools = [scratch mutableBytes];
+            [values enumerateObjectsUsingBlock:^(NSNumber* value, NSUInteger index, BOOL* stop) {
+                bools[index] = [value boolValue];
+            }];
+            JotStrokeEncodeBits(bools, count, buffer);
+            break;
+        }
+        case JotStrokeColumnKindInteger:
+        case JotStrokeColumnKindString:
+        case JotStrokeColumnKindColor: {
+            NSMutableData* scratch = [NSMutableData dataWithLength:count * sizeof(int64_t)];
+            int64_t* integers = [scratch mutableBytes];
+            [values enumerateObjectsUsingBlock:^(id value, NSUInteger index, BOOL* stop) {
+                if (kind == JotStrokeColumnKindString) {
+                    integers[index] = [self indexOfString:value];
+                } else if (kind == JotStrokeColumnKindColor) {
+                    integers[index] = [self indexOfColor:value];
+                } else {
+                    integers[index] = [value longLongValue];
+                }
+            }];
+            JotStrokeEncodeIntegers(integers, count, buffer);
+            break;
+        }
+        case JotStrokeColumnKindData:
+        case JotStrokeColumnKindPlist: {
+            for (id value in values) {
+                NSData* bytes = value;
+                if (kind == JotStrokeColumnKindPlist) {
+                    // a plist can't have a bare number or string at its root
+                    bytes = [NSPropertyListSerialization dataWithPropertyList:@[value] format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+                    if (!bytes) {
+                        return NO;
+                    }
+                }
+                JotStrokeBufferAppendVarint(buffer, [bytes length]);
+                JotStrokeBufferAppend(buffer, [bytes bytes], [bytes length]);
+            }
+            break;
+        }
+    }
+    return YES;
+}
+
+#pragma mark - Reading
+
++ (NSMutableDictionary*)strokeDictionaryAtPath:(NSString*)path {
+    NSData* data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+    if (!data) {
+        return nil;
+    }
+    return [self strokeDictionaryFromData:data];
+}
+
++ (NSMutableDictionary*)strokeDictionaryAtPath:(NSString*)path withLazySegments:(BOOL)lazySegments {
+    NSData* data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+    if (!data) {
+        return nil;
+    }
+    return [self strokeDictionaryFromData:data withLazySegments:lazySegments];
+}
+
++ (NSMutableDictionary*)strokeDictionaryFromData:(NSData*)data withLazySegments:(BOOL)lazySegments {
+    JotStrokeReader file;
+    NSArray* strings;
+    NSArray* colors;
+    if (![self openData:data withReader:&file andStrings:&strings andColors:&colors]) {
+        return nil;
+    }
+    NSMutableDictionary* strokeDictionary = [[self rowsOfTable:&file.stroke withStrings:strings andColors:colors] firstObject];
+    if (!(file.header.flags & kJotStrokeFileHasSegments)) {
+        // the segments, if any, were saved in the stroke table
+        return JotStrokeReaderVerify(&file) ? strokeDictionary : nil;
+    }
+    if (lazySegments && [strokeDictionary objectForKey:@"contentHash"] && [strokeDictionary objectForKey:@"bounds.x"]) {
+        // only the start of the file has been read, and the
+        // segments will be decoded from the mapped file later
+        [strokeDictionary setObject:data forKey:kJotStrokeSegmentDataKey];
+        return strokeDictionary;
+    }
+    if (!strokeDictionary || !JotStrokeReaderVerify(&file)) {
+        return nil;
+    }
+    JotStrokeSegmentColumns* segmentColumns = [[JotStrokeSegmentColumns alloc] initWithTable:&file.segments andStrings:strings andColors:colors];
+    if (!segmentColumns) {
+        return nil;
+    }
+    [strokeDictionary setObject:segmentColumns forKey:kJotStrokeSegmentColumnsKey];
+    return strokeDictionary;
+}
+
++ (NSMutableDictionary*)strokeDictionaryFromData:(NSData*)data {
+    JotStrokeReader file;
+    NSArray* strings;
+    NSArray* colors;
+    if (![self openData:data withReader:&file andStrings:&strings andColors:&colors] || !JotStrokeReaderVerify(&file)) {
+        return nil;
+    }
+    NSMutableDictionary* strokeDictionary = [[self rowsOfTable:&file.stroke withStrings:strings andColors:colors] firstObject];
+    if (!strokeDictionary) {
+        return nil;
+    }
+    if (file.header.flags & kJotStrokeFileHasSegments) {
+        NSMutableArray* segments = [self rowsOfTable:&file.segments withStrings:strings andColors:colors];
+        if (!segments) {
+            return nil;
+        }
+        [strokeDictionary setObject:segments forKey:@"segments"];
+    }
+    return strokeDictionary;
+}
+
++ (JotStrokeSegmentColumns*)segmentColumnsFromData:(NSData*)data {
+    JotStrokeReader file;
+    NSArray* strings;
+    NSArray* colors;
+    if (![self openData:data withReader:&file andStrings:&strings andColors:&colors] || !JotStrokeReaderVerify(&file)) {
+        return nil;
+    }
+    JotStrokeTable noSegments;
+    memset(&noSegments, 0, sizeof(noSegments));
+    const JotStrokeTable* segments = (file.header.flags & kJotStrokeFileHasSegments) ? &file.segments : &noSegments;
+    return [[JotStrokeSegmentColumns alloc] initWithTable:segments andStrings:strings andColors:colors];
+}
+
+/**
+ * opens the file and decodes its string table and color palette,
+ * which both of the tables need. this doesn't check the checksum
+ */
++ (BOOL)openData:(NSData*)data withReader:(JotStrokeReader*)file andStrings:(NSArray**)outStrings andColors:(NSArray**)outColors {
+    if (!JotStrokeReaderOpen([data bytes], [data length], file)) {
+        return NO;
+    }
+
+    NSMutableArray* strings = [NSMutableArray arrayWithCapacity:file->header.stringCount];
+    JotStrokeCursor cursor = file->strings;
+    for (uint32_t i = 0; i < file->header.stringCount; i++) {
+        uint64_t length;
+        const uint8_t* bytes;
+        NSString* string = nil;
+        if (JotStrokeReadVarint(&cursor, &length) && JotStrokeReadBytes(&cursor, (size_t)length, &bytes)) {
+            string = [[NSString alloc] initWithBytes:bytes length:(NSUInteger)length encoding:NSUTF8StringEncoding];
+        }
+        if (!string) {
+            return NO;
+        }
+        [strings addObject:string];
+    }
+
+    NSMutableArray* colors = [NSMutableArray arrayWithCapacity:file->header.colorCount + 1];
+    [colors addObject:[NSDictionary dictionary]];
+    for (uint32_t i = 0; i < file->header.colorCount; i++) {
+        float rgba[4];
+        JotStrokeReaderGetColor(file, i, rgba);
+        [colors addObject:@{ @"red": [NSNumber numberWithFloat:rgba[0]],
+                             @"green": [NSNumber numberWithFloat:rgba[1]],
+                             @"blue": [NSNumber numberWithFloat:rgba[2]],
+                             @"alpha": [NSNumber numberWithFloat:rgba[3]] }];
+    }
+
+    *outStrings = strings;
+    *outColors = colors;
+    return YES;
+}
+
++ (NSMutableArray*)rowsOfTable:(const JotStrokeTable*)table withStrings:(NSArray*)strings andColors:(NSArray*)colors {
+    NSUInteger rowCount = table->rowCount;
+    NSMutableArray* rows = [NSMutableArray arrayWithCapacity:rowCount];
+    for (NSUInteger row = 0; row < rowCount; row++) {
+        [rows addObject:[NSMutableDictionary dictionary]];
+    }
+    NSMutableData* present = [NSMutableData dataWithLength:rowCount * sizeof(bool)];
+    bool* isPresent = [present mutableBytes];
+
+    for (uint32_t i = 0; i < table->columnCount; i++) {
+        const JotStrokeColumn* column = &table->columns[i];
+        if (column->nameIndex >= [strings count]) {
+            return nil;
+        }
+        NSString* key = [strings objectAtIndex:column->nameIndex];
+        JotStrokeCursor cursor = {column->bytes, column->bytes + column->length};
+
+        NSUInteger count = rowCount;
+        if (column->flags & kJotStrokeColumnHasPresence) {
+            if (!JotStrokeDecodeBits(&cursor, isPresent, rowCount)) {
+                return nil;
+            }
+            count = 0;
+            for (NSUInteger row = 0; row < rowCount; row++) {
+                count += isPresent[row];
+            }
+        } else {
+            for (NSUInteger row = 0; row < rowCount; row++) {
+                isPresent[row] = true;
+            }
+        }
+
+        NSArray* values = [self valuesOfKind:column->kind count:count fromCursor:&cursor withStrings:strings andColors:colors];
+        if (!values || cursor.bytes != cursor.end) {
+            return nil;
+        }
+        NSUInteger index = 0;
+        for (NSUInteger row = 0; row < rowCount; row++) {
+            if (isPresent[row]) {
+                [[rows objectAtIndex:row] setObject:[values objectAtIndex:index++] forKey:key];
+            }
+        }
+    }
+    return rows;
+}
+
++ (NSArray*)valuesOfKind:(JotStrokeColumnKind)kind count:(NSUInteger)count fromCursor:(JotStrokeCursor*)cursor withStrings:(NSArray*)strings andColors:(NSArray*)colors {
+    NSMutableArray* values = [NSMutableArray arrayWithCapacity:count];
+    switch (kind) {
+        case JotStrokeColumnKindFloat: {
+            NSMutableData* scratch = [NSMutableData dataWithLength:count * sizeof(float)];
+            const float* floats = [scratch mutableBytes];
+            if (!JotStrokeDecodeFloats(cursor, [scratch mutableBytes], count)) {
+                return nil;
+            }
+            for (NSUInteger i = 0; i < count; i++) {
+                [values addObject:[NSNumber numberWithFloat:floats[i]]];
+            }
+            break;
+        }
+        case JotStrokeColumnKindDouble: {
+            NSMutableData* scratch = [NSMutableData dataWithLength:count * sizeof(double)];
+            const double* doubles = [scratch mutableBytes];
+            if (!JotStrokeDecodeDoubles(cursor, [scratch mutableBytes], count)) {
+                return nil;
+            }
+            for (NSUInteger i = 0; i < count; i++) {
+                [values addObject:[NSNumber numberWithDouble:doubles[i]]];
+            }
+            break;
+        }
+        case JotStrokeColumnKindBool: {
+            NSMutableData* scratch = [NSMutableData dataWithLength:count * sizeof(bool)];
+            const bool* bools = [scratch mutableBytes];
+            if (!JotStrokeDecodeBits(cursor, [scratch mutableBytes], count)) {
+                return nil;
+            }
+            for (NSUInteger i = 0; i < count; i++) {
+                [values addObject:[NSNumber numberWithBool:bools[i]]];
+            }
+            break;
+        }
+        case JotStrokeColumnKindInteger:
+        case JotStrokeColumnKindString:
+        case JotStrokeColumnKindColor: {
+            NSMutableData* scratch = [NSMutableData dataWithLength:count * sizeof(int64_t)];
+            const int64_t* integers = [scratch mutableBytes];
+            if (!JotStrokeDecodeIntegers(cursor, [scratch mutableBytes], count)) {
+                return nil;
+            }
+            NSArray* lookup = kind == JotStrokeColumnKindString ? strings : colors;
+            for (NSUInteger i = 0; i < count; i++) {
+                if (kind == JotStrokeColumnKindInteger) {
+                    [values addObject:[NSNumber numberWithLongLong:integers[i]]];
+                } else if (integers[i] >= 0 && (uint64_t)integers[i] < [lookup count]) {
+                    [values addObject:[lookup objectAtIndex:(NSUInteger)integers[i]]];
+                } else {
+                    return nil;
+                }
+            }
+            break;
+        }
+        case JotStrokeColumnKindData:
+        case JotStrokeColumnKindPlist: {
+            for (NSUInteger i = 0; i < count; i++) {
+                uint64_t length;
+                const uint8_t* bytes;
+                if (!JotStrokeReadVarint(cursor, &length) || !JotStrokeReadBytes(cursor, (size_t)length, &bytes)) {
+                    return nil;
+                }
+                NSData* data = [NSData dataWithBytes:bytes length:(NSUInteger)length];
+                if (kind == JotStrokeColumnKindData) {
+                    [values addObject:data];
+                    continue;
+                }
+                NSArray* plist = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListMutableContainers format:nil error:nil];
+                if (![plist isKindOfClass:[NSArray class]] || [plist count] != 1) {
+                    return nil;
+                }
+                [values addObject:[plist firstObject]];
+            }
+            break;
+        }
+        default:
+            // a column type from a newer version
+            return nil;
+    }
+    return values;
+}
+
+@end
+
+
+@implementation JotStrokeSegmentColumns {
+    NSArray* strings;
+    // color dictionaries, and the same colors as UIColors or NSNull
+    NSArray* colorDictionaries;
+    NSArray* colors;
+    // column name -> index into the arrays below
+    NSDictionary* columnIndexes;
+    JotStrokeColumnKind kinds[kJotStrokeMaxColumns];
+    // a value for each row. floats, doubles and bools are doubles, and
+    // integers, strings and colors are int64_t. missing values are 0,
+    // and missing strings and colors are -1
+    NSMutableData* values[kJotStrokeMaxColumns];
+    // the values of data and plist columns, with NSNull when missing
+    NSArray* objects[kJotStrokeMaxColumns];
+}
+
+@synthesize count;
+@synthesize row;
+
+- (instancetype)initWithTable:(const JotStrokeTable*)table andStrings:(NSArray*)_strings andColors:(NSArray*)_colorDictionaries {
+    if (self = [super init]) {
+        count = table->rowCount;
+        strings = _strings;
+        colorDictionaries = _colorDictionaries;
+        colors = [colorDictionaries jotMap:^id(NSDictionary* color, NSUInteger index) {
+            return [UIColor colorWithDictionary:color] ?: [NSNull null];
+        }];
+
+        NSMutableDictionary* indexes = [NSMutableDictionary dictionary];
+        NSMutableData* present = [NSMutableData dataWithLength:count * sizeof(bool)];
+        for (uint32_t i = 0; i < table->columnCount; i++) {
+            const JotStrokeColumn* column = &table->columns[i];
+            if (column->nameIndex >= [strings count] || ![self decodeColumn:column atIndex:i withPresence:[present mutableBytes]]) {
+                return nil;
+            }
+            [indexes setObject:[NSNumber numberWithUnsignedInt:i] forKey:[strings objectAtIndex:column->nameIndex]];
+        }
+        columnIndexes = indexes;
+    }
+    return self;
+}
+
+- (BOOL)decodeColumn:(const JotStrokeColumn*)column atIndex:(uint32_t)index withPresence:(bool*)isPresent {
+    JotStrokeCursor cursor = {column->bytes, column->bytes + column->length};
+    NSUInteger valueCount = count;
+    if (column->flags & kJotStrokeColumnHasPresence) {
+        if (!JotStrokeDecodeBits(&cursor, isPresent, count)) {
+            return NO;
+        }
+        valueCount = 0;
+        for (NSUInteger i = 0; i < count; i++) {
+            valueCount += isPresent[i];
+        }
+    } else {
+        memset(isPresent, true, count * sizeof(bool));
+    }
+
+    kinds[index] = column->kind;
+    switch (column->kind) {
+        case JotStrokeColumnKindFloat:
+        case JotStrokeColumnKindDouble:
+        case JotStrokeColumnKindBool: {
+            NSMutableData* decoded = [NSMutableData dataWithLength:valueCount * sizeof(double)];
+            double* doubles = [decoded mutableBytes];
+            BOOL didDecode = NO;
+            if (column->kind == JotStrokeColumnKindDouble) {
+                didDecode = JotStrokeDecodeDoubles(&cursor, doubles, valueCount);
+            } else if (column->kind == JotStrokeColumnKindFloat) {
+                // decoded into the front of the buffer, and widened from the back
+                float* floats = (float*)doubles;
+                didDecode = JotStrokeDecodeFloats(&cursor, floats, valueCount);
+                for (NSUInteger i = valueCount; didDecode && i > 0; i--) {
+                    doubles[i - 1] = floats[i - 1];
+                }
+            } else {
+                bool* bools = (bool*)doubles;
+                didDecode = JotStrokeDecodeBits(&cursor, bools, valueCount);
+                for (NSUInteger i = valueCount; didDecode && i > 0; i--) {
+                    doubles[i - 1] = bools[i - 1];
+                }
+            }
+            if (!didDecode) {
+                return NO;
+            }
+            values[index] = [self spreadValues:decoded ofSize:sizeof(double) withPresence:isPresent orMissingValue:NULL];
+            break;
+        }
+        case JotStrokeColumnKindInteger:
+        case JotStrokeColumnKindString:
+        case JotStrokeColumnKindColor: {
+            NSMutableData* decoded = [NSMutableData dataWithLength:valueCount * sizeof(int64_t)];
+            if (!JotStrokeDecodeIntegers(&cursor, [decoded mutableBytes], valueCount)) {
+                return NO;
+            }
+            if (column->kind != JotStrokeColumnKindInteger) {
+                NSUInteger lookupCount = column->kind == JotStrokeColumnKindString ? [strings count] : [colorDictionaries count];
+                const int64_t* indexes = [decoded bytes];
+                for (NSUInteger i = 0; i < valueCount; i++) {
+                    if (indexes[i] < 0 || (uint64_t)indexes[i] >= lookupCount) {
+                        return NO;
+                    }
+                }
+            }
+            int64_t missing = column->kind == JotStrokeColumnKindInteger ? 0 : -1;
+            values[index] = [self spreadValues:decoded ofSize:sizeof(int64_t) withPresence:isPresent orMissingValue:&missing];
+            break;
+        }
+        case JotStrokeColumnKindData:
+        case JotStrokeColumnKindPlist: {
+            NSArray* decoded = [JotStrokeFile valuesOfKind:column->kind count:valueCount fromCursor:&cursor withStrings:strings andColors:colorDictionaries];
+            if (!decoded) {
+                return NO;
+            }
+            NSMutableArray* spread = [NSMutableArray arrayWithCapacity:count];
+            NSUInteger next = 0;
+            for (NSUInteger i = 0; i < count; i++) {
+                [spread addObject:isPresent[i] ? [decoded objectAtIndex:next++] : [NSNull null]];
+            }
+            objects[index] = spread;
+            break;
+        }
+        default:
+            // a column type from a newer version
+            return NO;
+    }
+    return cursor.bytes == cursor.end;
+}
+
+// moves each value to its row, and fills in the rows without one
+- (NSMutableData*)spreadValues:(NSMutableData*)decoded ofSize:(size_t)size withPresence:(const bool*)isPresent orMissingValue:(const void*)missing {
+    if ([decoded length] == count * size) {
+        return decoded;
+    }
+    NSMutableData* spread = [NSMutableData dataWithLength:count * size];
+    const uint8_t* from = [decoded bytes];
+    uint8_t* to = [spread mutableBytes];
+    for (NSUInteger i = 0; i < count; i++) {
+        if (isPresent[i]) {
+            memcpy(to + i * size, from, size);
+            from += size;
+        } else if (missing) {
+            memcpy(to + i * size, missing, size);
+        }
+    }
+    return spread;
+}
+
+- (NSInteger)columnForKey:(NSString*)key {
+    NSNumber* index = [columnIndexes objectForKey:key];
+    return index && row < count ? [index integerValue] : -1;
+}
+
+#pragma mark - JotStrokeValues
+
+- (id)objectForKey:(NSString*)key {
+    NSInteger column = [self columnForKey:key];
+    if (column < 0) {
+        return nil;
+    }
+    switch (kinds[column]) {
+        case JotStrokeColumnKindFloat:
+            return [NSNumber numberWithFloat:((const double*)[values[column] bytes])[row]];
+        case JotStrokeColumnKindDouble:
+            return [NSNumber numberWithDouble:((const double*)[values[column] bytes])[row]];
+        case JotStrokeColumnKindBool:
+            return [NSNumber numberWithBool:((const double*)[values[column] bytes])[row] != 0];
+        case JotStrokeColumnKindInteger:
+            return [NSNumber numberWithLongLong:((const int64_t*)[values[column] bytes])[row]];
+        case JotStrokeColumnKindString:
+        case JotStrokeColumnKindColor: {
+            int64_t index = ((const int64_t*)[values[column] bytes])[row];
+            NSArray* lookup = kinds[column] == JotStrokeColumnKindString ? strings : colorDictionaries;
+            return index < 0 ? nil : [lookup objectAtIndex:(NSUInteger)index];
+        }
+        default: {
+            id object = [objects[column] objectAtIndex:row];
+            return object == [NSNull null] ? nil : object;
+        }
+    }
+}
+
+- (double)doubleForKey:(NSString*)key {
+    NSInteger column = [self columnForKey:key];
+    if (column < 0) {
+        return 0;
+    }
+    switch (kinds[column]) {
+        case JotStrokeColumnKindFloat:
+        case JotStrokeColumnKindDouble:
+        case JotStrokeColumnKindBool:
+            return ((const double*)[values[column] bytes])[row];
+        case JotStrokeColumnKindInteger:
+            return ((const int64_t*)[values[column] bytes])[row];
+        default: {
+            // mixed columns keep each value's own type
+            id object = [self objectForKey:key];
+            return [object isKindOfClass:[NSNumber class]] || [object isKindOfClass:[NSString class]] ? [object doubleValue] : 0;
+        }
+    }
+}
+
+- (float)jotFloatForKey:(NSString*)key {
+    return (float)[self doubleForKey:key];
+}
+
+- (BOOL)jotBoolForKey:(NSString*)key {
+    return [self doubleForKey:key] != 0;
+}
+
+- (NSInteger)jotIntegerForKey:(NSString*)key {
+    NSInteger column = [self columnForKey:key];
+    if (column >= 0 && kinds[column] == JotStrokeColumnKindInteger) {
+        return (NSInteger)((const int64_t*)[values[column] bytes])[row];
+    }
+    return (NSInteger)[self doubleForKey:key];
+}
+
+- (UIColor*)jotColorForKey:(NSString*)key {
+    NSInteger column = [self columnForKey:key];
+    if (column >= 0 && kinds[column] == JotStrokeColumnKindColor) {
+        int64_t index = ((const int64_t*)[values[column] bytes])[row];
+        id color = index < 0 ? nil : [colors objectAtIndex:(NSUInteger)index];
+        return color == [NSNull null] ? nil : color;
+    }
+    id dictionary = [self objectForKey:key];
+    return [dictionary isKindOfClass:[NSDictionary class]] ? [UIColor colorWithDictionary:dictionary] : nil;
+}
+
+@end
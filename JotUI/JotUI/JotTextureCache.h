@@ -9,13 +9,43 @@
 #import <Foundation/Foundation.h>
 #import "JotGLTexture.h"
 
+// the most bytes of unused textures that are cached by default
+#define kJotTextureCacheDefaultByteBudget (64 * 1024 * 1024)
 
+
+/**
+ * Caches textures that are returned after an export or a stencil
+ * pass, so that the next one of the same size can reuse them.
+ *
+ * Textures are only reused for the exact pixel size they were made
+ * for. The unused textures are kept in least recently returned order,
+ * and once they're over byteBudget the oldest are sent to the trash
+ * manager, which deletes them.
+ */
 @interface JotTextureCache : NSObject
 
 + (JotTextureCache*)sharedManager;
 
+// the most bytes of unused textures to keep. lowering it evicts
+// textures right away
+@property(nonatomic, assign) int byteBudget;
+
+// bytes of unused textures in the cache
+@property(nonatomic, readonly) int cachedBytes;
+
+// textures that were reused, that had to be generated, and that
+// were evicted to stay under the budget
+@property(nonatomic, readonly) NSUInteger hitCount;
+@property(nonatomic, readonly) NSUInteger missCount;
+@property(nonatomic, readonly) NSUInteger evictionCount;
+
 - (JotGLTexture*)generateTextureForContext:(JotGLContext*)context ofSize:(CGSize)fullSize;
 
 - (void)returnTextureForReuse:(JotGLTexture*)texture;
 
+// evicts the oldest textures until about bytesToFree are evicted, and
+// returns how many bytes were. the memory manager calls this when it's
+// over budget
+- (NSUInteger)evictBytes:(NSUInteger)bytesToFree;
+
 @end
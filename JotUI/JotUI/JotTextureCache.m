@@ -8,6 +8,8 @@
 
 #import "JotTextureCache.h"
 #import "JotGLContext.h"
+#import "JotTrashManager.h"
+#import "JotMemoryManager.h"
 
 
 @interface JotGLTexture (Lock)
@@ -18,12 +20,31 @@
 
 
 @implementation JotTextureCache {
-    NSMutableArray* cachedTextures;
+    // pixel size => the unused textures of that size
+    NSMutableDictionary* texturesBySize;
+    // every unused texture, least recently returned first
+    NSMutableOrderedSet* texturesByAge;
+}
+
+@synthesize byteBudget;
+@synthesize cachedBytes;
+@synthesize hitCount;
+@synthesize missCount;
+@synthesize evictionCount;
+
+static size_t JotTextureCacheTrim(void* context, size_t bytesToFree) {
+    return [(__bridge JotTextureCache*)context evictBytes:bytesToFree];
 }
 
 - (id)init {
     if (self = [super init]) {
-        cachedTextures = [NSMutableArray array];
+        texturesBySize = [NSMutableDictionary dictionary];
+        texturesByAge = [NSMutableOrderedSet orderedSet];
+        byteBudget = kJotTextureCacheDefaultByteBudget;
+        // the cache is never deallocated, so it's never removed. its textures
+        // are already counted as JotMemoryCategoryTexture, so it has no size
+        JotMemoryAccountantAddPool([[JotMemoryManager sharedManager] accountant], JotMemoryCategoryTexture, kJotMemoryPriorityTextureCache,
+                                   &JotTextureCacheTrim, NULL, (__bridge void*)self);
     }
     return self;
 }
@@ -37,23 +58,73 @@
     return manager;
 }
 
++ (NSString*)keyForSize:(CGSize)pixelSize {
+    return [NSString stringWithFormat:@"%dx%d", (int)pixelSize.width, (int)pixelSize.height];
+}
+
+#pragma mark - Budget
+
+- (void)setByteBudget:(int)_byteBudget {
+    @synchronized(self) {
+        byteBudget = _byteBudget;
+        [self evictToBudget];
+    }
+}
+
+// must be called while synchronized on self
+- (void)removeCachedTexture:(JotGLTexture*)texture {
+    NSString* key = [JotTextureCache keyForSize:texture.pixelSize];
+    NSMutableArray* textures = texturesBySize[key];
+    [textures removeObjectIdenticalTo:texture];
+    if (![textures count]) {
+        [texturesBySize removeObjectForKey:key];
+    }
+    [texturesByAge removeObject:texture];
+    cachedBytes -= texture.fullByteSize;
+}
+
+// must be called while synchronized on self
+- (void)evictOldestTexture {
+    JotGLTexture* texture = [texturesByAge firstObject];
+    [self removeCachedTexture:texture];
+    evictionCount++;
+    // the trash manager deletes the texture on its own context
+    // without stalling whichever thread returned it
+    [[JotTrashManager sharedInstance] addObjectToDealloc:texture];
+}
+
+// must be called while synchronized on self
+- (void)evictToBudget {
+    while (cachedBytes > byteBudget && [texturesByAge count]) {
+        [self evictOldestTexture];
+    }
+}
+
+- (NSUInteger)evictBytes:(NSUInteger)bytesToFree {
+    @synchronized(self) {
+        int startingBytes = cachedBytes;
+        while ((NSUInteger)(startingBytes - cachedBytes) < bytesToFree && [texturesByAge count]) {
+            [self evictOldestTexture];
+        }
+        return (NSUInteger)(startingBytes - cachedBytes);
+    }
+}
+
+#pragma mark - Textures
+
 - (JotGLTexture*)generateTextureForContext:(JotGLContext*)context ofSize:(CGSize)fullSize {
     __block GLuint canvastexture = 0;
 
     @synchronized(self) {
-        if ([cachedTextures count]) {
-            CGFloat targetPxCount = fullSize.width * fullSize.height;
-            for (NSInteger index = 0; index < [cachedTextures count]; index++) {
-                JotGLTexture* reusedTexture = cachedTextures[index];
-                CGFloat reusedPxCount = reusedTexture.pixelSize.width * reusedTexture.pixelSize.height;
-                if (reusedPxCount >= targetPxCount) {
-                    // Only return a cached texture if it could fit the requested texture size
-                    // in it's allocated size
-                    [cachedTextures removeObject:reusedTexture];
-                    return reusedTexture;
-                }
-            }
+        // a texture of any other size would draw with the wrong
+        // aspect ratio, or waste memory
+        JotGLTexture* reusedTexture = [texturesBySize[[JotTextureCache keyForSize:fullSize]] lastObject];
+        if (reusedTexture) {
+            [self removeCachedTexture:reusedTexture];
+            hitCount++;
+            return reusedTexture;
         }
+        missCount++;
 
         [context runBlock:^{
             canvastexture = [context generateTextureForSize:fullSize withBytes:NULL];
@@ -73,11 +144,20 @@
         if ([texture isLocked]) {
             @throw [NSException exceptionWithName:@"TextureCacheException" reason:@"Caching locked texture" userInfo:nil];
         }
-        if ([cachedTextures containsObject:texture]) {
+        if ([texturesByAge containsObject:texture]) {
             @throw [NSException exceptionWithName:@"TextureCacheException" reason:@"Recaching already cached texture" userInfo:nil];
         }
-        [cachedTextures addObject:texture];
-        //        DebugLog(@"texture returned, have %d in cache", (int) [cachedTextures count]);
+        NSString* key = [JotTextureCache keyForSize:texture.pixelSize];
+        NSMutableArray* textures = texturesBySize[key];
+        if (!textures) {
+            textures = [NSMutableArray array];
+            texturesBySize[key] = textures;
+        }
+        [textures addObject:texture];
+        [texturesByAge addObject:texture];
+        cachedBytes += texture.fullByteSize;
+        [self evictToBudget];
+        //        DebugLog(@"texture returned, have %d in cache", (int) [texturesByAge count]);
     }
 }
 
@@ -13,6 +13,12 @@
 #import "JotBufferVBO.h"
 #import "NSArray+JotMapReduce.h"
 
+// a GL object costs about as much to delete as this many bytes
+#define kJotTrashBytesPerGLObject (64 * 1024)
+// the most bytes, counting GL objects by kJotTrashBytesPerGLObject,
+// that are reclaimed in one tick
+#define kJotTrashMaxBytesPerTick (16 * 1024 * 1024)
+
 /**
  * The trash manager will hold onto objects and slowly
  * release them over time. This way, instead of releasing
@@ -20,9 +26,17 @@
  * over time and spread that CPU over a longer duration.
  *
  * this'll prevent cpu spikes just from deallocs
+ *
+ * the trash is a FIFO queue. objects are appended to queueTail,
+ * and popped from the end of queueHead, which is queueTail reversed
+ * whenever it runs out. objectsInTrash is an identity set of both,
+ * so adding and removing are both O(1), amortized, no matter how
+ * much trash there is.
  */
 @implementation JotTrashManager {
-    NSMutableArray* objectsToDealloc;
+    NSMutableArray* queueHead;
+    NSMutableArray* queueTail;
+    NSHashTable* objectsInTrash;
     NSTimeInterval maxTickDuration;
     JotGLContext* backgroundContext;
 }
@@ -48,7 +62,10 @@ static const void* const kJotTrashQueueIdentifier = &kJotTrashQueueIdentifier;
     if (_instance)
         return _instance;
     if ((self = [super init])) {
-        objectsToDealloc = [[NSMutableArray alloc] init];
+        queueHead = [[NSMutableArray alloc] init];
+        queueTail = [[NSMutableArray alloc] init];
+        // the queues retain the trash, so the set only needs its pointers
+        objectsInTrash = [[NSHashTable alloc] initWithOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality capacity:0];
         maxTickDuration = 1;
         _instance = self;
     }
@@ -63,6 +80,30 @@ static const void* const kJotTrashQueueIdentifier = &kJotTrashQueueIdentifier;
 }
 
 
+#pragma mark - Trash Queue
+
+// must be called while synchronized on self
+- (void)enqueueObject:(NSObject*)obj {
+    if (![objectsInTrash containsObject:obj]) {
+        [objectsInTrash addObject:obj];
+        [queueTail addObject:obj];
+    }
+}
+
+// must be called while synchronized on self
+- (NSObject*)dequeueObject {
+    if (![queueHead count] && [queueTail count]) {
+        [queueHead addObjectsFromArray:[[queueTail reverseObjectEnumerator] allObjects]];
+        [queueTail removeAllObjects];
+    }
+    NSObject* obj = [queueHead lastObject];
+    if (obj) {
+        [objectsInTrash removeObject:obj];
+        [queueHead removeLastObject];
+    }
+    return obj;
+}
+
 #pragma mark - Public Interface
 
 - (void)setGLContext:(JotGLContext*)context {
@@ -91,6 +132,12 @@ static const void* const kJotTrashQueueIdentifier = &kJotTrashQueueIdentifier;
  *
  * for all objects we hold, we should be the only retain
  * for them, so releasing them will cause their dealloc
+ *
+ * a texture costs far more to delete than a stroke without
+ * any GL objects, so each tick also stops after reclaiming
+ * kJotTrashMaxBytesPerTick, counting each GL object that's
+ * deleted as kJotTrashBytesPerGLObject. all of the tick's GL
+ * deletes are batched into as few gl calls as possible
  */
 - (BOOL)tick {
     if (!backgroundContext) {
@@ -99,53 +146,60 @@ static const void* const kJotTrashQueueIdentifier = &kJotTrashQueueIdentifier;
     }
     NSUInteger countToDealloc = 0;
     @synchronized(self) {
-        countToDealloc = [objectsToDealloc count];
+        countToDealloc = [objectsInTrash count];
     }
     if (countToDealloc) {
         dispatch_async([JotTrashManager trashQueue], ^{
             @autoreleasepool {
                 __block NSUInteger lastKnownCountOfObjects;
                 @synchronized(self) {
-                    // only synchronize around objectsToDealloc
-                    lastKnownCountOfObjects = [objectsToDealloc count];
+                    // only synchronize around the trash queue
+                    lastKnownCountOfObjects = [objectsInTrash count];
                 }
 
                 if (lastKnownCountOfObjects) {
                     [backgroundContext runBlock:^{
+                        [backgroundContext beginBatchedDeletes];
                         double startTime = CACurrentMediaTime();
-                        while (lastKnownCountOfObjects && ABS(CACurrentMediaTime() - startTime) < maxTickDuration) {
-                            // this array should be the last retain for these objects,
+                        NSUInteger costOfTick = 0;
+                        while (lastKnownCountOfObjects && costOfTick < kJotTrashMaxBytesPerTick && ABS(CACurrentMediaTime() - startTime) < maxTickDuration) {
+                            // the queue should be the last retain for these objects,
                             // so removing them will release them and cause them to dealloc
                             __weak NSObject* weakObj;
+                            NSUInteger deletedObjectCount = [backgroundContext deletedObjectCount];
                             @autoreleasepool {
                                 id obj;
                                 @synchronized(self) {
-                                    obj = [objectsToDealloc lastObject];
+                                    obj = [self dequeueObject];
                                 }
                                 if (!obj) {
                                     break;
                                 }
                                 weakObj = obj;
+                                if ([obj respondsToSelector:@selector(fullByteSize)]) {
+                                    costOfTick += (NSUInteger)MAX(0, (int)[obj performSelector:@selector(fullByteSize)]);
+                                }
                                 @autoreleasepool {
                                     if ([obj respondsToSelector:@selector(deleteAssets)]) {
                                         [obj deleteAssets];
                                     }
-                                    @synchronized(self) {
-                                        [objectsToDealloc removeLastObject];
-                                    }
                                 }
                             }
+                            // counts the objects deleted by deleteAssets and by dealloc
+                            costOfTick += ([backgroundContext deletedObjectCount] - deletedObjectCount) * kJotTrashBytesPerGLObject;
                             @synchronized(weakObj) {
                                 if (weakObj) {
+                                    // still in use elsewhere, so try again later
                                     @synchronized(self) {
-                                        [objectsToDealloc insertObject:weakObj atIndex:0];
+                                        [self enqueueObject:weakObj];
                                     }
                                 }
                             }
                             @synchronized(self) {
-                                lastKnownCountOfObjects = [objectsToDealloc count];
+                                lastKnownCountOfObjects = [objectsInTrash count];
                             }
                         }
+                        [backgroundContext endBatchedDeletes];
                     }];
                 }
             }
@@ -160,10 +214,7 @@ static const void* const kJotTrashQueueIdentifier = &kJotTrashQueueIdentifier;
             if ([obj isKindOfClass:[JotView class]] && [(JotView*)obj hasLink]) {
                 @throw [NSException exceptionWithName:@"JotViewDeallocException" reason:@"Cannot dealloc JotView with active CADisplayLink" userInfo:nil];
             }
-            if (![objectsToDealloc containsObjectIdenticalTo:obj]) {
-                // trash queue is FIFO
-                [objectsToDealloc insertObject:obj atIndex:0];
-            }
+            [self enqueueObject:obj];
         }
     }
 }
@@ -182,16 +233,18 @@ static const void* const kJotTrashQueueIdentifier = &kJotTrashQueueIdentifier;
 
 - (NSInteger)numberOfItemsInTrash {
     @synchronized(self) {
-        return [objectsToDealloc count];
+        return [objectsInTrash count];
     }
 }
 
 - (int)knownBytesInTrash {
     int bytes = 0;
     @synchronized(self) {
-        for (NSObject* obj in objectsToDealloc) {
-            if ([obj respondsToSelector:@selector(fullByteSize)]) {
-                bytes += (int)[obj performSelector:@selector(fullByteSize)];
+        for (NSArray* queue in @[queueHead, queueTail]) {
+            for (NSObject* obj in queue) {
+                if ([obj respondsToSelector:@selector(fullByteSize)]) {
+                    bytes += (int)[obj performSelector:@selector(fullByteSize)];
+                }
             }
         }
     }
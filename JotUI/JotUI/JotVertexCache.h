@@ -0,0 +1,62 @@
+//
+//  JotVertexCache.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#define kJotVertexCacheExt @"jotvertices"
+// the stroke dictionary key for the stroke's cached vertex data
+#define kJotStrokeVertexCacheKey @"vertexCache"
+
+/**
+ * Strokes used to save each segment's vertex buffer in their stroke
+ * file. The vertex buffers are most of a stroke's saved bytes, but
+ * they're only good for the render version that made them, and are
+ * regenerated from the segment's points otherwise.
+ *
+ * The vertex buffers are saved to this cache next to the page instead,
+ * keyed by the stroke's uuid and kJotUIRenderVersion. The uuid hashes
+ * each segment's brush as well as its points, and each entry also
+ * saves the stroke's brushHash and is ignored if it doesn't match, for
+ * strokes saved before their uuids did. The buffers are in page
+ * points, so they're good for any screen scale. Each stroke's buffers
+ * are compressed together with JotLZ4. The cache is a page journal of
+ * its own, so it's appended to as strokes are added and compacted as
+ * they're removed.
+ *
+ * Nothing in the cache is needed to load a page. A missing, stale or
+ * unreadable cache only means the vertex buffers are generated again,
+ * so the file can be deleted at any time.
+ */
+@interface JotVertexCache : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+// the cache is saved next to the state file, as state.jotvertices
++ (NSString*)vertexCachePathForStatePath:(NSString*)statePath;
+
++ (JotVertexCache*)vertexCacheForStatePath:(NSString*)statePath;
+
+// encodes a stroke's vertex buffers, one per segment. a segment
+// without a vertex buffer has an NSNull instead. brushHash is the
+// stroke's -[JotStroke brushHash]
++ (NSData*)dataForVertexBuffers:(NSArray*)vertexBuffers withBrushHash:(uint64_t)brushHash;
+
+// decodes data from dataForVertexBuffers:withBrushHash:, or returns
+// nil if the data is corrupt or was made for a different brush
++ (NSArray*)vertexBuffersFromData:(NSData*)data withBrushHash:(uint64_t)brushHash;
+
+// the stroke's encoded vertex buffers, or nil if they're not cached
+- (NSData*)dataForStroke:(NSString*)uuid;
+
+// caches the vertex buffers of every stroke that has generated them
+// and isn't cached yet, and removes every stroke that's not in strokes.
+// if replacingExisting, the strokes that are already cached are
+// cached again
+- (BOOL)saveStrokes:(NSArray*)strokes replacingExisting:(BOOL)replacingExisting;
+
+@end
@@ -0,0 +1,184 @@
+//
+//  JotVertexCache.m
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import "JotVertexCache.h"
+#import "JotPageJournal.h"
+#import "JotStroke.h"
+#import "JotLZ4.h"
+#import "AbstractBezierPathElement.h"
+
+// the vertex buffers were compressed with JotLZ4
+#define kJotVertexCacheCompressed 1
+// 2 saves the brush hash in the header
+#define kJotVertexCacheVersion 2
+
+// all fields are little endian, which is every platform we run on.
+// the header is followed by the segments' vertex buffers, each as a
+// uint32_t length and then its bytes, and compressed if the flag is set
+struct JotVertexCacheHeader {
+    uint32_t segmentCount;
+    uint32_t flags;
+    // the length of the vertex buffers once they're decompressed
+    uint64_t rawLength;
+    // the stroke's brushHash when the buffers were made
+    uint64_t brushHash;
+};
+typedef struct JotVertexCacheHeader JotVertexCacheHeader;
+
+
+@implementation JotVertexCache {
+    JotPageJournal* journal;
+}
+
++ (NSString*)vertexCachePathForStatePath:(NSString*)statePath {
+    return [[statePath stringByDeletingPathExtension] stringByAppendingPathExtension:kJotVertexCacheExt];
+}
+
++ (JotVertexCache*)vertexCacheForStatePath:(NSString*)statePath {
+    return [[JotVertexCache alloc] initWithJournal:[JotPageJournal journalAtPath:[self vertexCachePathForStatePath:statePath]]];
+}
+
+- (instancetype)initWithJournal:(JotPageJournal*)_journal {
+    if (self = [super init]) {
+        journal = _journal;
+    }
+    return self;
+}
+
+// the render version is part of the key, so buffers from an older
+// renderer are never used and are removed at the next save. so is
+// the version of the entries, which added the brush hash
++ (NSString*)keyForStroke:(NSString*)uuid {
+    return [NSString stringWithFormat:@"%@.v%d.%d", uuid, kJotUIRenderVersion, kJotVertexCacheVersion];
+}
+
+#pragma mark - Encoding
+
++ (NSData*)dataForVertexBuffers:(NSArray*)vertexBuffers withBrushHash:(uint64_t)brushHash {
+    NSMutableData* rawData = [NSMutableData data];
+    for (id vertexBuffer in vertexBuffers) {
+        uint32_t length = [vertexBuffer isKindOfClass:[NSData class]] ? (uint32_t)[vertexBuffer length] : 0;
+        [rawData appendBytes:&length length:sizeof(length)];
+        if (length) {
+            [rawData appendData:vertexBuffer];
+        }
+    }
+
+    JotVertexCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.segmentCount = (uint32_t)[vertexBuffers count];
+    header.rawLength = [rawData length];
+    header.brushHash = brushHash;
+
+    NSMutableData* data = [NSMutableData dataWithLength:sizeof(header) + JotLZ4CompressBound([rawData length])];
+    size_t compressedLength = JotLZ4Compress([rawData bytes], [rawData length], (uint8_t*)[data mutableBytes] + sizeof(header), [data length] - sizeof(header));
+    if (compressedLength && compressedLength < [rawData length]) {
+        header.flags = kJotVertexCacheCompressed;
+        [data setLength:sizeof(header) + compressedLength];
+    } else {
+        // vertex data that doesn't compress is saved as is
+        [data setLength:sizeof(header)];
+        [data appendData:rawData];
+    }
+    memcpy([data mutableBytes], &header, sizeof(header));
+    return data;
+}
+
++ (NSArray*)vertexBuffersFromData:(NSData*)data withBrushHash:(uint64_t)brushHash {
+    JotVertexCacheHeader header;
+    if ([data length] < sizeof(header)) {
+        return nil;
+    }
+    memcpy(&header, [data bytes], sizeof(header));
+    if (header.brushHash != brushHash) {
+        // the same points, drawn with a different brush
+        return nil;
+    }
+    const uint8_t* body = (const uint8_t*)[data bytes] + sizeof(header);
+    size_t bodyLength = [data length] - sizeof(header);
+
+    NSData* rawData;
+    if (header.flags == kJotVertexCacheCompressed) {
+        // every segment has at least its length, and the lengths are
+        // far smaller than any sane amount of vertex data
+        if (header.rawLength < (uint64_t)header.segmentCount * sizeof(uint32_t) || header.rawLength > UINT32_MAX) {
+            return nil;
+        }
+        NSMutableData* decompressed = [NSMutableData dataWithLength:(NSUInteger)header.rawLength];
+        if (!JotLZ4Decompress(body, bodyLength, [decompressed mutableBytes], [decompressed length])) {
+            return nil;
+        }
+        rawData = decompressed;
+    } else if (header.flags == 0 && header.rawLength == bodyLength) {
+        rawData = [NSData dataWithBytesNoCopy:(void*)body length:bodyLength freeWhenDone:NO];
+    } else {
+        return nil;
+    }
+
+    NSMutableArray* vertexBuffers = [NSMutableArray arrayWithCapacity:header.segmentCount];
+    const uint8_t* next = [rawData bytes];
+    const uint8_t* end = next + [rawData length];
+    for (uint32_t i = 0; i < header.segmentCount; i++) {
+        uint32_t length;
+        if ((size_t)(end - next) < sizeof(length)) {
+            return nil;
+        }
+        memcpy(&length, next, sizeof(length));
+        next += sizeof(length);
+        if ((size_t)(end - next) < length) {
+            return nil;
+        }
+        // copied, so that the buffers don't keep the whole record alive
+        [vertexBuffers addObject:length ? [NSData dataWithBytes:next length:length] : [NSNull null]];
+        next += length;
+    }
+    return next == end ? vertexBuffers : nil;
+}
+
+#pragma mark - Reading and Saving
+
+- (NSData*)dataForStroke:(NSString*)uuid {
+    return [journal dataForStroke:[JotVertexCache keyForStroke:uuid]];
+}
+
+- (BOOL)saveStrokes:(NSArray*)strokes replacingExisting:(BOOL)replacingExisting {
+    NSMutableArray* keys = [NSMutableArray array];
+    NSMutableDictionary* vertexData = [NSMutableDictionary dictionary];
+    for (JotStroke* stroke in strokes) {
+        NSString* key = [JotVertexCache keyForStroke:[stroke uuid]];
+        if (![journal containsStroke:key] || replacingExisting) {
+            // a stroke that was loaded lazily and never drawn hasn't
+            // generated anything to cache, so it's cached once it's drawn
+            if (![stroke hasLoadedSegments]) {
+                continue;
+            }
+            BOOL hasVertexBuffer = NO;
+            NSMutableArray* vertexBuffers = [NSMutableArray array];
+            for (AbstractBezierPathElement* segment in [stroke segments]) {
+                NSData* vertexBuffer = [segment vertexBuffer];
+                hasVertexBuffer = hasVertexBuffer || vertexBuffer != nil;
+                [vertexBuffers addObject:vertexBuffer ?: [NSNull null]];
+            }
+            if (!hasVertexBuffer) {
+                continue;
+            }
+            [vertexData setObject:[JotVertexCache dataForVertexBuffers:vertexBuffers withBrushHash:[stroke brushHash]] forKey:key];
+        }
+        [keys addObject:key];
+    }
+
+    // most saves only add a stroke or two, and plenty add none
+    // that have vertex buffers yet
+    if (![vertexData count] && [[NSSet setWithArray:[journal strokeUUIDs]] isSubsetOfSet:[NSSet setWithArray:keys]]) {
+        return YES;
+    }
+    NSDictionary* state = @{ @"renderVersion": @(kJotUIRenderVersion) };
+    return [journal saveState:state withStrokes:keys andStrokeData:vertexData];
+}
+
+@end
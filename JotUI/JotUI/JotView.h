@@ -62,7 +62,11 @@
 // then nothing has changed that would affect the output image
 - (NSUInteger)undoHash;
 
-// this will export both the ink and the thumbnail image
+// this will export both the ink and the thumbnail image.
+// if only a small part of the ink has changed since it was last
+// saved to inkPath, then only those tiles are read back, and only
+// the bands of the PNG that they touch are encoded again. the
+// block's ink image is always the whole page
 - (void)exportImageTo:(NSString*)inkPath
        andThumbnailTo:(NSString*)thumbnailPath
            andStateTo:(NSString*)plistPath
@@ -80,6 +84,12 @@
 + (dispatch_queue_t)importExportStateQueue;
 + (BOOL)isImportExportStateQueue;
 
+// a serial queue for one page's image or state, so that different
+// pages load and export in parallel while each page's work stays in
+// order. both are import/export queues, and nil paths get the shared ones
++ (dispatch_queue_t)importExportImageQueueForPath:(NSString*)inkPath;
++ (dispatch_queue_t)importExportStateQueueForPath:(NSString*)plistPath;
+
 - (void)slowDownFPS;
 - (void)speedUpFPS;
 - (void)setPreferredFPS:(NSInteger)preferredFramesPerSecond;
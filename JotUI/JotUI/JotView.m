@@ -21,6 +21,7 @@
 #import "JotGLTextureBackedFrameBuffer.h"
 #import "JotDefaultBrushTexture.h"
 #import "JotTrashManager.h"
+#import "JotWarmTextureCache.h"
 #import "JotViewState.h"
 #import "JotViewImmutableState.h"
 #import "SegmentSmoother.h"
@@ -35,6 +36,8 @@
 #import "JotGLColorlessPointProgram.h"
 #import "JotGLColoredPointProgram.h"
 #import "NSArray+JotMapReduce.h"
+#import "JotImageKernels.h"
+#import "JotGLContextPool.h"
 
 #define kJotValidateUndoTimer .06
 
@@ -72,6 +75,9 @@ dispatch_queue_t importExportStateQueue;
 
     // a handle to the image used as the current brush texture
     JotViewStateProxy* state;
+    // the strokes of a progressively loading state that
+    // were loaded when it was last rendered
+    NSUInteger renderedLoadedStrokeCount;
 
     CGSize initialFrameSize;
 
@@ -88,6 +94,68 @@ dispatch_queue_t importExportStateQueue;
 @end
 
 
+#pragma mark - Pixel Readback
+
+static void JotReleaseExportedPixels(void* info, const void* data, size_t size) {
+    free((void*)data);
+}
+
+/**
+ * wraps the bottom-to-top pixels that we read back from OpenGL
+ * into a top-to-bottom CGImage of exportSize, resampling them if
+ * the sizes differ.
+ *
+ * this takes ownership of data, and it will be freed when the
+ * returned image is released
+ */
+static CGImageRef JotCreateImageFromGLPixels(GLubyte* data, CGSize fullSize, CGSize exportSize) {
+    GLSize full = GLSizeFromCGSize(fullSize);
+    GLSize target = GLSizeFromCGSize(exportSize);
+    GLubyte* pixels = data;
+
+    if (full.width == target.width && full.height == target.height) {
+        JotImageFlipVertical(data, full.width * 4, full.height);
+    } else {
+        pixels = malloc(target.width * target.height * 4);
+        if (!pixels) {
+            free(data);
+            @throw [NSException exceptionWithName:@"Memory Exception" reason:@"can't malloc" userInfo:nil];
+        }
+        // thumbnails are an area average, and anything
+        // larger than the canvas gets the sharper lanczos
+        JotImageResampleFilter filter = (target.width <= full.width && target.height <= full.height) ? JotImageResampleBox : JotImageResampleLanczos;
+        BOOL resampled = JotImageResample(data, full.width, full.height, full.width * 4, pixels, target.width, target.height, target.width * 4, filter, YES);
+        free(data);
+        if (!resampled) {
+            free(pixels);
+            @throw [NSException exceptionWithName:@"Memory Exception" reason:@"can't malloc" userInfo:nil];
+        }
+    }
+
+    CGDataProviderRef provider = CGDataProviderCreateWithData(NULL, pixels, target.width * target.height * 4, JotReleaseExportedPixels);
+    CGColorSpaceRef colorspace = CGColorSpaceCreateDeviceRGB();
+    CGImageRef image = CGImageCreate(target.width, target.height, 8, 32, target.width * 4, colorspace, kCGBitmapByteOrderDefault | kCGImageAlphaPremultipliedLast,
+                                     provider, NULL, false, kCGRenderingIntentDefault);
+    CGColorSpaceRelease(colorspace);
+    CGDataProviderRelease(provider);
+    if (!image) {
+        @throw [NSException exceptionWithName:@"CGImage Exception" reason:@"can't create exported image" userInfo:nil];
+    }
+    return image;
+}
+
+// the bottom-to-top pixels of the ink tiles, as if they'd been read
+// back from OpenGL. the caller must free() the returned buffer
+static GLubyte* JotCopyPixelsFromInkTiles(JotInkTileSet* tiles) {
+    GLubyte* data = malloc((size_t)tiles.pixelSize.width * (size_t)tiles.pixelSize.height * 4);
+    if (!data) {
+        @throw [NSException exceptionWithName:@"Memory Exception" reason:@"can't malloc" userInfo:nil];
+    }
+    [tiles unpackIntoPixels:data];
+    return data;
+}
+
+
 @implementation JotView
 
 @synthesize delegate;
@@ -176,6 +244,9 @@ static JotGLContext* mainThreadContext;
         }];
         mainThreadContext = context;
         [[JotTrashManager sharedInstance] setGLContext:mainThreadContext];
+        [[JotGLContextPool sharedPool] setGLContext:mainThreadContext];
+        // compiles the shaders for the sharegroup off the main thread
+        [[JotGLContextPool sharedPool] warmUp];
     } else {
         context = [[JotGLContext alloc] initWithName:@"JotViewMainThreadContext" andSharegroup:mainThreadContext.sharegroup andValidateThreadWith:^BOOL {
             return [NSThread isMainThread];
@@ -234,6 +305,45 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
     return dispatch_get_specific(kImportExportStateQueueIdentifier) != NULL;
 }
 
+// a page's queue is only held weakly, and goes away once it has no work
+// left and no one holds it. a queue that's still running work for the
+// page is always the one that's returned, so its work stays in order
++ (dispatch_queue_t)queueForPath:(NSString*)path inQueues:(NSMapTable*)queuesByPath withLabel:(const char*)label andIdentifier:(const void*)identifier {
+    @synchronized(queuesByPath) {
+        dispatch_queue_t queue = [queuesByPath objectForKey:path];
+        if (!queue) {
+            queue = dispatch_queue_create(label, DISPATCH_QUEUE_SERIAL);
+            dispatch_queue_set_specific(queue, identifier, (void*)identifier, NULL);
+            [queuesByPath setObject:queue forKey:path];
+        }
+        return queue;
+    }
+}
+
++ (dispatch_queue_t)importExportImageQueueForPath:(NSString*)inkPath {
+    static NSMapTable* imageQueuesByPath;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        imageQueuesByPath = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsCopyIn valueOptions:NSPointerFunctionsWeakMemory];
+    });
+    if (!inkPath) {
+        return [JotView importExportImageQueue];
+    }
+    return [JotView queueForPath:inkPath inQueues:imageQueuesByPath withLabel:"com.milestonemade.looseleaf.importExportImageQueue.page" andIdentifier:kImportExportImageQueueIdentifier];
+}
+
++ (dispatch_queue_t)importExportStateQueueForPath:(NSString*)plistPath {
+    static NSMapTable* stateQueuesByPath;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        stateQueuesByPath = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsCopyIn valueOptions:NSPointerFunctionsWeakMemory];
+    });
+    if (!plistPath) {
+        return [JotView importExportStateQueue];
+    }
+    return [JotView queueForPath:plistPath inQueues:stateQueuesByPath withLabel:"com.milestonemade.looseleaf.importExportStateQueue.page" andIdentifier:kImportExportStateQueueIdentifier];
+}
+
 
 #pragma mark - OpenGL Init
 
@@ -292,6 +402,7 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
     CheckMainThread;
     if (state != newState) {
         state = newState;
+        renderedLoadedStrokeCount = [state loadedStrokeCount];
         [self renderAllStrokesToContext:context inFramebuffer:viewFramebuffer andPresentBuffer:YES inRect:CGRectZero];
         if ([state hasEditsToSave]) {
             // be explicit about not letting us change the state of
@@ -409,6 +520,12 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
 
     __block UIImage* thumb = nil;
     __block UIImage* ink = nil;
+    __block JotInkTileSet* inkTiles = nil;
+    __block BOOL inkChanged = NO;
+    __block NSUInteger inkSaveGeneration = 0;
+    // hold the tracker instead of the framebuffer, which
+    // can only be released on an OpenGL context
+    JotDirtyTileTracker* dirtyTileTracker = state.backgroundFramebuffer.dirtyTileTracker;
 
     //
     // we need to save a version of the state at this exact
@@ -420,8 +537,11 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
     // to the backing texture
     JotViewImmutableState* immutableState = [state immutableState];
 
-    [self exportInkTextureOnComplete:^(UIImage* image) {
+    [self exportInkTextureForPath:inkPath onComplete:^(UIImage* image, JotInkTileSet* tiles, BOOL changed, NSUInteger generation) {
         ink = image;
+        inkTiles = tiles;
+        inkChanged = changed;
+        inkSaveGeneration = generation;
         dispatch_semaphore_signal(sema2);
     }];
 
@@ -431,7 +551,9 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
     [self exportToImageOnComplete:^(UIImage* image) {
         thumb = image;
         dispatch_semaphore_signal(sema1);
-    } withScale:[thumbScale floatValue]];
+    }
+                        withScale:[thumbScale floatValue]
+                          onQueue:[JotView importExportImageQueueForPath:inkPath]];
 
     /////////////////////////////////////////////////////
     /////////////////////////////////////////////////////
@@ -455,7 +577,7 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
     // while i wait + write to disk in the background
     //
 
-    dispatch_async([JotView importExportStateQueue], ^(void) {
+    dispatch_async([JotView importExportStateQueueForPath:plistPath], ^(void) {
         @autoreleasepool {
             // waiting on ink and thumbnail
             dispatch_semaphore_wait(sema1, DISPATCH_TIME_FOREVER);
@@ -475,22 +597,31 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
                 @synchronized(self) {
                     isCurrentlyExporting = 0;
                 }
+                [dirtyTileTracker finishSaveToPath:inkPath withTiles:nil generation:inkSaveGeneration];
                 DebugLog(@"forget: skipping export write to disk for forgetful jotview");
                 [[JotTrashManager sharedInstance] addObjectToDealloc:immutableState];
                 return;
             }
 
-            if (ink) {
-                // we have the backing ink texture to save
-                // so write it to disk
-                [[JotDiskAssetManager sharedManager] writeImage:ink toPath:inkPath];
+            if (ink && inkChanged) {
+                // we have the backing ink texture to save, so write
+                // it to disk in the same group commit as the thumbnail.
+                // the encoder reuses the bands of the PNG on disk that
+                // haven't changed, so a small edit is a small encode
+                [[JotDiskAssetManager sharedManager] writeImages:@{ inkPath: ink,
+                                                                    thumbnailPath: thumb ?: [NSNull null] }
+                                         withTextureSidecarPaths:[NSSet setWithObject:inkPath]
+                                                      onComplete:^(BOOL success) {
+                                                          [dirtyTileTracker finishSaveToPath:inkPath withTiles:success ? inkTiles : nil generation:inkSaveGeneration];
+                                                      }];
             } else {
-                // the backing texture either hasn't changed, or
-                // doesn't have anything written to it at all
-                // so skip writing a blank PNG to disk
-            }
+                // the backing texture either hasn't changed since it
+                // was saved to inkPath, or couldn't be exported at all,
+                // so skip writing the same PNG to disk
+                [dirtyTileTracker finishSaveToPath:inkPath withTiles:ink ? inkTiles : nil generation:inkSaveGeneration];
 
-            [[JotDiskAssetManager sharedManager] writeImage:thumb toPath:thumbnailPath];
+                [[JotDiskAssetManager sharedManager] writeImage:thumb toPath:thumbnailPath];
+            }
 
             // this call will both serialize the state
             // and write it to disk
@@ -535,6 +666,10 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
  * http://stackoverflow.com/questions/1379274/uiimagewritetosavedphotosalbum-saves-to-wrong-size-and-quality
  */
 - (void)exportToImageOnComplete:(void (^)(UIImage*))exportFinishBlock withScale:(CGFloat)outputScale {
+    [self exportToImageOnComplete:exportFinishBlock withScale:outputScale onQueue:[JotView importExportImageQueue]];
+}
+
+- (void)exportToImageOnComplete:(void (^)(UIImage*))exportFinishBlock withScale:(CGFloat)outputScale onQueue:(dispatch_queue_t)exportQueue {
     CheckMainThread;
 
     if (!exportFinishBlock)
@@ -551,7 +686,7 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
 
     //
     // the rest can be done in Core Graphics in a background thread
-    dispatch_async([JotView importExportImageQueue], ^{
+    dispatch_async(exportQueue, ^{
         @autoreleasepool {
             if (state.isForgetful) {
                 DebugLog(@"forget: skipping export for forgetful jotview");
@@ -563,10 +698,8 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
             __block CGImageRef cgImage;
             __block UIImage* image;
 
-            JotGLContext* secondSubContext = [[JotGLContext alloc] initWithName:@"JotViewExportToImageContext" andSharegroup:mainThreadContext.sharegroup andValidateThreadWith:^BOOL {
-                return [JotView isImportExportImageQueue];
-            }];
-            [secondSubContext runBlock:^{
+            // reuse a context from the pool, which has its programs compiled already
+            [[JotGLContextPool sharedPool] runBlock:^(JotGLContext* secondSubContext) {
                 @autoreleasepool {
                     [secondSubContext glDisableDither];
                     [secondSubContext glEnableBlend];
@@ -662,7 +795,6 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
 
                     // step 3:
                     // read the image from OpenGL and push it into a data buffer
-                    NSInteger dataLength = fullSize.width * fullSize.height * 4;
                     GLubyte* data = calloc(fullSize.height * fullSize.width, 4);
                     if (!data) {
                         @throw [NSException exceptionWithName:@"Memory Exception" reason:@"can't malloc" userInfo:nil];
@@ -676,55 +808,10 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
                     [canvasTexture unbind];
                     [[JotTextureCache sharedManager] returnTextureForReuse:canvasTexture];
 
-                    // Create a CGImage with the pixel data from OpenGL
-                    // If your OpenGL ES content is opaque, use kCGImageAlphaNoneSkipLast to ignore the alpha channel
-                    // otherwise, use kCGImageAlphaPremultipliedLast
-                    CGDataProviderRef ref = CGDataProviderCreateWithData(NULL, data, dataLength, NULL);
-                    CGColorSpaceRef colorspace = CGColorSpaceCreateDeviceRGB();
-                    CGImageRef iref = CGImageCreate(fullSize.width, fullSize.height, 8, 32, fullSize.width * 4, colorspace, kCGBitmapByteOrderDefault |
-                                                        kCGImageAlphaPremultipliedLast,
-                                                    ref, NULL, true, kCGRenderingIntentDefault);
-
-                    // ok, now we have the pixel data from the OpenGL frame buffer.
-                    // next we need to setup the image context to composite the
-                    // background color, background image, and opengl image
-
-                    // OpenGL ES measures data in PIXELS
-                    // Create a graphics context with the target size measured in POINTS
-                    CGContextRef bitmapContext = CGBitmapContextCreate(NULL, exportSize.width, exportSize.height, 8, exportSize.width * 4, colorspace, kCGBitmapByteOrderDefault | kCGImageAlphaPremultipliedLast);
-                    if (!bitmapContext) {
-                        @throw [NSException exceptionWithName:@"CGContext Exception" reason:@"can't create new context" userInfo:nil];
-                    }
-
-                    // can I clear less stuff and still be ok?
-                    CGContextClearRect(bitmapContext, CGRectMake(0, 0, exportSize.width, exportSize.height));
-
-                    if (!bitmapContext) {
-                        @throw [NSException exceptionWithName:@"BitmapContextException" reason:@"Cannot generate bitmap context" userInfo:nil];
-                    }
-
-                    // flip vertical for our drawn content, since OpenGL is opposite core graphics
-                    CGContextTranslateCTM(bitmapContext, 0, exportSize.height);
-                    CGContextScaleCTM(bitmapContext, 1.0, -1.0);
-
-                    //
-                    // ok, now render our actual content
-                    CGContextDrawImage(bitmapContext, CGRectMake(0.0, 0.0, exportSize.width, exportSize.height), iref);
-
-                    // Retrieve the UIImage from the current context
-                    cgImage = CGBitmapContextCreateImage(bitmapContext);
-                    if (!cgImage) {
-                        @throw [NSException exceptionWithName:@"CGContext Exception" reason:@"can't create new context" userInfo:nil];
-                    }
-
+                    // flip and resample the pixels straight into the exported image,
+                    // instead of drawing them through a CoreGraphics context
+                    cgImage = JotCreateImageFromGLPixels(data, fullSize, exportSize);
                     image = [UIImage imageWithCGImage:cgImage scale:self.contentScaleFactor orientation:UIImageOrientationUp];
-
-                    // Clean up
-                    free(data);
-                    CFRelease(ref);
-                    CFRelease(colorspace);
-                    CGImageRelease(iref);
-                    CGContextRelease(bitmapContext);
                 }
             }];
 
@@ -740,7 +827,7 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
                 // lock message. Unlocking a lock from a different thread can result in undefined behavior.
                 [imageTextureLock unlock];
 
-                dispatch_async([JotView importExportImageQueue], ^{
+                dispatch_async(exportQueue, ^{
                     // ok, we're done exporting and cleaning up
                     // so pass the newly generated image to the completion block
                     @autoreleasepool {
@@ -771,12 +858,12 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
  * and
  * http://stackoverflow.com/questions/1379274/uiimagewritetosavedphotosalbum-saves-to-wrong-size-and-quality
  */
-- (void)exportInkTextureOnComplete:(void (^)(UIImage*))exportFinishBlock {
+- (void)exportInkTextureForPath:(NSString*)inkPath onComplete:(void (^)(UIImage* ink, JotInkTileSet* inkTiles, BOOL changed, NSUInteger generation))exportFinishBlock {
     CheckMainThread;
 
     if (!state) {
         if (exportFinishBlock)
-            exportFinishBlock(nil);
+            exportFinishBlock(nil, nil, NO, 0);
         return;
     }
 
@@ -786,25 +873,43 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
     if (![inkTextureLock tryLock]) {
         // save failed, just exit and our
         // caller can retry later
-        exportFinishBlock(nil);
+        exportFinishBlock(nil, nil, NO, 0);
         return;
     }
 
+    // nothing can draw to the backing texture while we hold the lock,
+    // so this is exactly what's changed since the ink in savedTiles.
+    // nil means we need to read back all of it
+    NSUInteger saveGeneration = 0;
+    JotInkTileSet* savedTiles = nil;
+    NSData* dirtyTiles = [state.backgroundFramebuffer.dirtyTileTracker beginSaveToPath:inkPath savedTiles:&savedTiles generation:&saveGeneration];
+
     // the rest can be done in Core Graphics in a background thread
-    dispatch_async([JotView importExportImageQueue], ^{
+    dispatch_async([JotView importExportImageQueueForPath:inkPath], ^{
         @autoreleasepool {
             if (state.isForgetful) {
                 // if we're forgetful, it's because we're going to be deleted soon anyways,
                 // so our export will be trashed with us. we can bail early here.
-                exportFinishBlock(nil);
+                exportFinishBlock(nil, nil, NO, saveGeneration);
                 [inkTextureLock unlock];
                 return;
             }
 
-            JotGLContext* secondSubContext = [[JotGLContext alloc] initWithName:@"JotViewExportInkTextureContext" andSharegroup:mainThreadContext.sharegroup andValidateThreadWith:^BOOL {
-                return [JotView isImportExportImageQueue];
-            }];
-            [secondSubContext runBlock:^{
+            if (dirtyTiles && ![dirtyTiles length]) {
+                // the ink hasn't changed since it was saved to inkPath,
+                // so build the image from the saved tiles without OpenGL
+                CGSize fullSize = savedTiles.pixelSize;
+                CGImageRef cgImage = JotCreateImageFromGLPixels(JotCopyPixelsFromInkTiles(savedTiles), fullSize, fullSize);
+                UIImage* image = [UIImage imageWithCGImage:cgImage scale:self.contentScaleFactor orientation:UIImageOrientationUp];
+                exportFinishBlock(image, savedTiles, NO, saveGeneration);
+                CGImageRelease(cgImage);
+                [[MMMainOperationQueue sharedQueue] addOperationWithBlock:^{
+                    [inkTextureLock unlock];
+                }];
+                return;
+            }
+
+            [[JotGLContextPool sharedPool] runBlock:^(JotGLContext* secondSubContext) {
                 // finish current gl calls
                 //            glFinish();
                 printOpenGLError();
@@ -868,15 +973,29 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
 
                 [secondSubContext assertCheckFramebuffer];
 
-                // step 3:
-                // read the image from OpenGL and push it into a data buffer
-                NSInteger dataLength = fullSize.width * fullSize.height * 4;
-                GLubyte* data = calloc(fullSize.height * fullSize.width, 4);
-                if (!data) {
-                    @throw [NSException exceptionWithName:@"Memory Exception" reason:@"can't malloc" userInfo:nil];
+                JotInkTileSet* inkTiles = nil;
+                GLubyte* data = NULL;
+                if (dirtyTiles && CGSizeEqualToSize(fullSize, savedTiles.pixelSize)) {
+                    // step 3:
+                    // read back only the bands of tiles that have changed,
+                    // and apply them to the ink that was last saved
+                    JotInkTileSet* patch = [JotInkTileSet tileSetWithPixelSize:fullSize
+                                                                  readingTiles:dirtyTiles
+                                                                     fromBands:^(CGRect pixelRect, uint8_t* band) {
+                                                                         [secondSubContext readPixelsInto:band inRect:pixelRect];
+                                                                     }];
+                    inkTiles = [savedTiles tileSetByApplyingPatch:patch inTiles:dirtyTiles];
+                }
+                if (!inkTiles) {
+                    // step 3:
+                    // read the image from OpenGL and push it into a data buffer
+                    data = calloc(fullSize.height * fullSize.width, 4);
+                    if (!data) {
+                        @throw [NSException exceptionWithName:@"Memory Exception" reason:@"can't malloc" userInfo:nil];
+                    }
+                    // Read pixel data from the framebuffer of size fullSize
+                    [secondSubContext readPixelsInto:data ofSize:GLSizeFromCGSize(fullSize)];
                 }
-                // Read pixel data from the framebuffer of size fullSize
-                [secondSubContext readPixelsInto:data ofSize:GLSizeFromCGSize(fullSize)];
 
                 // now we're done, delete our buffers
                 [secondSubContext unbindFramebuffer];
@@ -884,59 +1003,22 @@ static const void* const kImportExportStateQueueIdentifier = &kImportExportState
                 [canvasTexture unbind];
                 [[JotTextureCache sharedManager] returnTextureForReuse:canvasTexture];
 
-                // Create a CGImage with the pixel data from OpenGL
-                // If your OpenGL ES content is opaque, use kCGImageAlphaNoneSkipLast to ignore the alpha channel
-                // otherwise, use kCGImageAlphaPremultipliedLast
-                CGDataProviderRef ref = CGDataProviderCreateWithData(NULL, data, dataLength, NULL);
-                CGColorSpaceRef colorspace = CGColorSpaceCreateDeviceRGB();
-                CGImageRef iref = CGImageCreate(fullSize.width, fullSize.height, 8, 32, fullSize.width * 4, colorspace, kCGBitmapByteOrderDefault |
-                                                    kCGImageAlphaPremultipliedLast,
-                                                ref, NULL, true, kCGRenderingIntentDefault);
-
-                // ok, now we have the pixel data from the OpenGL frame buffer.
-                // next we need to setup the image context to composite the
-                // background color, background image, and opengl image
-
-                // OpenGL ES measures data in PIXELS
-                // Create a graphics context with the target size measured in POINTS
-                CGContextRef bitmapContext = CGBitmapContextCreate(NULL, exportSize.width, exportSize.height, 8, exportSize.width * 4, colorspace, kCGBitmapByteOrderDefault | kCGImageAlphaPremultipliedLast);
-                if (!bitmapContext) {
-                    @throw [NSException exceptionWithName:@"CGContext Exception" reason:@"can't create new context" userInfo:nil];
-                }
-
-                // can I clear less stuff and still be ok?
-                CGContextClearRect(bitmapContext, CGRectMake(0, 0, exportSize.width, exportSize.height));
-
-                if (!bitmapContext) {
-                    @throw [NSException exceptionWithName:@"BitmapContextException" reason:@"Cannot generate bitmap context" userInfo:nil];
-                }
-
-                // flip vertical for our drawn content, since OpenGL is opposite core graphics
-                CGContextTranslateCTM(bitmapContext, 0, exportSize.height);
-                CGContextScaleCTM(bitmapContext, 1.0, -1.0);
-
-                //
-                // ok, now render our actual content
-                CGContextDrawImage(bitmapContext, CGRectMake(0.0, 0.0, exportSize.width, exportSize.height), iref);
-
-                // Retrieve the UIImage from the current context
-                CGImageRef cgImage = CGBitmapContextCreateImage(bitmapContext);
-                if (!cgImage) {
-                    @throw [NSException exceptionWithName:@"CGContext Exception" reason:@"can't create new context" userInfo:nil];
+                if (inkTiles) {
+                    // the whole page, from the saved ink and the changed tiles
+                    data = JotCopyPixelsFromInkTiles(inkTiles);
+                } else if (CGSizeEqualToSize(fullSize, state.backgroundTexture.pixelSize)) {
+                    // the next save only needs the tiles that change after this
+                    inkTiles = [JotInkTileSet tileSetWithPixels:data bytesPerRow:fullSize.width * 4 pixelSize:fullSize];
                 }
 
+                // flip the pixels into the exported image, instead of
+                // drawing them through a CoreGraphics context
+                CGImageRef cgImage = JotCreateImageFromGLPixels(data, fullSize, exportSize);
                 UIImage* image = [UIImage imageWithCGImage:cgImage scale:self.contentScaleFactor orientation:UIImageOrientationUp];
 
-                // Clean up
-                free(data);
-                CFRelease(ref);
-                CFRelease(colorspace);
-                CGImageRelease(iref);
-                CGContextRelease(bitmapContext);
-
                 // ok, we're done exporting and cleaning up
                 // so pass the newly generated image to the completion block
-                exportFinishBlock(image);
+                exportFinishBlock(image, inkTiles, YES, saveGeneration);
                 CGImageRelease(cgImage);
             }];
             [JotGLContext validateEmptyContextStack];
@@ -1258,6 +1340,13 @@ static int undoCounter;
     UIApplicationState applicationState = [[UIApplication sharedApplication] applicationState];
 
     if (applicationState == UIApplicationStateActive) {
+        NSUInteger loadedStrokeCount = [state loadedStrokeCount];
+        if (loadedStrokeCount != renderedLoadedStrokeCount) {
+            // the state's strokes are loading in the background,
+            // so show the ones that have loaded since
+            renderedLoadedStrokeCount = loadedStrokeCount;
+            [self renderAllStrokesToContext:context inFramebuffer:viewFramebuffer andPresentBuffer:YES inRect:CGRectZero];
+        }
         if ([inkTextureLock tryLock]) {
             if ([imageTextureLock tryLock]) {
                 // only write to the bg texture if we can
@@ -1294,6 +1383,9 @@ static int undoCounter;
                             AbstractBezierPathElement* element = [strokeToWriteToTexture.segments objectAtIndex:0];
                             [strokeToWriteToTexture removeElementAtIndex:0];
                             [self renderElement:element fromPreviousElement:prevElementForTextureWriting includeOpenGLPrepForFBO:nil toContext:context];
+                            // element bounds are in points, and pad a bit for antialiasing
+                            CGRect pixelBounds = CGRectApplyAffineTransform(element.bounds, CGAffineTransformMakeScale(self.contentScaleFactor, self.contentScaleFactor));
+                            [state.backgroundFramebuffer.dirtyTileTracker markDirtyInRect:CGRectInset(pixelBounds, -2, -2)];
                             prevElementForTextureWriting = element;
                             distance += [element lengthOfElement];
                             // this should dealloc the element immediately,
@@ -1504,9 +1596,7 @@ static inline CGFloat distanceBetween2(CGPoint a, CGPoint b) {
                     if ([[currentStroke segments] count] == 1 && distanceBetween2(start, end) < 7) {
                         // if the rotation is off by at least 10 degrees, then updated the rotation on the stroke
                         // otherwise let the previous rotation stand
-                        [[currentStroke segments] enumerateObjectsUsingBlock:^(AbstractBezierPathElement* _Nonnull obj, NSUInteger idx, BOOL* _Nonnull stop) {
-                            obj.rotation = rot;
-                        }];
+                        [currentStroke setRotationOfSegments:rot];
                         shouldSkipSegment = YES;
                     }
                 }
@@ -1998,6 +2088,7 @@ static inline CGFloat distanceBetween2(CGPoint a, CGPoint b) {
                 withCanvasSize:initialViewport];
         [texture unbind];
         [state.backgroundFramebuffer unbind];
+        [state.backgroundFramebuffer.dirtyTileTracker markAllDirty];
     }];
 
     //
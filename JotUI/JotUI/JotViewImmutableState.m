@@ -10,11 +10,18 @@
 #import "JotStroke.h"
 #import "JotImmutableStroke.h"
 #import "JotViewState.h"
+#import "JotStrokeFile.h"
+#import "JotPageJournal.h"
+#import "JotVertexCache.h"
 #import "NSArray+JotMapReduce.h"
 
 
 @implementation JotViewImmutableState {
     NSMutableDictionary* stateDict;
+    // every stroke in the state, so that any the
+    // page journal doesn't have yet can be saved
+    NSArray* strokes;
+    BOOL hasWrittenStrokes;
 }
 
 /**
@@ -34,9 +41,11 @@
         for (JotStroke* stroke in [stateInfo objectForKey:@"stackOfUndoneStrokes"]) {
             [stackOfImmutableUndoneStrokes addObject:[[JotImmutableStroke alloc] initWithJotStroke:stroke]];
         }
+        strokes = [stackOfImmutableStrokes arrayByAddingObjectsFromArray:stackOfImmutableUndoneStrokes];
 
-        [stateDict setObject:stackOfImmutableStrokes forKey:@"stackOfStrokes"];
-        [stateDict setObject:stackOfImmutableUndoneStrokes forKey:@"stackOfUndoneStrokes"];
+        // the strokes are saved separately, so the state only refers to them by uuid
+        [stateDict setObject:[stackOfImmutableStrokes jotMapWithSelector:@selector(uuid)] forKey:@"stackOfStrokes"];
+        [stateDict setObject:[stackOfImmutableUndoneStrokes jotMapWithSelector:@selector(uuid)] forKey:@"stackOfUndoneStrokes"];
         [stateDict setObject:[stateInfo objectForKey:@"undoHash"] forKey:@"undoHash"];
         [stateDict setObject:[stateInfo objectForKey:@"undoLimit"] forKey:@"undoLimit"];
 
@@ -47,49 +56,68 @@
 }
 
 /**
- * this will write out the state to the specified path.
- * this file can be loaded into a JotViewState object
+ * this will write out the state to the page journal
+ * for the specified path. the journal can be loaded
+ * into a JotViewState object
  */
 - (void)writeToDisk:(NSString*)plistPath {
     if (![JotView isImportExportStateQueue]) {
         @throw [NSException exceptionWithName:@"InconsistentQueueException" reason:@"writing immutable jotViewState in wrong queue" userInfo:nil];
     }
-    if (![[stateDict objectForKey:@"hasConverted"] boolValue]) {
-        // write each stroke to disk to its own file. this is because the
-        // vertex buffer for each stroke can be fairly large. writing it
-        // out will let us write each stroke once instead of every time the
-        // state is saved
-        NSString* stateDirectory = [plistPath stringByDeletingLastPathComponent];
-        NSMutableArray* fileNamesOfStrokes = [NSMutableArray array];
-        [[[stateDict objectForKey:@"stackOfStrokes"] arrayByAddingObjectsFromArray:[stateDict objectForKey:@"stackOfUndoneStrokes"]] jotMap:^id(id obj, NSUInteger index) {
-            NSString* filename = [[stateDirectory stringByAppendingPathComponent:[obj uuid]] stringByAppendingPathExtension:kJotStrokeFileExt];
-            NSFileManager* manager = [NSFileManager defaultManager];
-            if (![manager fileExistsAtPath:filename] || self.mustOverwriteAllStrokeFiles) {
-                [[obj asDictionary] writeToFile:filename atomically:YES];
-            }
-            [fileNamesOfStrokes addObject:filename];
-            return obj;
-        }];
+    JotPageJournal* journal = [JotPageJournal journalForStatePath:plistPath];
+    // pages saved before the journal have a plist and a file for each stroke
+    BOOL isFirstJournalSave = !journal.state;
 
-        // now that we've saved all of our strokes,
-        // we need to delete the files of any strokes that were
-        // written to the disk and aren't in our state dictionary any more.
-        // to do that, loop over the directory and compare to the files we just wrote.
-        NSArray* contents = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:stateDirectory error:nil];
-        for (NSString* item in contents) {
-            NSString* fileInDir = [stateDirectory stringByAppendingPathComponent:item];
-            if (![fileNamesOfStrokes containsObject:fileInDir] && [[fileInDir pathExtension] isEqualToString:kJotStrokeFileExt]) {
-                [[NSFileManager defaultManager] removeItemAtPath:fileInDir error:nil];
+    // only strokes that the journal doesn't have yet are saved
+    BOOL mustOverwriteStrokes = self.mustOverwriteAllStrokeFiles && !hasWrittenStrokes;
+    NSMutableDictionary* strokeData = [NSMutableDictionary dictionary];
+    NSMutableArray* strokeUUIDs = [NSMutableArray array];
+    for (JotImmutableStroke* stroke in strokes) {
+        NSString* uuid = [stroke uuid];
+        [strokeUUIDs addObject:uuid];
+        if (mustOverwriteStrokes || ![journal containsStroke:uuid]) {
+            NSDictionary* strokeDictionary = [stroke asDictionary];
+            if (!strokeDictionary) {
+                // keep what's on disk rather than lose the stroke
+                DebugLog(@"not saving page, stroke %@ couldn't be loaded", uuid);
+                return;
+            }
+            NSData* data = [JotStrokeFile dataForStrokeDictionary:strokeDictionary];
+            if (!data) {
+                // fall back to the plist for anything the binary format can't hold
+                data = [NSPropertyListSerialization dataWithPropertyList:strokeDictionary format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+            }
+            if (data) {
+                [strokeData setObject:data forKey:uuid];
             }
         }
+    }
 
-        [stateDict setObject:[[stateDict objectForKey:@"stackOfStrokes"] jotMapWithSelector:@selector(uuid)] forKey:@"stackOfStrokes"];
-        [stateDict setObject:[[stateDict objectForKey:@"stackOfUndoneStrokes"] jotMapWithSelector:@selector(uuid)] forKey:@"stackOfUndoneStrokes"];
-        [stateDict setObject:[NSNumber numberWithBool:YES] forKey:@"hasConverted"];
+    if (![journal saveState:stateDict withStrokes:strokeUUIDs andStrokeData:strokeData]) {
+        DebugLog(@"couldn't write page journal");
+        return;
     }
 
-    if (![stateDict writeToFile:plistPath atomically:YES]) {
-        DebugLog(@"couldn't write plist file");
+    // the vertex buffers are cached separately, since they can always be generated again
+    JotVertexCache* vertexCache = [JotVertexCache vertexCacheForStatePath:plistPath];
+    if (![vertexCache saveStrokes:strokes replacingExisting:mustOverwriteStrokes]) {
+        DebugLog(@"couldn't write vertex cache");
+    }
+    hasWrittenStrokes = YES;
+
+    if (isFirstJournalSave) {
+        // the journal has everything now, so the old files can go
+        NSFileManager* manager = [NSFileManager defaultManager];
+        NSString* stateDirectory = [plistPath stringByDeletingLastPathComponent];
+        for (NSString* item in [manager contentsOfDirectoryAtPath:stateDirectory error:nil]) {
+            NSString* extension = [item pathExtension];
+            if ([extension isEqualToString:kJotStrokeBinaryFileExt] || [extension isEqualToString:kJotStrokeFileExt]) {
+                [manager removeItemAtPath:[stateDirectory stringByAppendingPathComponent:item] error:nil];
+            }
+        }
+        if (![plistPath isEqualToString:journal.path]) {
+            [manager removeItemAtPath:plistPath error:nil];
+        }
     }
 }
 
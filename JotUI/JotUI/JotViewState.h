@@ -17,6 +17,15 @@
 
 #define kJotStrokeFileExt @"strokedata"
 
+@class JotViewState;
+
+/**
+ * called as a progressively loaded state adds its strokes. loadedStrokes
+ * are the strokes added since the last call, and isFinished is YES for
+ * the last call, once every stroke is loaded or the load was canceled
+ */
+typedef void (^JotViewStateStrokesLoadedBlock)(JotViewState* state, NSArray* loadedStrokes, BOOL isFinished);
+
 
 @interface JotViewState : NSObject <JotStrokeDelegate>
 
@@ -33,8 +42,20 @@
 // opengl backing memory
 @property(nonatomic, readonly) JotBufferManager* bufferManager;
 @property(nonatomic, readonly) int fullByteSize;
+// YES until every stroke has been loaded from disk
+@property(readonly) BOOL isLoadingStrokes;
+// the strokes that a progressive load has added so far
+@property(readonly) NSUInteger loadedStrokeCount;
 
 
+/**
+ * when YES, which is the default, strokes saved as binary stroke files
+ * open with only their hash, bounds and brush. their segments stay in
+ * the mapped file until the stroke is first drawn, exported or undone
+ */
++ (void)setLoadsStrokesLazily:(BOOL)loadsStrokesLazily;
++ (BOOL)loadsStrokesLazily;
+
 /**
  * synchronous init method to load textures and strokes
  * from disk
@@ -46,6 +67,31 @@
            andGLContext:(JotGLContext*)glContext
        andBufferManager:(JotBufferManager*)bufferManager;
 
+/**
+ * loads the texture from disk, and returns as soon as it's loaded. the
+ * strokes are loaded afterward on the import/export state queue, most
+ * recent first, and strokesLoadedBlock is called on that queue as each
+ * batch of them is added to the stacks.
+ *
+ * the state can be drawn on, undone and redone while its strokes load.
+ * loaded strokes are always added under the strokes that were drawn or
+ * undone since, but the state isn't ready to export until they're all
+ * loaded
+ */
+- (id)initWithImageFile:(NSString*)inkImageFile
+           andStateFile:(NSString*)stateInfoFile
+            andPageSize:(CGSize)fullPtSize
+               andScale:(CGFloat)scale
+           andGLContext:(JotGLContext*)glContext
+       andBufferManager:(JotBufferManager*)bufferManager
+        onStrokesLoaded:(JotViewStateStrokesLoadedBlock)strokesLoadedBlock;
+
+/**
+ * stops a progressive load before its next stroke. the strokes that
+ * aren't loaded yet are left out of the state
+ */
+- (void)cancelLoadingStrokes;
+
 /**
  * this will return an immutable copy of the state
  * but only if we are ready to export
@@ -58,7 +104,7 @@
  * this will return YES only
  * if there are zero strokes in the 
  * strokesBeingWrittenToBackingTexture and
- * currentStrokes
+ * currentStrokes, and every stroke has loaded
  */
 - (BOOL)isReadyToExport;
 
@@ -86,6 +132,18 @@
  */
 - (NSUInteger)undoHash;
 
+/**
+ * the undoHash of the strokes as they were loaded from disk, including
+ * only the strokes that have loaded so far
+ */
+- (NSUInteger)loadedUndoHash;
+
+/**
+ * YES if the strokes have been changed since they were loaded, even
+ * while they're still loading
+ */
+- (BOOL)hasEditsSinceLoad;
+
 
 #pragma mark - Undo Redo
 
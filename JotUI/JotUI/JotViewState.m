@@ -20,8 +20,16 @@
 #import "AbstractBezierPathElement-Protected.h"
 #import "NSMutableArray+RemoveSingle.h"
 #import "JotDiskAssetManager.h"
+#import "JotStrokeFile.h"
+#import "JotPageJournal.h"
+#import "JotVertexCache.h"
+#import "JotContentHash.h"
+#import "JotWarmTextureCache.h"
+#import "JotGLContextPool.h"
 
 #define kJotDefaultUndoLimit 10
+// strokes that a progressive load adds between notifications
+#define kJotStrokeLoadBatchSize 16
 
 //
 // private intializer for the immutable state
@@ -44,6 +52,19 @@
     // these arrays will act as stacks for our undo state
     __strong NSMutableArray* stackOfStrokes;
     __strong NSMutableArray* stackOfUndoneStrokes;
+    // the hashes of the stacks, kept up to date as they're
+    // pushed and popped so that undoHash is O(1)
+    JotStackHash stackOfStrokesHash;
+    JotStackHash stackOfUndoneStrokesHash;
+    // the hashes of the stacks as they were loaded from disk, so that
+    // edits can be told apart from strokes that are still loading
+    JotStackHash loadedStrokesHash;
+    JotStackHash loadedUndoneStrokesHash;
+    // a stack that's cleared while its strokes are loading throws away
+    // the rest of them as they load, after adding them to its loaded hash
+    BOOL discardsLoadingStrokes;
+    BOOL discardsLoadingUndoneStrokes;
+    BOOL isCancellingStrokeLoad;
     NSMutableArray* strokesBeingWrittenToBackingTexture;
     JotBufferManager* bufferManager;
 
@@ -58,6 +79,18 @@
 @synthesize currentStroke;
 @synthesize bufferManager;
 @synthesize strokesBeingWrittenToBackingTexture;
+@synthesize isLoadingStrokes;
+@synthesize loadedStrokeCount;
+
+static BOOL loadsStrokesLazily = YES;
+
++ (void)setLoadsStrokesLazily:(BOOL)_loadsStrokesLazily {
+    loadsStrokesLazily = _loadsStrokesLazily;
+}
+
++ (BOOL)loadsStrokesLazily {
+    return loadsStrokesLazily;
+}
 
 - (id)init {
     if (self = [super init]) {
@@ -65,6 +98,10 @@
         currentStroke = nil;
         stackOfStrokes = [NSMutableArray array];
         stackOfUndoneStrokes = [NSMutableArray array];
+        JotStackHashInit(&stackOfStrokesHash);
+        JotStackHashInit(&stackOfUndoneStrokesHash);
+        JotStackHashInit(&loadedStrokesHash);
+        JotStackHashInit(&loadedUndoneStrokesHash);
         strokesBeingWrittenToBackingTexture = [NSMutableArray array];
         undoLimit = kJotDefaultUndoLimit;
     }
@@ -77,9 +114,45 @@
                andScale:(CGFloat)scale
            andGLContext:(JotGLContext*)glContext
        andBufferManager:(JotBufferManager*)_bufferManager {
+    return [self initWithImageFile:inkImageFile
+                      andStateFile:stateInfoFile
+                       andPageSize:_fullPtSize
+                          andScale:scale
+                      andGLContext:glContext
+                  andBufferManager:_bufferManager
+                     progressively:NO
+                   onStrokesLoaded:nil];
+}
+
+- (id)initWithImageFile:(NSString*)inkImageFile
+           andStateFile:(NSString*)stateInfoFile
+            andPageSize:(CGSize)_fullPtSize
+               andScale:(CGFloat)scale
+           andGLContext:(JotGLContext*)glContext
+       andBufferManager:(JotBufferManager*)_bufferManager
+        onStrokesLoaded:(JotViewStateStrokesLoadedBlock)strokesLoadedBlock {
+    return [self initWithImageFile:inkImageFile
+                      andStateFile:stateInfoFile
+                       andPageSize:_fullPtSize
+                          andScale:scale
+                      andGLContext:glContext
+                  andBufferManager:_bufferManager
+                     progressively:YES
+                   onStrokesLoaded:strokesLoadedBlock];
+}
+
+- (id)initWithImageFile:(NSString*)inkImageFile
+           andStateFile:(NSString*)stateInfoFile
+            andPageSize:(CGSize)_fullPtSize
+               andScale:(CGFloat)scale
+           andGLContext:(JotGLContext*)glContext
+       andBufferManager:(JotBufferManager*)_bufferManager
+          progressively:(BOOL)progressively
+        onStrokesLoaded:(JotViewStateStrokesLoadedBlock)strokesLoadedBlock {
     if (self = [self init]) {
         bufferManager = _bufferManager;
         fullPtSize = _fullPtSize;
+        isLoadingStrokes = YES;
         // we're going to wait for two background operations to complete
         // using these semaphores
         dispatch_semaphore_t sema1 = dispatch_semaphore_create(0);
@@ -88,7 +161,7 @@
 
         // the second item is loading the ink texture
         // into Open GL
-        dispatch_async([JotView importExportImageQueue], ^{
+        dispatch_async([JotView importExportImageQueueForPath:inkImageFile], ^{
             @autoreleasepool {
                 [self loadTextureHelperWithGLContext:glContext andInkImageFile:inkImageFile andPixelSize:CGSizeMake(fullPtSize.width * scale, fullPtSize.height * scale)];
                 dispatch_semaphore_signal(sema1);
@@ -97,16 +170,19 @@
 
         // the first item is unserializing the plist
         // information for our page state
-        dispatch_async([JotView importExportStateQueue], ^{
+        dispatch_async([JotView importExportStateQueueForPath:stateInfoFile], ^{
             @autoreleasepool {
-                [self loadStrokesHelperWithGLContext:glContext andStateInfoFile:stateInfoFile andScale:scale];
+                [self loadStrokesHelperWithGLContext:glContext andStateInfoFile:stateInfoFile andScale:scale progressively:progressively onStrokesLoaded:strokesLoadedBlock];
                 dispatch_semaphore_signal(sema2);
             }
         });
         // wait here
-        // until both above items are complete
+        // until both above items are complete. a progressive
+        // load only waits for the texture
         dispatch_semaphore_wait(sema1, DISPATCH_TIME_FOREVER);
-        dispatch_semaphore_wait(sema2, DISPATCH_TIME_FOREVER);
+        if (!progressively) {
+            dispatch_semaphore_wait(sema2, DISPATCH_TIME_FOREVER);
+        }
     }
     return self;
 }
@@ -129,22 +205,36 @@
 
 // These used to just be blocked used above in the initFromDictionary method,
 // but I've moved them into methods so that instruments can give me better detail
-// about CPU usage inside here
-
-static JotGLContext* backgroundLoadTexturesThreadContext = nil;
+// about CPU usage inside here. each page loads on its own queues, with a
+// context from the pool, so that pages can load in parallel
 
 - (void)loadTextureHelperWithGLContext:(JotGLContext*)glContext andInkImageFile:(NSString*)inkImageFile andPixelSize:(CGSize)fullPixelSize {
     if (![JotView isImportExportImageQueue]) {
         @throw [NSException exceptionWithName:@"InconsistentQueueException" reason:@"loading texture in wrong queue" userInfo:nil];
     }
-    if (!backgroundLoadTexturesThreadContext) {
-        backgroundLoadTexturesThreadContext = [[JotGLContext alloc] initWithName:@"JotBackgroundTextureLoadContext" andSharegroup:glContext.sharegroup andValidateThreadWith:^BOOL {
-            return [JotView isImportExportImageQueue];
-        }];
+    if (![[JotGLContextPool sharedPool] sharegroup]) {
+        [[JotGLContextPool sharedPool] setGLContext:glContext];
+    }
+    // a page that unloaded recently may still have its ink in memory.
+    // otherwise the texture sidecar has the ink's raw tiles, which lets
+    // us skip the PNG decode entirely when it's up to date. the ink is
+    // read before checking out a context, which is only needed to upload it
+    JotInkTileSet* savedInkTiles = [[JotWarmTextureCache sharedCache] takeTilesForImagePath:inkImageFile withPixelSize:fullPixelSize];
+    if (!savedInkTiles) {
+        savedInkTiles = [JotDiskAssetManager inkTilesForImageAtPath:inkImageFile withPixelSize:fullPixelSize];
     }
-    [backgroundLoadTexturesThreadContext runBlock:^{
-        // load image from disk
-        UIImage* savedInkImage = [JotDiskAssetManager imageWithContentsOfFile:inkImageFile];
+    // load image from disk
+    UIImage* savedInkImage = savedInkTiles ? nil : [JotDiskAssetManager imageWithContentsOfFile:inkImageFile];
+
+    [[JotGLContextPool sharedPool] runBlock:^(JotGLContext* textureLoadContext) {
+        if (savedInkTiles) {
+            self.backgroundTexture = [[JotGLTexture alloc] initForTiles:savedInkTiles];
+            // the texture matches the saved tiles, so the next save
+            // only needs to read back the tiles that change
+            [self.backgroundFramebuffer.dirtyTileTracker markCleanForPath:inkImageFile withTiles:savedInkTiles];
+            [textureLoadContext finish];
+            return;
+        }
 
         // load new texture
         self.backgroundTexture = [[JotGLTexture alloc] initForImage:savedInkImage withSize:fullPixelSize];
@@ -154,67 +244,173 @@ static JotGLContext* backgroundLoadTexturesThreadContext = nil;
             // lets erase it, since it defaults to uncleared memory
             [self.backgroundFramebuffer clear];
         }
-        [backgroundLoadTexturesThreadContext finish];
+        [textureLoadContext finish];
     }];
 }
 
-static JotGLContext* backgroundLoadStrokesThreadContext = nil;
-
-- (void)loadStrokesHelperWithGLContext:(JotGLContext*)glContext andStateInfoFile:(NSString*)stateInfoFile andScale:(CGFloat)scale {
+- (void)loadStrokesHelperWithGLContext:(JotGLContext*)glContext
+                      andStateInfoFile:(NSString*)stateInfoFile
+                              andScale:(CGFloat)scale
+                         progressively:(BOOL)progressively
+                       onStrokesLoaded:(JotViewStateStrokesLoadedBlock)strokesLoadedBlock {
     if (![JotView isImportExportStateQueue]) {
         @throw [NSException exceptionWithName:@"InconsistentQueueException" reason:@"loading jotViewState in wrong queue" userInfo:nil];
     }
-    if (!backgroundLoadStrokesThreadContext) {
-        backgroundLoadStrokesThreadContext = [[JotGLContext alloc] initWithName:@"JotBackgroundStrokeLoadContext" andSharegroup:glContext.sharegroup andValidateThreadWith:^BOOL {
-            return [JotView isImportExportStateQueue];
-        }];
+    if (![[JotGLContextPool sharedPool] sharegroup]) {
+        [[JotGLContextPool sharedPool] setGLContext:glContext];
     }
-    [backgroundLoadStrokesThreadContext runBlock:^{
-        // load the file
-        NSDictionary* stateInfo = [NSDictionary dictionaryWithContentsOfFile:stateInfoFile];
-
-        undoLimit = [stateInfo[@"undoLimit"] integerValue] ?: kJotDefaultUndoLimit;
-
-        if (stateInfo) {
-            CGSize strokeStatePageSize = CGSizeMake([stateInfo[@"screenSize.width"] floatValue], [stateInfo[@"screenSize.height"] floatValue]);
-
-            // load our undo state if we have it
-            NSString* stateDirectory = [stateInfoFile stringByDeletingLastPathComponent];
-            id (^loadStrokeBlock)(id obj, NSUInteger index) = ^id(id obj, NSUInteger index) {
-                if (![obj isKindOfClass:[NSDictionary class]]) {
-                    NSString* filename = [[stateDirectory stringByAppendingPathComponent:obj] stringByAppendingPathExtension:kJotStrokeFileExt];
+    // the files are read and the strokes decoded without a context,
+    // which is only checked out to build each batch of strokes and
+    // upload their vertex buffers. that way a loading page doesn't hold
+    // one of the pool's few contexts while it waits on the disk, or on
+    // its delegate between batches
+    __block NSMutableArray* loadedStrokes = [NSMutableArray array];
+    // load the file. pages saved before the journal
+    // have a plist and a file for each stroke
+    JotPageJournal* journal = [JotPageJournal journalForStatePath:stateInfoFile];
+    JotVertexCache* vertexCache = [JotVertexCache vertexCacheForStatePath:stateInfoFile];
+    NSDictionary* stateInfo = journal.state ?: [NSDictionary dictionaryWithContentsOfFile:stateInfoFile];
+
+    // the main thread reads the limit while a progressive load runs
+    self.undoLimit = [stateInfo[@"undoLimit"] integerValue] ?: kJotDefaultUndoLimit;
+
+    if (stateInfo) {
+        CGSize strokeStatePageSize = CGSizeMake([stateInfo[@"screenSize.width"] floatValue], [stateInfo[@"screenSize.height"] floatValue]);
+
+        // load our undo state if we have it
+        NSString* stateDirectory = [stateInfoFile stringByDeletingLastPathComponent];
+        id (^loadStrokeInfoBlock)(id obj, NSUInteger index) = ^id(id obj, NSUInteger index) {
+            if (![obj isKindOfClass:[NSDictionary class]]) {
+                NSString* uuid = obj;
+                NSData* strokeData = [journal dataForStroke:uuid];
+                if (strokeData) {
+                    obj = [JotStrokeFile strokeDictionaryFromData:strokeData withLazySegments:loadsStrokesLazily];
+                    if (!obj) {
+                        // strokes the binary format couldn't hold are saved as plists
+                        obj = [NSPropertyListSerialization propertyListWithData:strokeData options:NSPropertyListMutableContainers format:NULL error:nil];
+                    }
+                    if (!obj) {
+                        DebugLog(@"couldn't load stroke %@ from the page journal", uuid);
+                        return nil;
+                    }
+                    NSData* vertexData = [vertexCache dataForStroke:uuid];
+                    if (vertexData) {
+                        [obj setObject:vertexData forKey:kJotStrokeVertexCacheKey];
+                    }
+                }
+            }
+            if (![obj isKindOfClass:[NSDictionary class]]) {
+                NSString* uuid = obj;
+                NSString* strokeFile = [[stateDirectory stringByAppendingPathComponent:uuid] stringByAppendingPathExtension:kJotStrokeBinaryFileExt];
+                obj = [JotStrokeFile strokeDictionaryAtPath:strokeFile withLazySegments:loadsStrokesLazily];
+                if (!obj) {
+                    // strokes saved before the binary format are still plists
+                    NSString* filename = [[stateDirectory stringByAppendingPathComponent:uuid] stringByAppendingPathExtension:kJotStrokeFileExt];
                     obj = [NSDictionary dictionaryWithContentsOfFile:filename];
                 }
-                // pass in the buffer manager to use
-                [obj setObject:bufferManager forKey:@"bufferManager"];
-                [obj setObject:[NSNumber numberWithFloat:scale] forKey:@"scale"];
-
-                NSString* className = [obj objectForKey:@"class"];
-                Class class = NSClassFromString(className);
-                JotStroke* stroke = [[class alloc] initFromDictionary:obj];
-
-                if (!CGSizeEqualToSize(strokeStatePageSize, CGSizeZero)) {
-                    if (fullPtSize.width != strokeStatePageSize.width && fullPtSize.height != strokeStatePageSize.height) {
-                        didRequireScaleDuringLoad = YES;
-
-                        CGFloat widthRatio = fullPtSize.width / strokeStatePageSize.width;
-                        CGFloat heightRatio = fullPtSize.height / strokeStatePageSize.height;
+            }
+            // pass in the buffer manager to use
+            [obj setObject:bufferManager forKey:@"bufferManager"];
+            [obj setObject:[NSNumber numberWithFloat:scale] forKey:@"scale"];
+            return obj;
+        };
+        // must be called with a context, since strokes that aren't
+        // lazy upload their vertex buffers as they're built
+        id (^buildStrokeBlock)(id obj, NSUInteger index) = ^id(id obj, NSUInteger index) {
+            NSString* className = [obj objectForKey:@"class"];
+            Class class = NSClassFromString(className);
+            JotStroke* stroke = [[class alloc] initFromDictionary:obj];
+
+            if (!CGSizeEqualToSize(strokeStatePageSize, CGSizeZero)) {
+                if (fullPtSize.width != strokeStatePageSize.width && fullPtSize.height != strokeStatePageSize.height) {
+                    didRequireScaleDuringLoad = YES;
+
+                    CGFloat widthRatio = fullPtSize.width / strokeStatePageSize.width;
+                    CGFloat heightRatio = fullPtSize.height / strokeStatePageSize.height;
+
+                    [stroke scaleSegmentsForWidth:widthRatio andHeight:heightRatio];
+                }
+            }
 
-                        [stroke scaleSegmentsForWidth:widthRatio andHeight:heightRatio];
+            stroke.delegate = self;
+            return stroke;
+        };
+
+        if (progressively) {
+            // the most recent strokes are loaded first, and each is added
+            // under the strokes that were drawn or undone since the load
+            // began, so the top of each stack is always loaded
+            for (NSString* stackKey in @[@"stackOfStrokes", @"stackOfUndoneStrokes"]) {
+                BOOL isUndoneStack = [stackKey isEqualToString:@"stackOfUndoneStrokes"];
+                NSArray* strokeInfos = [stateInfo objectForKey:stackKey];
+                NSUInteger index = [strokeInfos count];
+                while (index > 0 && ![self isCancellingStrokeLoad]) {
+                    NSMutableArray* batch = [NSMutableArray arrayWithCapacity:kJotStrokeLoadBatchSize];
+                    for (; index > 0 && [batch count] < kJotStrokeLoadBatchSize; index--) {
+                        id strokeInfo = loadStrokeInfoBlock(strokeInfos[index - 1], index - 1);
+                        if (strokeInfo) {
+                            [batch addObject:strokeInfo];
+                        }
+                    }
+                    [[JotGLContextPool sharedPool] runBlock:^(JotGLContext* strokeLoadContext) {
+                        for (id strokeInfo in batch) {
+                            if ([self isCancellingStrokeLoad]) {
+                                break;
+                            }
+                            JotStroke* stroke = buildStrokeBlock(strokeInfo, 0);
+                            if (stroke && [self insertLoadedStroke:stroke intoUndoneStack:isUndoneStack]) {
+                                [loadedStrokes addObject:stroke];
+                            }
+                        }
+                        [strokeLoadContext finish];
+                    }];
+                    if ([loadedStrokes count] >= kJotStrokeLoadBatchSize) {
+                        if (strokesLoadedBlock) {
+                            strokesLoadedBlock(self, loadedStrokes, NO);
+                        }
+                        loadedStrokes = [NSMutableArray array];
                     }
                 }
+            }
+        } else {
+            NSArray* strokeInfos = [[stateInfo objectForKey:@"stackOfStrokes"] jotMap:loadStrokeInfoBlock];
+            NSArray* undoneStrokeInfos = [[stateInfo objectForKey:@"stackOfUndoneStrokes"] jotMap:loadStrokeInfoBlock];
+            [[JotGLContextPool sharedPool] runBlock:^(JotGLContext* strokeLoadContext) {
+                @synchronized(self) {
+                    for (JotStroke* stroke in [strokeInfos jotMap:buildStrokeBlock]) {
+                        [self pushStroke:stroke];
+                    }
+                    for (JotStroke* stroke in [undoneStrokeInfos jotMap:buildStrokeBlock]) {
+                        [self pushUndoneStroke:stroke];
+                    }
+                    loadedStrokesHash = stackOfStrokesHash;
+                    loadedUndoneStrokesHash = stackOfUndoneStrokesHash;
+                }
+                [strokeLoadContext finish];
+            }];
+        }
+    }
+    @synchronized(self) {
+        isLoadingStrokes = NO;
+        isCancellingStrokeLoad = NO;
+    }
+    if (strokesLoadedBlock) {
+        strokesLoadedBlock(self, loadedStrokes, YES);
+    }
+}
 
-                stroke.delegate = self;
-                return stroke;
-            };
+- (BOOL)isCancellingStrokeLoad {
+    @synchronized(self) {
+        return isCancellingStrokeLoad;
+    }
+}
 
-            @synchronized(self) {
-                [stackOfStrokes addObjectsFromArray:[[stateInfo objectForKey:@"stackOfStrokes"] jotMap:loadStrokeBlock]];
-                [stackOfUndoneStrokes addObjectsFromArray:[[stateInfo objectForKey:@"stackOfUndoneStrokes"] jotMap:loadStrokeBlock]];
-            }
+- (void)cancelLoadingStrokes {
+    @synchronized(self) {
+        if (isLoadingStrokes) {
+            isCancellingStrokeLoad = YES;
         }
-        [backgroundLoadStrokesThreadContext finish];
-    }];
+    }
 }
 
 
@@ -236,13 +432,29 @@ static JotGLContext* backgroundLoadStrokesThreadContext = nil;
     backgroundFramebuffer = [[JotGLTextureBackedFrameBuffer alloc] initForTexture:backgroundTexture];
 }
 
+- (NSInteger)undoLimit {
+    @synchronized(self) {
+        return undoLimit;
+    }
+}
+
+- (void)setUndoLimit:(NSInteger)_undoLimit {
+    @synchronized(self) {
+        undoLimit = _undoLimit;
+    }
+}
+
 
 - (void)tick {
     @synchronized(self) {
+        if (isLoadingStrokes) {
+            // the bottom of the stack is still loading, so
+            // there's nothing to write to the texture yet
+            return;
+        }
         if ([stackOfStrokes count] > undoLimit) {
             while ([stackOfStrokes count] > undoLimit) {
-                [strokesBeingWrittenToBackingTexture addObject:[stackOfStrokes objectAtIndex:0]];
-                [stackOfStrokes removeObjectAtIndex:0];
+                [strokesBeingWrittenToBackingTexture addObject:[self removeBottomStroke]];
             }
         }
     }
@@ -276,10 +488,13 @@ static JotGLContext* backgroundLoadStrokesThreadContext = nil;
 - (BOOL)isReadyToExport {
     [self tick];
     @synchronized(self) {
-        if ([strokesBeingWrittenToBackingTexture count] ||
+        if (isLoadingStrokes ||
+            [strokesBeingWrittenToBackingTexture count] ||
             currentStroke ||
             [stackOfStrokes count] > undoLimit) {
-            if (currentStroke) {
+            if (isLoadingStrokes) {
+                // can't save, the strokes haven't all loaded
+            } else if (currentStroke) {
                 // can't save, currently drawing
             } else if ([strokesBeingWrittenToBackingTexture count]) {
                 // can't save, writing to texture
@@ -293,6 +508,12 @@ static JotGLContext* backgroundLoadStrokesThreadContext = nil;
 }
 
 
+static uint64_t JotUndoHashOfStacks(JotStackHash* strokesHash, JotStackHash* undoneStrokesHash) {
+    uint64_t hashVal = JotContentHashCombine(strokesHash->hash, strokesHash->count);
+    hashVal = JotContentHashCombine(hashVal, undoneStrokesHash->hash);
+    return JotContentHashCombine(hashVal, undoneStrokesHash->count);
+}
+
 /**
  * returns a single integer that represents the current state
  * of the visible UI. This number will take into account the strokes
@@ -304,22 +525,98 @@ static JotGLContext* backgroundLoadStrokesThreadContext = nil;
  * as if they had never drawn the stroke
  */
 - (NSUInteger)undoHash {
-    NSUInteger prime = 31;
-    NSUInteger hashVal = 1;
     @synchronized(self) {
-        for (JotStroke* stroke in stackOfStrokes) {
-            hashVal = prime * hashVal + [stroke hash];
-        }
-        hashVal = prime * hashVal + 4409; // a prime from http://www.bigprimes.net/archive/prime/6/
-        for (JotStroke* stroke in stackOfUndoneStrokes) {
-            hashVal = prime * hashVal + [stroke hash];
-        }
-        hashVal = prime * hashVal + 4409; // a prime from http://www.bigprimes.net/archive/prime/6/
+        uint64_t hashVal = JotUndoHashOfStacks(&stackOfStrokesHash, &stackOfUndoneStrokesHash);
         if (self.currentStroke) {
-            hashVal = prime * hashVal + [self.currentStroke hash];
+            hashVal = JotContentHashCombine(hashVal, [self.currentStroke contentHash]);
         }
+        return (NSUInteger)hashVal;
+    }
+}
+
+- (NSUInteger)loadedUndoHash {
+    @synchronized(self) {
+        return (NSUInteger)JotUndoHashOfStacks(&loadedStrokesHash, &loadedUndoneStrokesHash);
+    }
+}
+
+- (BOOL)hasEditsSinceLoad {
+    @synchronized(self) {
+        return [self undoHash] != [self loadedUndoHash];
+    }
+}
+
+#pragma mark - Stacks
+
+// every change to the undo and redo stacks goes through these, so that
+// their hashes stay current. strokes are finished by the time they're
+// pushed, so a stroke's hash is the same when it's popped
+
+- (void)pushStroke:(JotStroke*)stroke {
+    [stackOfStrokes addObject:stroke];
+    JotStackHashPush(&stackOfStrokesHash, [stroke contentHash]);
+}
+
+- (JotStroke*)popStroke {
+    JotStroke* stroke = [stackOfStrokes lastObject];
+    [stackOfStrokes removeLastObject];
+    JotStackHashPop(&stackOfStrokesHash, [stroke contentHash]);
+    return stroke;
+}
+
+- (JotStroke*)removeBottomStroke {
+    JotStroke* stroke = [stackOfStrokes firstObject];
+    [stackOfStrokes removeObjectAtIndex:0];
+    JotStackHashRemoveBottom(&stackOfStrokesHash, [stroke contentHash]);
+    return stroke;
+}
+
+- (void)pushUndoneStroke:(JotStroke*)stroke {
+    [stackOfUndoneStrokes addObject:stroke];
+    JotStackHashPush(&stackOfUndoneStrokesHash, [stroke contentHash]);
+}
+
+- (JotStroke*)popUndoneStroke {
+    JotStroke* stroke = [stackOfUndoneStrokes lastObject];
+    [stackOfUndoneStrokes removeLastObject];
+    JotStackHashPop(&stackOfUndoneStrokesHash, [stroke contentHash]);
+    return stroke;
+}
+
+- (void)trashUndoneStrokes {
+    [[JotTrashManager sharedInstance] addObjectsToDealloc:stackOfUndoneStrokes];
+    [stackOfUndoneStrokes removeAllObjects];
+    JotStackHashInit(&stackOfUndoneStrokesHash);
+    if (isLoadingStrokes) {
+        discardsLoadingUndoneStrokes = YES;
+    }
+}
+
+// adds a stroke that's just loaded under the bottom of its stack, or
+// throws it away if the stack was cleared since the load began.
+// returns YES if it was added
+- (BOOL)insertLoadedStroke:(JotStroke*)stroke intoUndoneStack:(BOOL)isUndoneStack {
+    @synchronized(self) {
+        if (isUndoneStack) {
+            JotStackHashInsertBottom(&loadedUndoneStrokesHash, [stroke contentHash]);
+            if (!discardsLoadingUndoneStrokes) {
+                [stackOfUndoneStrokes insertObject:stroke atIndex:0];
+                JotStackHashInsertBottom(&stackOfUndoneStrokesHash, [stroke contentHash]);
+                loadedStrokeCount++;
+                return YES;
+            }
+        } else {
+            JotStackHashInsertBottom(&loadedStrokesHash, [stroke contentHash]);
+            if (!discardsLoadingStrokes) {
+                [stackOfStrokes insertObject:stroke atIndex:0];
+                JotStackHashInsertBottom(&stackOfStrokesHash, [stroke contentHash]);
+                loadedStrokeCount++;
+                return YES;
+            }
+        }
+        [[JotTrashManager sharedInstance] addObjectToDealloc:stroke];
+        return NO;
     }
-    return hashVal;
 }
 
 #pragma mark - Undo Redo
@@ -339,9 +636,8 @@ static JotGLContext* backgroundLoadStrokesThreadContext = nil;
 - (JotStroke*)undo {
     @synchronized(self) {
         if ([self canUndo]) {
-            JotStroke* undoneStroke = [stackOfStrokes lastObject];
-            [stackOfUndoneStrokes addObject:undoneStroke];
-            [stackOfStrokes removeLastObject];
+            JotStroke* undoneStroke = [self popStroke];
+            [self pushUndoneStroke:undoneStroke];
             return undoneStroke;
         }
         return nil;
@@ -351,9 +647,8 @@ static JotGLContext* backgroundLoadStrokesThreadContext = nil;
 - (JotStroke*)redo {
     @synchronized(self) {
         if ([self canRedo]) {
-            JotStroke* redoneStroke = [stackOfUndoneStrokes lastObject];
-            [stackOfStrokes addObject:redoneStroke];
-            [stackOfUndoneStrokes removeLastObject];
+            JotStroke* redoneStroke = [self popUndoneStroke];
+            [self pushStroke:redoneStroke];
             return redoneStroke;
         }
         return nil;
@@ -363,8 +658,7 @@ static JotGLContext* backgroundLoadStrokesThreadContext = nil;
 - (JotStroke*)undoAndForget {
     @synchronized(self) {
         if ([self canUndo]) {
-            JotStroke* lastKnownStroke = [stackOfStrokes lastObject];
-            [stackOfStrokes removeLastObject];
+            JotStroke* lastKnownStroke = [self popStroke];
             // don't add to the undone stack
             return lastKnownStroke;
         }
@@ -374,31 +668,29 @@ static JotGLContext* backgroundLoadStrokesThreadContext = nil;
 
 - (void)forceAddStroke:(JotStroke*)stroke {
     @synchronized(self) {
-        [stackOfStrokes addObject:stroke];
+        [self pushStroke:stroke];
     }
 }
 
 - (void)finishCurrentStroke {
     @synchronized(self) {
         if (currentStroke) {
-            [stackOfStrokes addObject:currentStroke];
+            [self pushStroke:currentStroke];
             currentStroke = nil;
         }
-        [[JotTrashManager sharedInstance] addObjectsToDealloc:stackOfUndoneStrokes];
-        [stackOfUndoneStrokes removeAllObjects];
+        [self trashUndoneStrokes];
     }
 }
 
 - (void)addUndoLevelAndFinishStroke {
     @synchronized(self) {
         if (currentStroke) {
-            [stackOfStrokes addObject:currentStroke];
+            [self pushStroke:currentStroke];
             currentStroke = nil;
         } else {
             [self forceAddEmptyStrokeWithBrush:[JotDefaultBrushTexture sharedInstance]];
         }
-        [[JotTrashManager sharedInstance] addObjectsToDealloc:stackOfUndoneStrokes];
-        [stackOfUndoneStrokes removeAllObjects];
+        [self trashUndoneStrokes];
     }
 }
 
@@ -413,10 +705,13 @@ static JotGLContext* backgroundLoadStrokesThreadContext = nil;
 - (void)clearAllStrokes {
     @synchronized(self) {
         [[JotTrashManager sharedInstance] addObjectsToDealloc:stackOfStrokes];
-        [[JotTrashManager sharedInstance] addObjectsToDealloc:stackOfUndoneStrokes];
         [[JotTrashManager sharedInstance] addObjectToDealloc:currentStroke];
-        [stackOfUndoneStrokes removeAllObjects];
+        [self trashUndoneStrokes];
         [stackOfStrokes removeAllObjects];
+        JotStackHashInit(&stackOfStrokesHash);
+        if (isLoadingStrokes) {
+            discardsLoadingStrokes = YES;
+        }
         currentStroke = nil;
     }
 }
@@ -427,7 +722,7 @@ static JotGLContext* backgroundLoadStrokesThreadContext = nil;
             // we have a currentStroke, so we need to
             // make an empty stroke to pick up where this
             // one will leave off.
-            [stackOfStrokes addObject:currentStroke];
+            [self pushStroke:currentStroke];
 
             // now make a new stroke to pick up where we left off
             JotStroke* newStroke = [[JotStroke alloc] initWithTexture:currentStroke.texture andBufferManager:bufferManager];
@@ -456,8 +751,7 @@ static JotGLContext* backgroundLoadStrokesThreadContext = nil;
 
         // since we've added an undo level, we need to
         // remove all undone strokes.
-        [[JotTrashManager sharedInstance] addObjectsToDealloc:stackOfUndoneStrokes];
-        [stackOfUndoneStrokes removeAllObjects];
+        [self trashUndoneStrokes];
     }
 }
 
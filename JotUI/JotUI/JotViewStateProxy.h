@@ -27,12 +27,18 @@
 @property(nonatomic, strong) JotStroke* currentStroke;
 @property(nonatomic, readonly) int fullByteSize;
 @property(nonatomic, assign) BOOL isForgetful;
+// when YES, the state finishes loading once its texture is loaded, and
+// its strokes load and render afterward. defaults to NO
+@property(nonatomic, assign) BOOL loadsStrokesProgressively;
 @property(nonatomic, assign) NSInteger undoLimit;
 
 - (id)initWithDelegate:(NSObject<JotViewStateProxyDelegate>*)delegate;
 
 - (BOOL)isStateLoaded;
 - (BOOL)isStateLoading;
+// YES while a progressively loaded state is still loading its strokes
+- (BOOL)isLoadingStrokes;
+- (NSUInteger)loadedStrokeCount;
 
 - (BOOL)isReadyToExport;
 
@@ -9,29 +9,36 @@
 #import "JotViewStateProxy.h"
 #import <JotUI/JotUI.h>
 #import "JotViewState.h"
-
-static dispatch_queue_t loadUnloadStateQueue;
+#import "JotMemoryManager.h"
 
 
 @implementation JotViewStateProxy {
+    // each page loads and unloads in order on its own queue,
+    // so that different pages can load at the same time
+    dispatch_queue_t loadUnloadStateQueue;
+
     // ideal state
     BOOL shouldKeepStateLoaded;
     BOOL isLoadingState;
+    BOOL isLoadingStrokes;
     BOOL isForgetful;
 
     JotViewState* jotViewState;
 }
 
-+ (dispatch_queue_t)loadUnloadStateQueue {
-    if (!loadUnloadStateQueue) {
-        loadUnloadStateQueue = dispatch_queue_create("com.milestonemade.looseleaf.loadUnloadStateQueue", DISPATCH_QUEUE_SERIAL);
+- (dispatch_queue_t)loadUnloadStateQueue {
+    @synchronized(self) {
+        if (!loadUnloadStateQueue) {
+            loadUnloadStateQueue = dispatch_queue_create("com.milestonemade.looseleaf.loadUnloadStateQueue", DISPATCH_QUEUE_SERIAL);
+        }
+        return loadUnloadStateQueue;
     }
-    return loadUnloadStateQueue;
 }
 
 @synthesize delegate;
 @synthesize jotViewState;
 @synthesize isForgetful;
+@synthesize loadsStrokesProgressively;
 
 - (id)initWithDelegate:(NSObject<JotViewStateProxyDelegate>*)_delegate {
     if (self = [super init]) {
@@ -44,6 +51,20 @@ static dispatch_queue_t loadUnloadStateQueue;
     return jotViewState.fullByteSize;
 }
 
+// reports the page's texture and vertex buffer bytes to the memory
+// manager, or removes them if the state isn't loaded
+- (void)updatePageBytes {
+    JotMemoryAccountant* accountant = [[JotMemoryManager sharedManager] accountant];
+    JotViewState* state = jotViewState;
+    if (state) {
+        int textureBytes = state.backgroundTexture.fullByteSize;
+        JotMemoryAccountantSetPageBytes(accountant, (__bridge void*)self, JotMemoryCategoryTexture, textureBytes);
+        JotMemoryAccountantSetPageBytes(accountant, (__bridge void*)self, JotMemoryCategoryVertexBuffer, MAX(0, state.fullByteSize - textureBytes));
+    } else {
+        JotMemoryAccountantRemovePage(accountant, (__bridge void*)self);
+    }
+}
+
 - (NSMutableArray*)strokesBeingWrittenToBackingTexture {
     return jotViewState.strokesBeingWrittenToBackingTexture;
 }
@@ -51,8 +72,11 @@ static dispatch_queue_t loadUnloadStateQueue;
 - (void)loadJotStateAsynchronously:(BOOL)async withSize:(CGSize)pagePtSize andScale:(CGFloat)scale andContext:(JotGLContext*)context andBufferManager:(JotBufferManager*)bufferManager {
     @synchronized(self) {
         // if we're already loading our
-        // state, then bail early
+        // state, then bail early. an unload
+        // may have asked the load to throw its
+        // state away, so make sure it keeps it
         if (isLoadingState) {
+            shouldKeepStateLoaded = YES;
             return;
         }
         // if we already have our state,
@@ -76,12 +100,27 @@ static dispatch_queue_t loadUnloadStateQueue;
                 if (!shouldKeepStateLoaded) {
                     DebugLog(@"will waste some time loading a JotViewState that we don't need...");
                 }
-                jotViewState = [[JotViewState alloc] initWithImageFile:delegate.jotViewStateInkPath
-                                                          andStateFile:delegate.jotViewStatePlistPath
-                                                           andPageSize:pagePtSize
-                                                              andScale:scale
-                                                          andGLContext:context
-                                                      andBufferManager:bufferManager];
+                if (self.loadsStrokesProgressively) {
+                    @synchronized(self) {
+                        isLoadingStrokes = YES;
+                    }
+                    jotViewState = [[JotViewState alloc] initWithImageFile:delegate.jotViewStateInkPath
+                                                              andStateFile:delegate.jotViewStatePlistPath
+                                                               andPageSize:pagePtSize
+                                                                  andScale:scale
+                                                              andGLContext:context
+                                                          andBufferManager:bufferManager
+                                                           onStrokesLoaded:^(JotViewState* state, NSArray* loadedStrokes, BOOL isFinished) {
+                                                               [self state:state didLoadStrokes:loadedStrokes isFinished:isFinished];
+                                                           }];
+                } else {
+                    jotViewState = [[JotViewState alloc] initWithImageFile:delegate.jotViewStateInkPath
+                                                              andStateFile:delegate.jotViewStatePlistPath
+                                                               andPageSize:pagePtSize
+                                                                  andScale:scale
+                                                              andGLContext:context
+                                                          andBufferManager:bufferManager];
+                }
                 if (!shouldKeepStateLoaded) {
                     DebugLog(@"wasted some time loading a JotViewState that we didn't need...");
                 }
@@ -98,14 +137,22 @@ static dispatch_queue_t loadUnloadStateQueue;
                     }
                 }
                 if (shouldNotify) {
+                    [self updatePageBytes];
                     // nothing changed in our goals since we started
                     // to load state, so notify our delegate
                     [self.delegate didLoadState:self];
+                    if (![jotViewState isLoadingStrokes]) {
+                        // the strokes may have finished loading before
+                        // the state was ours, so it missed the last batch
+                        [self state:jotViewState didLoadStrokes:@[] isFinished:YES];
+                    }
                 } else {
+                    [jotViewState cancelLoadingStrokes];
                     [[JotTrashManager sharedInstance] addObjectToDealloc:jotViewState];
                     @synchronized(self) {
                         jotViewState = nil;
                         lastSavedUndoHash = 0;
+                        isLoadingStrokes = NO;
                     }
                 }
                 @synchronized(self) {
@@ -125,15 +172,46 @@ static dispatch_queue_t loadUnloadStateQueue;
     };
 
     if (async) {
-        dispatch_async(([JotViewStateProxy loadUnloadStateQueue]), block2);
+        dispatch_async([self loadUnloadStateQueue], block2);
     } else {
         block2();
     }
 }
 
+// called on the import/export state queue as a progressively loaded
+// state adds its strokes
+- (void)state:(JotViewState*)state didLoadStrokes:(NSArray*)loadedStrokes isFinished:(BOOL)isFinished {
+    BOOL didFinish = NO;
+    @synchronized(self) {
+        if (state != jotViewState || !isLoadingStrokes) {
+            // the state was unloaded, or hasn't been set yet
+            return;
+        }
+        if (isFinished) {
+            // the loaded strokes are what's saved, even if
+            // the page was edited while they loaded
+            lastSavedUndoHash = [state loadedUndoHash];
+            isLoadingStrokes = NO;
+            didFinish = YES;
+        }
+    }
+    if (didFinish) {
+        [self updatePageBytes];
+    }
+    dispatch_async(dispatch_get_main_queue(), ^{
+        if ([loadedStrokes count] && [self.delegate respondsToSelector:@selector(didLoadStrokes:forState:)]) {
+            [self.delegate didLoadStrokes:loadedStrokes forState:self];
+        }
+        if (didFinish && [self.delegate respondsToSelector:@selector(didFinishLoadingStrokesForState:)]) {
+            [self.delegate didFinishLoadingStrokesForState:self];
+        }
+    });
+}
+
 - (void)wasSavedAtImmutableState:(JotViewImmutableState*)immutableState {
     lastSavedUndoHash = [immutableState undoHash];
     lastSavedUndoHash = [immutableState undoHash];
+    [self updatePageBytes];
 }
 
 - (void)unload {
@@ -141,7 +219,7 @@ static dispatch_queue_t loadUnloadStateQueue;
     @synchronized(self) {
         shouldKeepStateLoaded = NO;
         if ([self isStateLoaded] && !isLoadingState) {
-            dispatch_async(([JotViewStateProxy loadUnloadStateQueue]), ^{
+            dispatch_async([self loadUnloadStateQueue], ^{
                 @autoreleasepool {
                     @synchronized(strongSelf) {
                         if ([self isStateLoaded]) {
@@ -156,9 +234,23 @@ static dispatch_queue_t loadUnloadStateQueue;
                                 @throw [NSException exceptionWithName:@"UnloadedEditedPageException" reason:@"The page has been asked to unload, but has edits pending save" userInfo:nil];
                             }
                             if (!isLoadingState && jotViewState) {
-                                [[JotTrashManager sharedInstance] addObjectToDealloc:jotViewState];
+                                JotViewState* unloadedState = jotViewState;
+                                [unloadedState cancelLoadingStrokes];
+                                isLoadingStrokes = NO;
+                                if (strongSelf.isForgetful) {
+                                    [[JotTrashManager sharedInstance] addObjectToDealloc:unloadedState];
+                                } else {
+                                    // keep the ink in memory in case the page is loaded again soon,
+                                    // and only then let the trash manager delete the texture
+                                    [[JotWarmTextureCache sharedCache] captureTexture:unloadedState.backgroundTexture
+                                                                         forImagePath:strongSelf.delegate.jotViewStateInkPath
+                                                                           onComplete:^{
+                                                                               [[JotTrashManager sharedInstance] addObjectToDealloc:unloadedState];
+                                                                           }];
+                                }
                                 jotViewState = nil;
                                 lastSavedUndoHash = 0;
+                                [strongSelf updatePageBytes];
                                 [strongSelf.delegate didUnloadState:strongSelf];
                             }
                         } else {
@@ -180,6 +272,14 @@ static dispatch_queue_t loadUnloadStateQueue;
     return isLoadingState;
 }
 
+- (BOOL)isLoadingStrokes {
+    return isLoadingStrokes;
+}
+
+- (NSUInteger)loadedStrokeCount {
+    return [jotViewState loadedStrokeCount];
+}
+
 - (BOOL)isReadyToExport {
     return [jotViewState isReadyToExport];
 }
@@ -228,6 +328,10 @@ static dispatch_queue_t loadUnloadStateQueue;
     if (self.isForgetful) {
         return NO;
     }
+    if (isLoadingStrokes) {
+        // the strokes that haven't loaded yet aren't edits
+        return [self.jotViewState hasEditsSinceLoad];
+    }
     return self.jotViewState && [self.jotViewState undoHash] != lastSavedUndoHash;
 }
 
@@ -295,6 +399,7 @@ static dispatch_queue_t loadUnloadStateQueue;
 
 - (void)dealloc {
     NSAssert(![self hasEditsToSave], @"deallocating a jotview state that has pending edits");
+    JotMemoryAccountantRemovePage([[JotMemoryManager sharedManager] accountant], (__bridge void*)self);
 }
 
 @end
@@ -20,4 +20,12 @@
 
 - (void)didUnloadState:(JotViewStateProxy*)state;
 
+@optional
+
+// called on the main queue as a state that loads its strokes
+// progressively adds them, after didLoadState:
+- (void)didLoadStrokes:(NSArray*)strokes forState:(JotViewStateProxy*)state;
+
+- (void)didFinishLoadingStrokesForState:(JotViewStateProxy*)state;
+
 @end
@@ -0,0 +1,63 @@
+//
+//  JotWarmTextureCache.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "JotGLTexture.h"
+#import "JotInkTileSet.h"
+
+// the most bytes of compressed ink that are kept by default
+#define kJotWarmTextureCacheDefaultByteBudget (32 * 1024 * 1024)
+
+
+/**
+ * Keeps the ink of recently unloaded pages in memory, so that loading
+ * them again is a decompress and upload instead of a trip to disk.
+ *
+ * When a page unloads, its background texture is read back one band of
+ * tiles at a time, and its non-empty tiles are LZ4 compressed. Mostly
+ * empty pages are a small fraction of their texture's size. The ink is
+ * keyed by its image path, along with the size and date of the image
+ * and its texture sidecar, so it's only used if nothing has been saved
+ * to that path since.
+ *
+ * Captures run on their page's import/export image queue, after any
+ * pending writes to their path, so a page that's loaded right after it
+ * unloads finds its ink already captured. They're skipped until the
+ * context pool has a sharegroup to read textures with. The least recently captured ink is
+ * evicted when it's over byteBudget, and the memory manager can trim
+ * it when memory is short.
+ */
+@interface JotWarmTextureCache : NSObject
+
++ (JotWarmTextureCache*)sharedCache;
+
+@property(nonatomic, assign) NSUInteger byteBudget;
+
+@property(nonatomic, readonly) NSUInteger cachedBytes;
+@property(nonatomic, readonly) NSUInteger hitCount;
+@property(nonatomic, readonly) NSUInteger missCount;
+
+// reads back the texture and caches its ink for imagePath. the
+// completion block is called on the page's image queue once
+// the texture isn't needed anymore, whether or not it was cached
+- (void)captureTexture:(JotGLTexture*)texture forImagePath:(NSString*)imagePath onComplete:(void (^)(void))completionBlock;
+
+// returns and forgets the ink cached for imagePath, or nil if there
+// isn't any, or it's out of date or a different size
+- (JotInkTileSet*)takeTilesForImagePath:(NSString*)imagePath withPixelSize:(CGSize)pixelSize;
+
+// caches tiles that match what's saved at imagePath
+- (void)cacheTiles:(JotInkTileSet*)tiles forImagePath:(NSString*)imagePath;
+
+- (void)removeTilesForImagePath:(NSString*)imagePath;
+
+// evicts the least recently cached ink until about bytesToFree are
+// evicted, and returns how many bytes were
+- (NSUInteger)evictBytes:(NSUInteger)bytesToFree;
+
+@end
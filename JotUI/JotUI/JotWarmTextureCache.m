@@ -0,0 +1,232 @@
+//
+//  JotWarmTextureCache.m
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import "JotWarmTextureCache.h"
+#import "JotView.h"
+#import "JotDiskAssetManager.h"
+#import "JotInkTextureSidecar.h"
+#import "JotMemoryManager.h"
+#import "JotLZ4.h"
+#import "JotGLContextPool.h"
+
+
+@interface JotWarmTexture : NSObject
+
+@property(nonatomic, assign) CGSize pixelSize;
+@property(nonatomic, assign) NSUInteger tileSize;
+@property(nonatomic, strong) NSData* bitmap;
+// LZ4 compressed, unless compressing didn't make them smaller
+@property(nonatomic, strong) NSData* tiles;
+@property(nonatomic, assign) NSUInteger packedLength;
+// the size and date of the image and its sidecar when it was cached
+@property(nonatomic, strong) NSArray* fileStamp;
+@property(nonatomic, readonly) NSUInteger byteSize;
+
+@end
+
+@implementation JotWarmTexture
+
+- (NSUInteger)byteSize {
+    return [self.bitmap length] + [self.tiles length];
+}
+
+@end
+
+
+@implementation JotWarmTextureCache {
+    // image path => JotWarmTexture
+    NSMutableDictionary* texturesByPath;
+    // image paths, least recently cached first
+    NSMutableOrderedSet* pathsByAge;
+}
+
+@synthesize byteBudget;
+@synthesize cachedBytes;
+@synthesize hitCount;
+@synthesize missCount;
+
++ (JotWarmTextureCache*)sharedCache {
+    static dispatch_once_t onceToken;
+    static JotWarmTextureCache* sharedCache;
+    dispatch_once(&onceToken, ^{
+        sharedCache = [[JotWarmTextureCache alloc] init];
+    });
+    return sharedCache;
+}
+
+static size_t JotWarmTextureCacheTrim(void* context, size_t bytesToFree) {
+    return [(__bridge JotWarmTextureCache*)context evictBytes:bytesToFree];
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        texturesByPath = [NSMutableDictionary dictionary];
+        pathsByAge = [NSMutableOrderedSet orderedSet];
+        byteBudget = kJotWarmTextureCacheDefaultByteBudget;
+        // the cache is never deallocated, so it's never removed. its bytes
+        // are adjusted as ink is cached and evicted, so it has no size
+        JotMemoryAccountantAddPool([[JotMemoryManager sharedManager] accountant], JotMemoryCategoryWarmTextures, kJotMemoryPriorityWarmTextures,
+                                   &JotWarmTextureCacheTrim, NULL, (__bridge void*)self);
+    }
+    return self;
+}
+
+- (void)setByteBudget:(NSUInteger)_byteBudget {
+    @synchronized(self) {
+        byteBudget = _byteBudget;
+        [self evictToBudget];
+    }
+}
+
+#pragma mark - Capture and Restore
+
+// the image and sidecar files' sizes and dates, which change whenever
+// anything is saved to the image path
++ (NSArray*)fileStampForImagePath:(NSString*)imagePath {
+    NSMutableArray* stamp = [NSMutableArray array];
+    for (NSString* path in @[imagePath, [JotInkTextureSidecar sidecarPathForImagePath:imagePath]]) {
+        NSDictionary* attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil];
+        [stamp addObject:attributes ? @[@([attributes fileSize]), [attributes fileModificationDate] ?: [NSNull null]] : [NSNull null]];
+    }
+    return stamp;
+}
+
+- (void)captureTexture:(JotGLTexture*)texture forImagePath:(NSString*)imagePath onComplete:(void (^)(void))completionBlock {
+    dispatch_async([JotView importExportImageQueueForPath:imagePath], ^{
+        @autoreleasepool {
+            if (texture && imagePath && [[JotGLContextPool sharedPool] sharegroup]) {
+                // the texture matches what's being saved, so
+                // wait for it to be saved before stamping it
+                [[JotDiskAssetManager sharedManager] blockUntilCompletedForPath:imagePath];
+
+                __block JotInkTileSet* tiles = nil;
+                [[JotGLContextPool sharedPool] runBlock:^(JotGLContext* context) {
+                    JotInkTileGrid grid = JotInkTileGridMake(texture.pixelSize.width, texture.pixelSize.height, kJotInkTileSize);
+                    NSMutableData* everyTile = [NSMutableData dataWithLength:JotInkTileGridBitmapLength(&grid)];
+                    memset([everyTile mutableBytes], 0xFF, [everyTile length]);
+
+                    GLuint framebuffer = [context generateFramebufferWithTextureBacking:texture];
+                    [context bindFramebuffer:framebuffer];
+                    tiles = [JotInkTileSet tileSetWithPixelSize:texture.pixelSize
+                                                   readingTiles:everyTile
+                                                      fromBands:^(CGRect pixelRect, uint8_t* band) {
+                                                          [context readPixelsInto:band inRect:pixelRect];
+                                                      }];
+                    [context unbindFramebuffer];
+                    [context deleteFramebuffer:framebuffer];
+                }];
+                [self cacheTiles:tiles forImagePath:imagePath];
+            }
+            if (completionBlock) {
+                completionBlock();
+            }
+        }
+    });
+}
+
+- (void)cacheTiles:(JotInkTileSet*)tiles forImagePath:(NSString*)imagePath {
+    if (!tiles || !imagePath) {
+        return;
+    }
+    NSData* packedTiles = tiles.packedTiles;
+    NSData* storedTiles = packedTiles;
+    NSMutableData* compressedTiles = [NSMutableData dataWithLength:JotLZ4CompressBound([packedTiles length])];
+    size_t compressedLength = JotLZ4Compress([packedTiles bytes], [packedTiles length], [compressedTiles mutableBytes], [compressedTiles length]);
+    if (compressedLength && compressedLength < [packedTiles length]) {
+        [compressedTiles setLength:compressedLength];
+        storedTiles = compressedTiles;
+    }
+
+    JotWarmTexture* warmTexture = [[JotWarmTexture alloc] init];
+    warmTexture.pixelSize = tiles.pixelSize;
+    warmTexture.tileSize = tiles.tileSize;
+    warmTexture.bitmap = tiles.bitmap;
+    warmTexture.tiles = storedTiles;
+    warmTexture.packedLength = [packedTiles length];
+    warmTexture.fileStamp = [JotWarmTextureCache fileStampForImagePath:imagePath];
+
+    @synchronized(self) {
+        [self removeTilesForImagePath:imagePath];
+        if ([warmTexture byteSize] > byteBudget) {
+            return;
+        }
+        texturesByPath[imagePath] = warmTexture;
+        [pathsByAge addObject:imagePath];
+        cachedBytes += [warmTexture byteSize];
+        JotMemoryAccountantAdjust([[JotMemoryManager sharedManager] accountant], JotMemoryCategoryWarmTextures, [warmTexture byteSize]);
+        [self evictToBudget];
+    }
+}
+
+- (JotInkTileSet*)takeTilesForImagePath:(NSString*)imagePath withPixelSize:(CGSize)pixelSize {
+    JotWarmTexture* warmTexture;
+    @synchronized(self) {
+        warmTexture = texturesByPath[imagePath];
+        [self removeTilesForImagePath:imagePath];
+    }
+    // a pending write hasn't changed the files yet, but will
+    if (!warmTexture || [[JotDiskAssetManager sharedManager] hasPendingWritesForPath:imagePath] || !CGSizeEqualToSize(warmTexture.pixelSize, pixelSize) ||
+        ![warmTexture.fileStamp isEqualToArray:[JotWarmTextureCache fileStampForImagePath:imagePath]]) {
+        @synchronized(self) {
+            missCount++;
+        }
+        return nil;
+    }
+
+    NSData* packedTiles = warmTexture.tiles;
+    if ([packedTiles length] != warmTexture.packedLength) {
+        NSMutableData* decompressedTiles = [NSMutableData dataWithLength:warmTexture.packedLength];
+        if (!JotLZ4Decompress([packedTiles bytes], [packedTiles length], [decompressedTiles mutableBytes], [decompressedTiles length])) {
+            @synchronized(self) {
+                missCount++;
+            }
+            return nil;
+        }
+        packedTiles = decompressedTiles;
+    }
+    @synchronized(self) {
+        hitCount++;
+    }
+    return [[JotInkTileSet alloc] initWithPixelSize:pixelSize andTileSize:warmTexture.tileSize andBitmap:warmTexture.bitmap andPackedTiles:packedTiles];
+}
+
+#pragma mark - Eviction
+
+- (void)removeTilesForImagePath:(NSString*)imagePath {
+    if (!imagePath) {
+        return;
+    }
+    @synchronized(self) {
+        JotWarmTexture* warmTexture = texturesByPath[imagePath];
+        if (warmTexture) {
+            [texturesByPath removeObjectForKey:imagePath];
+            [pathsByAge removeObject:imagePath];
+            cachedBytes -= [warmTexture byteSize];
+            JotMemoryAccountantAdjust([[JotMemoryManager sharedManager] accountant], JotMemoryCategoryWarmTextures, -(int64_t)[warmTexture byteSize]);
+        }
+    }
+}
+
+// must be called while synchronized on self
+- (void)evictToBudget {
+    while (cachedBytes > byteBudget && [pathsByAge count]) {
+        [self removeTilesForImagePath:[pathsByAge firstObject]];
+    }
+}
+
+- (NSUInteger)evictBytes:(NSUInteger)bytesToFree {
+    @synchronized(self) {
+        NSUInteger startingBytes = cachedBytes;
+        while (startingBytes - cachedBytes < bytesToFree && [pathsByAge count]) {
+            [self removeTilesForImagePath:[pathsByAge firstObject]];
+        }
+        return startingBytes - cachedBytes;
+    }
+}
+
+@end
@@ -13,9 +13,15 @@
 
 + (MMDataCache*)sharedCache;
 
-
+// the data's length is its buffer's size class, which can
+// be larger than byteSize. returns nil if it can't be allocated
 - (NSData*)dataOfSize:(NSUInteger)byteSize;
 
 - (void)returnDataToCache:(NSData*)data;
 
+// frees cached buffers until no more than maxCachedBytes are cached.
+// the memory manager also trims the cache when it's over budget or
+// for a memory warning
+- (void)trimCacheToBytes:(NSUInteger)maxCachedBytes;
+
 @end
@@ -7,10 +7,18 @@
 //
 
 #import "MMDataCache.h"
+#import "JotBufferPool.h"
+#import "JotMemoryManager.h"
+
+// the most bytes that are cached while they're not in use
+#define kMMDataCacheMaxCachedBytes (64 * 1024 * 1024)
+// how long the cache is idle before it starts to shrink
+#define kMMDataCacheBleedDelay 3
 
 
 @implementation MMDataCache {
-    NSMutableArray* memoryQueue;
+    JotBufferPool* pool;
+    JotMemoryPoolID memoryPoolID;
 }
 
 static MMDataCache* sharedCache;
@@ -23,52 +31,71 @@ static MMDataCache* sharedCache;
     return sharedCache;
 }
 
+// the pool's cached buffers can be freed, but not those in use
+static size_t MMDataCacheTrim(void* context, size_t bytesToFree) {
+    JotBufferPool* pool = context;
+    JotBufferPoolStats stats;
+    JotBufferPoolGetStats(pool, &stats);
+    JotBufferPoolTrim(pool, stats.cachedBytes > bytesToFree ? stats.cachedBytes - bytesToFree : 0);
+    size_t cachedBytes = stats.cachedBytes;
+    JotBufferPoolGetStats(pool, &stats);
+    return cachedBytes > stats.cachedBytes ? cachedBytes - stats.cachedBytes : 0;
+}
+
+static size_t MMDataCacheSize(void* context) {
+    JotBufferPoolStats stats;
+    JotBufferPoolGetStats(context, &stats);
+    return stats.cachedBytes + stats.outstandingBytes;
+}
+
 - (instancetype)init {
     if (self = [super init]) {
-        memoryQueue = [NSMutableArray array];
+        pool = JotBufferPoolCreate(kMMDataCacheMaxCachedBytes);
+        // memory warnings trim the pool through the memory manager
+        memoryPoolID = JotMemoryAccountantAddPool([[JotMemoryManager sharedManager] accountant], JotMemoryCategoryDataCache, kJotMemoryPriorityDataCache,
+                                                  &MMDataCacheTrim, &MMDataCacheSize, pool);
     }
     return self;
 }
 
-- (NSData*)dataOfSize:(NSUInteger)byteSize {
-    NSData* cachedNSData = nil;
-
-    @synchronized(memoryQueue) {
-        for (NSData* data in memoryQueue) {
-            if ([data length] >= byteSize) {
-                cachedNSData = data;
-                [memoryQueue removeObject:data];
-                break;
-            }
-        }
-    }
+- (void)dealloc {
+    JotMemoryAccountantRemovePool([[JotMemoryManager sharedManager] accountant], memoryPoolID);
+    JotBufferPoolFree(pool);
+}
 
-    if (!cachedNSData) {
-        cachedNSData = [NSData dataWithBytesNoCopy:malloc(byteSize) length:byteSize freeWhenDone:NO];
+- (NSData*)dataOfSize:(NSUInteger)byteSize {
+    size_t capacity = 0;
+    void* bytes = JotBufferPoolAlloc(pool, byteSize, &capacity);
+    if (!bytes) {
+        return nil;
     }
-
-    return cachedNSData;
+    return [NSData dataWithBytesNoCopy:bytes length:capacity freeWhenDone:NO];
 }
 
 - (void)returnDataToCache:(NSData*)cachedNSData {
-    @synchronized(memoryQueue) {
-        [memoryQueue addObject:cachedNSData];
-    }
+    JotBufferPoolRelease(pool, (void*)[cachedNSData bytes], [cachedNSData length]);
 
-    [[self class] cancelPreviousPerformRequestsWithTarget:self selector:@selector(bleedCache) object:nil];
-    [self performSelector:@selector(bleedCache) withObject:nil afterDelay:3];
+    // the run loop of the thread that returned the data may never run
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [[self class] cancelPreviousPerformRequestsWithTarget:self selector:@selector(bleedCache) object:nil];
+        [self performSelector:@selector(bleedCache) withObject:nil afterDelay:kMMDataCacheBleedDelay];
+    });
 }
 
+- (void)trimCacheToBytes:(NSUInteger)maxCachedBytes {
+    JotBufferPoolTrim(pool, maxCachedBytes);
+}
+
+// halves the cache every few seconds while it's idle, so that it
+// shrinks in proportion to how much is cached
 - (void)bleedCache {
-    @synchronized(memoryQueue) {
-        if ([memoryQueue count]) {
-            NSData* cachedNSData = [memoryQueue firstObject];
-            [memoryQueue removeObjectAtIndex:0];
-            free((void*)cachedNSData.bytes);
-
-            // continue bleeding the cache every 3 seconds
-            [self performSelector:@selector(bleedCache) withObject:nil afterDelay:3];
-        }
+    JotBufferPoolStats stats;
+    JotBufferPoolGetStats(pool, &stats);
+    if (stats.cachedBytes) {
+        [self trimCacheToBytes:stats.cachedBytes / 2];
+
+        // continue bleeding the cache every few seconds
+        [self performSelector:@selector(bleedCache) withObject:nil afterDelay:kMMDataCacheBleedDelay];
     }
 }
 
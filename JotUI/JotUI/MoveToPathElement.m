@@ -8,19 +8,17 @@
 
 #import "MoveToPathElement.h"
 #import "AbstractBezierPathElement-Protected.h"
+#import "JotContentHash.h"
 
 
 @implementation MoveToPathElement {
     // cache the hash, since it's expenseive to calculate
-    NSUInteger _hashCache;
+    uint64_t _hashCache;
 }
 
 - (id)initWithMoveTo:(CGPoint)point {
     if (self = [super initWithStart:point]) {
-        NSUInteger prime = 31;
-        _hashCache = 1;
-        _hashCache = prime * _hashCache + _startPoint.x;
-        _hashCache = prime * _hashCache + _startPoint.y;
+        [self updateHashCache];
     }
     return self;
 }
@@ -81,14 +79,11 @@
 
 #pragma mark - PlistSaving
 
-- (id)initFromDictionary:(NSDictionary*)dictionary {
-    if (self = [super initFromDictionary:dictionary]) {
-        NSUInteger prime = 31;
-        _hashCache = 1;
-        _hashCache = prime * _hashCache + _startPoint.x;
-        _hashCache = prime * _hashCache + _startPoint.y;
+- (id)initFromStrokeValues:(id<JotStrokeValues>)values {
+    if (self = [super initFromStrokeValues:values]) {
+        [self updateHashCache];
 
-        CGFloat currentScale = [[dictionary objectForKey:@"scale"] floatValue];
+        CGFloat currentScale = [values jotFloatForKey:@"scale"];
         if (currentScale != _scaleOfVertexBuffer) {
             // the scale of the cached data in the dictionary is
             // different than the scael of the data that we need.
@@ -110,10 +105,19 @@
 
 #pragma mark - hashing and equality
 
-- (NSUInteger)hash {
+- (void)updateHashCache {
+    double values[2] = { _startPoint.x, _startPoint.y };
+    _hashCache = JotContentHashOfDoubles(values, 2);
+}
+
+- (uint64_t)pointsHash {
     return _hashCache;
 }
 
+- (NSUInteger)hash {
+    return (NSUInteger)[self contentHash];
+}
+
 - (BOOL)isEqual:(id)object {
     return self == object || [self hash] == [object hash];
 }
@@ -0,0 +1,15 @@
+//
+//  NSDictionary+JotStrokeValues.h
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "PlistSaving.h"
+
+
+@interface NSDictionary (JotStrokeValues) <JotStrokeValues>
+
+@end
@@ -0,0 +1,31 @@
+//
+//  NSDictionary+JotStrokeValues.m
+//  JotUI
+//
+//  Created by Adam Wulf on 10/19/26.
+//  Copyright © 2026 Milestone Made. All rights reserved.
+//
+
+#import "NSDictionary+JotStrokeValues.h"
+#import "UIColor+JotHelper.h"
+
+
+@implementation NSDictionary (JotStrokeValues)
+
+- (float)jotFloatForKey:(NSString*)key {
+    return [[self objectForKey:key] floatValue];
+}
+
+- (BOOL)jotBoolForKey:(NSString*)key {
+    return [[self objectForKey:key] boolValue];
+}
+
+- (NSInteger)jotIntegerForKey:(NSString*)key {
+    return [[self objectForKey:key] integerValue];
+}
+
+- (UIColor*)jotColorForKey:(NSString*)key {
+    return [UIColor colorWithDictionary:[self objectForKey:key]];
+}
+
+@end
@@ -7,6 +7,7 @@
 //
 
 #import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
 
 @protocol PlistSaving <NSObject>
 
@@ -15,3 +16,24 @@
 - (id)initFromDictionary:(NSDictionary*)dictionary;
 
 @end
+
+/**
+ * the saved values of one segment, which segments read in
+ * initFromStrokeValues:. a missing value reads as 0, NO or nil.
+ * this is either the segment's dictionary, or one row of the
+ * columns of a binary stroke file (see JotStrokeFile.h)
+ */
+@protocol JotStrokeValues <NSObject>
+
+- (id)objectForKey:(NSString*)key;
+
+- (float)jotFloatForKey:(NSString*)key;
+
+- (BOOL)jotBoolForKey:(NSString*)key;
+
+- (NSInteger)jotIntegerForKey:(NSString*)key;
+
+// from a dictionary of red, green, blue and alpha, see UIColor+JotHelper.h
+- (UIColor*)jotColorForKey:(NSString*)key;
+
+@end
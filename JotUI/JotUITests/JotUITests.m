@@ -9,9 +9,157 @@
 #import <XCTest/XCTest.h>
 #import <JotUI/JotUI.h>
 #import <JotUI/SegmentSmoother.h>
+#import <JotUI/JotImageKernels.h>
+#import <JotUI/JotPNGWriter.h>
+#import <JotUI/JotLZ4.h>
+#import <JotUI/JotInkTextureSidecar.h>
+#import <JotUI/JotInkTileSet.h>
+#import <JotUI/JotDirtyTileTracker.h>
+#import <JotUI/JotStrokeFile.h>
+#import <JotUI/JotImmutableStroke.h>
+#import <JotUI/JotPageJournal.h>
+#import <JotUI/JotContentHash.h>
+#import <JotUI/JotVertexCache.h>
+#import <JotUI/JotFileBatch.h>
+#import <JotUI/JotBufferPool.h>
+#import <JotUI/JotMemoryAccountant.h>
+#import <JotUI/JotGLQuadProgram.h>
+#import <JotUI/JotGLCommandBuffer.h>
+#import <JotUI/JotGLMockBackend.h>
+#import <JotUI/JotGLProfiler.h>
+#import <JotUI/JotTextureCache.h>
 
 #define kPrecision 6
 
+// a simulated cache for the memory accountant, which adjusts its
+// category as it frees its cached bytes
+typedef struct {
+    JotMemoryAccountant* accountant;
+    JotMemoryCategory category;
+    size_t cachedBytes;
+    int trimOrder;
+} JotTestMemoryPool;
+
+static int testMemoryTrimCount;
+
+static size_t JotTestMemoryPoolTrim(void* context, size_t bytesToFree) {
+    JotTestMemoryPool* pool = context;
+    size_t freed = MIN(bytesToFree, pool->cachedBytes);
+    pool->cachedBytes -= freed;
+    pool->trimOrder = ++testMemoryTrimCount;
+    JotMemoryAccountantAdjust(pool->accountant, pool->category, -(int64_t)freed);
+    return freed;
+}
+
+static void JotTestMemoryOverBudget(JotMemoryAccountant* accountant, void* context) {
+    (*(int*)context)++;
+}
+
+// a page that loads and unloads right away, without any files or GL
+@interface JotTestPageProxy : JotViewStateProxy
+
+@property(nonatomic, assign) BOOL loaded;
+@property(nonatomic, assign) NSInteger loadCount;
+
+@end
+
+@implementation JotTestPageProxy
+
+- (void)loadJotStateAsynchronously:(BOOL)async withSize:(CGSize)pagePtSize andScale:(CGFloat)scale andContext:(JotGLContext*)context andBufferManager:(JotBufferManager*)bufferManager {
+    if (!self.loaded) {
+        self.loaded = YES;
+        self.loadCount++;
+    }
+}
+
+- (void)unload {
+    self.loaded = NO;
+}
+
+- (BOOL)isStateLoaded {
+    return self.loaded;
+}
+
+- (BOOL)isStateLoading {
+    return NO;
+}
+
+- (BOOL)hasEditsToSave {
+    return NO;
+}
+
+@end
+
+// the proxy is told about each batch of strokes a progressive load adds
+@interface JotViewStateProxy (JotTestLoading)
+
+- (void)state:(JotViewState*)state didLoadStrokes:(NSArray*)loadedStrokes isFinished:(BOOL)isFinished;
+
+@end
+
+// a page saved in a directory, whose progressive load pauses after its
+// first batch of strokes until it's told to resume
+@interface JotTestProgressivePage : JotViewStateProxy <JotViewStateProxyDelegate>
+
+@property(nonatomic, strong) NSString* directory;
+@property(nonatomic, strong) dispatch_semaphore_t didPause;
+@property(nonatomic, strong) dispatch_semaphore_t resume;
+@property(nonatomic, strong) dispatch_semaphore_t didFinish;
+
+@end
+
+@implementation JotTestProgressivePage {
+    BOOL hasPaused;
+}
+
+- (id)initWithDirectory:(NSString*)directory {
+    if (self = [super initWithDelegate:nil]) {
+        self.delegate = self;
+        self.directory = directory;
+        self.loadsStrokesProgressively = YES;
+        self.didPause = dispatch_semaphore_create(0);
+        self.resume = dispatch_semaphore_create(0);
+        self.didFinish = dispatch_semaphore_create(0);
+    }
+    return self;
+}
+
+- (NSString*)jotViewStateInkPath {
+    return [self.directory stringByAppendingPathComponent:@"ink.png"];
+}
+
+- (NSString*)jotViewStatePlistPath {
+    return [self.directory stringByAppendingPathComponent:@"state.plist"];
+}
+
+- (void)didLoadState:(JotViewStateProxy*)state {
+}
+
+- (void)didUnloadState:(JotViewStateProxy*)state {
+}
+
+- (void)state:(JotViewState*)state didLoadStrokes:(NSArray*)loadedStrokes isFinished:(BOOL)isFinished {
+    if (!isFinished && !hasPaused) {
+        hasPaused = YES;
+        dispatch_semaphore_signal(self.didPause);
+        dispatch_semaphore_wait(self.resume, DISPATCH_TIME_FOREVER);
+    }
+    [super state:state didLoadStrokes:loadedStrokes isFinished:isFinished];
+    if (isFinished) {
+        dispatch_semaphore_signal(self.didFinish);
+    }
+}
+
+@end
+
+// vertex generation is protected, but the tests compare the vertices
+// that segments generate
+@interface AbstractBezierPathElement (JotTestVertices)
+
+- (struct ColorfulVertex*)generatedVertexArrayForScale:(CGFloat)scale;
+
+@end
+
 @interface JotUITests : XCTestCase
 
 @end
@@ -121,4 +269,1345 @@
     [self assertNear:[curve ctrl2].y and:113];
 }
 
+#pragma mark - Image Kernels
+
+// mostly transparent, with opaque ink and antialiased edges
+- (NSMutableData*)inkPageOfWidth:(NSUInteger)width height:(NSUInteger)height {
+    NSMutableData* data = [NSMutableData dataWithLength:width * height * 4];
+    uint8_t* px = [data mutableBytes];
+    srand(42);
+    for (NSUInteger i = 0; i < width * height; i++) {
+        uint8_t alpha = (i % 11 == 0) ? rand() % 256 : ((i % 5) ? 0 : 255);
+        px[i * 4 + 3] = alpha;
+        for (int c = 0; c < 3; c++) {
+            px[i * 4 + c] = alpha ? rand() % (alpha + 1) : 0;
+        }
+    }
+    return data;
+}
+
+- (void)testImageKernelsMatchScalarReference {
+    NSUInteger width = 301;
+    NSUInteger height = 203;
+    NSData* page = [self inkPageOfWidth:width height:height];
+    uint8_t const swizzle[4] = {2, 1, 0, 3};
+    BOOL wasVectorized = JotImageKernelsIsVectorized();
+
+    NSMutableArray* results = [NSMutableArray array];
+    for (int vectorized = 0; vectorized < 2; vectorized++) {
+        JotImageKernelsSetVectorized(vectorized && wasVectorized);
+
+        NSMutableData* pixels = [page mutableCopy];
+        JotImageFlipVertical([pixels mutableBytes], width * 4, height);
+        JotImageSwizzle([pixels mutableBytes], width * height, swizzle);
+        JotImageUnpremultiply([pixels mutableBytes], width * height);
+        JotImagePremultiply([pixels mutableBytes], width * height);
+
+        NSMutableData* thumb = [NSMutableData dataWithLength:(width / 3) * (height / 3) * 4];
+        XCTAssertTrue(JotImageResample([pixels bytes], width, height, width * 4, [thumb mutableBytes], width / 3, height / 3, (width / 3) * 4, JotImageResampleBox, YES));
+
+        [results addObject:@[pixels, thumb]];
+    }
+    JotImageKernelsSetVectorized(wasVectorized);
+
+    XCTAssertEqualObjects(results[0][0], results[1][0]);
+    XCTAssertEqualObjects(results[0][1], results[1][1]);
+
+    // flipping twice is a no-op
+    NSMutableData* flipped = [page mutableCopy];
+    JotImageFlipVertical([flipped mutableBytes], width * 4, height);
+    JotImageFlipVertical([flipped mutableBytes], width * 4, height);
+    XCTAssertEqualObjects(flipped, page);
+}
+
+- (void)testImageKernelsExportPerformance {
+    NSUInteger width = 1536;
+    NSUInteger height = 2048;
+    NSMutableData* page = [self inkPageOfWidth:width height:height];
+    NSMutableData* thumb = [NSMutableData dataWithLength:(width / 4) * (height / 4) * 4];
+
+    [self measureBlock:^{
+        JotImageFlipVertical([page mutableBytes], width * 4, height);
+        JotImageResample([page bytes], width, height, width * 4, [thumb mutableBytes], width / 4, height / 4, (width / 4) * 4, JotImageResampleBox, YES);
+    }];
+}
+
+#pragma mark - PNG Writer
+
+- (NSData*)straightPixelsOfPNG:(NSData*)png width:(size_t)width height:(size_t)height {
+    UIImage* image = [UIImage imageWithData:png];
+    XCTAssertNotNil(image);
+    XCTAssertEqual(CGImageGetWidth(image.CGImage), width);
+    XCTAssertEqual(CGImageGetHeight(image.CGImage), height);
+
+    NSMutableData* pixels = [NSMutableData dataWithLength:width * height * 4];
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef bitmapContext = CGBitmapContextCreate([pixels mutableBytes], width, height, 8, width * 4, colorSpace, kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big);
+    CGContextDrawImage(bitmapContext, CGRectMake(0, 0, width, height), image.CGImage);
+    CGContextRelease(bitmapContext);
+    CGColorSpaceRelease(colorSpace);
+    return pixels;
+}
+
+- (void)testPNGWriterOutputDecodes {
+    NSUInteger width = 640;
+    NSUInteger height = 900;
+    NSMutableData* page = [self inkPageOfWidth:width height:height];
+    JotImageUnpremultiply([page mutableBytes], width * height);
+
+    NSMutableArray* decoded = [NSMutableArray array];
+    JotPNGWriterOptions options[2] = {JotPNGWriterFastOptions(), JotPNGWriterCompactOptions()};
+    for (int i = 0; i < 2; i++) {
+        size_t length = 0;
+        uint8_t* png = JotPNGWriterEncode([page bytes], width, height, width * 4, &options[i], &length);
+        XCTAssertTrue(png != NULL);
+        NSData* data = [NSData dataWithBytesNoCopy:png length:length freeWhenDone:YES];
+        [decoded addObject:[self straightPixelsOfPNG:data width:width height:height]];
+    }
+
+    // sliced, run length and single stream deflate all decode to the same page
+    XCTAssertEqualObjects(decoded[0], decoded[1]);
+}
+
+- (void)testPNGEncodersDecodeAlike {
+    NSUInteger width = 320;
+    NSUInteger height = 450;
+    NSMutableData* page = [self inkPageOfWidth:width height:height];
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGDataProviderRef provider = CGDataProviderCreateWithCFData((__bridge CFDataRef)page);
+    CGImageRef cgImage = CGImageCreate(width, height, 8, 32, width * 4, colorSpace, kCGBitmapByteOrderDefault | kCGImageAlphaPremultipliedLast,
+                                       provider, NULL, NO, kCGRenderingIntentDefault);
+    UIImage* image = [UIImage imageWithCGImage:cgImage];
+    CGImageRelease(cgImage);
+    CGDataProviderRelease(provider);
+    CGColorSpaceRelease(colorSpace);
+
+    XCTAssertEqual([[JotPNGEncoder compactEncoder] mode], JotPNGEncoderModeCompact);
+    NSData* fast = [[JotPNGEncoder fastEncoder] encodedDataForImage:image];
+    NSData* compact = [[JotPNGEncoder compactEncoder] encodedDataForImage:image];
+    XCTAssertEqualObjects([self straightPixelsOfPNG:compact width:width height:height], [self straightPixelsOfPNG:fast width:width height:height]);
+}
+
+- (void)testPNGWriterReusesUnchangedBands {
+    NSUInteger width = 640;
+    NSUInteger height = 900;
+    NSMutableData* page = [self inkPageOfWidth:width height:height];
+    JotImageUnpremultiply([page mutableBytes], width * height);
+    JotPNGWriterOptions options = JotPNGWriterFastOptions();
+    size_t bandCount = (height + 63) / 64;
+
+    size_t length = 0;
+    size_t encodedBands = 0;
+    uint8_t* png = JotPNGWriterEncodeBands([page bytes], width, height, width * 4, 64, NULL, 0, &options, &length, &encodedBands);
+    XCTAssertTrue(png != NULL);
+    XCTAssertEqual(encodedBands, bandCount);
+    NSData* saved = [NSData dataWithBytesNoCopy:png length:length freeWhenDone:YES];
+
+    // an unchanged page is copied from the last save byte for byte
+    png = JotPNGWriterEncodeBands([page bytes], width, height, width * 4, 64, [saved bytes], [saved length], &options, &length, &encodedBands);
+    XCTAssertEqual(encodedBands, 0);
+    XCTAssertEqualObjects([NSData dataWithBytesNoCopy:png length:length freeWhenDone:YES], saved);
+
+    // a change in one band encodes that band, and the one below it
+    // that used its rows as a dictionary
+    uint8_t* px = [page mutableBytes];
+    memset(px + (300 * width + 100) * 4, 0xFF, 20 * 4);
+    png = JotPNGWriterEncodeBands([page bytes], width, height, width * 4, 64, [saved bytes], [saved length], &options, &length, &encodedBands);
+    XCTAssertEqual(encodedBands, 2);
+    NSData* patched = [NSData dataWithBytesNoCopy:png length:length freeWhenDone:YES];
+    XCTAssertEqualObjects([self straightPixelsOfPNG:patched width:width height:height], [self straightPixelsOfPNG:[self pngOfPage:page width:width height:height] width:width height:height]);
+
+    // a damaged file is encoded from scratch
+    NSMutableData* damaged = [saved mutableCopy];
+    ((uint8_t*)[damaged mutableBytes])[[damaged length] / 2] ^= 0xFF;
+    free(JotPNGWriterEncodeBands([page bytes], width, height, width * 4, 64, [damaged bytes], [damaged length], &options, &length, &encodedBands));
+    XCTAssertEqual(encodedBands, bandCount);
+}
+
+- (NSData*)pngOfPage:(NSData*)page width:(size_t)width height:(size_t)height {
+    JotPNGWriterOptions options = JotPNGWriterCompactOptions();
+    size_t length = 0;
+    uint8_t* png = JotPNGWriterEncode([page bytes], width, height, width * 4, &options, &length);
+    return [NSData dataWithBytesNoCopy:png length:length freeWhenDone:YES];
+}
+
+- (void)testPNGWriterPerformance {
+    NSUInteger width = 1536;
+    NSUInteger height = 2048;
+    NSMutableData* page = [self inkPageOfWidth:width height:height];
+    JotPNGWriterOptions options = JotPNGWriterFastOptions();
+
+    [self measureBlock:^{
+        size_t length = 0;
+        free(JotPNGWriterEncode([page bytes], width, height, width * 4, &options, &length));
+    }];
+}
+
+#pragma mark - Texture Sidecar
+
+- (void)testLZ4RoundTrip {
+    NSArray* pages = @[[self inkPageOfWidth:640 height:900], [NSMutableData dataWithLength:640 * 900 * 4], [NSData data]];
+    for (NSData* page in pages) {
+        NSMutableData* compressed = [NSMutableData dataWithLength:JotLZ4CompressBound([page length])];
+        size_t length = JotLZ4Compress([page bytes], [page length], [compressed mutableBytes], [compressed length]);
+        XCTAssertTrue(length > 0);
+        XCTAssertTrue(length < [page length] || ![page length]);
+
+        NSMutableData* decompressed = [NSMutableData dataWithLength:[page length]];
+        XCTAssertTrue(JotLZ4Decompress([compressed bytes], length, [decompressed mutableBytes], [decompressed length]));
+        XCTAssertEqualObjects(decompressed, page);
+
+        // truncated input is rejected instead of read past
+        if (length > 1) {
+            XCTAssertFalse(JotLZ4Decompress([compressed bytes], length - 1, [decompressed mutableBytes], [decompressed length]));
+        }
+    }
+}
+
+- (void)testInkTextureSidecarRoundTrip {
+    NSUInteger width = 320;
+    NSUInteger height = 240;
+    NSData* page = [self inkPageOfWidth:width height:height];
+
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGDataProviderRef provider = CGDataProviderCreateWithCFData((__bridge CFDataRef)page);
+    CGImageRef cgImage = CGImageCreate(width, height, 8, 32, width * 4, colorSpace, kCGBitmapByteOrderDefault | kCGImageAlphaPremultipliedLast,
+                                       provider, NULL, NO, kCGRenderingIntentDefault);
+    UIImage* image = [UIImage imageWithCGImage:cgImage];
+    CGImageRelease(cgImage);
+    CGDataProviderRelease(provider);
+    CGColorSpaceRelease(colorSpace);
+
+    NSString* path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"sidecar-ink.png"];
+    [[[JotPNGEncoder fastEncoder] encodedDataForImage:image] writeToFile:path atomically:YES];
+    XCTAssertTrue([JotInkTextureSidecar writeSidecarForImage:image atImagePath:path]);
+
+    // the sidecar holds the page flipped for OpenGL
+    NSMutableData* expected = [page mutableCopy];
+    JotImageFlipVertical([expected mutableBytes], width * 4, height);
+    XCTAssertEqualObjects([[JotInkTextureSidecar tilesForImagePath:path withPixelSize:CGSizeMake(width, height)] denseBytes], expected);
+    XCTAssertNil([JotInkTextureSidecar tilesForImagePath:path withPixelSize:CGSizeMake(width / 2, height / 2)]);
+
+    // rewriting the image makes the sidecar stale
+    [[NSData dataWithBytes:"stale" length:5] writeToFile:path atomically:YES];
+    XCTAssertNil([JotInkTextureSidecar tilesForImagePath:path withPixelSize:CGSizeMake(width, height)]);
+
+    [JotInkTextureSidecar removeSidecarForImagePath:path];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+#pragma mark - Ink Tiles
+
+- (void)testInkTilesRoundTrip {
+    // odd sizes so that the right and bottom tiles are cropped
+    NSUInteger width = 300;
+    NSUInteger height = 200;
+    NSMutableData* page = [NSMutableData dataWithLength:width * height * 4];
+    uint8_t* px = [page mutableBytes];
+    // one dot in the first tile, and a line across the last row of tiles
+    px[(3 * width + 5) * 4 + 3] = 255;
+    for (NSUInteger x = 70; x < width; x++) {
+        px[(199 * width + x) * 4 + 1] = 128;
+        px[(199 * width + x) * 4 + 3] = 128;
+    }
+
+    JotInkTileSet* tiles = [JotInkTileSet tileSetWithPixels:px bytesPerRow:width * 4 pixelSize:CGSizeMake(width, height)];
+    JotInkTileGrid grid = [tiles grid];
+    XCTAssertEqual(grid.columns, 5);
+    XCTAssertEqual(grid.rows, 4);
+    XCTAssertEqual(tiles.nonEmptyTileCount, 1 + 4);
+    XCTAssertTrue(tiles.fullByteSize < [page length] / 3);
+    XCTAssertEqualObjects([tiles denseBytes], page);
+
+    // a blank page is only its bitmap
+    NSData* blank = [NSMutableData dataWithLength:width * height * 4];
+    JotInkTileSet* blankTiles = [JotInkTileSet tileSetWithPixels:[blank bytes] bytesPerRow:width * 4 pixelSize:CGSizeMake(width, height)];
+    XCTAssertEqual(blankTiles.nonEmptyTileCount, 0);
+    XCTAssertEqual([blankTiles.packedTiles length], 0);
+    XCTAssertEqualObjects([blankTiles denseBytes], blank);
+
+    // the bitmap and tiles have to agree
+    XCTAssertNil([[JotInkTileSet alloc] initWithPixelSize:tiles.pixelSize andTileSize:tiles.tileSize andBitmap:tiles.bitmap andPackedTiles:blankTiles.packedTiles]);
+}
+
+- (void)testInkTilesPatch {
+    NSUInteger width = 300;
+    NSUInteger height = 200;
+    NSMutableData* page = [self inkPageOfWidth:width height:height];
+    JotInkTileSet* saved = [JotInkTileSet tileSetWithPixels:[page bytes] bytesPerRow:width * 4 pixelSize:CGSizeMake(width, height)];
+
+    // erase one tile, and draw into another
+    uint8_t* px = [page mutableBytes];
+    for (NSUInteger y = 0; y < 64; y++) {
+        memset(px + (y * width + 64) * 4, 0, 64 * 4);
+    }
+    px[(150 * width + 250) * 4 + 3] = 255;
+
+    JotDirtyTileTracker* tracker = [[JotDirtyTileTracker alloc] initWithPixelSize:CGSizeMake(width, height)];
+    NSUInteger generation = 0;
+    JotInkTileSet* savedTiles = nil;
+    [tracker markCleanForPath:@"ink.png" withTiles:saved];
+    [tracker markDirtyInRect:CGRectMake(64, 0, 64, 64)];
+    [tracker markDirtyInRect:CGRectMake(248, 148, 4, 4)];
+    NSData* dirtyTiles = [tracker beginSaveToPath:@"ink.png" savedTiles:&savedTiles generation:&generation];
+    XCTAssertNotNil(dirtyTiles);
+    XCTAssertEqual(savedTiles, saved);
+
+    JotInkTileSet* patch = [JotInkTileSet tileSetWithPixelSize:CGSizeMake(width, height)
+                                                  readingTiles:dirtyTiles
+                                                     fromBands:^(CGRect pixelRect, uint8_t* band) {
+                                                         for (NSUInteger y = 0; y < pixelRect.size.height; y++) {
+                                                             memcpy(band + y * (size_t)pixelRect.size.width * 4, px + ((y + (size_t)pixelRect.origin.y) * width + (size_t)pixelRect.origin.x) * 4, pixelRect.size.width * 4);
+                                                         }
+                                                     }];
+    // the erased tile is dropped from the patch
+    XCTAssertEqual(patch.nonEmptyTileCount, 1);
+    XCTAssertEqualObjects([[saved tileSetByApplyingPatch:patch inTiles:dirtyTiles] denseBytes], page);
+}
+
+- (void)testDirtyTileTrackerOnlyPatchesSavedInk {
+    CGSize pixelSize = CGSizeMake(640, 480);
+    NSData* blank = [NSMutableData dataWithLength:640 * 480 * 4];
+    JotInkTileSet* tiles = [JotInkTileSet tileSetWithPixels:[blank bytes] bytesPerRow:640 * 4 pixelSize:pixelSize];
+    JotDirtyTileTracker* tracker = [[JotDirtyTileTracker alloc] initWithPixelSize:pixelSize];
+    NSUInteger generation = 0;
+    JotInkTileSet* savedTiles = nil;
+
+    // nothing is known to be on disk yet
+    XCTAssertNil([tracker beginSaveToPath:@"ink.png" savedTiles:&savedTiles generation:&generation]);
+    XCTAssertNil(savedTiles);
+    [tracker finishSaveToPath:@"ink.png" withTiles:tiles generation:generation];
+
+    // nothing has changed since
+    XCTAssertEqual([[tracker beginSaveToPath:@"ink.png" savedTiles:&savedTiles generation:&generation] length], 0);
+    XCTAssertEqual(savedTiles, tiles);
+
+    // while that save is in flight, nothing is known to be on disk
+    NSUInteger inFlightGeneration = generation;
+    XCTAssertNil([tracker beginSaveToPath:@"ink.png" savedTiles:&savedTiles generation:&generation]);
+    // and the older save can't claim it
+    [tracker finishSaveToPath:@"ink.png" withTiles:tiles generation:inFlightGeneration];
+    XCTAssertNil([tracker beginSaveToPath:@"ink.png" savedTiles:&savedTiles generation:&generation]);
+    [tracker finishSaveToPath:@"ink.png" withTiles:tiles generation:generation];
+
+    [tracker markDirtyInRect:CGRectMake(10, 10, 20, 20)];
+    // one bit for each of the 10x8 tiles
+    XCTAssertEqual([[tracker beginSaveToPath:@"ink.png" savedTiles:&savedTiles generation:&generation] length], 10);
+    XCTAssertEqual(savedTiles, tiles);
+    [tracker finishSaveToPath:@"ink.png" withTiles:tiles generation:generation];
+
+    // a different path needs everything
+    [tracker markDirtyInRect:CGRectMake(10, 10, 20, 20)];
+    XCTAssertNil([tracker beginSaveToPath:@"other.png" savedTiles:&savedTiles generation:&generation]);
+
+    // and so does a failed save
+    [tracker finishSaveToPath:@"other.png" withTiles:nil generation:generation];
+    XCTAssertNil([tracker beginSaveToPath:@"other.png" savedTiles:&savedTiles generation:&generation]);
+}
+
+#pragma mark - Stroke Files
+
+// a stroke dictionary shaped like -[JotStroke asDictionary]
+- (NSDictionary*)strokeDictionaryWithSegments:(NSUInteger)count {
+    NSDictionary* color = @{ @"red": [NSNumber numberWithFloat:.2],
+                             @"green": [NSNumber numberWithFloat:.4],
+                             @"blue": [NSNumber numberWithFloat:.6],
+                             @"alpha": [NSNumber numberWithFloat:.8] };
+    NSMutableArray* segments = [NSMutableArray array];
+    CGPoint point = CGPointMake(100, 200);
+    [segments addObject:@{ @"class": @"MoveToPathElement",
+                           @"startPoint.x": [NSNumber numberWithFloat:point.x],
+                           @"startPoint.y": [NSNumber numberWithFloat:point.y],
+                           @"width": [NSNumber numberWithFloat:6],
+                           @"color": color,
+                           @"previousColor": [NSDictionary dictionary],
+                           @"followsMoveTo": [NSNumber numberWithBool:NO],
+                           @"renderVersion": [NSNumber numberWithInteger:2] }];
+    for (NSUInteger i = 1; i < count; i++) {
+        CGPoint next = CGPointMake(point.x + (i % 7) / 3.0, point.y - (i % 5) / 7.0);
+        [segments addObject:@{ @"class": @"CurveToPathElement",
+                               @"startPoint.x": [NSNumber numberWithFloat:point.x],
+                               @"startPoint.y": [NSNumber numberWithFloat:point.y],
+                               @"curveTo.x": [NSNumber numberWithFloat:next.x],
+                               @"curveTo.y": [NSNumber numberWithFloat:next.y],
+                               @"ctrl1.x": [NSNumber numberWithFloat:(point.x * 2 + next.x) / 3],
+                               @"ctrl1.y": [NSNumber numberWithFloat:(point.y * 2 + next.y) / 3],
+                               @"ctrl2.x": [NSNumber numberWithFloat:(point.x + next.x * 2) / 3],
+                               @"ctrl2.y": [NSNumber numberWithFloat:(point.y + next.y * 2) / 3],
+                               @"width": [NSNumber numberWithFloat:6 + (i % 3) * .25],
+                               @"rotation": [NSNumber numberWithFloat:-0.0],
+                               @"color": color,
+                               @"previousColor": color,
+                               @"followsMoveTo": [NSNumber numberWithBool:i == 1],
+                               @"renderVersion": [NSNumber numberWithInteger:2],
+                               @"vertexBuffer": [NSData dataWithBytes:&next length:sizeof(next)],
+                               @"numberOfBytesOfVertexData": [NSNumber numberWithFloat:sizeof(next)] }];
+        point = next;
+    }
+    return @{ @"class": @"JotStroke",
+              @"segments": segments,
+              @"segmentSmoother": @{ @"point0": @"{1, 2}", @"point1": @"{3, 4}", @"point2": @"{5, 6}", @"point3": @"{7, 8}" },
+              @"texture": @{ @"class": @"JotDefaultBrushTexture" } };
+}
+
+- (void)testStrokeFileConvertsPlistsLosslessly {
+    NSDictionary* stroke = [self strokeDictionaryWithSegments:200];
+    NSString* plistPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"stroke.strokedata"];
+    NSString* path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"stroke.jotstroke"];
+    XCTAssertTrue([stroke writeToFile:plistPath atomically:YES]);
+    XCTAssertTrue([JotStrokeFile convertPlistAtPath:plistPath toPath:path]);
+
+    NSDictionary* fromPlist = [NSDictionary dictionaryWithContentsOfFile:plistPath];
+    NSMutableDictionary* fromBinary = [JotStrokeFile strokeDictionaryAtPath:path];
+    XCTAssertEqualObjects(fromBinary, fromPlist);
+    XCTAssertEqualObjects([JotStrokeFile strokeDictionaryFromData:[JotStrokeFile dataForStrokeDictionary:stroke]], stroke);
+    XCTAssertLessThan([[[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil] fileSize],
+                      [[[NSFileManager defaultManager] attributesOfItemAtPath:plistPath error:nil] fileSize]);
+
+    // segments load through initFromDictionary:, which adds keys to them
+    [[[fromBinary objectForKey:@"segments"] firstObject] setObject:@1 forKey:@"scale"];
+
+    // any damage is caught by the checksum
+    NSMutableData* corrupt = [[JotStrokeFile dataForStrokeDictionary:stroke] mutableCopy];
+    ((uint8_t*)[corrupt mutableBytes])[[corrupt length] / 2] ^= 1;
+    XCTAssertNil([JotStrokeFile strokeDictionaryFromData:corrupt]);
+    XCTAssertNil([JotStrokeFile strokeDictionaryFromData:[corrupt subdataWithRange:NSMakeRange(0, 20)]]);
+
+    [[NSFileManager defaultManager] removeItemAtPath:plistPath error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void)testLazyStrokeDecodesSegmentsOnFirstUse {
+    NSMutableDictionary* saved = [[self strokeDictionaryWithSegments:50] mutableCopy];
+    [saved setObject:[NSNumber numberWithLongLong:12345] forKey:@"contentHash"];
+    [saved setObject:[NSNumber numberWithFloat:10] forKey:@"bounds.x"];
+    [saved setObject:[NSNumber numberWithFloat:20] forKey:@"bounds.y"];
+    [saved setObject:[NSNumber numberWithFloat:30] forKey:@"bounds.width"];
+    [saved setObject:[NSNumber numberWithFloat:40] forKey:@"bounds.height"];
+    NSString* path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"lazy.jotstroke"];
+    XCTAssertTrue([JotStrokeFile writeStrokeDictionary:saved toPath:path]);
+
+    NSMutableDictionary* opened = [JotStrokeFile strokeDictionaryAtPath:path withLazySegments:YES];
+    XCTAssertNil([opened objectForKey:@"segments"]);
+    XCTAssertNotNil([opened objectForKey:kJotStrokeSegmentDataKey]);
+
+    JotStroke* stroke = [[JotStroke alloc] initFromDictionary:opened];
+    XCTAssertFalse([stroke hasLoadedSegments]);
+    XCTAssertEqual([stroke contentHash], 12345);
+    XCTAssertTrue(CGRectEqualToRect([stroke bounds], CGRectMake(10, 20, 30, 40)));
+
+    [stroke scaleSegmentsForWidth:2 andHeight:.5];
+    XCTAssertTrue(CGRectEqualToRect([stroke bounds], CGRectMake(20, 10, 60, 20)));
+    XCTAssertFalse([stroke hasLoadedSegments]);
+
+    XCTAssertEqual([[stroke segments] count], 50);
+    XCTAssertTrue([stroke hasLoadedSegments]);
+    XCTAssertEqual([[[stroke segments] firstObject] startPoint].x, 200);
+    XCTAssertEqual([stroke contentHash], 12345);
+
+    // strokes without a saved hash are read in full
+    [saved removeObjectForKey:@"contentHash"];
+    XCTAssertTrue([JotStrokeFile writeStrokeDictionary:saved toPath:path]);
+    XCTAssertEqual([[[JotStrokeFile strokeDictionaryAtPath:path withLazySegments:YES] objectForKey:kJotStrokeSegmentColumnsKey] count], 50);
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void)testLazyStrokeWithCorruptSegmentsIsNotSaved {
+    NSMutableDictionary* saved = [[self strokeDictionaryWithSegments:50] mutableCopy];
+    [saved setObject:[NSNumber numberWithLongLong:12345] forKey:@"contentHash"];
+    [saved setObject:[NSNumber numberWithFloat:10] forKey:@"bounds.x"];
+    [saved setObject:[NSNumber numberWithFloat:20] forKey:@"bounds.y"];
+    [saved setObject:[NSNumber numberWithFloat:30] forKey:@"bounds.width"];
+    [saved setObject:[NSNumber numberWithFloat:40] forKey:@"bounds.height"];
+    [saved setObject:[NSNumber numberWithInteger:4096] forKey:@"totalNumberOfBytes"];
+    NSMutableData* data = [[JotStrokeFile dataForStrokeDictionary:saved] mutableCopy];
+    ((uint8_t*)[data mutableBytes])[[data length] - 1] ^= 0xFF;
+
+    // the start of the file is fine, so the stroke opens lazily
+    JotStroke* stroke = [[JotStroke alloc] initFromDictionary:[JotStrokeFile strokeDictionaryFromData:data withLazySegments:YES]];
+    XCTAssertEqual([stroke totalNumberOfBytes], 4096);
+    XCTAssertEqual([stroke fullByteSize], 4096);
+    XCTAssertFalse([stroke hasCorruptSegments]);
+
+    XCTAssertEqual([[stroke segments] count], 0);
+    XCTAssertTrue([stroke hasCorruptSegments]);
+    XCTAssertFalse([stroke hasLoadedSegments]);
+    XCTAssertTrue(CGRectEqualToRect([stroke bounds], CGRectMake(10, 20, 30, 40)));
+    XCTAssertNil([stroke asDictionary]);
+    XCTAssertNil([[[JotImmutableStroke alloc] initWithJotStroke:stroke] asDictionary]);
+}
+
+- (void)testStrokeFromSegmentColumnsMatchesStrokeFromDictionaries {
+    NSData* data = [JotStrokeFile dataForStrokeDictionary:[self strokeDictionaryWithSegments:50]];
+    NSMutableDictionary* fromColumns = [JotStrokeFile strokeDictionaryFromData:data withLazySegments:NO];
+    NSMutableDictionary* fromDictionaries = [JotStrokeFile strokeDictionaryFromData:data];
+    XCTAssertNil([fromColumns objectForKey:@"segments"]);
+    XCTAssertEqual([[fromColumns objectForKey:kJotStrokeSegmentColumnsKey] count], 50);
+
+    JotStroke* stroke = [[JotStroke alloc] initFromDictionary:fromColumns];
+    JotStroke* expected = [[JotStroke alloc] initFromDictionary:fromDictionaries];
+    XCTAssertEqual([[stroke segments] count], [[expected segments] count]);
+    XCTAssertEqual([stroke contentHash], [expected contentHash]);
+    XCTAssertEqualObjects([[stroke segments] jotMapWithSelector:@selector(asDictionary)], [[expected segments] jotMapWithSelector:@selector(asDictionary)]);
+}
+
+- (void)testPageJournalRecoversFromTornSave {
+    NSString* statePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"journal-state.plist"];
+    NSString* path = [JotPageJournal journalPathForStatePath:statePath];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+
+    NSData* stroke1 = [JotStrokeFile dataForStrokeDictionary:[self strokeDictionaryWithSegments:20]];
+    NSData* stroke2 = [JotStrokeFile dataForStrokeDictionary:[self strokeDictionaryWithSegments:30]];
+    JotPageJournal* journal = [JotPageJournal journalForStatePath:statePath];
+    XCTAssertNil(journal.state);
+    XCTAssertTrue([journal saveState:@{ @"stackOfStrokes": @[@"a", @"b"] } withStrokes:@[@"a", @"b"] andStrokeData:@{ @"a": stroke1, @"b": stroke1 }]);
+    XCTAssertTrue([journal saveState:@{ @"stackOfStrokes": @[@"b", @"c"] } withStrokes:@[@"b", @"c"] andStrokeData:@{ @"c": stroke2 }]);
+    XCTAssertFalse([journal containsStroke:@"a"]);
+    XCTAssertEqualObjects([journal dataForStroke:@"c"], stroke2);
+
+    // a save that was cut short leaves part of a record at the end
+    NSFileHandle* handle = [NSFileHandle fileHandleForWritingAtPath:path];
+    [handle seekToEndOfFile];
+    [handle writeData:[stroke2 subdataWithRange:NSMakeRange(0, 100)]];
+    [handle closeFile];
+
+    JotPageJournal* reopened = [JotPageJournal journalForStatePath:statePath];
+    XCTAssertNotEqual(reopened, journal);
+    XCTAssertEqualObjects(reopened.state, (@{ @"stackOfStrokes": @[@"b", @"c"] }));
+    XCTAssertEqualObjects([reopened dataForStroke:@"b"], stroke1);
+    XCTAssertEqual([[[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil] fileSize], reopened.liveBytes + reopened.deadBytes);
+
+    // compacting drops the replaced and removed records
+    XCTAssertGreaterThan(reopened.deadBytes, 0);
+    XCTAssertTrue([reopened compact]);
+    XCTAssertEqual(reopened.deadBytes, 0);
+    XCTAssertEqualObjects([reopened dataForStroke:@"c"], stroke2);
+    XCTAssertEqual([JotPageJournal journalForStatePath:statePath], reopened);
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void)testStrokesThatDifferOnlyInColorHashDifferently {
+    NSDictionary* red = @{ @"red": [NSNumber numberWithFloat:1],
+                           @"green": [NSNumber numberWithFloat:0],
+                           @"blue": [NSNumber numberWithFloat:0],
+                           @"alpha": [NSNumber numberWithFloat:1] };
+    NSMutableDictionary* redStroke = [[self strokeDictionaryWithSegments:20] mutableCopy];
+    [redStroke setObject:[[redStroke objectForKey:@"segments"] jotMap:^id(NSDictionary* segment, NSUInteger index) {
+        NSMutableDictionary* redSegment = [segment mutableCopy];
+        [redSegment setObject:red forKey:@"color"];
+        return redSegment;
+    }] forKey:@"segments"];
+
+    JotStroke* stroke = [[JotStroke alloc] initFromDictionary:[self strokeDictionaryWithSegments:20]];
+    JotStroke* sameStroke = [[JotStroke alloc] initFromDictionary:[self strokeDictionaryWithSegments:20]];
+    JotStroke* redCopy = [[JotStroke alloc] initFromDictionary:redStroke];
+    XCTAssertEqual([stroke contentHash], [sameStroke contentHash]);
+    XCTAssertNotEqual([stroke contentHash], [redCopy contentHash]);
+    XCTAssertNotEqualObjects([stroke uuid], [redCopy uuid]);
+
+    // an empty stroke starts from its brush's hash, not a constant
+    JotStroke* emptyStroke = [[JotStroke alloc] initFromDictionary:@{}];
+    XCTAssertNotEqual([emptyStroke contentHash], 1);
+}
+
+- (void)testResizedSegmentsDrawLikeSegmentsDrawnAtTheNewSize {
+    JotStroke* drawn = [[JotStroke alloc] initFromDictionary:[self strokeDictionaryWithSegments:20]];
+    JotStroke* resized = [[JotStroke alloc] initFromDictionary:[self strokeDictionaryWithSegments:20]];
+    JotStroke* retina = [[JotStroke alloc] initFromDictionary:[self strokeDictionaryWithSegments:20]];
+    for (NSUInteger i = 0; i < [[drawn segments] count]; i++) {
+        [[[drawn segments] objectAtIndex:i] generatedVertexArrayForScale:1];
+        [[[retina segments] objectAtIndex:i] generatedVertexArrayForScale:2];
+        // vertices are in points, so the screen scale doesn't change them
+        XCTAssertEqualObjects([[[drawn segments] objectAtIndex:i] vertexBuffer], [[[retina segments] objectAtIndex:i] vertexBuffer]);
+    }
+
+    // a segment that's resized after it's drawn spaces and sizes its
+    // dots like one that's only ever drawn at the new size
+    [drawn scaleSegmentsForWidth:2 andHeight:.5];
+    [resized scaleSegmentsForWidth:2 andHeight:.5];
+    for (NSUInteger i = 0; i < [[drawn segments] count]; i++) {
+        AbstractBezierPathElement* drawnSegment = [[drawn segments] objectAtIndex:i];
+        AbstractBezierPathElement* resizedSegment = [[resized segments] objectAtIndex:i];
+        XCTAssertNil([drawnSegment vertexBuffer]);
+        [drawnSegment generatedVertexArrayForScale:2];
+        [resizedSegment generatedVertexArrayForScale:2];
+        XCTAssertEqualObjects([drawnSegment vertexBuffer], [resizedSegment vertexBuffer]);
+    }
+
+    // the point shaders keep dots half a pixel wide, so hairlines
+    // aren't widened to half a point at 2x
+    NSMutableDictionary* hairline = [[self strokeDictionaryWithSegments:3] mutableCopy];
+    [hairline setObject:[[hairline objectForKey:@"segments"] jotMap:^id(NSDictionary* segment, NSUInteger index) {
+        NSMutableDictionary* thinSegment = [segment mutableCopy];
+        [thinSegment setObject:[NSNumber numberWithFloat:.3] forKey:@"width"];
+        return thinSegment;
+    }] forKey:@"segments"];
+    JotStroke* thin = [[JotStroke alloc] initFromDictionary:hairline];
+    AbstractBezierPathElement* thinSegment = [[thin segments] lastObject];
+    // its color doesn't change, so its vertices are colorless
+    struct ColorlessVertex* vertices = (struct ColorlessVertex*)[thinSegment generatedVertexArrayForScale:2];
+    XCTAssertGreaterThan([[thinSegment vertexBuffer] length], 0);
+    XCTAssertLessThan(vertices[0].Size, .5);
+}
+
+- (void)testContentHashes {
+    XCTAssertEqual(JotContentHash("abc", 3, 0), 0x44BC2CF5AD770999ULL);
+
+    // segments that differ by less than a point don't collide
+    MoveToPathElement* moveTo1 = [MoveToPathElement elementWithMoveTo:CGPointMake(10.25, 20)];
+    MoveToPathElement* moveTo2 = [MoveToPathElement elementWithMoveTo:CGPointMake(10.5, 20)];
+    XCTAssertNotEqual([moveTo1 contentHash], [moveTo2 contentHash]);
+    XCTAssertEqual([[MoveToPathElement elementWithMoveTo:CGPointMake(0, 1)] contentHash],
+                   [[MoveToPathElement elementWithMoveTo:CGPointMake(-0.0, 1)] contentHash]);
+
+    // popping and removing from the bottom undo pushes exactly
+    JotStackHash stack;
+    JotStackHash expected;
+    JotStackHashInit(&stack);
+    JotStackHashInit(&expected);
+    for (uint64_t value = 1; value <= 20; value++) {
+        JotStackHashPush(&stack, value * 0x9E3779B97F4A7C15ULL);
+    }
+    for (uint64_t value = 1; value <= 5; value++) {
+        JotStackHashRemoveBottom(&stack, value * 0x9E3779B97F4A7C15ULL);
+    }
+    JotStackHashPop(&stack, 20 * 0x9E3779B97F4A7C15ULL);
+    for (uint64_t value = 6; value <= 19; value++) {
+        JotStackHashPush(&expected, value * 0x9E3779B97F4A7C15ULL);
+    }
+    XCTAssertEqual(stack.hash, expected.hash);
+    XCTAssertEqual(stack.count, 14);
+
+    // inserting under the bottom is the same as pushing first, which is
+    // how progressively loaded strokes end up under newer ones
+    for (uint64_t value = 5; value >= 1; value--) {
+        JotStackHashInsertBottom(&stack, value * 0x9E3779B97F4A7C15ULL);
+    }
+    JotStackHashPush(&stack, 20 * 0x9E3779B97F4A7C15ULL);
+    JotStackHashInit(&expected);
+    for (uint64_t value = 1; value <= 20; value++) {
+        JotStackHashPush(&expected, value * 0x9E3779B97F4A7C15ULL);
+    }
+    XCTAssertEqual(stack.hash, expected.hash);
+    XCTAssertEqual(stack.power, expected.power);
+    XCTAssertEqual(stack.count, 20);
+}
+
+- (void)testVertexCacheRoundTrip {
+    NSMutableData* repetitive = [NSMutableData dataWithLength:4096];
+    memset([repetitive mutableBytes], 7, [repetitive length]);
+    uint8_t noise[37];
+    for (int i = 0; i < sizeof(noise); i++) {
+        noise[i] = (uint8_t)(i * 97 + 13);
+    }
+    NSArray* vertexBuffers = @[repetitive, [NSNull null], [NSData dataWithBytes:noise length:sizeof(noise)]];
+
+    NSData* data = [JotVertexCache dataForVertexBuffers:vertexBuffers withBrushHash:42];
+    XCTAssertLessThan([data length], [repetitive length]);
+    XCTAssertEqualObjects([JotVertexCache vertexBuffersFromData:data withBrushHash:42], vertexBuffers);
+    XCTAssertEqualObjects([JotVertexCache vertexBuffersFromData:[JotVertexCache dataForVertexBuffers:@[] withBrushHash:42] withBrushHash:42], @[]);
+
+    // buffers made with a different brush aren't used
+    XCTAssertNil([JotVertexCache vertexBuffersFromData:data withBrushHash:43]);
+
+    // a cut or damaged record is ignored, and the buffers are generated again
+    XCTAssertNil([JotVertexCache vertexBuffersFromData:[data subdataWithRange:NSMakeRange(0, [data length] - 1)] withBrushHash:42]);
+    NSMutableData* damaged = [data mutableCopy];
+    ((uint32_t*)[damaged mutableBytes])[0] += 1;
+    XCTAssertNil([JotVertexCache vertexBuffersFromData:damaged withBrushHash:42]);
+}
+
+- (void)testFileBatchCommitsTogether {
+    NSString* directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+    NSString* ink = [directory stringByAppendingPathComponent:@"ink.png"];
+    NSString* thumb = [directory stringByAppendingPathComponent:@"thumb.png"];
+    NSString* stale = [directory stringByAppendingPathComponent:@"ink.png.jottex"];
+    [[NSData dataWithBytes:"old" length:3] writeToFile:ink atomically:YES];
+    [[NSData dataWithBytes:"stale" length:5] writeToFile:stale atomically:YES];
+
+    // nothing changes until the batch commits, and an abandoned batch leaves nothing behind
+    JotFileBatch* batch = JotFileBatchCreate();
+    XCTAssertTrue(JotFileBatchAdd(batch, [ink fileSystemRepresentation], "new ink", 7) != NULL);
+    XCTAssertTrue(JotFileBatchAdd(batch, [thumb fileSystemRepresentation], "thumb", 5) != NULL);
+    XCTAssertTrue(JotFileBatchRemove(batch, [stale fileSystemRepresentation]));
+    XCTAssertEqualObjects([NSData dataWithContentsOfFile:ink], [NSData dataWithBytes:"old" length:3]);
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:thumb]);
+    XCTAssertTrue(JotFileBatchCommit(batch));
+    XCTAssertEqual(JotFileBatchDirectorySyncCount(batch), 1);
+    JotFileBatchFree(batch);
+
+    XCTAssertEqualObjects([NSData dataWithContentsOfFile:ink], [NSData dataWithBytes:"new ink" length:7]);
+    XCTAssertEqualObjects([NSData dataWithContentsOfFile:thumb], [NSData dataWithBytes:"thumb" length:5]);
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:stale]);
+
+    batch = JotFileBatchCreate();
+    XCTAssertTrue(JotFileBatchAdd(batch, [thumb fileSystemRepresentation], "abandoned", 9) != NULL);
+    JotFileBatchFree(batch);
+    XCTAssertEqualObjects([NSData dataWithContentsOfFile:thumb], [NSData dataWithBytes:"thumb" length:5]);
+    NSArray* contents = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:directory error:nil];
+    XCTAssertEqual([contents count], 2);
+
+    // temp files that a crash left behind are cleaned up, but not
+    // the temp files of batches that started since
+    NSString* crashed = [directory stringByAppendingPathComponent:@"ink.png.jottmp.a1b2c3"];
+    NSString* inFlight = [directory stringByAppendingPathComponent:@"thumb.png.jottmp.d4e5f6"];
+    [[NSData dataWithBytes:"torn" length:4] writeToFile:crashed atomically:NO];
+    [[NSData dataWithBytes:"saving" length:6] writeToFile:inFlight atomically:NO];
+    [[NSFileManager defaultManager] setAttributes:@{NSFileModificationDate: [NSDate dateWithTimeIntervalSinceNow:-60]} ofItemAtPath:crashed error:nil];
+    XCTAssertEqual(JotFileBatchRemoveStaleFiles([directory fileSystemRepresentation], time(NULL) - 30), 1);
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:crashed]);
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:inFlight]);
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:ink]);
+
+    [[NSFileManager defaultManager] removeItemAtPath:directory error:nil];
+}
+
+- (void)testBufferPoolSizeClassesAndTrim {
+    XCTAssertEqual(JotBufferPoolCapacityForSize(1), 4096);
+    XCTAssertEqual(JotBufferPoolCapacityForSize(4097), 6144);
+    XCTAssertEqual(JotBufferPoolCapacityForSize(6145), 8192);
+    XCTAssertEqual(JotBufferPoolCapacityForSize(1024 * 1024 + 1), 1536 * 1024);
+
+    JotBufferPool* pool = JotBufferPoolCreate(16 * 1024 * 1024);
+    JotBufferPoolStats stats;
+    size_t capacities[4];
+    void* buffers[4];
+    for (int i = 0; i < 4; i++) {
+        buffers[i] = JotBufferPoolAlloc(pool, 1000 * 1000, &capacities[i]);
+        XCTAssertEqual(capacities[i], 1024 * 1024);
+    }
+    for (int i = 0; i < 4; i++) {
+        JotBufferPoolRelease(pool, buffers[i], capacities[i]);
+    }
+    JotBufferPoolGetStats(pool, &stats);
+    XCTAssertEqual(stats.cachedBytes, 4 * 1024 * 1024);
+    XCTAssertEqual(stats.outstandingBytes, 0);
+
+    // a small request isn't served by a big cached buffer
+    void* small = JotBufferPoolAlloc(pool, 100, &capacities[0]);
+    XCTAssertEqual(capacities[0], 4096);
+    JotBufferPoolRelease(pool, small, capacities[0]);
+
+    // a trim lowers the high water mark, so afterward the class
+    // only caches as many buffers as it's used at once since
+    JotBufferPoolTrim(pool, 0);
+    JotBufferPoolGetStats(pool, &stats);
+    XCTAssertEqual(stats.cachedBytes, 0);
+    buffers[0] = JotBufferPoolAlloc(pool, 1000 * 1000, &capacities[0]);
+    buffers[1] = JotBufferPoolAlloc(pool, 1000 * 1000, &capacities[1]);
+    JotBufferPoolRelease(pool, buffers[0], capacities[0]);
+    JotBufferPoolRelease(pool, buffers[1], capacities[1]);
+    buffers[0] = JotBufferPoolAlloc(pool, 1000 * 1000, &capacities[0]);
+    JotBufferPoolTrim(pool, 0);
+    JotBufferPoolRelease(pool, buffers[0], capacities[0]);
+    JotBufferPoolGetStats(pool, &stats);
+    XCTAssertEqual(stats.cachedBytes, 1024 * 1024);
+    JotBufferPoolFree(pool);
+}
+
+- (void)testStrokeBoundsFollowScaling {
+    JotStroke* measured = [[JotStroke alloc] initFromDictionary:[self strokeDictionaryWithSegments:20]];
+    JotStroke* unmeasured = [[JotStroke alloc] initFromDictionary:[self strokeDictionaryWithSegments:20]];
+    CGRect bounds = [measured bounds];
+
+    // curves cache their bounds, which have to move with their points.
+    // the other stroke's curves only measure their bounds once scaled
+    [measured scaleSegmentsForWidth:2 andHeight:.5];
+    [unmeasured scaleSegmentsForWidth:2 andHeight:.5];
+    XCTAssertFalse(CGRectEqualToRect(bounds, [measured bounds]));
+    XCTAssertTrue(CGRectEqualToRect([measured bounds], [unmeasured bounds]));
+}
+
+- (void)testMemoryAccountantTrimsByPriority {
+    JotMemoryAccountant* accountant = JotMemoryAccountantCreate();
+    JotTestMemoryPool textures = { accountant, JotMemoryCategoryTexture, 40 };
+    JotTestMemoryPool buffers = { accountant, JotMemoryCategoryVertexBuffer, 30 };
+    JotTestMemoryPool data = { accountant, JotMemoryCategoryDataCache, 50 };
+    JotMemoryAccountantAddPool(accountant, JotMemoryCategoryVertexBuffer, 20, &JotTestMemoryPoolTrim, NULL, &buffers);
+    JotMemoryAccountantAddPool(accountant, JotMemoryCategoryTexture, 10, &JotTestMemoryPoolTrim, NULL, &textures);
+    JotMemoryAccountantAddPool(accountant, JotMemoryCategoryDataCache, 0, &JotTestMemoryPoolTrim, NULL, &data);
+    int overBudgetCount = 0;
+    JotMemoryAccountantSetOverBudgetHandler(accountant, &JotTestMemoryOverBudget, &overBudgetCount);
+    JotMemoryAccountantSetBudget(accountant, JotMemoryDomainGPU, 150);
+
+    JotMemoryAccountantAdjust(accountant, JotMemoryCategoryTexture, 140);
+    JotMemoryAccountantAdjust(accountant, JotMemoryCategoryVertexBuffer, 50);
+    JotMemoryAccountantAdjust(accountant, JotMemoryCategoryDataCache, 50);
+    XCTAssertEqual(overBudgetCount, 1);
+    XCTAssertEqual(JotMemoryAccountantGetDomainBytes(accountant, JotMemoryDomainGPU), 190);
+    XCTAssertEqual(JotMemoryAccountantGetDomainBytes(accountant, JotMemoryDomainCPU), 50);
+
+    // the texture cache has enough to get back under budget on its own
+    XCTAssertEqual(JotMemoryAccountantEnforceBudget(accountant), 40);
+    XCTAssertEqual(textures.cachedBytes, 0);
+    XCTAssertEqual(buffers.trimOrder, 0);
+    XCTAssertEqual(data.trimOrder, 0);
+
+    // a warning halves each domain, lowest priority first
+    textures.cachedBytes = 5;
+    XCTAssertEqual(JotMemoryAccountantHandlePressure(accountant, JotMemoryPressureWarning), 60);
+    XCTAssertEqual(data.cachedBytes, 25);
+    XCTAssertEqual(buffers.cachedBytes, 0);
+    XCTAssertLessThan(data.trimOrder, textures.trimOrder);
+    XCTAssertLessThan(textures.trimOrder, buffers.trimOrder);
+
+    JotMemoryAccountantHandlePressure(accountant, JotMemoryPressureCritical);
+    XCTAssertEqual(data.cachedBytes, 0);
+
+    JotMemoryAccountantSetPageBytes(accountant, &textures, JotMemoryCategoryTexture, 64);
+    XCTAssertEqual(JotMemoryAccountantGetPageBytes(accountant, &textures, JotMemoryCategoryTexture), 64);
+    JotMemoryAccountantRemovePage(accountant, &textures);
+    XCTAssertEqual(JotMemoryAccountantGetPageBytes(accountant, &textures, JotMemoryCategoryTexture), 0);
+    JotMemoryAccountantFree(accountant);
+}
+
+- (void)testPageResidencyKeepsRecentPagesAndPrefetchesNeighbors {
+    NSMutableArray* pages = [NSMutableArray array];
+    for (int i = 0; i < 10; i++) {
+        [pages addObject:[[JotTestPageProxy alloc] initWithDelegate:nil]];
+    }
+    JotPageResidencyManager* residency = [[JotPageResidencyManager alloc] initWithPageSize:CGSizeMake(100, 100) andScale:1 andContext:nil andBufferManager:nil];
+    residency.pages = pages;
+    residency.maxLoadedPages = 4;
+
+    [residency showPage:pages[0]];
+    XCTAssertTrue([pages[0] loaded]);
+    XCTAssertTrue([pages[1] loaded]);
+    XCTAssertEqual(residency.missCount, 1);
+
+    // flipping forward finds each page already prefetched
+    for (int i = 1; i < 6; i++) {
+        [residency showPage:pages[i]];
+    }
+    XCTAssertEqual(residency.hitCount, 5);
+    XCTAssertEqual(residency.missCount, 1);
+    for (int i = 0; i < 10; i++) {
+        // the visible page, its neighbors, and the most recently visible page
+        BOOL shouldBeLoaded = i >= 3 && i <= 6;
+        XCTAssertEqual([pages[i] loaded], shouldBeLoaded, @"page %d", i);
+    }
+
+    // flipping back to a recent page is warm too
+    [residency showPage:pages[3]];
+    XCTAssertEqual(residency.hitCount, 6);
+    XCTAssertEqual([pages[3] loadCount], 1);
+
+    // only the visible page is kept when memory is short
+    [residency unloadPagesToFreeBytes:NSUIntegerMax];
+    XCTAssertTrue([pages[3] loaded]);
+    XCTAssertFalse([pages[2] loaded]);
+    XCTAssertFalse([pages[4] loaded]);
+}
+
+- (void)testTextureCacheReusesExactSizesAndEvictsOldest {
+    // a cache of its own, so the shared one's budget and counts don't matter
+    JotTextureCache* cache = [[JotTextureCache alloc] init];
+    int textureBytes = 100 * 100 * 4;
+    cache.byteBudget = 3 * textureBytes;
+    JotGLTexture* first = [[JotGLTexture alloc] initForTextureID:0 withSize:CGSizeMake(100, 100)];
+    JotGLTexture* second = [[JotGLTexture alloc] initForTextureID:0 withSize:CGSizeMake(100, 100)];
+    JotGLTexture* tall = [[JotGLTexture alloc] initForTextureID:0 withSize:CGSizeMake(50, 200)];
+    [cache returnTextureForReuse:first];
+    [cache returnTextureForReuse:second];
+    [cache returnTextureForReuse:tall];
+    XCTAssertEqual(cache.cachedBytes, 3 * textureBytes);
+    XCTAssertEqual(cache.evictionCount, 0);
+
+    // the same number of pixels in another shape isn't reused
+    JotGLTexture* wide = [cache generateTextureForContext:nil ofSize:CGSizeMake(200, 50)];
+    XCTAssertNotEqual(wide, tall);
+    XCTAssertTrue(CGSizeEqualToSize(wide.pixelSize, CGSizeMake(200, 50)));
+    XCTAssertEqual(cache.missCount, 1);
+    XCTAssertEqual(cache.hitCount, 0);
+
+    // the most recently returned texture of the size is reused first
+    XCTAssertEqual([cache generateTextureForContext:nil ofSize:CGSizeMake(100, 100)], second);
+    XCTAssertEqual(cache.hitCount, 1);
+    XCTAssertEqual(cache.cachedBytes, 2 * textureBytes);
+
+    // going over the budget evicts the least recently returned
+    JotGLTexture* third = [[JotGLTexture alloc] initForTextureID:0 withSize:CGSizeMake(100, 100)];
+    [cache returnTextureForReuse:second];
+    [cache returnTextureForReuse:third];
+    XCTAssertEqual(cache.evictionCount, 1);
+    XCTAssertEqual(cache.cachedBytes, 3 * textureBytes);
+    XCTAssertEqual([cache generateTextureForContext:nil ofSize:CGSizeMake(100, 100)], third);
+    XCTAssertEqual([cache generateTextureForContext:nil ofSize:CGSizeMake(100, 100)], second);
+    XCTAssertNotEqual([cache generateTextureForContext:nil ofSize:CGSizeMake(100, 100)], first);
+    XCTAssertEqual(cache.hitCount, 3);
+    XCTAssertEqual(cache.missCount, 2);
+
+    // lowering the budget evicts right away
+    XCTAssertEqual(cache.cachedBytes, textureBytes);
+    cache.byteBudget = 0;
+    XCTAssertEqual(cache.cachedBytes, 0);
+    XCTAssertEqual(cache.evictionCount, 2);
+
+    // the memory manager's evictions also start with the oldest
+    cache.byteBudget = 3 * textureBytes;
+    [cache returnTextureForReuse:wide];
+    [cache returnTextureForReuse:second];
+    XCTAssertEqual([cache evictBytes:1], textureBytes);
+    XCTAssertEqual(cache.evictionCount, 3);
+    XCTAssertEqual([cache generateTextureForContext:nil ofSize:CGSizeMake(100, 100)], second);
+    XCTAssertEqual([cache evictBytes:textureBytes], 0);
+}
+
+- (void)testWarmTextureCacheRoundTrip {
+    NSUInteger width = 1024;
+    NSUInteger height = 768;
+    NSMutableData* page = [NSMutableData dataWithLength:width * height * 4];
+    uint8_t* px = [page mutableBytes];
+    // a solid line of ink across a mostly empty page
+    for (NSUInteger x = 100; x < 900; x++) {
+        for (NSUInteger y = 300; y < 304; y++) {
+            px[(y * width + x) * 4 + 2] = 200;
+            px[(y * width + x) * 4 + 3] = 255;
+        }
+    }
+    JotInkTileSet* tiles = [JotInkTileSet tileSetWithPixels:px bytesPerRow:width * 4 pixelSize:CGSizeMake(width, height)];
+    NSString* imagePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+
+    JotWarmTextureCache* cache = [JotWarmTextureCache sharedCache];
+    NSUInteger cachedBytes = cache.cachedBytes;
+    [cache cacheTiles:tiles forImagePath:imagePath];
+    XCTAssertLessThan(cache.cachedBytes - cachedBytes, [page length] / 50);
+
+    JotInkTileSet* restored = [cache takeTilesForImagePath:imagePath withPixelSize:CGSizeMake(width, height)];
+    XCTAssertEqualObjects([restored denseBytes], page);
+    XCTAssertEqual(cache.cachedBytes, cachedBytes);
+    XCTAssertNil([cache takeTilesForImagePath:imagePath withPixelSize:CGSizeMake(width, height)]);
+
+    // anything saved to the path since makes the ink stale
+    [cache cacheTiles:tiles forImagePath:imagePath];
+    [page writeToFile:imagePath atomically:YES];
+    XCTAssertNil([cache takeTilesForImagePath:imagePath withPixelSize:CGSizeMake(width, height)]);
+    [[NSFileManager defaultManager] removeItemAtPath:imagePath error:nil];
+}
+
+- (void)testPageQueuesRunDifferentPagesInParallel {
+    dispatch_queue_t pageA = [JotView importExportImageQueueForPath:@"pageA/ink.png"];
+    dispatch_queue_t pageB = [JotView importExportImageQueueForPath:@"pageB/ink.png"];
+    XCTAssertEqual(pageA, [JotView importExportImageQueueForPath:@"pageA/ink.png"]);
+    XCTAssertNotEqual(pageA, pageB);
+    XCTAssertEqual([JotView importExportImageQueueForPath:nil], [JotView importExportImageQueue]);
+
+    // page A waits for page B, which would never run if they shared a queue
+    dispatch_semaphore_t pageBDidRun = dispatch_semaphore_create(0);
+    dispatch_semaphore_t pageADidFinish = dispatch_semaphore_create(0);
+    __block BOOL isImportExportQueue = NO;
+    __block long waitResult = -1;
+    dispatch_async(pageA, ^{
+        isImportExportQueue = [JotView isImportExportImageQueue];
+        waitResult = dispatch_semaphore_wait(pageBDidRun, dispatch_time(DISPATCH_TIME_NOW, 5 * NSEC_PER_SEC));
+        dispatch_semaphore_signal(pageADidFinish);
+    });
+    dispatch_async(pageB, ^{
+        dispatch_semaphore_signal(pageBDidRun);
+    });
+    dispatch_semaphore_wait(pageADidFinish, DISPATCH_TIME_FOREVER);
+    XCTAssertTrue(isImportExportQueue);
+    XCTAssertEqual(waitResult, 0);
+
+    // a page's queue goes away once nothing holds it or runs on it
+    __weak dispatch_queue_t unusedQueue;
+    @autoreleasepool {
+        unusedQueue = [JotView importExportStateQueueForPath:@"pageC/state.plist"];
+        XCTAssertNotNil(unusedQueue);
+    }
+    XCTAssertNil(unusedQueue);
+}
+
+// loads the page, and returns once its first batch of strokes has loaded
+- (JotTestProgressivePage*)pausedPageInDirectory:(NSString*)directory withContext:(JotGLContext*)context {
+    JotTestProgressivePage* page = [[JotTestProgressivePage alloc] initWithDirectory:directory];
+    [page loadJotStateAsynchronously:NO withSize:CGSizeMake(100, 100) andScale:1 andContext:context andBufferManager:[JotBufferManager sharedInstance]];
+
+    // the state is loaded as soon as its texture is, and its strokes are still loading
+    XCTAssertTrue([page isStateLoaded]);
+    XCTAssertNotNil([page backgroundTexture]);
+    XCTAssertTrue([page isLoadingStrokes]);
+    XCTAssertFalse([page isReadyToExport]);
+
+    XCTAssertEqual(dispatch_semaphore_wait(page.didPause, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)), 0);
+    XCTAssertEqual([page loadedStrokeCount], 16);
+    XCTAssertFalse([page hasEditsToSave]);
+    return page;
+}
+
+- (void)finishLoadingPage:(JotTestProgressivePage*)page {
+    dispatch_semaphore_signal(page.resume);
+    XCTAssertEqual(dispatch_semaphore_wait(page.didFinish, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)), 0);
+    XCTAssertFalse([page isLoadingStrokes]);
+    XCTAssertTrue([page isReadyToExport]);
+}
+
+- (void)testProgressiveLoadKeepsEditsAboveLoadedStrokes {
+    // 20 saved strokes and 20 undone ones, which each have
+    // a different number of segments
+    NSString* directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+    NSMutableArray* strokes = [NSMutableArray array];
+    NSMutableArray* undoneStrokes = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 40; i++) {
+        NSString* uuid = [[NSUUID UUID] UUIDString];
+        NSString* path = [[directory stringByAppendingPathComponent:uuid] stringByAppendingPathExtension:kJotStrokeBinaryFileExt];
+        XCTAssertTrue([JotStrokeFile writeStrokeDictionary:[self strokeDictionaryWithSegments:i + 2] toPath:path]);
+        [(i < 20 ? strokes : undoneStrokes) addObject:uuid];
+    }
+    NSDictionary* stateInfo = @{ @"stackOfStrokes": strokes,
+                                 @"stackOfUndoneStrokes": undoneStrokes,
+                                 @"undoLimit": @50,
+                                 @"screenSize.width": @100,
+                                 @"screenSize.height": @100 };
+    XCTAssertTrue([stateInfo writeToFile:[directory stringByAppendingPathComponent:@"state.plist"] atomically:YES]);
+
+    JotGLContext* context = [[JotGLContext alloc] initWithName:@"JotTestLoadContext" andValidateThreadWith:^BOOL {
+        return YES;
+    }];
+    JotViewState* loadedAtOnce = [[JotViewState alloc] initWithImageFile:[directory stringByAppendingPathComponent:@"ink.png"]
+                                                            andStateFile:[directory stringByAppendingPathComponent:@"state.plist"]
+                                                             andPageSize:CGSizeMake(100, 100)
+                                                                andScale:1
+                                                            andGLContext:context
+                                                        andBufferManager:[JotBufferManager sharedInstance]];
+    XCTAssertFalse([loadedAtOnce hasEditsSinceLoad]);
+
+    // the most recent strokes load first, and strokes drawn
+    // and undone meanwhile stay above the rest
+    JotTestProgressivePage* page = [self pausedPageInDirectory:directory withContext:context];
+    XCTAssertEqual([[(JotStroke*)[[page everyVisibleStroke] lastObject] segments] count], 21);
+    JotStroke* undone = [[JotStroke alloc] initFromDictionary:[self strokeDictionaryWithSegments:100]];
+    JotStroke* drawn = [[JotStroke alloc] initFromDictionary:[self strokeDictionaryWithSegments:120]];
+    [page forceAddStroke:undone];
+    XCTAssertTrue([page hasEditsToSave]);
+    XCTAssertEqual([page undo], undone);
+    [page forceAddStroke:drawn];
+    XCTAssertTrue([page.jotViewState hasEditsSinceLoad]);
+    [self finishLoadingPage:page];
+
+    XCTAssertEqual([page loadedStrokeCount], 40);
+    XCTAssertEqual([page.jotViewState loadedUndoHash], [loadedAtOnce undoHash]);
+    XCTAssertEqual([page lastSavedUndoHash], [loadedAtOnce undoHash]);
+    XCTAssertTrue([page hasEditsToSave]);
+    NSArray* visibleStrokes = [page everyVisibleStroke];
+    XCTAssertEqual([visibleStrokes count], 21);
+    XCTAssertEqual([visibleStrokes lastObject], drawn);
+    for (NSUInteger i = 0; i < 20; i++) {
+        XCTAssertEqual([[(JotStroke*)visibleStrokes[i] segments] count], i + 2);
+    }
+
+    // forgetting the edits leaves what was saved
+    XCTAssertEqual([page undoAndForget], drawn);
+    XCTAssertEqual([page redo], undone);
+    XCTAssertEqual([page undoAndForget], undone);
+    XCTAssertFalse([page hasEditsToSave]);
+    XCTAssertEqual([page undoHash], [loadedAtOnce undoHash]);
+    for (NSUInteger i = 40; i > 20; i--) {
+        XCTAssertEqual([[[page redo] segments] count], i + 1);
+    }
+    XCTAssertFalse([page canRedo]);
+
+    // clearing the page throws away the strokes that are still loading
+    JotTestProgressivePage* cleared = [self pausedPageInDirectory:directory withContext:context];
+    [cleared clearAllStrokes];
+    [self finishLoadingPage:cleared];
+    XCTAssertEqual([[cleared everyVisibleStroke] count], 0);
+    XCTAssertFalse([cleared canRedo]);
+    XCTAssertEqual([cleared loadedStrokeCount], 16);
+    XCTAssertEqual([cleared.jotViewState loadedUndoHash], [loadedAtOnce undoHash]);
+    XCTAssertTrue([cleared hasEditsToSave]);
+
+    // a cancelled load stops before its next stroke
+    JotTestProgressivePage* cancelled = [self pausedPageInDirectory:directory withContext:context];
+    [cancelled.jotViewState cancelLoadingStrokes];
+    [self finishLoadingPage:cancelled];
+    XCTAssertEqual([cancelled loadedStrokeCount], 16);
+    XCTAssertEqual([[cancelled everyVisibleStroke] count], 16);
+    XCTAssertFalse([cancelled canRedo]);
+
+    // the edited pages would otherwise refuse to deallocate
+    page.isForgetful = YES;
+    cleared.isForgetful = YES;
+    cancelled.isForgetful = YES;
+    [[NSFileManager defaultManager] removeItemAtPath:directory error:nil];
+}
+
+- (void)testContextPoolBoundsAndReusesContexts {
+    JotGLContext* contextA = [[JotGLContext alloc] initWithName:@"JotTestContextA" andValidateThreadWith:^BOOL {
+        return YES;
+    }];
+    JotGLContext* contextB = [[JotGLContext alloc] initWithName:@"JotTestContextB" andValidateThreadWith:^BOOL {
+        return YES;
+    }];
+    JotGLContextPool* pool = [[JotGLContextPool alloc] init];
+    [pool setGLContext:contextA];
+
+    // no more than maxContexts blocks run at once
+    pool.maxContexts = 2;
+    __block NSInteger runningCount = 0;
+    __block NSInteger mostRunning = 0;
+    NSObject* lock = [[NSObject alloc] init];
+    dispatch_apply(6, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        [pool runBlock:^(JotGLContext* context) {
+            @synchronized(lock) {
+                runningCount++;
+                mostRunning = MAX(mostRunning, runningCount);
+            }
+            usleep(20000);
+            @synchronized(lock) {
+                runningCount--;
+            }
+        }];
+    });
+    XCTAssertLessThanOrEqual(mostRunning, 2);
+    XCTAssertLessThanOrEqual(pool.contextCount, 2);
+
+    // a nested block reuses its thread's context instead of waiting for
+    // another, and the next block on the thread gets it back from the pool
+    pool.maxContexts = 1;
+    __block JotGLContext* outerContext;
+    __block JotGLContext* innerContext;
+    [pool runBlock:^(JotGLContext* context) {
+        outerContext = context;
+        [pool runBlock:^(JotGLContext* nestedContext) {
+            innerContext = nestedContext;
+        }];
+    }];
+    XCTAssertNotNil(outerContext);
+    XCTAssertEqual(innerContext, outerContext);
+    XCTAssertEqual(outerContext.sharegroup, contextA.sharegroup);
+    [pool runBlock:^(JotGLContext* context) {
+        innerContext = context;
+    }];
+    XCTAssertEqual(innerContext, outerContext);
+    XCTAssertEqual(pool.contextCount, 1);
+
+    // a new sharegroup drops the contexts of the old one, even those
+    // that were checked out when it changed
+    [pool runBlock:^(JotGLContext* context) {
+        [pool setGLContext:contextB];
+    }];
+    XCTAssertEqual(pool.sharegroup, contextB.sharegroup);
+    XCTAssertEqual(pool.contextCount, 0);
+    [pool runBlock:^(JotGLContext* context) {
+        innerContext = context;
+    }];
+    XCTAssertNotEqual(innerContext, outerContext);
+    XCTAssertEqual(innerContext.sharegroup, contextB.sharegroup);
+    XCTAssertEqual(pool.contextCount, 1);
+}
+
+- (void)testContextPoolWarmsEveryContext {
+    JotGLContext* context = [[JotGLContext alloc] initWithName:@"JotTestContext" andValidateThreadWith:^BOOL {
+        return YES;
+    }];
+    JotGLContextPool* pool = [[JotGLContextPool alloc] init];
+    pool.maxContexts = 3;
+    [pool warmUp];
+    XCTAssertEqual(pool.contextCount, 0);
+
+    // every context is built, even if the warm up runs on one thread
+    [pool setGLContext:context];
+    [pool warmUp];
+    NSDate* timeout = [NSDate dateWithTimeIntervalSinceNow:10];
+    while (pool.contextCount < 3 && [timeout timeIntervalSinceNow] > 0) {
+        usleep(10000);
+    }
+    XCTAssertEqual(pool.contextCount, 3);
+}
+
+- (void)testContextPoolEndsAProfilerFrameForEachBlock {
+    JotGLContext* context = [[JotGLContext alloc] initWithName:@"JotTestContext" andValidateThreadWith:^BOOL {
+        return YES;
+    }];
+    JotGLContextPool* pool = [[JotGLContextPool alloc] init];
+    [pool setGLContext:context];
+
+    __block JotGLContext* pooledContext;
+    __block uint64_t framesDuringBlock = 0;
+    [pool runBlock:^(JotGLContext* outerContext) {
+        pooledContext = outerContext;
+        [pool runBlock:^(JotGLContext* nestedContext) {
+            [nestedContext flush];
+        }];
+        framesDuringBlock = JotGLProfilerGetFrameCount([outerContext profiler]);
+    }];
+
+    // a nested block doesn't end the frame, and the
+    // profiler is NULL unless profiling is compiled in
+    XCTAssertEqual(framesDuringBlock, 0);
+    XCTAssertEqual(JotGLProfilerGetFrameCount([pooledContext profiler]), kJotEnableGLProfiling ? 1 : 0);
+}
+
+- (void)testProgramsShareShadersAcrossSharegroup {
+    JotGLContext* contextA = [[JotGLContext alloc] initWithName:@"JotTestContextA" andValidateThreadWith:^BOOL {
+        return YES;
+    }];
+    JotGLContext* contextB = [[JotGLContext alloc] initWithName:@"JotTestContextB" andSharegroup:contextA.sharegroup andValidateThreadWith:^BOOL {
+        return YES;
+    }];
+
+    GLuint programs[2] = { 0, 0 };
+    GLuint shaders[2][2] = { { 0, 0 }, { 0, 0 } };
+    NSArray* contexts = @[contextA, contextB];
+    for (NSUInteger i = 0; i < [contexts count]; i++) {
+        JotGLContext* context = contexts[i];
+        [context runBlock:^{
+            [context warmUpPrograms];
+            JotGLQuadProgram* program = [context quadProgram];
+            program.canvasSize = GLSizeMake(100, 100);
+            [program use];
+            GLint currentProgram;
+            glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
+            programs[i] = (GLuint)currentProgram;
+            GLsizei count;
+            glGetAttachedShaders(programs[i], 2, &count, shaders[i]);
+            XCTAssertEqual(count, 2);
+            XCTAssertEqual([program uniformMVPIndex], (GLuint)glGetUniformLocation(programs[i], "MVP"));
+        }];
+    }
+
+    // each context links its own program from the same compiled shaders
+    XCTAssertNotEqual(programs[0], 0);
+    XCTAssertNotEqual(programs[1], 0);
+    XCTAssertTrue(shaders[0][0] == shaders[1][0] || shaders[0][0] == shaders[1][1]);
+    XCTAssertTrue(shaders[0][1] == shaders[1][0] || shaders[0][1] == shaders[1][1]);
+}
+
+- (void)testCommandBufferStripsRedundantState {
+    JotGLMockBackend* mock = JotGLMockBackendCreate();
+    JotGLCommandState* state = JotGLCommandStateCreate();
+    JotGLCommandQueue* queue = JotGLCommandQueueCreate();
+
+    // two threads each record the same state and a draw
+    dispatch_apply(2, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        JotGLCommandBuffer* buffer = JotGLCommandBufferCreate();
+        JotGLCommandBufferBindFramebuffer(buffer, 3);
+        JotGLCommandBufferEnable(buffer, GL_BLEND);
+        JotGLCommandBufferEnable(buffer, GL_BLEND);
+        JotGLCommandBufferBlendFunc(buffer, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        JotGLCommandBufferBindArrayBuffer(buffer, 7);
+        JotGLCommandBufferBufferSubData(buffer, 16, "ink", 4);
+        JotGLCommandBufferVertexAttribPointer(buffer, 0, 2, GL_FLOAT, NO, 12, (const void*)8);
+        JotGLCommandBufferVertexAttribPointer(buffer, 0, 2, GL_FLOAT, NO, 12, (const void*)8);
+        JotGLCommandBufferDrawArrays(buffer, GL_POINTS, 0, 10);
+        XCTAssertEqual(JotGLCommandBufferGetCommandCount(buffer), 7);
+        XCTAssertEqual(JotGLCommandBufferGetElidedCount(buffer), 2);
+        JotGLCommandQueueEnqueue(queue, buffer);
+    });
+    XCTAssertEqual(JotGLCommandQueueGetBufferCount(queue), 2);
+
+    // the second buffer only uploads and draws
+    XCTAssertEqual(JotGLCommandQueueSubmit(queue, state, JotGLMockBackendGetBackend(mock)), 9);
+    XCTAssertEqual(JotGLCommandStateGetElidedCount(state), 5);
+    XCTAssertEqual(JotGLMockBackendGetCountOfType(mock, JotGLCommandDrawArrays), 2);
+    XCTAssertEqual(JotGLMockBackendGetCountOfType(mock, JotGLCommandBindFramebuffer), 1);
+    XCTAssertEqual(JotGLMockBackendGetUploadedBytes(mock), 8);
+
+    JotGLCommand command;
+    XCTAssertTrue(JotGLMockBackendGetCommand(mock, 5, &command));
+    XCTAssertEqual(command.type, JotGLCommandVertexAttribPointer);
+    XCTAssertEqual(command.ints[4], 12);
+    XCTAssertEqual(command.pointer, (const void*)8);
+    XCTAssertFalse(JotGLMockBackendGetCommand(mock, 9, &command));
+
+    JotGLCommandQueueFree(queue);
+    JotGLCommandStateFree(state);
+    JotGLMockBackendFree(mock);
+}
+
+- (void)testProfilerCountsFramesAndWritesTrace {
+    JotGLProfiler* profiler = JotGLProfilerCreate();
+
+    JotGLProfilerRecordCall(profiler, JotGLCallDrawArrays, 100);
+    JotGLProfilerRecordCall(profiler, JotGLCallDrawArrays, 50);
+    JotGLProfilerRecordElided(profiler, JotGLCallBindTexture);
+    JotGLProfilerRecordUpload(profiler, 64);
+    JotGLProfilerEndFrame(profiler);
+    JotGLProfilerRecordCall(profiler, JotGLCallUseProgram, 10);
+    JotGLProfilerEndFrame(profiler);
+    XCTAssertEqual(JotGLProfilerGetFrameCount(profiler), 2);
+
+    JotGLProfileFrame frame;
+    XCTAssertTrue(JotGLProfilerGetFrame(profiler, 1, &frame));
+    XCTAssertEqual(frame.frameNumber, 1);
+    XCTAssertEqual(frame.callCounts[JotGLCallDrawArrays], 2);
+    XCTAssertEqual(frame.callNanoseconds[JotGLCallDrawArrays], 150);
+    XCTAssertEqual(frame.elidedCounts[JotGLCallBindTexture], 1);
+    XCTAssertEqual(frame.uploadedBytes, 64);
+    XCTAssertFalse(JotGLProfilerGetFrame(profiler, 2, &frame));
+
+    JotGLProfileFrame totals;
+    JotGLProfilerGetTotals(profiler, &totals);
+    XCTAssertEqual(JotGLProfileFrameGetCallCount(&totals), 3);
+    XCTAssertEqual(JotGLProfileFrameGetElidedCount(&totals), 1);
+    XCTAssertEqual(JotGLProfileFrameGetNanoseconds(&totals), 160);
+
+    // measures the trace first, like snprintf
+    size_t length = JotGLProfilerWriteTrace(profiler, NULL, 0);
+    char* trace = malloc(length + 1);
+    XCTAssertEqual(JotGLProfilerWriteTrace(profiler, trace, length + 1), length);
+    NSString* csv = [NSString stringWithUTF8String:trace];
+    free(trace);
+    XCTAssertTrue([csv hasPrefix:@"frame,call,count,nanoseconds,elided,bytes\n"]);
+    XCTAssertTrue([csv containsString:@"1,glDrawArrays,2,150,0,\n"]);
+    XCTAssertTrue([csv containsString:@"1,glBindTexture,0,0,1,\n"]);
+    XCTAssertTrue([csv containsString:@"total,uploads,,,,64\n"]);
+
+    JotGLProfilerReset(profiler);
+    XCTAssertEqual(JotGLProfilerGetFrameCount(profiler), 0);
+    JotGLProfilerFree(profiler);
+}
+
+- (void)testTrashManagerIgnoresDuplicates {
+    JotTrashManager* trash = [JotTrashManager sharedInstance];
+    NSInteger countBefore = [trash numberOfItemsInTrash];
+    NSMutableArray* objs = [NSMutableArray array];
+    for (int i = 0; i < 10000; i++) {
+        [objs addObject:[[NSObject alloc] init]];
+    }
+    [trash addObjectsToDealloc:objs];
+    [trash addObjectsToDealloc:objs];
+    [trash addObjectToDealloc:[objs lastObject]];
+    XCTAssertEqual([trash numberOfItemsInTrash], countBefore + [objs count]);
+}
+
+- (void)testStrokeFileEncodePerformance {
+    NSDictionary* stroke = [self strokeDictionaryWithSegments:2000];
+
+    [self measureBlock:^{
+        [JotStrokeFile dataForStrokeDictionary:stroke];
+    }];
+}
+
+- (void)testStrokeFileDecodePerformance {
+    NSData* data = [JotStrokeFile dataForStrokeDictionary:[self strokeDictionaryWithSegments:2000]];
+
+    [self measureBlock:^{
+        [JotStrokeFile strokeDictionaryFromData:data];
+    }];
+}
+
+- (void)testStrokeLoadPerformance {
+    NSData* data = [JotStrokeFile dataForStrokeDictionary:[self strokeDictionaryWithSegments:2000]];
+
+    // what loading a page does, from the file to the stroke's segments
+    [self measureBlock:^{
+        [[JotStroke alloc] initFromDictionary:[JotStrokeFile strokeDictionaryFromData:data withLazySegments:NO]];
+    }];
+}
+
+- (void)testStrokePlistDecodePerformance {
+    // the format the binary files replace, for comparison
+    NSData* data = [NSPropertyListSerialization dataWithPropertyList:[self strokeDictionaryWithSegments:2000] format:NSPropertyListXMLFormat_v1_0 options:0 error:nil];
+
+    [self measureBlock:^{
+        [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListMutableContainers format:nil error:nil];
+    }];
+}
+
 @end